@@ -0,0 +1,223 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include <QDateTime>
+#include <QSignalSpy>
+#include <QTest>
+
+#include <QAlphaCloud/AdaptivePoller>
+#include <QAlphaCloud/Connector>
+#include <QAlphaCloud/OneDayPowerModel>
+#include <QAlphaCloud/QAlphaCloud>
+
+#include "testnetworkaccessmanager.h"
+
+using namespace QAlphaCloud;
+
+class AdaptivePollerTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+
+    void testInitialState();
+    void testLearnPeriod();
+    void testLearnPeriodMissedUpdate();
+    void testMissedPoll();
+    void testErrorBackoff();
+    void testIdleBackoff();
+    void testOneDayPowerModelTarget();
+
+private:
+    // Milliseconds until the next poll.
+    static qint64 nextPollDelay(const AdaptivePoller &poller);
+};
+
+qint64 AdaptivePollerTest::nextPollDelay(const AdaptivePoller &poller)
+{
+    return QDateTime::currentDateTime().msecsTo(poller.nextPollTime());
+}
+
+void AdaptivePollerTest::initTestCase()
+{
+    // Don't talk to a daemon that might be running.
+    qputenv("QALPHACLOUD_NO_DAEMON", "1");
+}
+
+void AdaptivePollerTest::testInitialState()
+{
+    AdaptivePoller poller;
+    QCOMPARE(poller.target(), nullptr);
+    QVERIFY(!poller.running());
+    QCOMPARE(poller.interval(), 10000);
+    QCOMPARE(poller.learnedPeriod(), 0);
+    QVERIFY(!poller.nextPollTime().isValid());
+
+    QSignalSpy pollRequestedSpy(&poller, &AdaptivePoller::pollRequested);
+
+    // Polls right away.
+    poller.start();
+    QVERIFY(poller.running());
+    QCOMPARE(pollRequestedSpy.count(), 1);
+    QVERIFY(poller.nextPollTime().isValid());
+
+    // Nothing learned yet, uses the regular interval.
+    QVERIFY(qAbs(nextPollDelay(poller) - 10000) < 1000);
+
+    poller.stop();
+    QVERIFY(!poller.running());
+    QVERIFY(!poller.nextPollTime().isValid());
+}
+
+void AdaptivePollerTest::testLearnPeriod()
+{
+    AdaptivePoller poller;
+    poller.setInterval(60000);
+
+    const QDateTime now = QDateTime::currentDateTime();
+
+    poller.recordUpdate(now.addMSecs(-25000));
+    poller.recordUpdate(now.addMSecs(-15000));
+    QCOMPARE(poller.learnedPeriod(), 0);
+
+    poller.recordUpdate(now.addMSecs(-5000));
+    QCOMPARE(poller.learnedPeriod(), 10000);
+
+    // Older updates are ignored.
+    poller.recordUpdate(now.addMSecs(-6000));
+    QCOMPARE(poller.learnedPeriod(), 10000);
+
+    poller.start();
+
+    // Next update is expected in 5 seconds, poll shortly after that rather than in a minute.
+    const qint64 delay = nextPollDelay(poller);
+    QVERIFY2(delay > 5000 && delay < 7000, qPrintable(QString::number(delay)));
+}
+
+void AdaptivePollerTest::testLearnPeriodMissedUpdate()
+{
+    AdaptivePoller poller;
+
+    const QDateTime start = QDateTime::currentDateTime().addSecs(-120);
+
+    poller.recordUpdate(start);
+    poller.recordUpdate(start.addSecs(10));
+    poller.recordUpdate(start.addSecs(20));
+    poller.recordUpdate(start.addSecs(30));
+    // Missed one in between.
+    poller.recordUpdate(start.addSecs(50));
+
+    QCOMPARE(poller.learnedPeriod(), 10000);
+}
+
+void AdaptivePollerTest::testMissedPoll()
+{
+    AdaptivePoller poller;
+    poller.setInterval(60000);
+
+    const QDateTime now = QDateTime::currentDateTime();
+    poller.recordUpdate(now.addSecs(-30));
+    poller.recordUpdate(now.addSecs(-20));
+    poller.recordUpdate(now.addSecs(-10));
+    QCOMPARE(poller.learnedPeriod(), 10000);
+
+    poller.start();
+
+    // Expected update didn't arrive, check again shortly.
+    poller.recordNoChange();
+    const qint64 delay = nextPollDelay(poller);
+    QVERIFY2(delay > 0 && delay <= 1500, qPrintable(QString::number(delay)));
+}
+
+void AdaptivePollerTest::testErrorBackoff()
+{
+    AdaptivePoller poller;
+    poller.setInterval(10000);
+    poller.start();
+
+    poller.recordError();
+    QVERIFY(qAbs(nextPollDelay(poller) - 20000) < 1000);
+
+    poller.recordError();
+    QVERIFY(qAbs(nextPollDelay(poller) - 40000) < 1000);
+
+    // Back to normal.
+    poller.recordNoChange();
+    QVERIFY(qAbs(nextPollDelay(poller) - 10000) < 1000);
+}
+
+void AdaptivePollerTest::testIdleBackoff()
+{
+    AdaptivePoller poller;
+    poller.setInterval(10000);
+    poller.setMaximumInterval(60000);
+    poller.start();
+
+    poller.recordNoChange(true /*idle*/);
+    QVERIFY(qAbs(nextPollDelay(poller) - 20000) < 1000);
+
+    poller.recordNoChange(true /*idle*/);
+    QVERIFY(qAbs(nextPollDelay(poller) - 40000) < 1000);
+
+    // Capped to maximumInterval.
+    poller.recordNoChange(true /*idle*/);
+    QVERIFY(qAbs(nextPollDelay(poller) - 60000) < 1000);
+
+    // Something happened, back to normal.
+    poller.recordUpdate(QDateTime::currentDateTime());
+    QVERIFY(qAbs(nextPollDelay(poller) - 10000) < 1000);
+}
+
+void AdaptivePollerTest::testOneDayPowerModelTarget()
+{
+    TestNetworkAccessManager networkAccessManager;
+
+    Connector connector;
+    // Don't rely on defaultConfiguration in tests!
+    auto *configuration = new Configuration(&connector);
+    configuration->setAppId(QStringLiteral("adaptivePollerTestApp"));
+    configuration->setAppSecret(QStringLiteral("testSecret"));
+    connector.setConfiguration(configuration);
+    connector.setNetworkAccessManager(&networkAccessManager);
+
+    OneDayPowerModel model(&connector, QStringLiteral("SERIAL"), QDate(2023, 01, 01));
+    // Every poll should actually ask the API.
+    model.setCached(false);
+
+    AdaptivePoller poller(&model);
+    poller.setInterval(10000);
+    QCOMPARE(poller.target(), &model);
+
+    // Errors back off.
+    networkAccessManager.setOverrideUrl(QUrl::fromLocalFile(QFINDTESTDATA("data/api_error.json")));
+    poller.start();
+    QCOMPARE(model.status(), QAlphaCloud::RequestStatus::Loading);
+    QTRY_COMPARE(model.status(), QAlphaCloud::RequestStatus::Error);
+    QVERIFY(qAbs(nextPollDelay(poller) - 20000) < 1000);
+
+    // New data, back to normal.
+    networkAccessManager.setOverrideUrl(QUrl::fromLocalFile(QFINDTESTDATA("data/onedaypower.json")));
+    QVERIFY(model.reload());
+    QTRY_COMPARE(model.status(), QAlphaCloud::RequestStatus::Finished);
+    QCOMPARE(model.rowCount(), 3);
+    QVERIFY(qAbs(nextPollDelay(poller) - 10000) < 1000);
+
+    // Same data again, but the system is producing, so keep polling at the regular interval.
+    QVERIFY(model.reload());
+    QCOMPARE(model.status(), QAlphaCloud::RequestStatus::Loading);
+    QTRY_COMPARE(model.status(), QAlphaCloud::RequestStatus::Finished);
+    QVERIFY(qAbs(nextPollDelay(poller) - 10000) < 1000);
+
+    // No production at all, back off.
+    networkAccessManager.setOverrideUrl(QUrl::fromLocalFile(QFINDTESTDATA("data/empty_array.json")));
+    QVERIFY(model.reload());
+    QTRY_COMPARE(model.status(), QAlphaCloud::RequestStatus::Finished);
+    QCOMPARE(model.rowCount(), 0);
+    QVERIFY(qAbs(nextPollDelay(poller) - 20000) < 1000);
+}
+
+QTEST_GUILESS_MAIN(AdaptivePollerTest)
+#include "adaptivepollertest.moc"
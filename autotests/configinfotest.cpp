@@ -0,0 +1,251 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include <QNetworkReply>
+#include <QStandardPaths>
+#include <QTest>
+#include <QTime>
+
+#include <QAlphaCloud/ChargeConfigInfo>
+#include <QAlphaCloud/Connector>
+#include <QAlphaCloud/DischargeConfigInfo>
+#include <QAlphaCloud/QAlphaCloud>
+#include <QAlphaCloud/RequestGroup>
+
+#include "testnetworkaccessmanager.h"
+
+using namespace QAlphaCloud;
+
+static QString g_serialNumber = QStringLiteral("SERIAL");
+
+class ConfigInfoTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void testInitialState();
+
+    void testChargeData();
+    void testDischargeData();
+    void testCache();
+    void testCoalescing();
+    void testRequestGroup();
+
+    void testApiError();
+
+private:
+    TestNetworkAccessManager m_networkAccessManager;
+    Connector m_connector;
+};
+
+void ConfigInfoTest::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+
+    // Don't rely on defaultConfiguration in tests!
+    auto *configuration = new Configuration(&m_connector);
+    configuration->setAppId(QStringLiteral("configInfoApp"));
+    configuration->setAppSecret(QStringLiteral("testSecret"));
+    m_connector.setConfiguration(configuration);
+
+    m_connector.setNetworkAccessManager(&m_networkAccessManager);
+}
+
+void ConfigInfoTest::testInitialState()
+{
+    {
+        ChargeConfigInfo config;
+        QCOMPARE(config.status(), RequestStatus::NoRequest);
+        QVERIFY(!config.valid());
+        QVERIFY(config.cached());
+
+        // Can't load without a connector.
+        QVERIFY(!config.reload());
+    }
+
+    {
+        DischargeConfigInfo config(&m_connector, QString() /*serialNumber*/);
+        QCOMPARE(config.connector(), &m_connector);
+        QCOMPARE(config.status(), RequestStatus::NoRequest);
+        QVERIFY(!config.valid());
+
+        // Can't load without a serial number.
+        QVERIFY(!config.reload());
+
+        config.setSerialNumber(g_serialNumber);
+        QCOMPARE(config.serialNumber(), g_serialNumber);
+    }
+}
+
+void ConfigInfoTest::testChargeData()
+{
+    m_networkAccessManager.setOverrideUrl(QUrl::fromLocalFile(QFINDTESTDATA("data/chargeconfiginfo.json")));
+
+    ChargeConfigInfo config(&m_connector, g_serialNumber);
+
+    QVERIFY(config.forceReload());
+    QCOMPARE(config.status(), RequestStatus::Loading);
+
+    QTRY_COMPARE(config.status(), RequestStatus::Finished);
+    QCOMPARE(config.error(), ErrorCode::NoError);
+    QVERIFY(config.valid());
+
+    QVERIFY(config.gridChargeEnabled());
+    QCOMPARE(config.chargeLimit(), 90.0);
+    QCOMPARE(config.period1Start(), QTime(1, 0));
+    QCOMPARE(config.period1End(), QTime(5, 30));
+    QCOMPARE(config.period2Start(), QTime(0, 0));
+    QCOMPARE(config.period2End(), QTime(0, 0));
+
+    config.reset();
+    QCOMPARE(config.status(), RequestStatus::NoRequest);
+    QVERIFY(!config.valid());
+    QCOMPARE(config.chargeLimit(), 0.0);
+}
+
+void ConfigInfoTest::testDischargeData()
+{
+    m_networkAccessManager.setOverrideUrl(QUrl::fromLocalFile(QFINDTESTDATA("data/dischargeconfiginfo.json")));
+
+    DischargeConfigInfo config(&m_connector, g_serialNumber);
+
+    QVERIFY(config.forceReload());
+    QCOMPARE(config.status(), RequestStatus::Loading);
+
+    QTRY_COMPARE(config.status(), RequestStatus::Finished);
+    QCOMPARE(config.error(), ErrorCode::NoError);
+    QVERIFY(config.valid());
+
+    QVERIFY(!config.dischargeControlEnabled());
+    QCOMPARE(config.dischargeLimit(), 10.0);
+    QCOMPARE(config.period1Start(), QTime(18, 0));
+    QCOMPARE(config.period1End(), QTime(23, 45));
+}
+
+void ConfigInfoTest::testCache()
+{
+    m_networkAccessManager.setOverrideUrl(QUrl::fromLocalFile(QFINDTESTDATA("data/chargeconfiginfo.json")));
+
+    {
+        ChargeConfigInfo config(&m_connector, g_serialNumber);
+        QVERIFY(config.forceReload());
+        QTRY_COMPARE(config.status(), RequestStatus::Finished);
+    }
+
+    // Would fail if it actually sent a request.
+    m_networkAccessManager.setOverrideUrl(QUrl::fromLocalFile(QFINDTESTDATA("data/garbled.json")));
+
+    ChargeConfigInfo config(&m_connector, g_serialNumber);
+    QVERIFY(config.reload());
+    // Served from cache right away.
+    QCOMPARE(config.status(), RequestStatus::Finished);
+    QVERIFY(config.valid());
+    QCOMPARE(config.chargeLimit(), 90.0);
+
+    // Not when disabled.
+    config.setCached(false);
+    QVERIFY(config.reload());
+    QCOMPARE(config.status(), RequestStatus::Loading);
+    QTRY_COMPARE(config.status(), RequestStatus::Error);
+    QCOMPARE(config.error(), ErrorCode::JsonParseError);
+    // Old data is retained.
+    QVERIFY(config.valid());
+}
+
+void ConfigInfoTest::testCoalescing()
+{
+    m_networkAccessManager.setOverrideUrl(QUrl::fromLocalFile(QFINDTESTDATA("data/dischargeconfiginfo.json")));
+
+    DischargeConfigInfo config1(&m_connector, g_serialNumber);
+    DischargeConfigInfo config2(&m_connector, g_serialNumber);
+
+    QVERIFY(config1.forceReload());
+    QCOMPARE(config1.status(), RequestStatus::Loading);
+
+    // Joins the request in-flight.
+    QVERIFY(config2.reload());
+    QCOMPARE(config2.status(), RequestStatus::Loading);
+
+    QTRY_COMPARE(config1.status(), RequestStatus::Finished);
+    QCOMPARE(config2.status(), RequestStatus::Finished);
+    QCOMPARE(config2.dischargeLimit(), 10.0);
+}
+
+void ConfigInfoTest::testRequestGroup()
+{
+    m_networkAccessManager.setOverrideUrl(QUrl::fromLocalFile(QFINDTESTDATA("data/chargeconfiginfo.json")));
+    // Keep the request in-flight long enough to cancel it.
+    m_networkAccessManager.setReplyDelay(200);
+
+    RequestGroup group1;
+    RequestGroup group2;
+
+    ChargeConfigInfo config1(&m_connector, g_serialNumber);
+    config1.setRequestGroup(&group1);
+    QCOMPARE(config1.requestGroup(), &group1);
+
+    ChargeConfigInfo config2(&m_connector, g_serialNumber);
+    config2.setRequestGroup(&group2);
+
+    QVERIFY(config1.forceReload());
+    QVERIFY(config2.reload());
+    QCOMPARE(config2.status(), RequestStatus::Loading);
+
+    // The shared request is still needed by the other one.
+    group1.cancel();
+    QCOMPARE(config1.status(), RequestStatus::Error);
+    QCOMPARE(config1.error(), static_cast<ErrorCode>(QNetworkReply::OperationCanceledError));
+    QCOMPARE(config2.status(), RequestStatus::Loading);
+
+    QTRY_COMPARE(config2.status(), RequestStatus::Finished);
+    QCOMPARE(config2.chargeLimit(), 90.0);
+    // Its data is no longer needed.
+    QCOMPARE(config1.status(), RequestStatus::Error);
+    QVERIFY(!config1.valid());
+
+    // Not sent at all when the group was canceled already.
+    QVERIFY(!config1.forceReload());
+
+    group1.reset();
+    ChargeConfigInfo config3(&m_connector, g_serialNumber);
+    config3.setRequestGroup(&group1);
+
+    QVERIFY(config2.forceReload());
+    QVERIFY(config3.reload());
+    QCOMPARE(config3.status(), RequestStatus::Loading);
+
+    // Aborted once nobody wants it anymore.
+    group2.cancel();
+    group1.cancel();
+    QCOMPARE(config2.status(), RequestStatus::Error);
+    QCOMPARE(config3.status(), RequestStatus::Error);
+
+    // Would be delivered to them, had it not been aborted.
+    QTest::qWait(400);
+    QCOMPARE(config2.status(), RequestStatus::Error);
+    QCOMPARE(config3.status(), RequestStatus::Error);
+    QVERIFY(!config3.valid());
+
+    m_networkAccessManager.setReplyDelay(0);
+}
+
+void ConfigInfoTest::testApiError()
+{
+    m_networkAccessManager.setOverrideUrl(QUrl::fromLocalFile(QFINDTESTDATA("data/api_error.json")));
+
+    ChargeConfigInfo config(&m_connector, QStringLiteral("ERROR"));
+
+    QVERIFY(config.forceReload());
+    QCOMPARE(config.status(), RequestStatus::Loading);
+
+    QTRY_COMPARE(config.status(), RequestStatus::Error);
+    QCOMPARE(config.error(), ErrorCode::ParameterError);
+    QCOMPARE(config.errorString(), QStringLiteral("Parameter error"));
+    QVERIFY(!config.valid());
+}
+
+QTEST_GUILESS_MAIN(ConfigInfoTest)
+#include "configinfotest.moc"
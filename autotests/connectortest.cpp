@@ -0,0 +1,464 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include <QCoreApplication>
+#include <QDate>
+#include <QDateTime>
+#include <QLocale>
+#include <QNetworkReply>
+#include <QSignalSpy>
+#include <QTest>
+#include <QThread>
+
+#include <memory>
+
+#include <QAlphaCloud/ApiRequest>
+#include <QAlphaCloud/Connector>
+#include <QAlphaCloud/LastPowerData>
+#include <QAlphaCloud/QAlphaCloud>
+#include <QAlphaCloud/RequestGroup>
+
+#include "testnetworkaccessmanager.h"
+
+using namespace QAlphaCloud;
+
+static QString g_serialNumber = QStringLiteral("SERIAL");
+
+static QByteArray httpDate(const QDateTime &dateTime)
+{
+    return QLocale::c().toString(dateTime.toUTC(), QStringLiteral("ddd, dd MMM yyyy hh:mm:ss 'GMT'")).toLatin1();
+}
+
+// Tests the request layer shared by all objects: threading, circuit breaker,
+// last known data, request groups, holding back requests while offline,
+// request hedging, and signing requests with the server's clock.
+class ConnectorTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    // Every test gets a fresh connector, so state like open circuits,
+    // learned latencies, or the clock offset doesn't leak between them.
+    void init();
+    void cleanup();
+
+    void testNetworkAccessManagerPerThread();
+    void testSystemOffline();
+    void testLastData();
+    void testRequestGroup();
+    void testOffline();
+    void testOfflineTimeout();
+    void testHedgeRequests();
+    void testServerClock();
+
+private:
+    // Sends a request for the energy of the given date and waits for it to finish.
+    void fetchEnergy(const QDate &date, ErrorCode *error, bool *stale);
+
+    TestNetworkAccessManager m_networkAccessManager;
+    std::unique_ptr<Connector> m_connector;
+};
+
+void ConnectorTest::initTestCase()
+{
+    // Don't talk to a daemon that might be running.
+    qputenv("QALPHACLOUD_NO_DAEMON", "1");
+}
+
+void ConnectorTest::init()
+{
+    m_connector = std::make_unique<Connector>();
+
+    // Don't rely on defaultConfiguration in tests!
+    auto *configuration = new Configuration(m_connector.get());
+    configuration->setAppId(QStringLiteral("connectorTestApp"));
+    configuration->setAppSecret(QStringLiteral("testSecret"));
+    m_connector->setConfiguration(configuration);
+
+    m_connector->setNetworkAccessManager(&m_networkAccessManager);
+    // Replies come from local files, regardless of what the platform thinks of the network.
+    m_connector->setOnline(true);
+}
+
+void ConnectorTest::cleanup()
+{
+    m_connector.reset();
+
+    m_networkAccessManager.setReplyDelay(0);
+    m_networkAccessManager.clearReplyHeaders();
+}
+
+void ConnectorTest::fetchEnergy(const QDate &date, ErrorCode *error, bool *stale)
+{
+    auto *request = new ApiRequest(m_connector.get(), ApiRequest::EndPoint::OneDateEnergyBySn);
+    request->setSysSn(g_serialNumber);
+    request->setQueryDate(date);
+
+    bool finished = false;
+    connect(request, &ApiRequest::finished, this, [request, error, stale, &finished] {
+        *error = request->error();
+        *stale = request->stale();
+        finished = true;
+    });
+
+    QVERIFY(request->send());
+    QTRY_VERIFY(finished);
+}
+
+void ConnectorTest::testNetworkAccessManagerPerThread()
+{
+    QCOMPARE(m_connector->networkAccessManager(), &m_networkAccessManager);
+
+    QNetworkAccessManager *workerManager = nullptr;
+    QNetworkAccessManager *workerManagerAgain = nullptr;
+    bool workerValid = false;
+
+    std::unique_ptr<QThread> thread(QThread::create([&] {
+        workerManager = m_connector->networkAccessManager();
+        workerManagerAgain = m_connector->networkAccessManager();
+        workerValid = m_connector->valid();
+    }));
+    thread->start();
+    QVERIFY(thread->wait(5000));
+
+    // The worker thread gets its own.
+    QVERIFY(workerManager);
+    QVERIFY(workerManager != &m_networkAccessManager);
+    QCOMPARE(workerManagerAgain, workerManager);
+    QVERIFY(workerValid);
+
+    QCOMPARE(m_connector->networkAccessManager(), &m_networkAccessManager);
+}
+
+void ConnectorTest::testSystemOffline()
+{
+    QSignalSpy requestFinishedSpy(m_connector.get(), &Connector::requestFinished);
+
+    LastPowerData data(m_connector.get(), g_serialNumber);
+
+    m_networkAccessManager.setOverrideUrl(QUrl::fromLocalFile(QFINDTESTDATA("data/lastpowerdata_1.json")));
+    QVERIFY(data.reload());
+    QTRY_COMPARE(data.status(), QAlphaCloud::RequestStatus::Finished);
+    QVERIFY(!data.stale());
+
+    m_networkAccessManager.setOverrideUrl(QUrl::fromLocalFile(QFINDTESTDATA("data/system_offline.json")));
+
+    for (int i = 0; i < 3; ++i) {
+        QVERIFY(data.reload());
+        QTRY_COMPARE(data.status(), QAlphaCloud::RequestStatus::Error);
+        QCOMPARE(data.error(), QAlphaCloud::ErrorCode::SystemOffline);
+    }
+    QCOMPARE(requestFinishedSpy.count(), 4);
+
+    // Now the last known data is provided without asking the API.
+    QVERIFY(data.reload());
+    QTRY_COMPARE(data.status(), QAlphaCloud::RequestStatus::Finished);
+    QVERIFY(data.stale());
+    QVERIFY(data.valid());
+    QCOMPARE(data.photovoltaicPower(), 4397);
+    QCOMPARE(requestFinishedSpy.count(), 4);
+
+    // Other systems are not affected.
+    LastPowerData otherData(m_connector.get(), QStringLiteral("OTHER"));
+    m_networkAccessManager.setOverrideUrl(QUrl::fromLocalFile(QFINDTESTDATA("data/lastpowerdata_2.json")));
+    QVERIFY(otherData.reload());
+    QTRY_COMPARE(otherData.status(), QAlphaCloud::RequestStatus::Finished);
+    QVERIFY(!otherData.stale());
+    QCOMPARE(requestFinishedSpy.count(), 5);
+}
+
+void ConnectorTest::testLastData()
+{
+    const QDate today = QDate::currentDate();
+    const QDate yesterday = today.addDays(-1);
+    ErrorCode error = ErrorCode::UnknownError;
+    bool stale = false;
+
+    LastPowerData data(m_connector.get(), g_serialNumber);
+    QCOMPARE(data.circuitState(), QAlphaCloud::CircuitState::Closed);
+    QSignalSpy circuitStateChangedSpy(&data, &LastPowerData::circuitStateChanged);
+
+    m_networkAccessManager.setOverrideUrl(QUrl::fromLocalFile(QFINDTESTDATA("data/lastpowerdata_1.json")));
+    QVERIFY(data.reload());
+    QTRY_COMPARE(data.status(), QAlphaCloud::RequestStatus::Finished);
+
+    m_networkAccessManager.setOverrideUrl(QUrl::fromLocalFile(QFINDTESTDATA("data/onedateenergy_1.json")));
+    fetchEnergy(today, &error, &stale);
+    if (QTest::currentTestFailed()) {
+        return;
+    }
+    QCOMPARE(error, QAlphaCloud::ErrorCode::NoError);
+
+    m_networkAccessManager.setOverrideUrl(QUrl::fromLocalFile(QFINDTESTDATA("data/system_offline.json")));
+
+    for (int i = 0; i < 3; ++i) {
+        QCOMPARE(data.circuitState(), QAlphaCloud::CircuitState::Closed);
+        QVERIFY(data.reload());
+        QTRY_COMPARE(data.status(), QAlphaCloud::RequestStatus::Error);
+    }
+    QCOMPARE(data.circuitState(), QAlphaCloud::CircuitState::Open);
+    QCOMPARE(circuitStateChangedSpy.count(), 1);
+
+    // Each endpoint has its own circuit.
+    for (int i = 0; i < 3; ++i) {
+        fetchEnergy(yesterday, &error, &stale);
+        if (QTest::currentTestFailed()) {
+            return;
+        }
+        QCOMPARE(error, QAlphaCloud::ErrorCode::SystemOffline);
+    }
+
+    const int requestCount = m_networkAccessManager.requestCount();
+
+    // Live data is provided in its stead.
+    QVERIFY(data.reload());
+    QTRY_COMPARE(data.status(), QAlphaCloud::RequestStatus::Finished);
+    QVERIFY(data.stale());
+    QCOMPARE(data.photovoltaicPower(), 4397);
+    QCOMPARE(data.circuitState(), QAlphaCloud::CircuitState::Open);
+
+    fetchEnergy(today, &error, &stale);
+    if (QTest::currentTestFailed()) {
+        return;
+    }
+    QCOMPARE(error, QAlphaCloud::ErrorCode::NoError);
+    QVERIFY(stale);
+
+    // But not history, which can just be requested again later.
+    fetchEnergy(yesterday, &error, &stale);
+    if (QTest::currentTestFailed()) {
+        return;
+    }
+    QCOMPARE(error, QAlphaCloud::ErrorCode::SystemOffline);
+    QVERIFY(!stale);
+
+    QCOMPARE(m_networkAccessManager.requestCount(), requestCount);
+
+    data.reset();
+    QCOMPARE(data.circuitState(), QAlphaCloud::CircuitState::Closed);
+    QCOMPARE(circuitStateChangedSpy.count(), 2);
+}
+
+void ConnectorTest::testRequestGroup()
+{
+    m_networkAccessManager.setOverrideUrl(QUrl::fromLocalFile(QFINDTESTDATA("data/lastpowerdata_1.json")));
+
+    QSignalSpy requestFinishedSpy(m_connector.get(), &Connector::requestFinished);
+
+    RequestGroup group;
+    LastPowerData data(m_connector.get(), g_serialNumber);
+    data.setRequestGroup(&group);
+    QCOMPARE(data.requestGroup(), &group);
+
+    // Canceling the group aborts the request in-flight.
+    QVERIFY(data.reload());
+    QCOMPARE(data.status(), QAlphaCloud::RequestStatus::Loading);
+    group.cancel();
+    QVERIFY(group.canceled());
+    QTRY_COMPARE(data.status(), QAlphaCloud::RequestStatus::Error);
+    QCOMPARE(data.error(), static_cast<QAlphaCloud::ErrorCode>(QNetworkReply::OperationCanceledError));
+    QCOMPARE(requestFinishedSpy.count(), 1);
+
+    // Nothing is sent while the group is canceled.
+    QVERIFY(data.reload());
+    QTRY_COMPARE(data.status(), QAlphaCloud::RequestStatus::Error);
+    QCOMPARE(requestFinishedSpy.count(), 1);
+
+    // Nor after the deadline.
+    group.reset();
+    QVERIFY(!group.canceled());
+    group.setDeadline(QDateTime::currentDateTimeUtc().addSecs(-1));
+    QVERIFY(group.deadlineExceeded());
+    QVERIFY(group.canceled());
+    QCOMPARE(group.remainingTime(), 0);
+
+    QVERIFY(data.reload());
+    QTRY_COMPARE(data.status(), QAlphaCloud::RequestStatus::Error);
+    QCOMPARE(data.error(), QAlphaCloud::ErrorCode::DeadlineExceededError);
+    QCOMPARE(requestFinishedSpy.count(), 1);
+
+    // Sent normally with plenty of time left.
+    group.reset();
+    group.setTimeout(60000);
+    QVERIFY(group.remainingTime() > 0);
+    QVERIFY(data.reload());
+    QTRY_COMPARE(data.status(), QAlphaCloud::RequestStatus::Finished);
+    QVERIFY(data.valid());
+    QCOMPARE(requestFinishedSpy.count(), 2);
+}
+
+void ConnectorTest::testOffline()
+{
+    QSignalSpy requestFinishedSpy(m_connector.get(), &Connector::requestFinished);
+    QSignalSpy onlineChangedSpy(m_connector.get(), &Connector::onlineChanged);
+
+    m_networkAccessManager.setOverrideUrl(QUrl::fromLocalFile(QFINDTESTDATA("data/lastpowerdata_1.json")));
+    const int requestCount = m_networkAccessManager.requestCount();
+
+    m_connector->setOnline(false);
+    QVERIFY(!m_connector->online());
+    QCOMPARE(onlineChangedSpy.count(), 1);
+
+    auto *energyRequest = new ApiRequest(m_connector.get(), ApiRequest::EndPoint::OneDateEnergyBySn);
+    energyRequest->setSysSn(g_serialNumber);
+    energyRequest->setQueryDate(QDate::currentDate());
+    QSignalSpy energyFinishedSpy(energyRequest, &ApiRequest::finished);
+    QVERIFY(energyRequest->send());
+
+    LastPowerData data(m_connector.get(), g_serialNumber);
+    QVERIFY(data.reload());
+    QCOMPARE(data.status(), QAlphaCloud::RequestStatus::Loading);
+
+    // Nothing is sent and nothing fails, not even once pending events are handled.
+    QCoreApplication::processEvents();
+    QCOMPARE(m_networkAccessManager.requestCount(), requestCount);
+    QCOMPARE(data.status(), QAlphaCloud::RequestStatus::Loading);
+    QCOMPARE(energyFinishedSpy.count(), 0);
+    QCOMPARE(requestFinishedSpy.count(), 0);
+
+    m_connector->setOnline(true);
+    QCOMPARE(onlineChangedSpy.count(), 2);
+
+    // Live data is more important, even though it was requested later.
+    QVERIFY(energyFinishedSpy.wait());
+    QCOMPARE(requestFinishedSpy.count(), 2);
+    QCOMPARE(requestFinishedSpy.at(0).at(0).toString(), QString(ApiRequest::EndPoint::LastPowerData));
+    QCOMPARE(requestFinishedSpy.at(1).at(0).toString(), QString(ApiRequest::EndPoint::OneDateEnergyBySn));
+    QCOMPARE(data.status(), QAlphaCloud::RequestStatus::Finished);
+    QCOMPARE(data.photovoltaicPower(), 4397);
+}
+
+void ConnectorTest::testOfflineTimeout()
+{
+    QSignalSpy requestFinishedSpy(m_connector.get(), &Connector::requestFinished);
+
+    m_networkAccessManager.setOverrideUrl(QUrl::fromLocalFile(QFINDTESTDATA("data/lastpowerdata_1.json")));
+    const int requestCount = m_networkAccessManager.requestCount();
+
+    m_connector->configuration()->setRequestTimeout(100);
+    m_connector->setOnline(false);
+
+    LastPowerData data(m_connector.get(), g_serialNumber);
+    QVERIFY(data.reload());
+    QCOMPARE(data.status(), QAlphaCloud::RequestStatus::Loading);
+
+    // Requests held back don't wait forever.
+    QTRY_COMPARE(data.status(), QAlphaCloud::RequestStatus::Error);
+    QCOMPARE(data.error(), static_cast<QAlphaCloud::ErrorCode>(QNetworkReply::TimeoutError));
+    QCOMPARE(m_networkAccessManager.requestCount(), requestCount);
+    QCOMPARE(requestFinishedSpy.count(), 0);
+
+    // Nothing is left to send once back online, so new requests are sent right away.
+    m_connector->setOnline(true);
+    QVERIFY(data.reload());
+    QCOMPARE(m_networkAccessManager.requestCount(), requestCount + 1);
+    QTRY_COMPARE(data.status(), QAlphaCloud::RequestStatus::Finished);
+    QCOMPARE(requestFinishedSpy.count(), 1);
+}
+
+void ConnectorTest::testHedgeRequests()
+{
+    const QUrl fastUrl = QUrl::fromLocalFile(QFINDTESTDATA("data/lastpowerdata_1.json"));
+    const QUrl hedgeUrl = QUrl::fromLocalFile(QFINDTESTDATA("data/lastpowerdata_2.json"));
+    m_networkAccessManager.setOverrideUrl(fastUrl);
+
+    QSignalSpy requestFinishedSpy(m_connector.get(), &Connector::requestFinished);
+
+    m_connector->setHedgeRequests(true);
+    LastPowerData data(m_connector.get(), g_serialNumber);
+
+    const auto reload = [&data] {
+        return data.reload() && QTest::qWaitFor([&data] {
+                   return data.status() == QAlphaCloud::RequestStatus::Finished;
+               });
+    };
+
+    for (int i = 0; i < 9; ++i) {
+        QVERIFY(reload());
+    }
+
+    // Nothing is known about the latency yet, no matter how slow it is.
+    int requestCount = m_networkAccessManager.requestCount();
+    m_networkAccessManager.enqueueReply(fastUrl, 250);
+    QVERIFY(reload());
+    QCOMPARE(m_networkAccessManager.requestCount(), requestCount + 1);
+
+    // Only one in 20 requests may be duplicated, so earn it.
+    for (int i = 0; i < 10; ++i) {
+        QVERIFY(reload());
+    }
+    QCOMPARE(requestFinishedSpy.count(), 20);
+
+    // Much slower than usual, sent again and the faster reply wins.
+    requestCount = m_networkAccessManager.requestCount();
+    m_networkAccessManager.enqueueReply(fastUrl, 2000);
+    m_networkAccessManager.enqueueReply(hedgeUrl, 0);
+    QVERIFY(reload());
+    QCOMPARE(m_networkAccessManager.requestCount(), requestCount + 2);
+    QCOMPARE(data.photovoltaicPower(), 10);
+    QCOMPARE(requestFinishedSpy.count(), 21);
+
+    // The slower one doesn't produce another result.
+    QTest::qWait(2100);
+    QCOMPARE(data.photovoltaicPower(), 10);
+    QCOMPARE(requestFinishedSpy.count(), 21);
+
+    // The budget is spent.
+    requestCount = m_networkAccessManager.requestCount();
+    m_networkAccessManager.setReplyDelay(500);
+    QVERIFY(reload());
+    QCOMPARE(m_networkAccessManager.requestCount(), requestCount + 1);
+    QCOMPARE(data.photovoltaicPower(), 4397);
+    QCOMPARE(requestFinishedSpy.count(), 22);
+}
+
+void ConnectorTest::testServerClock()
+{
+    const QUrl timestampErrorUrl = QUrl::fromLocalFile(QFINDTESTDATA("data/timestamp_error.json"));
+    m_networkAccessManager.setOverrideUrl(QUrl::fromLocalFile(QFINDTESTDATA("data/lastpowerdata_1.json")));
+
+    const auto timeStamp = [this] {
+        return m_networkAccessManager.lastRequest().rawHeader(QByteArrayLiteral("timeStamp")).toLongLong();
+    };
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+
+    LastPowerData data(m_connector.get(), g_serialNumber);
+
+    // The server is an hour ahead of us.
+    m_networkAccessManager.setReplyHeader(QByteArrayLiteral("Date"), httpDate(now.addSecs(3600)));
+    QVERIFY(data.reload());
+    QVERIFY(qAbs(timeStamp() - now.toSecsSinceEpoch()) <= 5);
+    QTRY_COMPARE(data.status(), QAlphaCloud::RequestStatus::Finished);
+
+    // Subsequent requests are signed with its time.
+    QVERIFY(data.reload());
+    QVERIFY(qAbs(timeStamp() - now.addSecs(3600).toSecsSinceEpoch()) <= 5);
+    QTRY_COMPARE(data.status(), QAlphaCloud::RequestStatus::Finished);
+
+    // When it rejects our time nonetheless, the request is signed again with the time it replied with.
+    m_networkAccessManager.clearReplyHeaders();
+    m_networkAccessManager.setReplyHeader(QByteArrayLiteral("Date"), httpDate(now.addSecs(2 * 3600)));
+    m_networkAccessManager.enqueueReply(timestampErrorUrl);
+
+    int requestCount = m_networkAccessManager.requestCount();
+    QVERIFY(data.reload());
+    QTRY_COMPARE(data.status(), QAlphaCloud::RequestStatus::Finished);
+    QCOMPARE(m_networkAccessManager.requestCount(), requestCount + 2);
+    QVERIFY(qAbs(timeStamp() - now.addSecs(2 * 3600).toSecsSinceEpoch()) <= 5);
+    QCOMPARE(data.error(), QAlphaCloud::ErrorCode::NoError);
+
+    // But only once.
+    m_networkAccessManager.setOverrideUrl(timestampErrorUrl);
+    requestCount = m_networkAccessManager.requestCount();
+    QVERIFY(data.reload());
+    QTRY_COMPARE(data.status(), QAlphaCloud::RequestStatus::Error);
+    QCOMPARE(data.error(), QAlphaCloud::ErrorCode::TimestampError);
+    QTest::qWait(100);
+    QCOMPARE(m_networkAccessManager.requestCount(), requestCount + 2);
+}
+
+QTEST_GUILESS_MAIN(ConnectorTest)
+#include "connectortest.moc"
@@ -0,0 +1,236 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include <QDate>
+#include <QStandardPaths>
+#include <QTest>
+
+#include <QAlphaCloud/Connector>
+#include <QAlphaCloud/EnergyHistoryModel>
+#include <QAlphaCloud/QAlphaCloud>
+
+#include "testnetworkaccessmanager.h"
+
+using namespace QAlphaCloud;
+
+static QString g_serialNumber = QStringLiteral("SERIAL");
+
+class EnergyHistoryModelTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void testInitialState();
+
+    void testData();
+    void testGranularity();
+    void testCache();
+    void testTooManyRequests();
+
+    void testApiError();
+
+private:
+    TestNetworkAccessManager m_networkAccessManager;
+    Connector m_connector;
+};
+
+void EnergyHistoryModelTest::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+
+    // Don't rely on defaultConfiguration in tests!
+    auto *configuration = new Configuration(&m_connector);
+    configuration->setAppId(QStringLiteral("energyHistoryApp"));
+    configuration->setAppSecret(QStringLiteral("testSecret"));
+    m_connector.setConfiguration(configuration);
+
+    m_connector.setNetworkAccessManager(&m_networkAccessManager);
+}
+
+void EnergyHistoryModelTest::testInitialState()
+{
+    {
+        EnergyHistoryModel model;
+        QCOMPARE(model.status(), RequestStatus::NoRequest);
+        QCOMPARE(model.rowCount(), 0);
+        QCOMPARE(model.fromDate(), QDate(QDate::currentDate().year(), 1, 1));
+        QCOMPARE(model.toDate(), QDate::currentDate());
+        QCOMPARE(model.granularity(), EnergyHistoryModel::Granularity::Day);
+
+        // Can't load without a connector.
+        QVERIFY(!model.reload());
+    }
+
+    {
+        EnergyHistoryModel model(&m_connector, QString() /*serialNumber*/, QDate(2023, 01, 10), QDate(2023, 01, 01));
+        model.setCached(false);
+        QCOMPARE(model.connector(), &m_connector);
+
+        // Can't load without a serial number.
+        QVERIFY(!model.reload());
+
+        model.setSerialNumber(g_serialNumber);
+        QCOMPARE(model.serialNumber(), g_serialNumber);
+
+        // Can't load with an inverted range.
+        QVERIFY(!model.reload());
+
+        model.resetFromDate();
+        model.resetToDate();
+        QVERIFY(model.reload());
+    }
+}
+
+void EnergyHistoryModelTest::testData()
+{
+    // Every day returns the same data.
+    m_networkAccessManager.setOverrideUrl(QUrl::fromLocalFile(QFINDTESTDATA("data/onedateenergy_1.json")));
+
+    EnergyHistoryModel model(&m_connector, g_serialNumber, QDate(2023, 01, 01), QDate(2023, 01, 10));
+    model.setCached(false);
+    model.setMaximumConcurrentRequests(3);
+
+    QVERIFY(model.reload());
+    QCOMPARE(model.status(), RequestStatus::Loading);
+    QCOMPARE(model.totalDays(), 10);
+    // Rows are available right away, filled in as data arrives.
+    QCOMPARE(model.rowCount(), 10);
+
+    QTRY_COMPARE(model.status(), RequestStatus::Finished);
+    QCOMPARE(model.error(), ErrorCode::NoError);
+    QCOMPARE(model.loadedDays(), 10);
+
+    QCOMPARE(model.photovoltaic(), 10 * 20100);
+    QCOMPARE(model.input(), 10 * 30);
+    QCOMPARE(model.output(), 10 * 14630);
+    QCOMPARE(model.charge(), 10 * 2800);
+    QCOMPARE(model.discharge(), 10 * 1000);
+    QCOMPARE(model.gridCharge(), 10 * 10);
+    QCOMPARE(model.totalLoad(), 10 * (20100 + 1000 + 30 - 14630 - 2800));
+
+    const QModelIndex index = model.index(4, 0);
+    QCOMPARE(index.data(static_cast<int>(EnergyHistoryModel::Roles::StartDate)).toDate(), QDate(2023, 01, 05));
+    QCOMPARE(index.data(static_cast<int>(EnergyHistoryModel::Roles::EndDate)).toDate(), QDate(2023, 01, 05));
+    QCOMPARE(index.data(static_cast<int>(EnergyHistoryModel::Roles::Photovoltaic)).toInt(), 20100);
+    QCOMPARE(index.data(static_cast<int>(EnergyHistoryModel::Roles::DayCount)).toInt(), 1);
+    QCOMPARE(index.data(static_cast<int>(EnergyHistoryModel::Roles::LoadedDays)).toInt(), 1);
+
+    // Reloading a range of past days that are all loaded doesn't send any requests.
+    QVERIFY(model.reload());
+    QCOMPARE(model.status(), RequestStatus::Finished);
+    QCOMPARE(model.photovoltaic(), 10 * 20100);
+}
+
+void EnergyHistoryModelTest::testGranularity()
+{
+    m_networkAccessManager.setOverrideUrl(QUrl::fromLocalFile(QFINDTESTDATA("data/onedateenergy_1.json")));
+
+    // 2023-01-01 is a Sunday.
+    EnergyHistoryModel model(&m_connector, g_serialNumber, QDate(2023, 01, 01), QDate(2023, 01, 10));
+    model.setCached(false);
+
+    QVERIFY(model.reload());
+    QTRY_COMPARE(model.status(), RequestStatus::Finished);
+
+    // Changing granularity must not fetch anything again.
+    m_networkAccessManager.setOverrideUrl(QUrl::fromLocalFile(QFINDTESTDATA("data/garbled.json")));
+
+    model.setGranularity(EnergyHistoryModel::Granularity::Week);
+    QCOMPARE(model.status(), RequestStatus::Finished);
+    QCOMPARE(model.rowCount(), 3);
+
+    const int dayCountRole = static_cast<int>(EnergyHistoryModel::Roles::DayCount);
+    const int photovoltaicRole = static_cast<int>(EnergyHistoryModel::Roles::Photovoltaic);
+
+    QCOMPARE(model.index(0, 0).data(dayCountRole).toInt(), 1);
+    QCOMPARE(model.index(1, 0).data(dayCountRole).toInt(), 7);
+    QCOMPARE(model.index(2, 0).data(dayCountRole).toInt(), 2);
+    QCOMPARE(model.index(1, 0).data(static_cast<int>(EnergyHistoryModel::Roles::StartDate)).toDate(), QDate(2023, 01, 02));
+    QCOMPARE(model.index(1, 0).data(photovoltaicRole).toInt(), 7 * 20100);
+
+    model.setGranularity(EnergyHistoryModel::Granularity::Month);
+    QCOMPARE(model.rowCount(), 1);
+    QCOMPARE(model.index(0, 0).data(dayCountRole).toInt(), 10);
+    QCOMPARE(model.index(0, 0).data(photovoltaicRole).toInt(), 10 * 20100);
+
+    QCOMPARE(model.photovoltaic(), 10 * 20100);
+    QCOMPARE(model.loadedDays(), 10);
+}
+
+void EnergyHistoryModelTest::testCache()
+{
+    const QString serialNumber = QStringLiteral("CACHED");
+
+    m_networkAccessManager.setOverrideUrl(QUrl::fromLocalFile(QFINDTESTDATA("data/onedateenergy_1.json")));
+
+    {
+        EnergyHistoryModel model(&m_connector, serialNumber, QDate(2023, 01, 01), QDate(2023, 01, 03));
+        QVERIFY(model.cached());
+
+        QVERIFY(model.reload());
+        QTRY_COMPARE(model.status(), RequestStatus::Finished);
+        QCOMPARE(model.loadedDays(), 3);
+    }
+
+    // Past days must come from the cache and not be fetched again.
+    m_networkAccessManager.setOverrideUrl(QUrl::fromLocalFile(QFINDTESTDATA("data/garbled.json")));
+
+    EnergyHistoryModel model(&m_connector, serialNumber, QDate(2023, 01, 01), QDate(2023, 01, 03));
+    QVERIFY(model.reload());
+    QCOMPARE(model.status(), RequestStatus::Finished);
+    QCOMPARE(model.error(), ErrorCode::NoError);
+    QCOMPARE(model.loadedDays(), 3);
+    QCOMPARE(model.photovoltaic(), 3 * 20100);
+
+    // Days outside the cached range still have to be fetched.
+    model.setToDate(QDate(2023, 01, 04));
+    QVERIFY(model.reload());
+    QTRY_COMPARE(model.status(), RequestStatus::Error);
+    QCOMPARE(model.error(), ErrorCode::JsonParseError);
+    QCOMPARE(model.loadedDays(), 3);
+}
+
+void EnergyHistoryModelTest::testTooManyRequests()
+{
+    m_networkAccessManager.setOverrideUrl(QUrl::fromLocalFile(QFINDTESTDATA("data/too_many_requests.json")));
+
+    EnergyHistoryModel model(&m_connector, g_serialNumber, QDate(2023, 01, 01), QDate(2023, 01, 05));
+    model.setCached(false);
+    model.setMaximumConcurrentRequests(4);
+
+    QVERIFY(model.reload());
+    QCOMPARE(model.status(), RequestStatus::Loading);
+
+    // Being asked to slow down isn't an error, the days are tried again later.
+    QTest::qWait(200);
+    QCOMPARE(model.status(), RequestStatus::Loading);
+    QCOMPARE(model.error(), ErrorCode::NoError);
+    QCOMPARE(model.loadedDays(), 0);
+
+    m_networkAccessManager.setOverrideUrl(QUrl::fromLocalFile(QFINDTESTDATA("data/onedateenergy_1.json")));
+
+    QTRY_COMPARE(model.status(), RequestStatus::Finished);
+    QCOMPARE(model.error(), ErrorCode::NoError);
+    QCOMPARE(model.loadedDays(), 5);
+    QCOMPARE(model.photovoltaic(), 5 * 20100);
+}
+
+void EnergyHistoryModelTest::testApiError()
+{
+    m_networkAccessManager.setOverrideUrl(QUrl::fromLocalFile(QFINDTESTDATA("data/api_error.json")));
+
+    EnergyHistoryModel model(&m_connector, g_serialNumber, QDate(2023, 01, 01), QDate(2023, 01, 03));
+    model.setCached(false);
+
+    QVERIFY(model.reload());
+    QTRY_COMPARE(model.status(), RequestStatus::Error);
+    QCOMPARE(model.error(), ErrorCode::ParameterError);
+    QCOMPARE(model.loadedDays(), 0);
+    QCOMPARE(model.rowCount(), 3);
+}
+
+QTEST_GUILESS_MAIN(EnergyHistoryModelTest)
+#include "energyhistorymodeltest.moc"
@@ -0,0 +1,263 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include <QSignalSpy>
+#include <QTest>
+
+#include <QAlphaCloud/Connector>
+#include <QAlphaCloud/FleetLiveDataModel>
+#include <QAlphaCloud/QAlphaCloud>
+
+#include "testnetworkaccessmanager.h"
+
+using namespace QAlphaCloud;
+
+static QStringList serialNumbers(int count)
+{
+    QStringList serialNumbers;
+    serialNumbers.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        serialNumbers.append(QStringLiteral("SERIAL%1").arg(i));
+    }
+    return serialNumbers;
+}
+
+class FleetLiveDataModelTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void testInitialState();
+
+    void testData();
+    void testDataChanged();
+    void testStaggeredPolling();
+    void testChangeSerialNumbers();
+    void testReset();
+
+    void testApiError();
+
+    void benchmarkPollCycle_data();
+    void benchmarkPollCycle();
+
+private:
+    TestNetworkAccessManager m_networkAccessManager;
+    Connector m_connector;
+};
+
+void FleetLiveDataModelTest::initTestCase()
+{
+    // Don't rely on defaultConfiguration in tests!
+    auto *configuration = new Configuration(&m_connector);
+    configuration->setAppId(QStringLiteral("fleetLiveDataModelApp"));
+    configuration->setAppSecret(QStringLiteral("testSecret"));
+    m_connector.setConfiguration(configuration);
+
+    m_connector.setNetworkAccessManager(&m_networkAccessManager);
+}
+
+void FleetLiveDataModelTest::testInitialState()
+{
+    FleetLiveDataModel model;
+    QCOMPARE(model.status(), RequestStatus::NoRequest);
+    QCOMPARE(model.rowCount(), 0);
+    QCOMPARE(model.validCount(), 0);
+    QCOMPARE(model.errorCount(), 0);
+
+    // Can't load without a connector.
+    QVERIFY(!model.reload());
+
+    model.setConnector(&m_connector);
+    // Can't load without serial numbers.
+    QVERIFY(!model.reload());
+
+    // Duplicates are ignored.
+    model.setSerialNumbers({QStringLiteral("A"), QStringLiteral("B"), QStringLiteral("A")});
+    QCOMPARE(model.rowCount(), 2);
+    QCOMPARE(model.indexOf(QStringLiteral("B")), 1);
+    QCOMPARE(model.indexOf(QStringLiteral("C")), -1);
+    QCOMPARE(model.index(1, 0).data(static_cast<int>(FleetLiveDataModel::Roles::SerialNumber)).toString(), QStringLiteral("B"));
+    QVERIFY(!model.index(1, 0).data(static_cast<int>(FleetLiveDataModel::Roles::Valid)).toBool());
+}
+
+void FleetLiveDataModelTest::testData()
+{
+    m_networkAccessManager.setOverrideUrl(QUrl::fromLocalFile(QFINDTESTDATA("data/lastpowerdata_1.json")));
+
+    FleetLiveDataModel model(&m_connector, serialNumbers(10));
+    model.setInterval(0);
+    model.setMaximumConcurrentRequests(3);
+
+    QVERIFY(model.reload());
+    QCOMPARE(model.status(), RequestStatus::Loading);
+
+    QTRY_COMPARE(model.status(), RequestStatus::Finished);
+
+    QCOMPARE(model.validCount(), 10);
+    QCOMPARE(model.errorCount(), 0);
+    QCOMPARE(model.photovoltaicPower(), 10 * 4397);
+    QCOMPARE(model.currentLoad(), 10 * 610);
+    QCOMPARE(model.gridPower(), 10 * -4358);
+    QCOMPARE(model.batteryPower(), 10 * 111);
+    QCOMPARE(model.batterySoc(), 98.0);
+
+    const QModelIndex index = model.index(4, 0);
+    QVERIFY(index.data(static_cast<int>(FleetLiveDataModel::Roles::Valid)).toBool());
+    QCOMPARE(index.data(static_cast<int>(FleetLiveDataModel::Roles::PhotovoltaicPower)).toInt(), 4397);
+    QCOMPARE(index.data(static_cast<int>(FleetLiveDataModel::Roles::BatterySoc)).toReal(), 98.0);
+    QVERIFY(index.data(static_cast<int>(FleetLiveDataModel::Roles::LastUpdate)).toDateTime().isValid());
+    QCOMPARE(index.data(static_cast<int>(FleetLiveDataModel::Roles::Error)).value<ErrorCode>(), ErrorCode::NoError);
+}
+
+void FleetLiveDataModelTest::testDataChanged()
+{
+    m_networkAccessManager.setOverrideUrl(QUrl::fromLocalFile(QFINDTESTDATA("data/lastpowerdata_1.json")));
+
+    FleetLiveDataModel model(&m_connector, serialNumbers(2));
+    model.setInterval(0);
+
+    QVERIFY(model.reload());
+    QTRY_COMPARE(model.status(), RequestStatus::Finished);
+
+    QSignalSpy dataChangedSpy(&model, &FleetLiveDataModel::dataChanged);
+    QSignalSpy photovoltaicPowerSpy(&model, &FleetLiveDataModel::photovoltaicPowerChanged);
+
+    m_networkAccessManager.setOverrideUrl(QUrl::fromLocalFile(QFINDTESTDATA("data/lastpowerdata_2.json")));
+
+    QVERIFY(model.reload());
+    QTRY_COMPARE(model.status(), RequestStatus::Finished);
+
+    // One signal per row.
+    QCOMPARE(dataChangedSpy.count(), 2);
+    for (const auto &arguments : std::as_const(dataChangedSpy)) {
+        QCOMPARE(arguments.at(0).toModelIndex(), arguments.at(1).toModelIndex());
+
+        const auto roles = arguments.at(2).value<QVector<int>>();
+        QVERIFY(roles.contains(static_cast<int>(FleetLiveDataModel::Roles::PhotovoltaicPower)));
+        QVERIFY(roles.contains(static_cast<int>(FleetLiveDataModel::Roles::BatterySoc)));
+        // Was valid before, too.
+        QVERIFY(!roles.contains(static_cast<int>(FleetLiveDataModel::Roles::Valid)));
+    }
+
+    QCOMPARE(photovoltaicPowerSpy.count(), 2);
+    QCOMPARE(model.photovoltaicPower(), 2 * 10);
+    QCOMPARE(model.batterySoc(), 55.0);
+}
+
+void FleetLiveDataModelTest::testStaggeredPolling()
+{
+    m_networkAccessManager.setOverrideUrl(QUrl::fromLocalFile(QFINDTESTDATA("data/lastpowerdata_1.json")));
+
+    FleetLiveDataModel model(&m_connector, serialNumbers(8));
+    // Two systems every 250ms.
+    model.setInterval(1000);
+
+    QVERIFY(model.reload());
+    QTRY_COMPARE(model.status(), RequestStatus::Finished);
+
+    QSignalSpy dataChangedSpy(&model, &FleetLiveDataModel::dataChanged);
+
+    // Only the first batch is polled.
+    QTRY_COMPARE(dataChangedSpy.count(), 2);
+    QCOMPARE(dataChangedSpy.at(0).at(0).toModelIndex().row(), 0);
+    QCOMPARE(dataChangedSpy.at(1).at(0).toModelIndex().row(), 1);
+
+    // Eventually all of them have been polled again.
+    QTRY_COMPARE(dataChangedSpy.count(), 8);
+    QCOMPARE(dataChangedSpy.at(7).at(0).toModelIndex().row(), 7);
+}
+
+void FleetLiveDataModelTest::testChangeSerialNumbers()
+{
+    m_networkAccessManager.setOverrideUrl(QUrl::fromLocalFile(QFINDTESTDATA("data/lastpowerdata_1.json")));
+
+    FleetLiveDataModel model(&m_connector, {QStringLiteral("A"), QStringLiteral("B")});
+    model.setInterval(0);
+
+    QVERIFY(model.reload());
+    QTRY_COMPARE(model.status(), RequestStatus::Finished);
+    QCOMPARE(model.validCount(), 2);
+
+    QSignalSpy countSpy(&model, &FleetLiveDataModel::countChanged);
+
+    model.setSerialNumbers({QStringLiteral("C"), QStringLiteral("B"), QStringLiteral("D")});
+    QCOMPARE(countSpy.count(), 1);
+    QCOMPARE(model.rowCount(), 3);
+
+    // Data of the system that remained is kept.
+    QCOMPARE(model.indexOf(QStringLiteral("B")), 1);
+    QVERIFY(model.index(1, 0).data(static_cast<int>(FleetLiveDataModel::Roles::Valid)).toBool());
+    QVERIFY(!model.index(0, 0).data(static_cast<int>(FleetLiveDataModel::Roles::Valid)).toBool());
+    QCOMPARE(model.validCount(), 1);
+
+    // And the new ones are polled right away.
+    QCOMPARE(model.status(), RequestStatus::Loading);
+    QTRY_COMPARE(model.status(), RequestStatus::Finished);
+    QCOMPARE(model.validCount(), 3);
+}
+
+void FleetLiveDataModelTest::testReset()
+{
+    m_networkAccessManager.setOverrideUrl(QUrl::fromLocalFile(QFINDTESTDATA("data/lastpowerdata_1.json")));
+
+    FleetLiveDataModel model(&m_connector, serialNumbers(3));
+
+    QVERIFY(model.reload());
+    QTRY_COMPARE(model.status(), RequestStatus::Finished);
+    QCOMPARE(model.validCount(), 3);
+
+    model.reset();
+    QCOMPARE(model.status(), RequestStatus::NoRequest);
+    QCOMPARE(model.rowCount(), 3);
+    QCOMPARE(model.validCount(), 0);
+    QCOMPARE(model.photovoltaicPower(), 0);
+    QVERIFY(!model.index(0, 0).data(static_cast<int>(FleetLiveDataModel::Roles::Valid)).toBool());
+}
+
+void FleetLiveDataModelTest::testApiError()
+{
+    m_networkAccessManager.setOverrideUrl(QUrl::fromLocalFile(QFINDTESTDATA("data/api_error.json")));
+
+    FleetLiveDataModel model(&m_connector, serialNumbers(3));
+    model.setInterval(0);
+
+    QVERIFY(model.reload());
+    // Errors are reported per system.
+    QTRY_COMPARE(model.status(), RequestStatus::Finished);
+
+    QCOMPARE(model.errorCount(), 3);
+    QCOMPARE(model.validCount(), 0);
+    QCOMPARE(model.index(2, 0).data(static_cast<int>(FleetLiveDataModel::Roles::Error)).value<ErrorCode>(), ErrorCode::ParameterError);
+}
+
+void FleetLiveDataModelTest::benchmarkPollCycle_data()
+{
+    QTest::addColumn<int>("systems");
+
+    QTest::newRow("1k") << 1000;
+    QTest::newRow("10k") << 10000;
+}
+
+void FleetLiveDataModelTest::benchmarkPollCycle()
+{
+    QFETCH(int, systems);
+
+    m_networkAccessManager.setOverrideUrl(QUrl::fromLocalFile(QFINDTESTDATA("data/lastpowerdata_1.json")));
+
+    FleetLiveDataModel model(&m_connector, serialNumbers(systems));
+    model.setInterval(0);
+    model.setMaximumConcurrentRequests(16);
+
+    QBENCHMARK_ONCE {
+        QVERIFY(model.reload());
+        QTRY_COMPARE_WITH_TIMEOUT(model.status(), RequestStatus::Finished, 120000);
+    }
+
+    QCOMPARE(model.validCount(), systems);
+}
+
+QTEST_GUILESS_MAIN(FleetLiveDataModelTest)
+#include "fleetlivedatamodeltest.moc"
@@ -31,6 +31,7 @@ private Q_SLOTS:
     void testReloadError();
     void testReset();
     void testReloadInFlight();
+    void testAutoRefresh();
 
     void testApiError();
     void testGarbledJson();
@@ -165,6 +166,51 @@ void LastPowerDataTest::testReloadInFlight()
 {
 }
 
+void LastPowerDataTest::testAutoRefresh()
+{
+    LastPowerData data(&m_connector, g_serialNumber);
+
+    m_networkAccessManager.setOverrideUrl(QUrl::fromLocalFile(QFINDTESTDATA("data/lastpowerdata_1.json")));
+
+    int loadCount = 0;
+    connect(&data, &LastPowerData::statusChanged, this, [&loadCount](RequestStatus status) {
+        if (status == RequestStatus::Loading) {
+            ++loadCount;
+        }
+    });
+
+    data.setAutoRefreshInterval(100);
+    QCOMPARE(data.autoRefreshInterval(), 100);
+
+    // Nothing is reloaded until data has been loaded once.
+    QTest::qWait(300);
+    QCOMPARE(loadCount, 0);
+
+    QVERIFY(data.reload());
+    QCOMPARE(loadCount, 1);
+    QTRY_COMPARE(data.status(), RequestStatus::Finished);
+
+    // Reloads by itself.
+    QTRY_COMPARE(loadCount, 2);
+    QTRY_COMPARE(data.status(), RequestStatus::Finished);
+
+    data.setPaused(true);
+    QVERIFY(data.paused());
+
+    QTest::qWait(300);
+    QCOMPARE(loadCount, 2);
+
+    // A reload became due while paused, so it happens right away.
+    data.setPaused(false);
+    QTRY_COMPARE(loadCount, 3);
+    QTRY_COMPARE(data.status(), RequestStatus::Finished);
+
+    // Resetting stops reloading until data is loaded again.
+    data.reset();
+    QTest::qWait(300);
+    QCOMPARE(loadCount, 3);
+}
+
 void LastPowerDataTest::testApiError()
 {
     LastPowerData data(&m_connector, g_serialNumber);
@@ -31,6 +31,10 @@ private Q_SLOTS:
     void testRoleNames();
 
     void testData();
+    void testIndexForDateTime();
+    void testRangeStatistics();
+    void testColumn();
+    void testScheduleReload();
     // TODO testReload
     // TODO testCache / testForceReload
 
@@ -195,6 +199,158 @@ void OneDayPowerModelTest::testData()
     QCOMPARE(model.peakGridCharge(), 103);
 }
 
+void OneDayPowerModelTest::testIndexForDateTime()
+{
+    const QDate date(2023, 01, 01);
+    OneDayPowerModel model(&m_connector, g_serialNumber, date);
+
+    // Nothing to look up yet.
+    QCOMPARE(model.indexForDateTime(QDateTime(date, QTime(15, 0, 0))), -1);
+
+    m_networkAccessManager.setOverrideUrl(QUrl::fromLocalFile(QFINDTESTDATA("data/onedaypower.json")));
+    QVERIFY(model.reload());
+    QTRY_COMPARE(model.status(), QAlphaCloud::RequestStatus::Finished);
+    QCOMPARE(model.rowCount(), 3);
+
+    QCOMPARE(model.indexForDateTime(QDateTime()), -1);
+
+    // Before and after the first and last entries, respectively.
+    QCOMPARE(model.indexForDateTime(QDateTime(date, QTime(8, 0, 0))), 0);
+    QCOMPARE(model.indexForDateTime(QDateTime(date, QTime(20, 0, 0))), 2);
+
+    // Exact matches.
+    QCOMPARE(model.indexForDateTime(QDateTime(date, QTime(14, 59, 32))), 0);
+    QCOMPARE(model.indexForDateTime(QDateTime(date, QTime(15, 4, 32))), 1);
+    QCOMPARE(model.indexForDateTime(QDateTime(date, QTime(15, 9, 32))), 2);
+
+    // Closest entry in between.
+    QCOMPARE(model.indexForDateTime(QDateTime(date, QTime(15, 1, 0))), 0);
+    QCOMPARE(model.indexForDateTime(QDateTime(date, QTime(15, 3, 0))), 1);
+    QCOMPARE(model.indexForDateTime(QDateTime(date, QTime(15, 8, 0))), 2);
+}
+
+void OneDayPowerModelTest::testRangeStatistics()
+{
+    using Roles = OneDayPowerModel::Roles;
+
+    const QDate date(2023, 01, 01);
+    OneDayPowerModel model(&m_connector, g_serialNumber, date);
+
+    QVERIFY(!model.rangeStatistics(Roles::PhotovoltaicEnergy, QDateTime(), QDateTime()).valid());
+
+    m_networkAccessManager.setOverrideUrl(QUrl::fromLocalFile(QFINDTESTDATA("data/onedaypower.json")));
+    QVERIFY(model.reload());
+    QTRY_COMPARE(model.status(), QAlphaCloud::RequestStatus::Finished);
+
+    // Entire range.
+    auto statistics = model.rangeStatistics(Roles::PhotovoltaicEnergy, QDateTime(), QDateTime());
+    QVERIFY(statistics.valid());
+    QCOMPARE(statistics.count, 3);
+    QCOMPARE(statistics.minimum, 3000);
+    QCOMPARE(statistics.maximum, 5000);
+    QCOMPARE(statistics.sum, 12000);
+    QCOMPARE(statistics.average(), 4000);
+
+    // The last two entries.
+    statistics = model.rangeStatistics(Roles::CurrentLoad, QDateTime(date, QTime(15, 0, 0)), QDateTime(date, QTime(16, 0, 0)));
+    QCOMPARE(statistics.count, 2);
+    QCOMPARE(statistics.minimum, 1100);
+    QCOMPARE(statistics.maximum, 1200);
+    QCOMPARE(statistics.sum, 2300);
+
+    // Bounds are inclusive.
+    statistics = model.rangeStatistics(Roles::BatterySoc, QDateTime(date, QTime(14, 59, 32)), QDateTime(date, QTime(14, 59, 32)));
+    QCOMPARE(statistics.count, 1);
+    QCOMPARE(statistics.minimum, 91);
+    QCOMPARE(statistics.maximum, 91);
+
+    // No entries in range.
+    statistics = model.rangeStatistics(Roles::GridFeed, QDateTime(date, QTime(15, 0, 0)), QDateTime(date, QTime(15, 1, 0)));
+    QVERIFY(!statistics.valid());
+
+    // Non-numeric role.
+    statistics = model.rangeStatistics(Roles::UploadTime, QDateTime(), QDateTime());
+    QVERIFY(!statistics.valid());
+}
+
+void OneDayPowerModelTest::testColumn()
+{
+    using Roles = OneDayPowerModel::Roles;
+
+    const QDate date(2023, 01, 01);
+    OneDayPowerModel model(&m_connector, g_serialNumber, date);
+
+    QVERIFY(model.column(Roles::PhotovoltaicEnergy).isEmpty());
+    QVERIFY(model.uploadTimes().isEmpty());
+
+    m_networkAccessManager.setOverrideUrl(QUrl::fromLocalFile(QFINDTESTDATA("data/onedaypower.json")));
+    QVERIFY(model.reload());
+    QTRY_COMPARE(model.status(), QAlphaCloud::RequestStatus::Finished);
+
+    const Roles roles[] = {Roles::PhotovoltaicEnergy, Roles::CurrentLoad, Roles::GridFeed, Roles::GridCharge, Roles::BatterySoc};
+    for (Roles role : roles) {
+        const auto column = model.column(role);
+        QCOMPARE(static_cast<int>(column.size()), model.rowCount());
+
+        for (int i = 0; i < model.rowCount(); ++i) {
+            QCOMPARE(column[i], model.index(i).data(static_cast<int>(role)).toReal());
+        }
+    }
+
+    const auto uploadTimes = model.uploadTimes();
+    QCOMPARE(static_cast<int>(uploadTimes.size()), model.rowCount());
+    for (int i = 0; i < model.rowCount(); ++i) {
+        QCOMPARE(uploadTimes[i], model.index(i).data(static_cast<int>(Roles::UploadTime)).toDateTime().toMSecsSinceEpoch());
+    }
+
+    // Non-numeric role.
+    QVERIFY(model.column(Roles::UploadTime).isEmpty());
+
+    model.reset();
+    QVERIFY(model.column(Roles::PhotovoltaicEnergy).isEmpty());
+}
+
+void OneDayPowerModelTest::testScheduleReload()
+{
+    OneDayPowerModel model(&m_connector, g_serialNumber, QDate(2023, 01, 01));
+    // Make sure every reload actually hits the network.
+    model.setCached(false);
+
+    m_networkAccessManager.setOverrideUrl(QUrl::fromLocalFile(QFINDTESTDATA("data/onedaypower.json")));
+
+    int loadCount = 0;
+    connect(&model, &OneDayPowerModel::statusChanged, this, [&loadCount](RequestStatus status) {
+        if (status == RequestStatus::Loading) {
+            ++loadCount;
+        }
+    });
+
+    // Changing several properties in a row results in a single request.
+    model.scheduleReload();
+    model.setDate(QDate(2023, 01, 02));
+    model.scheduleReload();
+    model.setSerialNumber(QStringLiteral("OTHER"));
+    model.scheduleReload();
+
+    QCOMPARE(model.status(), RequestStatus::NoRequest);
+    QCOMPARE(model.suppressedReloadCount(), 2);
+
+    QTRY_COMPARE(model.status(), RequestStatus::Finished);
+    QCOMPARE(loadCount, 1);
+    QCOMPARE(model.rowCount(), 3);
+
+    // Reloading right away makes a scheduled reload unnecessary.
+    QSignalSpy suppressedSpy(&model, &OneDayPowerModel::suppressedReloadCountChanged);
+    model.scheduleReload();
+    QVERIFY(model.reload());
+    QCOMPARE(suppressedSpy.count(), 1);
+    QCOMPARE(model.suppressedReloadCount(), 3);
+
+    QTRY_COMPARE(model.status(), RequestStatus::Finished);
+    QTest::qWait(50);
+    QCOMPARE(loadCount, 2);
+}
+
 void OneDayPowerModelTest::testApiError()
 {
     OneDayPowerModel model(&m_connector, g_serialNumber, QDate::currentDate());
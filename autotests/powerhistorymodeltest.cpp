@@ -0,0 +1,208 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include <QDate>
+#include <QSignalSpy>
+#include <QTest>
+
+#include <QAlphaCloud/Connector>
+#include <QAlphaCloud/PowerHistoryModel>
+#include <QAlphaCloud/QAlphaCloud>
+
+#include "testnetworkaccessmanager.h"
+
+using namespace QAlphaCloud;
+
+static QString g_serialNumber = QStringLiteral("SERIAL");
+
+class PowerHistoryModelTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void testInitialState();
+    void testFetchMore();
+    void testMaximumDays();
+    void testCache();
+    void testNoOlderData();
+
+    void testApiError();
+
+private:
+    TestNetworkAccessManager m_networkAccessManager;
+    Connector m_connector;
+};
+
+void PowerHistoryModelTest::initTestCase()
+{
+    // Don't rely on defaultConfiguration in tests!
+    auto *configuration = new Configuration(&m_connector);
+    configuration->setAppId(QStringLiteral("powerHistoryModelApp"));
+    configuration->setAppSecret(QStringLiteral("testSecret"));
+    m_connector.setConfiguration(configuration);
+
+    m_connector.setNetworkAccessManager(&m_networkAccessManager);
+}
+
+void PowerHistoryModelTest::testInitialState()
+{
+    PowerHistoryModel model;
+    QCOMPARE(model.status(), RequestStatus::NoRequest);
+    QCOMPARE(model.rowCount(), 0);
+    QVERIFY(!model.hasMore());
+    QVERIFY(!model.canFetchMore(QModelIndex()));
+    QVERIFY(!model.newestDate().isValid());
+    QVERIFY(!model.oldestDate().isValid());
+
+    // Can't load without a connector.
+    QVERIFY(!model.reload());
+
+    model.setConnector(&m_connector);
+    // Can't load without a serial number.
+    QVERIFY(!model.reload());
+}
+
+void PowerHistoryModelTest::testFetchMore()
+{
+    // Every day returns the same three entries.
+    m_networkAccessManager.setOverrideUrl(QUrl::fromLocalFile(QFINDTESTDATA("data/onedaypower.json")));
+
+    PowerHistoryModel model(&m_connector, g_serialNumber);
+
+    QVERIFY(model.reload());
+    QCOMPARE(model.status(), RequestStatus::Loading);
+    // Only one day at a time.
+    QVERIFY(!model.canFetchMore(QModelIndex()));
+
+    QTRY_COMPARE(model.status(), RequestStatus::Finished);
+    QCOMPARE(model.rowCount(), 3);
+    QVERIFY(model.hasMore());
+    QCOMPARE(model.newestDate(), QDate::currentDate());
+    QCOMPARE(model.oldestDate(), QDate::currentDate());
+
+    // Newest entry first.
+    QCOMPARE(model.index(0, 0).data(static_cast<int>(PowerHistoryModel::Roles::PhotovoltaicEnergy)).toInt(), 5000);
+    QCOMPARE(model.index(2, 0).data(static_cast<int>(PowerHistoryModel::Roles::PhotovoltaicEnergy)).toInt(), 3000);
+
+    QSignalSpy rowsInsertedSpy(&model, &PowerHistoryModel::rowsInserted);
+
+    QVERIFY(model.canFetchMore(QModelIndex()));
+    model.fetchMore(QModelIndex());
+    QTRY_COMPARE(model.status(), RequestStatus::Finished);
+
+    QCOMPARE(rowsInsertedSpy.count(), 1);
+    QCOMPARE(rowsInsertedSpy.first().at(1).toInt(), 3);
+    QCOMPARE(rowsInsertedSpy.first().at(2).toInt(), 5);
+
+    QCOMPARE(model.rowCount(), 6);
+    QCOMPARE(model.newestDate(), QDate::currentDate());
+    QCOMPARE(model.oldestDate(), QDate::currentDate().addDays(-1));
+    QCOMPARE(model.index(2, 0).data(static_cast<int>(PowerHistoryModel::Roles::Date)).toDate(), QDate::currentDate());
+    QCOMPARE(model.index(3, 0).data(static_cast<int>(PowerHistoryModel::Roles::Date)).toDate(), QDate::currentDate().addDays(-1));
+}
+
+void PowerHistoryModelTest::testMaximumDays()
+{
+    m_networkAccessManager.setOverrideUrl(QUrl::fromLocalFile(QFINDTESTDATA("data/onedaypower.json")));
+
+    PowerHistoryModel model(&m_connector, g_serialNumber);
+    model.setMaximumDays(2);
+
+    QVERIFY(model.reload());
+    QTRY_COMPARE(model.status(), RequestStatus::Finished);
+
+    model.fetchMore(QModelIndex());
+    QTRY_COMPARE(model.status(), RequestStatus::Finished);
+    QCOMPARE(model.rowCount(), 6);
+
+    QSignalSpy rowsRemovedSpy(&model, &PowerHistoryModel::rowsRemoved);
+
+    // The newest day makes room for the older one.
+    model.fetchMore(QModelIndex());
+    QTRY_COMPARE(model.status(), RequestStatus::Finished);
+
+    QCOMPARE(rowsRemovedSpy.count(), 1);
+    QCOMPARE(rowsRemovedSpy.first().at(1).toInt(), 0);
+    QCOMPARE(rowsRemovedSpy.first().at(2).toInt(), 2);
+
+    QCOMPARE(model.rowCount(), 6);
+    QCOMPARE(model.newestDate(), QDate::currentDate().addDays(-1));
+    QCOMPARE(model.oldestDate(), QDate::currentDate().addDays(-2));
+}
+
+void PowerHistoryModelTest::testCache()
+{
+    m_networkAccessManager.setOverrideUrl(QUrl::fromLocalFile(QFINDTESTDATA("data/onedaypower.json")));
+
+    PowerHistoryModel model(&m_connector, g_serialNumber);
+
+    QVERIFY(model.reload());
+    QTRY_COMPARE(model.status(), RequestStatus::Finished);
+
+    model.fetchMore(QModelIndex());
+    QTRY_COMPARE(model.status(), RequestStatus::Finished);
+
+    QVERIFY(model.reload());
+    QTRY_COMPARE(model.status(), RequestStatus::Finished);
+    QCOMPARE(model.rowCount(), 3);
+
+    // Yesterday is served from the cache right away.
+    model.fetchMore(QModelIndex());
+    QCOMPARE(model.status(), RequestStatus::Finished);
+    QCOMPARE(model.rowCount(), 6);
+
+    // The cache doesn't hold more days than the model.
+    model.setMaximumDays(1);
+
+    model.fetchMore(QModelIndex());
+    QTRY_COMPARE(model.status(), RequestStatus::Finished);
+    QCOMPARE(model.oldestDate(), QDate::currentDate().addDays(-2));
+
+    QVERIFY(model.reload());
+    QTRY_COMPARE(model.status(), RequestStatus::Finished);
+
+    // Yesterday made room for the day before.
+    model.fetchMore(QModelIndex());
+    QCOMPARE(model.status(), RequestStatus::Loading);
+    QTRY_COMPARE(model.status(), RequestStatus::Finished);
+    QCOMPARE(model.newestDate(), QDate::currentDate().addDays(-1));
+}
+
+void PowerHistoryModelTest::testNoOlderData()
+{
+    m_networkAccessManager.setOverrideUrl(QUrl::fromLocalFile(QFINDTESTDATA("data/empty_array.json")));
+
+    PowerHistoryModel model(&m_connector, g_serialNumber);
+
+    QSignalSpy hasMoreSpy(&model, &PowerHistoryModel::hasMoreChanged);
+
+    QVERIFY(model.reload());
+
+    // Keeps going back until it gives up.
+    QTRY_COMPARE(model.status(), RequestStatus::Finished);
+    QCOMPARE(model.rowCount(), 0);
+    QVERIFY(!model.hasMore());
+    QVERIFY(!model.canFetchMore(QModelIndex()));
+    QCOMPARE(hasMoreSpy.count(), 2);
+}
+
+void PowerHistoryModelTest::testApiError()
+{
+    m_networkAccessManager.setOverrideUrl(QUrl::fromLocalFile(QFINDTESTDATA("data/api_error.json")));
+
+    PowerHistoryModel model(&m_connector, g_serialNumber);
+
+    QVERIFY(model.reload());
+    QTRY_COMPARE(model.status(), RequestStatus::Error);
+    QCOMPARE(model.error(), ErrorCode::ParameterError);
+
+    // Doesn't try again by itself.
+    QVERIFY(!model.hasMore());
+    QVERIFY(!model.canFetchMore(QModelIndex()));
+}
+
+QTEST_GUILESS_MAIN(PowerHistoryModelTest)
+#include "powerhistorymodeltest.moc"
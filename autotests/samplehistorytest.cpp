@@ -0,0 +1,166 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include <QDateTime>
+#include <QTest>
+
+#include "samplehistory.h"
+
+using namespace std::chrono_literals;
+
+static constexpr qint64 s_minute = std::chrono::milliseconds(1min).count();
+
+class SampleHistoryTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testInitialState();
+    void testWindowExpiry();
+    void testExpiryOnRead();
+    void testWrapAround();
+    void testEnergyGap();
+    void testMidnightReset();
+
+private:
+    static SampleHistory::Values values(int power);
+    static qint64 time(const QDate &date, const QTime &time);
+};
+
+SampleHistory::Values SampleHistoryTest::values(int power)
+{
+    SampleHistory::Values values;
+    values.fill(power);
+    return values;
+}
+
+qint64 SampleHistoryTest::time(const QDate &date, const QTime &time)
+{
+    return QDateTime(date, time).toMSecsSinceEpoch();
+}
+
+void SampleHistoryTest::testInitialState()
+{
+    SampleHistory history(16);
+    QCOMPARE(history.count(), 0);
+    QCOMPARE(history.capacity(), 16);
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    QCOMPARE(history.average(SampleHistory::Window::FiveMinutes, SampleHistory::Channel::Photovoltaic, now), 0.0);
+    QCOMPARE(history.energyToday(SampleHistory::Channel::Photovoltaic, now), 0.0);
+}
+
+void SampleHistoryTest::testWindowExpiry()
+{
+    SampleHistory history;
+
+    const qint64 start = time(QDate(2023, 06, 01), QTime(10, 0));
+    history.addSample(start, values(100));
+    history.addSample(start + 1 * s_minute, values(200));
+    history.addSample(start + 2 * s_minute, values(300));
+
+    QCOMPARE(history.average(SampleHistory::Window::FiveMinutes, SampleHistory::Channel::Load, start + 2 * s_minute), 200.0);
+
+    // The first two samples are now older than five minutes.
+    history.addSample(start + 6 * s_minute, values(600));
+    QCOMPARE(history.average(SampleHistory::Window::FiveMinutes, SampleHistory::Channel::Load, start + 6 * s_minute), 450.0);
+    // But they're still within the larger windows.
+    QCOMPARE(history.average(SampleHistory::Window::FifteenMinutes, SampleHistory::Channel::Load, start + 6 * s_minute), 300.0);
+    QCOMPARE(history.average(SampleHistory::Window::SixtyMinutes, SampleHistory::Channel::Load, start + 6 * s_minute), 300.0);
+
+    // Adding samples out of order is ignored.
+    history.addSample(start + 5 * s_minute, values(10000));
+    QCOMPARE(history.count(), 4);
+    QCOMPARE(history.average(SampleHistory::Window::FiveMinutes, SampleHistory::Channel::Load, start + 6 * s_minute), 450.0);
+
+    history.clear();
+    QCOMPARE(history.count(), 0);
+    QCOMPARE(history.average(SampleHistory::Window::SixtyMinutes, SampleHistory::Channel::Load, start + 6 * s_minute), 0.0);
+}
+
+void SampleHistoryTest::testExpiryOnRead()
+{
+    SampleHistory history;
+
+    const qint64 start = time(QDate(2023, 06, 01), QTime(10, 0));
+    history.addSample(start, values(100));
+    history.addSample(start + 1 * s_minute, values(300));
+
+    // No new samples arrived, e.g. because polling stopped, old ones must not linger.
+    QCOMPARE(history.average(SampleHistory::Window::FiveMinutes, SampleHistory::Channel::Photovoltaic, start + 5 * s_minute + 1), 300.0);
+    QCOMPARE(history.average(SampleHistory::Window::FiveMinutes, SampleHistory::Channel::Photovoltaic, start + 10 * s_minute), 0.0);
+    QCOMPARE(history.average(SampleHistory::Window::SixtyMinutes, SampleHistory::Channel::Photovoltaic, start + 10 * s_minute), 200.0);
+
+    // New samples are averaged properly afterwards.
+    history.addSample(start + 11 * s_minute, values(500));
+    QCOMPARE(history.average(SampleHistory::Window::FiveMinutes, SampleHistory::Channel::Photovoltaic, start + 11 * s_minute), 500.0);
+    QCOMPARE(history.average(SampleHistory::Window::SixtyMinutes, SampleHistory::Channel::Photovoltaic, start + 11 * s_minute), 300.0);
+}
+
+void SampleHistoryTest::testWrapAround()
+{
+    SampleHistory history(4);
+
+    const qint64 start = time(QDate(2023, 06, 01), QTime(10, 0));
+    for (int i = 1; i <= 6; ++i) {
+        history.addSample(start + i * 10000, values(i * 100));
+    }
+
+    QCOMPARE(history.count(), 4);
+
+    // Only the four most recent samples are left, the overwritten ones no longer count.
+    const qint64 now = start + 6 * 10000;
+    QCOMPARE(history.average(SampleHistory::Window::FiveMinutes, SampleHistory::Channel::GridFeed, now), 450.0);
+    QCOMPARE(history.average(SampleHistory::Window::SixtyMinutes, SampleHistory::Channel::GridFeed, now), 450.0);
+}
+
+void SampleHistoryTest::testEnergyGap()
+{
+    SampleHistory history;
+
+    const QDate date(2023, 06, 01);
+    history.addSample(time(date, QTime(10, 0)), values(1200));
+    history.addSample(time(date, QTime(10, 1)), values(1200));
+    // 1200 W for one minute.
+    QCOMPARE(history.energyToday(SampleHistory::Channel::Photovoltaic, time(date, QTime(10, 1))), 20.0);
+
+    // Trapezoidal rule, average of 1200 W and 2400 W.
+    history.addSample(time(date, QTime(10, 2)), values(2400));
+    QCOMPARE(history.energyToday(SampleHistory::Channel::Photovoltaic, time(date, QTime(10, 2))), 50.0);
+
+    // We don't know what happened within a gap of more than five minutes, don't integrate it.
+    history.addSample(time(date, QTime(10, 10)), values(2400));
+    QCOMPARE(history.energyToday(SampleHistory::Channel::Photovoltaic, time(date, QTime(10, 10))), 50.0);
+
+    // Continues after the gap.
+    history.addSample(time(date, QTime(10, 11)), values(2400));
+    QCOMPARE(history.energyToday(SampleHistory::Channel::Photovoltaic, time(date, QTime(10, 11))), 90.0);
+}
+
+void SampleHistoryTest::testMidnightReset()
+{
+    SampleHistory history;
+
+    const QDate date(2023, 06, 01);
+    history.addSample(time(date, QTime(23, 58)), values(600));
+    history.addSample(time(date, QTime(23, 59)), values(600));
+    QCOMPARE(history.energyToday(SampleHistory::Channel::BatteryCharge, time(date, QTime(23, 59))), 10.0);
+
+    // Once the day is over, there's nothing for the new day yet.
+    QCOMPARE(history.energyToday(SampleHistory::Channel::BatteryCharge, time(date.addDays(1), QTime(0, 0, 30))), 0.0);
+
+    // The first sample of the new day starts from zero.
+    history.addSample(time(date.addDays(1), QTime(0, 0, 30)), values(600));
+    QCOMPARE(history.energyToday(SampleHistory::Channel::BatteryCharge, time(date.addDays(1), QTime(0, 0, 30))), 0.0);
+
+    history.addSample(time(date.addDays(1), QTime(0, 1, 30)), values(600));
+    QCOMPARE(history.energyToday(SampleHistory::Channel::BatteryCharge, time(date.addDays(1), QTime(0, 1, 30))), 10.0);
+
+    // Averages don't care about midnight.
+    QCOMPARE(history.average(SampleHistory::Window::FiveMinutes, SampleHistory::Channel::BatteryCharge, time(date.addDays(1), QTime(0, 1, 30))), 600.0);
+}
+
+QTEST_GUILESS_MAIN(SampleHistoryTest)
+#include "samplehistorytest.moc"
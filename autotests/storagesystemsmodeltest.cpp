@@ -34,6 +34,7 @@ private Q_SLOTS:
     void testMultipleData();
     void testReload();
     void testReloadSameData();
+    void testReloadChangedData();
     void testCache();
 
     void testApiError();
@@ -251,6 +252,25 @@ void StorageSystemsModelTest::testMultipleData()
         const int photovoltaicPower = idx.data(static_cast<int>(Roles::PhotovoltaicPower)).toInt();
         QCOMPARE(photovoltaicPower, (i + 1) * 1000); // Watts.
     }
+
+    // The bulk accessor provides the same data.
+    const auto systems = model.storageSystems();
+    QCOMPARE(static_cast<int>(systems.size()), 3);
+    for (int i = 0; i < 3; ++i) {
+        const QModelIndex idx = model.index(i);
+        const StorageSystem &system = systems[i];
+
+        QCOMPARE(system.serialNumber, idx.data(static_cast<int>(Roles::SerialNumber)).toString());
+        QCOMPARE(system.status, idx.data(static_cast<int>(Roles::Status)).value<QAlphaCloud::SystemStatus>());
+        QCOMPARE(system.inverterModel, idx.data(static_cast<int>(Roles::InverterModel)).toString());
+        QCOMPARE(system.inverterPower, idx.data(static_cast<int>(Roles::InverterPower)).toInt());
+        QCOMPARE(system.batteryModel, idx.data(static_cast<int>(Roles::BatteryModel)).toString());
+        QCOMPARE(system.grossBatteryCapacity, idx.data(static_cast<int>(Roles::BatteryGrossCapacity)).toInt());
+        QCOMPARE(system.remainingBatteryCapacity, idx.data(static_cast<int>(Roles::BatteryRemainingCapacity)).toInt());
+        QCOMPARE(system.usableBatteryCapacity, idx.data(static_cast<int>(Roles::BatteryUsableCapacity)).toReal());
+        QCOMPARE(system.photovoltaicPower, idx.data(static_cast<int>(Roles::PhotovoltaicPower)).toInt());
+        QCOMPARE(system.json, idx.data(static_cast<int>(Roles::RawJson)).toJsonObject());
+    }
 }
 
 void StorageSystemsModelTest::testReload()
@@ -345,6 +365,53 @@ void StorageSystemsModelTest::testReloadSameData()
     QCOMPARE(countChangedSpy.count(), 1);
 }
 
+void StorageSystemsModelTest::testReloadChangedData()
+{
+    using Roles = StorageSystemsModel::Roles;
+
+    StorageSystemsModel model(&m_connector);
+    model.setCached(false);
+
+    m_networkAccessManager.setOverrideUrl(QUrl::fromLocalFile(QFINDTESTDATA("data/storagesystems_multiple.json")));
+
+    QVERIFY(model.reload());
+    QTRY_COMPARE(model.status(), QAlphaCloud::RequestStatus::Finished);
+    QCOMPARE(model.rowCount(), 3);
+
+    QSignalSpy modelResetSpy(&model, &StorageSystemsModel::modelReset);
+    QSignalSpy rowsRemovedSpy(&model, &StorageSystemsModel::rowsRemoved);
+    QSignalSpy rowsInsertedSpy(&model, &StorageSystemsModel::rowsInserted);
+    QSignalSpy dataChangedSpy(&model, &StorageSystemsModel::dataChanged);
+    QSignalSpy primarySerialNumberChangedSpy(&model, &StorageSystemsModel::primarySerialNumberChanged);
+
+    // SERIALB is gone, SERIALA lost some capacity, SERIALC is unchanged, SERIALD is new.
+    m_networkAccessManager.setOverrideUrl(QUrl::fromLocalFile(QFINDTESTDATA("data/storagesystems_changed.json")));
+
+    QVERIFY(model.reload());
+    QTRY_COMPARE(model.status(), QAlphaCloud::RequestStatus::Finished);
+
+    // Applied incrementally rather than resetting the model.
+    QCOMPARE(modelResetSpy.count(), 0);
+    QCOMPARE(primarySerialNumberChangedSpy.count(), 0);
+
+    QCOMPARE(rowsRemovedSpy.count(), 1);
+    QCOMPARE(rowsRemovedSpy.first().at(1).toInt(), 1);
+
+    QCOMPARE(rowsInsertedSpy.count(), 1);
+    QCOMPARE(rowsInsertedSpy.first().at(1).toInt(), 2);
+
+    QCOMPARE(dataChangedSpy.count(), 1);
+    QCOMPARE(dataChangedSpy.first().at(0).toModelIndex().row(), 0);
+    const auto roles = dataChangedSpy.first().at(2).value<QVector<int>>();
+    QVERIFY(roles.contains(static_cast<int>(Roles::BatteryRemainingCapacity)));
+    QVERIFY(!roles.contains(static_cast<int>(Roles::BatteryGrossCapacity)));
+
+    QCOMPARE(model.rowCount(), 3);
+    QCOMPARE(model.index(0).data(static_cast<int>(Roles::BatteryRemainingCapacity)).toInt(), 1700);
+    QCOMPARE(model.index(1).data(static_cast<int>(Roles::SerialNumber)).toString(), QStringLiteral("SERIALC"));
+    QCOMPARE(model.index(2).data(static_cast<int>(Roles::SerialNumber)).toString(), QStringLiteral("SERIALD"));
+}
+
 void StorageSystemsModelTest::testCache()
 {
     using Roles = StorageSystemsModel::Roles;
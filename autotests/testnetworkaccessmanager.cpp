@@ -5,6 +5,84 @@
 
 #include "testnetworkaccessmanager.h"
 
+#include <QDebug>
+#include <QFile>
+#include <QNetworkReply>
+#include <QTimer>
+
+#include <algorithm>
+#include <cstring>
+
+// Successful HTTP reply served from memory, for when QNetworkAccessManager's own file:// reply won't do.
+class TestReply : public QNetworkReply
+{
+public:
+    TestReply(const QNetworkRequest &request, const QByteArray &data, const QList<QPair<QByteArray, QByteArray>> &headers, int delay, QObject *parent)
+        : QNetworkReply(parent)
+        , m_data(data)
+    {
+        setRequest(request);
+        setUrl(request.url());
+        setOperation(QNetworkAccessManager::GetOperation);
+        setAttribute(QNetworkRequest::HttpStatusCodeAttribute, 200);
+        setHeader(QNetworkRequest::ContentLengthHeader, m_data.size());
+        for (const auto &header : headers) {
+            setRawHeader(header.first, header.second);
+        }
+        open(QIODevice::ReadOnly);
+
+        QTimer::singleShot(delay, this, [this] {
+            if (isFinished()) { // aborted.
+                return;
+            }
+            setFinished(true);
+            Q_EMIT metaDataChanged();
+            Q_EMIT readyRead();
+            Q_EMIT finished();
+        });
+    }
+
+    void abort() override
+    {
+        if (isFinished()) {
+            return;
+        }
+
+        m_data.clear();
+        setError(OperationCanceledError, QStringLiteral("Operation canceled"));
+        setFinished(true);
+        Q_EMIT errorOccurred(OperationCanceledError);
+        Q_EMIT finished();
+    }
+
+    qint64 bytesAvailable() const override
+    {
+        return m_data.size() - m_offset + QNetworkReply::bytesAvailable();
+    }
+
+    bool isSequential() const override
+    {
+        return true;
+    }
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override
+    {
+        if (!isFinished() || m_offset >= m_data.size()) {
+            return isFinished() ? -1 : 0;
+        }
+
+        const qint64 size = std::min(maxSize, m_data.size() - m_offset);
+        std::memcpy(data, m_data.constData() + m_offset, size);
+        m_offset += size;
+        return size;
+    }
+
+private:
+    QByteArray m_data;
+    qint64 m_offset = 0;
+};
+
 TestNetworkAccessManager::TestNetworkAccessManager(QObject *parent)
     : QNetworkAccessManager(parent)
 {
@@ -22,11 +100,59 @@ void TestNetworkAccessManager::setOverrideUrl(const QUrl &url)
     m_overrideUrl = url;
 }
 
+void TestNetworkAccessManager::enqueueReply(const QUrl &url, int delay)
+{
+    m_replies.enqueue(Reply{url, delay});
+}
+
+int TestNetworkAccessManager::replyDelay() const
+{
+    return m_replyDelay;
+}
+
+void TestNetworkAccessManager::setReplyDelay(int delay)
+{
+    m_replyDelay = delay;
+}
+
+void TestNetworkAccessManager::setReplyHeader(const QByteArray &name, const QByteArray &value)
+{
+    m_replyHeaders.append(qMakePair(name, value));
+}
+
+void TestNetworkAccessManager::clearReplyHeaders()
+{
+    m_replyHeaders.clear();
+}
+
+int TestNetworkAccessManager::requestCount() const
+{
+    return m_requestCount;
+}
+
+QNetworkRequest TestNetworkAccessManager::lastRequest() const
+{
+    return m_lastRequest;
+}
+
 QNetworkReply *TestNetworkAccessManager::createRequest(Operation op, const QNetworkRequest &request, QIODevice *outgoingData)
 {
+    ++m_requestCount;
+    m_lastRequest = request;
+
+    const Reply reply = !m_replies.isEmpty() ? m_replies.dequeue() : Reply{m_overrideUrl, m_replyDelay};
+
+    if (reply.delay > 0 || !m_replyHeaders.isEmpty()) {
+        QFile file(reply.url.toLocalFile());
+        if (!file.open(QIODevice::ReadOnly)) {
+            qWarning() << "Failed to open" << reply.url << file.errorString();
+        }
+        return new TestReply(request, file.readAll(), m_replyHeaders, reply.delay, this);
+    }
+
     QNetworkRequest newRequest(request);
 
-    newRequest.setUrl(m_overrideUrl);
+    newRequest.setUrl(reply.url);
 
     return QNetworkAccessManager::createRequest(op, newRequest, outgoingData);
 }
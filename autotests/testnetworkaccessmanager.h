@@ -3,7 +3,13 @@
  * SPDX-License-Identifier: LGPL-2.1-or-later
  */
 
+#include <QByteArray>
+#include <QList>
 #include <QNetworkAccessManager>
+#include <QNetworkRequest>
+#include <QPair>
+#include <QQueue>
+#include <QUrl>
 
 class TestNetworkAccessManager : public QNetworkAccessManager
 {
@@ -14,9 +20,35 @@ public:
     QUrl overrideUrl() const;
     void setOverrideUrl(const QUrl &url);
 
+    // Serves the file to the next request after delay ms, before falling back to overrideUrl.
+    void enqueueReply(const QUrl &url, int delay = 0);
+
+    // Delay in ms of replies that weren't enqueued.
+    int replyDelay() const;
+    void setReplyDelay(int delay);
+
+    // Raw header added to every reply, e.g. Date.
+    void setReplyHeader(const QByteArray &name, const QByteArray &value);
+    void clearReplyHeaders();
+
+    // Number of requests created so far.
+    int requestCount() const;
+    // The request most recently created, before its URL was overridden.
+    QNetworkRequest lastRequest() const;
+
 protected:
     QNetworkReply *createRequest(Operation op, const QNetworkRequest &request, QIODevice *outgoingData = nullptr) override;
 
 private:
+    struct Reply {
+        QUrl url;
+        int delay = 0;
+    };
+
     QUrl m_overrideUrl;
+    QQueue<Reply> m_replies;
+    int m_replyDelay = 0;
+    QList<QPair<QByteArray, QByteArray>> m_replyHeaders;
+    int m_requestCount = 0;
+    QNetworkRequest m_lastRequest;
 };
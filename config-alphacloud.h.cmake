@@ -6,3 +6,5 @@
 #define API_URL "${API_URL}"
 
 #cmakedefine01 PRESENTATION_BUILD
+
+#cmakedefine01 HAVE_QTDBUS
@@ -0,0 +1,218 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "benchmark.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMetaEnum>
+
+#include <algorithm>
+#include <iostream>
+
+#include <QAlphaCloud/ApiRequest>
+#include <QAlphaCloud/Connector>
+
+using namespace QAlphaCloud;
+
+// Expects the values to be sorted.
+static qint64 percentile(const QVector<qint64> &values, int percent)
+{
+    if (values.isEmpty()) {
+        return 0;
+    }
+    const int index = std::min(values.count() - 1, static_cast<int>(values.count() * percent / 100));
+    return values.at(index);
+}
+
+static QString errorName(ErrorCode error)
+{
+    const char *key = QMetaEnum::fromType<ErrorCode>().valueToKey(static_cast<int>(error));
+    if (key) {
+        return QString::fromLatin1(key);
+    }
+    return QString::number(static_cast<int>(error));
+}
+
+Benchmark::Benchmark(Connector *connector, QObject *parent)
+    : QObject(parent)
+    , m_connector(connector)
+{
+}
+
+Benchmark::~Benchmark() = default;
+
+void Benchmark::addRequest(const QString &endPoint, const QString &serialNumber, const QDate &date)
+{
+    m_requests.append(Request{endPoint, serialNumber, date});
+}
+
+void Benchmark::setConcurrency(int concurrency)
+{
+    m_concurrency = std::max(1, concurrency);
+}
+
+void Benchmark::setDuration(int duration)
+{
+    m_duration = duration;
+}
+
+void Benchmark::setMaximumRequests(int maximumRequests)
+{
+    m_maximumRequests = maximumRequests;
+}
+
+void Benchmark::setJsonOutput(bool jsonOutput)
+{
+    m_jsonOutput = jsonOutput;
+}
+
+void Benchmark::start()
+{
+    if (m_requests.isEmpty()) {
+        std::cerr << "No requests to benchmark" << std::endl;
+        Q_EMIT finished(false);
+        return;
+    }
+
+    std::cerr << "Benchmarking " << m_requests.count() << " request(s) with concurrency " << m_concurrency << " for " << m_duration << " ms" << std::endl;
+
+    m_timer.start();
+
+    for (int i = 0; i < m_concurrency && !m_done; ++i) {
+        sendNext();
+    }
+
+    if (m_inFlight == 0 && !m_done) {
+        m_done = true;
+        Q_EMIT finished(false);
+    }
+}
+
+void Benchmark::sendNext()
+{
+    const bool expired = m_timer.elapsed() >= m_duration || (m_maximumRequests > 0 && m_sent >= m_maximumRequests);
+    if (expired) {
+        if (m_inFlight == 0 && !m_done) {
+            m_done = true;
+            m_totalTime = m_timer.elapsed();
+            printReport();
+            Q_EMIT finished(m_errors.isEmpty());
+        }
+        return;
+    }
+
+    const Request &spec = m_requests.at(m_sent % m_requests.count());
+
+    auto *request = new ApiRequest(m_connector, spec.endPoint, this);
+    if (!spec.serialNumber.isEmpty()) {
+        request->setSysSn(spec.serialNumber);
+    }
+    if (spec.date.isValid()) {
+        request->setQueryDate(spec.date);
+    }
+
+    connect(request, &ApiRequest::finished, this, [this, request] {
+        --m_inFlight;
+
+        // Short-circuited, rejected, and last-data results took no time at all,
+        // a request retried with a corrected timestamp has no meaningful one.
+        if (request->elapsedTime() <= 0 || request->stale()) {
+            ++m_unmeasured;
+        } else {
+            m_latencies.append(request->elapsedTime());
+            m_parseTimes.append(request->parseTime());
+            m_bytesReceived += request->bytesReceived();
+        }
+        if (request->error() != ErrorCode::NoError) {
+            ++m_errors[request->error()];
+        }
+
+        sendNext();
+    });
+
+    if (!request->send()) {
+        std::cerr << "Failed to send request" << std::endl;
+        return;
+    }
+
+    ++m_sent;
+    ++m_inFlight;
+}
+
+void Benchmark::printReport() const
+{
+    QVector<qint64> latencies = m_latencies;
+    std::sort(latencies.begin(), latencies.end());
+
+    QVector<qint64> parseTimes = m_parseTimes;
+    std::sort(parseTimes.begin(), parseTimes.end());
+
+    // Latency, parse time, and transfer statistics only cover requests that went to the API.
+    const int count = latencies.count();
+    const int totalCount = count + m_unmeasured;
+    const qreal seconds = m_totalTime / 1000.0;
+    const qreal throughput = seconds > 0 ? count / seconds : 0.0;
+
+    qint64 totalParseTime = 0;
+    for (qint64 parseTime : std::as_const(parseTimes)) {
+        totalParseTime += parseTime;
+    }
+
+    int errorCount = 0;
+    for (int errors : m_errors) {
+        errorCount += errors;
+    }
+
+    if (m_jsonOutput) {
+        QJsonObject errors;
+        for (auto it = m_errors.cbegin(), end = m_errors.cend(); it != end; ++it) {
+            errors.insert(errorName(it.key()), it.value());
+        }
+
+        const QJsonObject report{
+            {QStringLiteral("requests"), totalCount},
+            {QStringLiteral("unmeasured"), m_unmeasured},
+            {QStringLiteral("errors"), errorCount},
+            {QStringLiteral("duration"), m_totalTime},
+            {QStringLiteral("throughput"), throughput},
+            {QStringLiteral("latency"),
+             QJsonObject{
+                 {QStringLiteral("p50"), percentile(latencies, 50)},
+                 {QStringLiteral("p90"), percentile(latencies, 90)},
+                 {QStringLiteral("p99"), percentile(latencies, 99)},
+                 {QStringLiteral("max"), count > 0 ? latencies.constLast() : 0},
+             }},
+            {QStringLiteral("bytesReceived"), m_bytesReceived},
+            {QStringLiteral("parseTime"),
+             QJsonObject{
+                 {QStringLiteral("p50"), percentile(parseTimes, 50)},
+                 {QStringLiteral("p99"), percentile(parseTimes, 99)},
+                 {QStringLiteral("total"), totalParseTime},
+             }},
+            {QStringLiteral("errorCodes"), errors},
+        };
+
+        std::cout << qPrintable(QJsonDocument(report).toJson());
+        return;
+    }
+
+    std::cout << "Requests: " << totalCount << " (" << errorCount << " failed, " << m_unmeasured << " not measured) in " << seconds << " s" << '\n';
+    std::cout << "Throughput: " << throughput << " requests/s" << '\n';
+    std::cout << "Latency (ms): p50 " << percentile(latencies, 50) << ", p90 " << percentile(latencies, 90) << ", p99 " << percentile(latencies, 99)
+              << ", max " << (count > 0 ? latencies.constLast() : 0) << '\n';
+    std::cout << "Bytes received: " << m_bytesReceived << " (" << (count > 0 ? m_bytesReceived / count : 0) << " per request)" << '\n';
+    std::cout << "Parse time (µs): p50 " << percentile(parseTimes, 50) << ", p99 " << percentile(parseTimes, 99) << ", total " << totalParseTime << '\n';
+
+    if (!m_errors.isEmpty()) {
+        std::cout << "Errors:" << '\n';
+        for (auto it = m_errors.cbegin(), end = m_errors.cend(); it != end; ++it) {
+            std::cout << "  " << qPrintable(errorName(it.key())) << " (" << static_cast<int>(it.key()) << "): " << it.value() << '\n';
+        }
+    }
+
+    std::cout << std::flush;
+}
@@ -0,0 +1,85 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <QDate>
+#include <QElapsedTimer>
+#include <QMap>
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+#include <QAlphaCloud/QAlphaCloud>
+
+namespace QAlphaCloud
+{
+class Connector;
+}
+
+/**
+ * Sends a mix of API requests for a given duration and reports
+ * latency percentiles, throughput, errors, and transfer statistics.
+ *
+ * Requests go through the regular ApiRequest code path, so this measures
+ * the library as much as the server.
+ */
+class Benchmark : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit Benchmark(QAlphaCloud::Connector *connector, QObject *parent = nullptr);
+    ~Benchmark() override;
+
+    // Adds a request to the mix, which is sent in a round-robin fashion.
+    void addRequest(const QString &endPoint, const QString &serialNumber, const QDate &date);
+
+    void setConcurrency(int concurrency);
+    // In milliseconds.
+    void setDuration(int duration);
+    // Stop after this many requests, 0 for no limit.
+    void setMaximumRequests(int maximumRequests);
+
+    void setJsonOutput(bool jsonOutput);
+
+    void start();
+
+Q_SIGNALS:
+    void finished(bool success);
+
+private:
+    struct Request {
+        QString endPoint;
+        QString serialNumber;
+        QDate date;
+    };
+
+    void sendNext();
+    void printReport() const;
+
+    QAlphaCloud::Connector *m_connector;
+
+    QVector<Request> m_requests;
+    int m_concurrency = 4;
+    int m_duration = 10000;
+    int m_maximumRequests = 0;
+    bool m_jsonOutput = false;
+
+    QElapsedTimer m_timer;
+    qint64 m_totalTime = 0;
+    int m_sent = 0;
+    int m_inFlight = 0;
+    bool m_done = false;
+
+    // Only requests that actually went to the API are measured.
+    QVector<qint64> m_latencies; // ms
+    QVector<qint64> m_parseTimes; // µs
+    qint64 m_bytesReceived = 0;
+    // Answered without asking the API, e.g. by the circuit breaker,
+    // or without a meaningful elapsed time, e.g. after a timestamp retry.
+    int m_unmeasured = 0;
+    QMap<QAlphaCloud::ErrorCode, int> m_errors;
+};
@@ -0,0 +1,102 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "bufferedwriter.h"
+
+#include <QIODevice>
+#include <QString>
+
+#include <cstring>
+
+BufferedWriter::BufferedWriter(QIODevice *device, int capacity)
+    : m_device(device)
+    , m_capacity(capacity)
+{
+    m_buffer.reserve(capacity);
+}
+
+BufferedWriter::~BufferedWriter()
+{
+    flush();
+}
+
+void BufferedWriter::append(const char *data, int size)
+{
+    if (m_buffer.size() + size > m_capacity) {
+        flush();
+    }
+    // Still too large, don't bother buffering it.
+    if (size > m_capacity) {
+        m_ok = m_ok && m_device->write(data, size) == size;
+        return;
+    }
+    m_buffer.append(data, size);
+}
+
+BufferedWriter &BufferedWriter::operator<<(char c)
+{
+    append(&c, 1);
+    return *this;
+}
+
+BufferedWriter &BufferedWriter::operator<<(const char *string)
+{
+    append(string, static_cast<int>(std::strlen(string)));
+    return *this;
+}
+
+BufferedWriter &BufferedWriter::operator<<(const QByteArray &data)
+{
+    append(data.constData(), data.size());
+    return *this;
+}
+
+BufferedWriter &BufferedWriter::operator<<(const QString &string)
+{
+    return *this << string.toUtf8();
+}
+
+BufferedWriter &BufferedWriter::operator<<(int number)
+{
+    return *this << static_cast<qint64>(number);
+}
+
+BufferedWriter &BufferedWriter::operator<<(qint64 number)
+{
+    // Avoid a QByteArray allocation for every number.
+    char digits[24];
+    int pos = sizeof(digits);
+    const bool negative = number < 0;
+    quint64 value = negative ? 0 - static_cast<quint64>(number) : static_cast<quint64>(number);
+    do {
+        digits[--pos] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    if (negative) {
+        digits[--pos] = '-';
+    }
+    append(digits + pos, static_cast<int>(sizeof(digits)) - pos);
+    return *this;
+}
+
+BufferedWriter &BufferedWriter::operator<<(double number)
+{
+    return *this << QByteArray::number(number, 'g', 10);
+}
+
+bool BufferedWriter::flush()
+{
+    if (!m_buffer.isEmpty()) {
+        m_ok = m_ok && m_device->write(m_buffer) == m_buffer.size();
+        // Keeps the capacity.
+        m_buffer.resize(0);
+    }
+    return m_ok;
+}
+
+bool BufferedWriter::ok() const
+{
+    return m_ok;
+}
@@ -0,0 +1,43 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <QByteArray>
+
+class QIODevice;
+
+/**
+ * Collects output in a fixed-size buffer and writes it to the device in large chunks.
+ *
+ * Nothing is written until the buffer is full or flush() is called explicitly.
+ */
+class BufferedWriter
+{
+public:
+    explicit BufferedWriter(QIODevice *device, int capacity = 64 * 1024);
+    ~BufferedWriter();
+
+    BufferedWriter &operator<<(char c);
+    BufferedWriter &operator<<(const char *string);
+    BufferedWriter &operator<<(const QByteArray &data);
+    BufferedWriter &operator<<(const QString &string);
+    BufferedWriter &operator<<(int number);
+    BufferedWriter &operator<<(qint64 number);
+    BufferedWriter &operator<<(double number);
+
+    bool flush();
+
+    // Whether all writes to the device succeeded.
+    bool ok() const;
+
+private:
+    void append(const char *data, int size);
+
+    QIODevice *m_device;
+    QByteArray m_buffer;
+    int m_capacity;
+    bool m_ok = true;
+};
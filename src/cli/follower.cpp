@@ -0,0 +1,187 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "follower.h"
+
+#include "bufferedwriter.h"
+
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <algorithm>
+#include <iostream>
+
+#include <QAlphaCloud/ApiRequest>
+#include <QAlphaCloud/Connector>
+
+using namespace QAlphaCloud;
+
+Follower::Follower(Connector *connector, BufferedWriter *writer, QObject *parent)
+    : QObject(parent)
+    , m_connector(connector)
+    , m_writer(writer)
+{
+    m_timer.setTimerType(Qt::CoarseTimer);
+    connect(&m_timer, &QTimer::timeout, this, &Follower::poll);
+}
+
+Follower::~Follower() = default;
+
+void Follower::addTarget(const QString &name, const QString &endPoint, const QString &serialNumber, bool dated)
+{
+    Target target;
+    target.name = name;
+    target.endPoint = endPoint;
+    target.serialNumber = serialNumber;
+    target.dated = dated;
+    target.history = endPoint == ApiRequest::EndPoint::OneDayPowerBySn;
+    m_targets.append(target);
+}
+
+void Follower::setDate(const QDate &date)
+{
+    m_date = date;
+}
+
+void Follower::setInterval(int interval)
+{
+    m_interval = interval;
+}
+
+void Follower::start()
+{
+    if (m_interval > 0) {
+        m_timer.start(m_interval);
+    }
+    poll();
+}
+
+void Follower::poll()
+{
+    const QDate date = m_date.isValid() ? m_date : QDate::currentDate();
+
+    for (int i = 0; i < m_targets.count(); ++i) {
+        Target &target = m_targets[i];
+
+        // Still waiting for the previous one, don't pile up requests.
+        if (target.request) {
+            continue;
+        }
+
+        auto *request = new ApiRequest(m_connector, target.endPoint, this);
+        if (!target.serialNumber.isEmpty()) {
+            request->setSysSn(target.serialNumber);
+        }
+        if (target.dated) {
+            request->setQueryDate(date);
+        }
+
+        connect(request, &ApiRequest::errorOccurred, this, [this, request, i] {
+            const Target &target = m_targets.at(i);
+            std::cerr << "Failed to fetch " << qPrintable(target.name) << " " << qPrintable(target.serialNumber) << ": " << qPrintable(request->errorString())
+                      << std::endl;
+            requestFinished(false);
+        });
+
+        connect(request, &ApiRequest::result, this, [this, request, i, date] {
+            Target &target = m_targets[i];
+            // A new day starts with a fresh history.
+            if (target.lastDate != date) {
+                target.lastDate = date;
+                target.lastUploadTime.clear();
+            }
+
+            processResult(i, request->data());
+            requestFinished(true);
+        });
+
+        if (request->send()) {
+            target.request = request;
+            ++m_pending;
+        }
+    }
+
+    if (m_pending == 0) {
+        requestFinished(false);
+    }
+}
+
+void Follower::processResult(int index, const QJsonValue &data)
+{
+    Target &target = m_targets[index];
+
+    const QByteArray timestamp = QDateTime::currentDateTimeUtc().toString(Qt::ISODateWithMs).toUtf8();
+
+    if (!target.history) {
+        const QByteArray json = data.isArray() ? QJsonDocument(data.toArray()).toJson(QJsonDocument::Compact)
+                                               : QJsonDocument(data.toObject()).toJson(QJsonDocument::Compact);
+        if (json == target.lastData) {
+            return;
+        }
+        target.lastData = json;
+
+        writeRecord(target, timestamp, json);
+        return;
+    }
+
+    const QString uploadTimeKey = QStringLiteral("uploadTime");
+
+    QVector<QJsonObject> newEntries;
+    const QJsonArray entries = data.toArray();
+    for (const QJsonValue &entry : entries) {
+        const QJsonObject object = entry.toObject();
+        // The time is ISO formatted, so comparing the strings is sufficient.
+        if (object.value(uploadTimeKey).toString() > target.lastUploadTime) {
+            newEntries.append(object);
+        }
+    }
+
+    std::sort(newEntries.begin(), newEntries.end(), [&uploadTimeKey](const QJsonObject &a, const QJsonObject &b) {
+        return a.value(uploadTimeKey).toString() < b.value(uploadTimeKey).toString();
+    });
+
+    for (const QJsonObject &entry : std::as_const(newEntries)) {
+        writeRecord(target, timestamp, QJsonDocument(entry).toJson(QJsonDocument::Compact));
+    }
+
+    if (!newEntries.isEmpty()) {
+        target.lastUploadTime = newEntries.constLast().value(uploadTimeKey).toString();
+    }
+}
+
+void Follower::writeRecord(const Target &target, const QByteArray &timestamp, const QByteArray &data)
+{
+    *m_writer << "{\"time\":\"" << timestamp << "\",\"endpoint\":\"" << target.name << '"';
+    if (!target.serialNumber.isEmpty()) {
+        *m_writer << ",\"sysSn\":\"" << target.serialNumber << '"';
+    }
+    *m_writer << ",\"data\":" << data << "}\n";
+}
+
+void Follower::requestFinished(bool success)
+{
+    m_failed = m_failed || !success;
+
+    if (m_pending > 0) {
+        --m_pending;
+    }
+    if (m_pending > 0) {
+        return;
+    }
+
+    // Write everything from this round at once.
+    if (!m_writer->flush()) {
+        std::cerr << "Failed to write output" << std::endl;
+        m_timer.stop();
+        Q_EMIT finished(false);
+        return;
+    }
+
+    if (m_interval == 0) {
+        Q_EMIT finished(!m_failed);
+    }
+}
@@ -0,0 +1,92 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QDate>
+#include <QJsonValue>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QTimer>
+#include <QVector>
+
+namespace QAlphaCloud
+{
+class ApiRequest;
+class Connector;
+} // namespace QAlphaCloud
+
+class BufferedWriter;
+
+/**
+ * Polls several endpoints and storage systems on a shared schedule and prints
+ * the results as newline-delimited JSON, one compact record per line.
+ *
+ * Records whose data didn't change since the previous poll are skipped.
+ * For the history, only entries newer than the previously printed ones
+ * are printed, one record each.
+ */
+class Follower : public QObject
+{
+    Q_OBJECT
+
+public:
+    Follower(QAlphaCloud::Connector *connector, BufferedWriter *writer, QObject *parent = nullptr);
+    ~Follower() override;
+
+    /**
+     * @param name The name used in the record.
+     * @param endPoint The API endpoint.
+     * @param serialNumber The serial number, if the endpoint needs one.
+     * @param dated Whether the endpoint needs a date.
+     */
+    void addTarget(const QString &name, const QString &endPoint, const QString &serialNumber, bool dated);
+
+    // A date to use rather than the current one.
+    void setDate(const QDate &date);
+
+    // 0 only polls once.
+    void setInterval(int interval);
+
+    void start();
+
+Q_SIGNALS:
+    void finished(bool success);
+
+private:
+    struct Target {
+        QString name;
+        QString endPoint;
+        QString serialNumber;
+        bool dated = false;
+        bool history = false;
+
+        QByteArray lastData;
+        // The newest history entry printed so far.
+        QString lastUploadTime;
+        QDate lastDate;
+
+        QPointer<QAlphaCloud::ApiRequest> request;
+    };
+
+    void poll();
+    void processResult(int index, const QJsonValue &data);
+    void requestFinished(bool success);
+
+    void writeRecord(const Target &target, const QByteArray &timestamp, const QByteArray &data);
+
+    QAlphaCloud::Connector *m_connector;
+    BufferedWriter *m_writer;
+
+    QVector<Target> m_targets;
+    QDate m_date;
+    int m_interval = 0;
+
+    QTimer m_timer;
+    int m_pending = 0;
+    bool m_failed = false;
+};
@@ -0,0 +1,287 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "historyexporter.h"
+
+#include "bufferedwriter.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QTimer>
+#include <QVector>
+
+#include <algorithm>
+#include <iostream>
+
+#include <QAlphaCloud/ApiRequest>
+#include <QAlphaCloud/Connector>
+
+using namespace QAlphaCloud;
+
+// Failed requests are retried with 1, 2, 4, 8, and 16 seconds delay.
+static constexpr int s_maximumAttempts = 5;
+static constexpr int s_retryDelay = 1000; // ms
+
+HistoryExporter::HistoryExporter(Connector *connector, const QStringList &serialNumbers, BufferedWriter *writer, QObject *parent)
+    : QObject(parent)
+    , m_connector(connector)
+    , m_serialNumbers(serialNumbers)
+    , m_writer(writer)
+{
+}
+
+HistoryExporter::~HistoryExporter() = default;
+
+void HistoryExporter::setDateRange(const QDate &from, const QDate &to)
+{
+    m_from = from;
+    m_to = to;
+}
+
+void HistoryExporter::setFormat(Format format)
+{
+    m_format = format;
+}
+
+void HistoryExporter::setParallelRequests(int parallelRequests)
+{
+    m_parallelRequests = std::max(1, parallelRequests);
+}
+
+void HistoryExporter::setStateFilePath(const QString &stateFilePath)
+{
+    m_stateFilePath = stateFilePath;
+}
+
+void HistoryExporter::setWriteHeader(bool writeHeader)
+{
+    m_writeHeader = writeHeader;
+}
+
+QDate HistoryExporter::resumeDate() const
+{
+    if (m_stateFilePath.isEmpty()) {
+        return m_from;
+    }
+
+    QFile stateFile(m_stateFilePath);
+    if (!stateFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return m_from;
+    }
+
+    const QDate lastExportedDate = QDate::fromString(QString::fromUtf8(stateFile.readAll().trimmed()), Qt::ISODate);
+    if (!lastExportedDate.isValid()) {
+        return m_from;
+    }
+
+    return std::max(m_from, lastExportedDate.addDays(1));
+}
+
+int HistoryExporter::jobCount() const
+{
+    if (!m_from.isValid() || !m_to.isValid() || m_from > m_to) {
+        return 0;
+    }
+    return static_cast<int>(m_from.daysTo(m_to) + 1) * m_serialNumbers.count();
+}
+
+QDate HistoryExporter::jobDate(int job) const
+{
+    return m_from.addDays(job / m_serialNumbers.count());
+}
+
+QString HistoryExporter::jobSerialNumber(int job) const
+{
+    return m_serialNumbers.at(job % m_serialNumbers.count());
+}
+
+void HistoryExporter::start()
+{
+    m_from = resumeDate();
+
+    if (m_writeHeader) {
+        writeHeader();
+    }
+
+    if (jobCount() == 0) {
+        std::cerr << "Nothing to export" << std::endl;
+        m_writer->flush();
+        Q_EMIT finished(m_writer->ok());
+        return;
+    }
+
+    std::cerr << "Exporting " << m_from.daysTo(m_to) + 1 << " day(s) starting " << qPrintable(m_from.toString(Qt::ISODate)) << std::endl;
+
+    dispatch();
+}
+
+void HistoryExporter::dispatch()
+{
+    // Don't run too far ahead of what has been written, so memory usage stays constant.
+    const int window = m_nextWrite + 2 * m_parallelRequests;
+
+    while (!m_failed && m_inFlight < m_parallelRequests && m_nextJob < jobCount() && m_nextJob < window) {
+        ++m_inFlight;
+        fetch(m_nextJob, 0);
+        ++m_nextJob;
+    }
+}
+
+void HistoryExporter::fetch(int job, int attempt)
+{
+    auto *request = new ApiRequest(m_connector, ApiRequest::EndPoint::OneDayPowerBySn, this);
+    request->setSysSn(jobSerialNumber(job));
+    request->setQueryDate(jobDate(job));
+
+    connect(request, &ApiRequest::errorOccurred, this, [this, request, job, attempt] {
+        const ErrorCode error = request->error();
+
+        // Days before the system was installed.
+        if (error == ErrorCode::DataDoesNotExist) {
+            finishJob(job, QJsonArray());
+            return;
+        }
+
+        const bool transient = static_cast<int>(error) < 1000 || error == ErrorCode::TooManyRequests || error == ErrorCode::SystemOffline;
+        if (transient && attempt + 1 < s_maximumAttempts) {
+            QTimer::singleShot(s_retryDelay << attempt, this, [this, job, attempt] {
+                fetch(job, attempt + 1);
+            });
+            return;
+        }
+
+        fail(QStringLiteral("Failed to fetch %1: %2").arg(jobDate(job).toString(Qt::ISODate), request->errorString()));
+    });
+
+    connect(request, &ApiRequest::result, this, [this, request, job] {
+        finishJob(job, request->data().toArray());
+    });
+
+    if (!request->send()) {
+        fail(QStringLiteral("Failed to send request"));
+    }
+}
+
+void HistoryExporter::finishJob(int job, const QJsonArray &entries)
+{
+    if (m_failed) {
+        return;
+    }
+
+    --m_inFlight;
+    m_results.insert(job, entries);
+
+    while (m_results.contains(m_nextWrite)) {
+        writeEntries(jobSerialNumber(m_nextWrite), m_results.take(m_nextWrite));
+        ++m_nextWrite;
+
+        // Day completed for all systems.
+        if (m_nextWrite % m_serialNumbers.count() == 0) {
+            if (!m_writer->flush()) {
+                fail(QStringLiteral("Failed to write output"));
+                return;
+            }
+            saveState(jobDate(m_nextWrite - 1));
+        }
+    }
+
+    if (m_nextWrite == jobCount()) {
+        Q_EMIT finished(true);
+        return;
+    }
+
+    dispatch();
+}
+
+void HistoryExporter::fail(const QString &errorString)
+{
+    if (m_failed) {
+        return;
+    }
+    m_failed = true;
+
+    std::cerr << qPrintable(errorString) << std::endl;
+    if (!m_stateFilePath.isEmpty()) {
+        std::cerr << "Run the export again to resume it" << std::endl;
+    }
+
+    // Days already completed have been flushed, don't write partial ones.
+    Q_EMIT finished(false);
+}
+
+void HistoryExporter::writeHeader()
+{
+    if (m_format == Format::Csv) {
+        *m_writer << "serialNumber,uploadTime,photovoltaic,load,gridFeed,gridCharge,batterySoc\n";
+    }
+}
+
+void HistoryExporter::writeEntries(const QString &serialNumber, const QJsonArray &entries)
+{
+    QVector<QJsonObject> sortedEntries;
+    sortedEntries.reserve(entries.count());
+    for (const QJsonValue &entry : entries) {
+        sortedEntries.append(entry.toObject());
+    }
+
+    const QString uploadTimeKey = QStringLiteral("uploadTime");
+    // The time is ISO formatted, so sorting the strings is sufficient.
+    std::sort(sortedEntries.begin(), sortedEntries.end(), [&uploadTimeKey](const QJsonObject &a, const QJsonObject &b) {
+        return a.value(uploadTimeKey).toString() < b.value(uploadTimeKey).toString();
+    });
+
+    const QByteArray serialNumberUtf8 = serialNumber.toUtf8();
+
+    for (const QJsonObject &entry : std::as_const(sortedEntries)) {
+        const QString uploadTime = entry.value(uploadTimeKey).toString();
+        const int photovoltaic = entry.value(QStringLiteral("ppv")).toInt();
+        const int load = entry.value(QStringLiteral("load")).toInt();
+        const int gridFeed = entry.value(QStringLiteral("feedIn")).toInt();
+        const int gridCharge = entry.value(QStringLiteral("gridCharge")).toInt();
+        const double batterySoc = entry.value(QStringLiteral("cbat")).toDouble();
+
+        switch (m_format) {
+        case Format::Csv:
+            *m_writer << serialNumberUtf8 << ',' << uploadTime << ',' << photovoltaic << ',' << load << ',' << gridFeed << ',' << gridCharge << ','
+                      << batterySoc << '\n';
+            break;
+
+        case Format::NdJson:
+            *m_writer << QJsonDocument(entry).toJson(QJsonDocument::Compact) << '\n';
+            break;
+
+        case Format::InfluxLineProtocol: {
+            const QDateTime time = QDateTime::fromString(uploadTime, Qt::ISODate);
+            if (!time.isValid()) {
+                continue;
+            }
+
+            *m_writer << "qalphacloud,serialNumber=" << serialNumberUtf8 << " photovoltaic=" << photovoltaic << "i,load=" << load << "i,gridFeed=" << gridFeed
+                      << "i,gridCharge=" << gridCharge << "i,batterySoc=" << batterySoc << ' ' << time.toMSecsSinceEpoch() * 1000000 << '\n';
+            break;
+        }
+        }
+    }
+}
+
+void HistoryExporter::saveState(const QDate &date)
+{
+    if (m_stateFilePath.isEmpty()) {
+        return;
+    }
+
+    QSaveFile stateFile(m_stateFilePath);
+    if (!stateFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        std::cerr << "Failed to open state file " << qPrintable(m_stateFilePath) << ": " << qPrintable(stateFile.errorString()) << std::endl;
+        return;
+    }
+
+    stateFile.write(date.toString(Qt::ISODate).toUtf8());
+    stateFile.write("\n");
+    stateFile.commit();
+}
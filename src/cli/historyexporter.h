@@ -0,0 +1,94 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <QDate>
+#include <QHash>
+#include <QJsonArray>
+#include <QObject>
+#include <QStringList>
+
+#include <QAlphaCloud/QAlphaCloud>
+
+namespace QAlphaCloud
+{
+class Connector;
+}
+
+class BufferedWriter;
+
+/**
+ * Exports the power history of several storage systems over a date range.
+ *
+ * Days are fetched concurrently but written strictly in date order. Only a
+ * small window of days is kept in memory regardless of the length of the range.
+ *
+ * When a state file is given, the last completely exported day is recorded
+ * in it, and a subsequent export continues after that day.
+ */
+class HistoryExporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class Format {
+        Csv,
+        NdJson,
+        InfluxLineProtocol,
+    };
+
+    HistoryExporter(QAlphaCloud::Connector *connector, const QStringList &serialNumbers, BufferedWriter *writer, QObject *parent = nullptr);
+    ~HistoryExporter() override;
+
+    void setDateRange(const QDate &from, const QDate &to);
+    void setFormat(Format format);
+    void setParallelRequests(int parallelRequests);
+    void setStateFilePath(const QString &stateFilePath);
+
+    // Whether the output should start with a header, depends on the format.
+    void setWriteHeader(bool writeHeader);
+
+    // Returns the first day that will be exported, considering the state file.
+    QDate resumeDate() const;
+
+    void start();
+
+Q_SIGNALS:
+    void finished(bool success);
+
+private:
+    int jobCount() const;
+    QDate jobDate(int job) const;
+    QString jobSerialNumber(int job) const;
+
+    void dispatch();
+    void fetch(int job, int attempt);
+    void finishJob(int job, const QJsonArray &entries);
+    void fail(const QString &errorString);
+
+    void writeHeader();
+    void writeEntries(const QString &serialNumber, const QJsonArray &entries);
+    void saveState(const QDate &date);
+
+    QAlphaCloud::Connector *m_connector;
+    QStringList m_serialNumbers;
+    BufferedWriter *m_writer;
+
+    QDate m_from;
+    QDate m_to;
+    Format m_format = Format::Csv;
+    int m_parallelRequests = 4;
+    QString m_stateFilePath;
+    bool m_writeHeader = true;
+
+    int m_nextJob = 0;
+    int m_nextWrite = 0;
+    int m_inFlight = 0;
+    bool m_failed = false;
+
+    // Finished days waiting for earlier ones to be written.
+    QHash<int, QJsonArray> m_results;
+};
@@ -7,6 +7,7 @@
 #include <QCoreApplication>
 #include <QDate>
 #include <QEventLoop>
+#include <QFile>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
@@ -18,6 +19,8 @@
 
 #include <iostream>
 
+#include <QAlphaCloud/AdaptivePoller>
+#include <QAlphaCloud/ApiRequest>
 #include <QAlphaCloud/Configuration>
 #include <QAlphaCloud/Connector>
 #include <QAlphaCloud/LastPowerData>
@@ -25,7 +28,11 @@
 #include <QAlphaCloud/OneDayPowerModel>
 #include <QAlphaCloud/StorageSystemsModel>
 
+#include "benchmark.h"
+#include "bufferedwriter.h"
 #include "config-alphacloud.h"
+#include "follower.h"
+#include "historyexporter.h"
 #include "qalphacloud_version.h"
 
 static bool g_jsonOutput = false;
@@ -162,13 +169,13 @@ void showLastPowerData(Connector *connector, const QString &serialNumber)
     });
 
     if (g_updateInterval > 0) {
-        auto *timer = new QTimer();
-        timer->setInterval(g_updateInterval);
-        QObject::connect(timer, &QTimer::timeout, data, &LastPowerData::reload);
-        timer->start();
+        // Poll in sync with when the cloud actually has new data.
+        auto *poller = new AdaptivePoller(data, data);
+        poller->setInterval(g_updateInterval);
+        poller->start();
+    } else {
+        data->reload();
     }
-
-    data->reload();
 }
 
 void showEnergy(Connector *connector, const QString &serialNumber, const QDate &date)
@@ -244,13 +251,185 @@ void showHistory(Connector *connector, const QString &serialNumber, const QDate
     });
 
     if (g_updateInterval > 0) {
-        auto *timer = new QTimer();
-        timer->setInterval(g_updateInterval);
-        QObject::connect(timer, &QTimer::timeout, model, &OneDayPowerModel::reload);
-        timer->start();
+        auto *poller = new AdaptivePoller(model, model);
+        poller->setInterval(g_updateInterval);
+        poller->start();
+    } else {
+        model->reload();
+    }
+}
+
+bool exportHistory(Connector *connector,
+                   const QStringList &serialNumbers,
+                   const QDate &from,
+                   const QDate &to,
+                   HistoryExporter::Format format,
+                   const QString &outputPath,
+                   const QString &statePath,
+                   int parallelRequests)
+{
+    auto *output = new QFile(qApp);
+
+    bool ok = false;
+    if (outputPath.isEmpty()) {
+        // BufferedWriter does the buffering.
+        ok = output->open(stdout, QIODevice::WriteOnly | QIODevice::Unbuffered);
+    } else {
+        output->setFileName(outputPath);
+        // Resuming continues where the previous export left off.
+        ok = output->open(QIODevice::WriteOnly | QIODevice::Unbuffered | (statePath.isEmpty() ? QIODevice::Truncate : QIODevice::Append));
+    }
+
+    if (!ok) {
+        cerr << "Failed to open output: " << qPrintable(output->errorString()) << endl;
+        return false;
+    }
+
+    auto *writer = new BufferedWriter(output);
+
+    auto *exporter = new HistoryExporter(connector, serialNumbers, writer, qApp);
+    exporter->setDateRange(from, to);
+    exporter->setFormat(format);
+    exporter->setParallelRequests(parallelRequests);
+    exporter->setStateFilePath(statePath);
+    // Don't repeat the header in the middle of the file when resuming.
+    exporter->setWriteHeader(outputPath.isEmpty() ? exporter->resumeDate() == from : output->size() == 0);
+
+    QObject::connect(exporter, &HistoryExporter::finished, [output, writer](bool success) {
+        success = writer->flush() && success;
+        delete writer;
+        output->close();
+
+        QCoreApplication::exit(success ? 0 : 1);
+    });
+
+    // Start once the event loop is running.
+    QTimer::singleShot(0, exporter, &HistoryExporter::start);
+    return true;
+}
+
+bool followEndpoints(Connector *connector, const QStringList &endpoints, const QStringList &serialNumbers, const QDate &date)
+{
+    auto *output = new QFile(qApp);
+    // BufferedWriter does the buffering.
+    if (!output->open(stdout, QIODevice::WriteOnly | QIODevice::Unbuffered)) {
+        cerr << "Failed to open output: " << qPrintable(output->errorString()) << endl;
+        return false;
+    }
+
+    auto *writer = new BufferedWriter(output);
+
+    auto *follower = new Follower(connector, writer, qApp);
+    follower->setDate(date);
+    follower->setInterval(g_updateInterval);
+
+    for (const QString &endpoint : endpoints) {
+        if (endpoint.compare(QLatin1String("essList"), Qt::CaseInsensitive) == 0
+            || endpoint.compare(QLatin1String("storagesystems"), Qt::CaseInsensitive) == 0) {
+            follower->addTarget(QStringLiteral("storageSystems"), ApiRequest::EndPoint::EssList, QString(), false /*dated*/);
+            continue;
+        }
+
+        QString name;
+        QString apiEndPoint;
+        bool dated = false;
+
+        if (endpoint.compare(QLatin1String("lastPowerData"), Qt::CaseInsensitive) == 0 || endpoint.compare(QLatin1String("live"), Qt::CaseInsensitive) == 0) {
+            name = QStringLiteral("live");
+            apiEndPoint = ApiRequest::EndPoint::LastPowerData;
+        } else if (endpoint.compare(QLatin1String("oneDateEnergyBySn"), Qt::CaseInsensitive) == 0
+                   || endpoint.compare(QLatin1String("oneDateEnergy"), Qt::CaseInsensitive) == 0
+                   || endpoint.compare(QLatin1String("energy"), Qt::CaseInsensitive) == 0) {
+            name = QStringLiteral("energy");
+            apiEndPoint = ApiRequest::EndPoint::OneDateEnergyBySn;
+            dated = true;
+        } else if (endpoint.compare(QLatin1String("oneDayPowerBySn"), Qt::CaseInsensitive) == 0
+                   || endpoint.compare(QLatin1String("oneDayPower"), Qt::CaseInsensitive) == 0
+                   || endpoint.compare(QLatin1String("history"), Qt::CaseInsensitive) == 0) {
+            name = QStringLiteral("history");
+            apiEndPoint = ApiRequest::EndPoint::OneDayPowerBySn;
+            dated = true;
+        } else {
+            cerr << "Unknown endpoint provided: " << qPrintable(endpoint) << endl;
+            return false;
+        }
+
+        if (serialNumbers.isEmpty()) {
+            cerr << "No serial number provided" << endl;
+            return false;
+        }
+
+        for (const QString &serialNumber : serialNumbers) {
+            follower->addTarget(name, apiEndPoint, serialNumber, dated);
+        }
     }
 
-    model->reload();
+    QObject::connect(follower, &Follower::finished, [output, writer](bool success) {
+        delete writer;
+        output->close();
+
+        QCoreApplication::exit(success ? 0 : 1);
+    });
+
+    // Start once the event loop is running.
+    QTimer::singleShot(0, follower, &Follower::start);
+    return true;
+}
+
+bool runBenchmark(Connector *connector, const QStringList &mix, const QStringList &serialNumbers, const QDate &from, const QDate &to, int concurrency, int duration, int count)
+{
+    auto *benchmark = new Benchmark(connector, qApp);
+    benchmark->setConcurrency(concurrency);
+    benchmark->setDuration(duration);
+    benchmark->setMaximumRequests(count);
+    benchmark->setJsonOutput(g_jsonOutput);
+
+    for (const QString &entry : mix) {
+        if (entry.compare(QLatin1String("essList"), Qt::CaseInsensitive) == 0 || entry.compare(QLatin1String("storagesystems"), Qt::CaseInsensitive) == 0) {
+            benchmark->addRequest(ApiRequest::EndPoint::EssList, QString(), QDate());
+            continue;
+        }
+
+        QString apiEndPoint;
+        bool dated = false;
+
+        if (entry.compare(QLatin1String("lastPowerData"), Qt::CaseInsensitive) == 0 || entry.compare(QLatin1String("live"), Qt::CaseInsensitive) == 0) {
+            apiEndPoint = ApiRequest::EndPoint::LastPowerData;
+        } else if (entry.compare(QLatin1String("oneDateEnergy"), Qt::CaseInsensitive) == 0 || entry.compare(QLatin1String("energy"), Qt::CaseInsensitive) == 0) {
+            apiEndPoint = ApiRequest::EndPoint::OneDateEnergyBySn;
+            dated = true;
+        } else if (entry.compare(QLatin1String("oneDayPower"), Qt::CaseInsensitive) == 0 || entry.compare(QLatin1String("history"), Qt::CaseInsensitive) == 0) {
+            apiEndPoint = ApiRequest::EndPoint::OneDayPowerBySn;
+            dated = true;
+        } else {
+            cerr << "Unknown endpoint in request mix: " << qPrintable(entry) << endl;
+            return false;
+        }
+
+        if (serialNumbers.isEmpty()) {
+            cerr << "No serial number provided" << endl;
+            return false;
+        }
+
+        for (const QString &serialNumber : serialNumbers) {
+            if (!dated) {
+                benchmark->addRequest(apiEndPoint, serialNumber, QDate());
+                continue;
+            }
+
+            for (QDate date = from; date <= to; date = date.addDays(1)) {
+                benchmark->addRequest(apiEndPoint, serialNumber, date);
+            }
+        }
+    }
+
+    QObject::connect(benchmark, &Benchmark::finished, [](bool success) {
+        QCoreApplication::exit(success ? 0 : 1);
+    });
+
+    // Start once the event loop is running.
+    QTimer::singleShot(0, benchmark, &Benchmark::start);
+    return true;
 }
 
 QString getPrimarySerial(Connector *connector)
@@ -299,10 +478,41 @@ int main(int argc, char **argv)
     // "-w" use the default or allow "-w 1000")
     QCommandLineOption followOpt({QStringLiteral("w"), QStringLiteral("follow")}, QStringLiteral("Update periodically"));
     parser.addOption(followOpt);
+    QCommandLineOption intervalOpt(QStringLiteral("interval"), QStringLiteral("Update interval in milliseconds, implies --follow"), QStringLiteral("ms"));
+    parser.addOption(intervalOpt);
+    QCommandLineOption ndjsonOpt(QStringLiteral("ndjson"),
+                                 QStringLiteral("Output one compact JSON record per line, only when data changed. "
+                                                "Multiple endpoints and serial numbers can be given."));
+    parser.addOption(ndjsonOpt);
+
+    QCommandLineOption fromOpt(QStringLiteral("from"), QStringLiteral("First date to export"), QStringLiteral("date"));
+    parser.addOption(fromOpt);
+    QCommandLineOption toOpt(QStringLiteral("to"), QStringLiteral("Last date to export"), QStringLiteral("date"));
+    parser.addOption(toOpt);
+    QCommandLineOption formatOpt(QStringLiteral("format"), QStringLiteral("Export format (csv, ndjson, influx)"), QStringLiteral("format"), QStringLiteral("csv"));
+    parser.addOption(formatOpt);
+    QCommandLineOption outputOpt({QStringLiteral("o"), QStringLiteral("output")}, QStringLiteral("Export to file instead of stdout"), QStringLiteral("file"));
+    parser.addOption(outputOpt);
+    QCommandLineOption stateOpt(QStringLiteral("state"),
+                                QStringLiteral("Remember the last exported day in this file and resume from there"),
+                                QStringLiteral("file"));
+    parser.addOption(stateOpt);
+    QCommandLineOption parallelOpt(QStringLiteral("parallel"), QStringLiteral("Number of requests to send at once"), QStringLiteral("count"), QStringLiteral("4"));
+    parser.addOption(parallelOpt);
+
+    QCommandLineOption durationOpt(QStringLiteral("duration"), QStringLiteral("Benchmark duration in seconds"), QStringLiteral("seconds"), QStringLiteral("10"));
+    parser.addOption(durationOpt);
+    QCommandLineOption countOpt(QStringLiteral("count"), QStringLiteral("Stop the benchmark after this many requests"), QStringLiteral("count"));
+    parser.addOption(countOpt);
+    QCommandLineOption mixOpt(QStringLiteral("mix"),
+                              QStringLiteral("Comma-separated list of endpoints to benchmark"),
+                              QStringLiteral("endpoints"),
+                              QStringLiteral("live,energy,history,essList"));
+    parser.addOption(mixOpt);
 
     parser.addPositionalArgument(QStringLiteral("endpoint"),
                                  QStringLiteral("The API endpoint to talk to (essList/storageSystems, "
-                                                "lastPowerData/live, oneDateEnergy/energy, oneDayPower/history)"));
+                                                "lastPowerData/live, oneDateEnergy/energy, oneDayPower/history, export, bench)"));
 
     parser.addHelpOption();
     parser.addVersionOption();
@@ -348,8 +558,15 @@ int main(int argc, char **argv)
         cerr << "No API secret provided" << endl;
     }
 
-    if (parser.isSet(followOpt)) {
-        g_updateInterval = 10000; // TODO allow specifying.
+    if (parser.isSet(intervalOpt)) {
+        bool ok = false;
+        g_updateInterval = parser.value(intervalOpt).toInt(&ok);
+        if (!ok || g_updateInterval <= 0) {
+            cerr << "Invalid update interval provided" << endl;
+            return 1;
+        }
+    } else if (parser.isSet(followOpt)) {
+        g_updateInterval = 10000;
     }
 
     if (!apiUrl.isEmpty()) {
@@ -366,11 +583,16 @@ int main(int argc, char **argv)
         parser.showHelp(1);
     }
 
-    if (parser.positionalArguments().count() != 1) {
+    if (parser.positionalArguments().isEmpty()) {
         cerr << "No endpoint provided" << endl;
         parser.showHelp(1);
     }
 
+    if (parser.positionalArguments().count() > 1 && !parser.isSet(ndjsonOpt)) {
+        cerr << "Multiple endpoints can only be used with --ndjson" << endl;
+        parser.showHelp(1);
+    }
+
     const QString endpoint = parser.positionalArguments().first();
 
     QNetworkAccessManager manager;
@@ -383,7 +605,24 @@ int main(int argc, char **argv)
 
     cerr << "  API URL: " << qPrintable(config.apiUrl().toDisplayString()) << endl << endl;
 
-    if (endpoint.compare(QLatin1String("essList"), Qt::CaseInsensitive) == 0 || endpoint.compare(QLatin1String("storagesystems"), Qt::CaseInsensitive) == 0) {
+    if (parser.isSet(ndjsonOpt)) {
+        QStringList serialNumbers = parser.values(serialOpt);
+        if (serialNumbers.isEmpty()) {
+            serialNumber = getPrimarySerial(&connector);
+            if (!serialNumber.isEmpty()) {
+                serialNumbers.append(serialNumber);
+            }
+        }
+
+        // Only use the date when explicitly provided, otherwise follow the current day.
+        const QDate followDate = QDate::fromString(parser.value(dateOpt), Qt::ISODate);
+
+        if (!followEndpoints(&connector, parser.positionalArguments(), serialNumbers, followDate)) {
+            return 1;
+        }
+
+    } else if (endpoint.compare(QLatin1String("essList"), Qt::CaseInsensitive) == 0
+               || endpoint.compare(QLatin1String("storagesystems"), Qt::CaseInsensitive) == 0) {
         cerr << "List storage systems:" << endl;
         listStorageSystems(&connector);
 
@@ -445,6 +684,120 @@ int main(int argc, char **argv)
         cerr << "Date: " << qPrintable(date.toString(Qt::ISODate)) << endl;
         showHistory(&connector, serialNumber, date);
 
+    } else if (endpoint.compare(QLatin1String("export"), Qt::CaseInsensitive) == 0) {
+        cerr << "Export history:" << endl;
+
+        // Nobody else is interested in years of history, don't have the daemon cache it.
+        connector.setUseDaemon(false);
+
+        // Serial number option can be given multiple times.
+        QStringList serialNumbers = parser.values(serialOpt);
+        if (serialNumbers.isEmpty()) {
+            serialNumber = getPrimarySerial(&connector);
+            if (!serialNumber.isEmpty()) {
+                serialNumbers.append(serialNumber);
+            }
+        }
+
+        if (serialNumbers.isEmpty()) {
+            cerr << "No serial number provided" << endl;
+            return 1;
+        }
+
+        const QDate from = QDate::fromString(parser.value(fromOpt), Qt::ISODate);
+        QDate to = QDate::fromString(parser.value(toOpt), Qt::ISODate);
+        if (!to.isValid()) {
+            to = QDate::currentDate();
+        }
+
+        if (!from.isValid() || from > to) {
+            cerr << "Invalid date range provided" << endl;
+            return 1;
+        }
+
+        HistoryExporter::Format format = HistoryExporter::Format::Csv;
+        const QString formatName = parser.value(formatOpt);
+        if (formatName.compare(QLatin1String("ndjson"), Qt::CaseInsensitive) == 0) {
+            format = HistoryExporter::Format::NdJson;
+        } else if (formatName.compare(QLatin1String("influx"), Qt::CaseInsensitive) == 0) {
+            format = HistoryExporter::Format::InfluxLineProtocol;
+        } else if (formatName.compare(QLatin1String("csv"), Qt::CaseInsensitive) != 0) {
+            cerr << "Unknown export format provided: " << qPrintable(formatName) << endl;
+            return 1;
+        }
+
+#if !PRESENTATION_BUILD
+        cerr << "Serial number(s): " << qPrintable(serialNumbers.join(QLatin1String(", "))) << endl;
+#endif
+        cerr << "Dates: " << qPrintable(from.toString(Qt::ISODate)) << " - " << qPrintable(to.toString(Qt::ISODate)) << endl;
+
+        if (!exportHistory(&connector,
+                           serialNumbers,
+                           from,
+                           to,
+                           format,
+                           parser.value(outputOpt),
+                           parser.value(stateOpt),
+                           parser.value(parallelOpt).toInt())) {
+            return 1;
+        }
+
+    } else if (endpoint.compare(QLatin1String("bench"), Qt::CaseInsensitive) == 0) {
+        cerr << "Benchmark:" << endl;
+
+        // Measure the API, not the daemon's cache.
+        connector.setUseDaemon(false);
+
+        QStringList serialNumbers = parser.values(serialOpt);
+        if (serialNumbers.isEmpty()) {
+            serialNumber = getPrimarySerial(&connector);
+            if (!serialNumber.isEmpty()) {
+                serialNumbers.append(serialNumber);
+            }
+        }
+
+        // Spread dated requests over a range of days, if given, so it isn't just hitting a cache.
+        QDate from = QDate::fromString(parser.value(fromOpt), Qt::ISODate);
+        QDate to = QDate::fromString(parser.value(toOpt), Qt::ISODate);
+        if (!from.isValid()) {
+            from = date;
+        }
+        if (!to.isValid()) {
+            to = from;
+        }
+
+        if (from > to) {
+            cerr << "Invalid date range provided" << endl;
+            return 1;
+        }
+
+        bool ok = false;
+        const int duration = parser.value(durationOpt).toInt(&ok);
+        if (!ok || duration <= 0) {
+            cerr << "Invalid duration provided" << endl;
+            return 1;
+        }
+
+        int count = 0;
+        if (parser.isSet(countOpt)) {
+            count = parser.value(countOpt).toInt(&ok);
+            if (!ok || count <= 0) {
+                cerr << "Invalid request count provided" << endl;
+                return 1;
+            }
+        }
+
+        if (!runBenchmark(&connector,
+                          parser.value(mixOpt).split(QLatin1Char(','), Qt::SkipEmptyParts),
+                          serialNumbers,
+                          from,
+                          to,
+                          parser.value(parallelOpt).toInt(),
+                          duration * 1000,
+                          count)) {
+            return 1;
+        }
+
     } else {
         cerr << "Unknown endpoint provided: " << qPrintable(endpoint) << endl;
         parser.showHelp(1);
@@ -0,0 +1,168 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "dataservice.h"
+
+#include <QDBusConnection>
+#include <QDBusError>
+#include <QDate>
+#include <QDateTime>
+#include <QUrlQuery>
+
+#include <utility>
+
+#include <QAlphaCloud/ApiRequest>
+#include <QAlphaCloud/Configuration>
+#include <QAlphaCloud/Connector>
+
+#include "daemonprotocol_p.h"
+
+using namespace QAlphaCloud;
+
+// The cloud updates live data roughly every 10 seconds.
+static constexpr qint64 s_liveTimeToLive = 10 * 1000;
+// Today's data grows throughout the day.
+static constexpr qint64 s_todayTimeToLive = 60 * 1000;
+// Anything else (past days, list of systems, configuration) rarely changes.
+static constexpr qint64 s_staticTimeToLive = 10 * 60 * 1000;
+// Entries nobody asked for in a while are dropped.
+static constexpr qint64 s_unusedTimeout = 60 * 60 * 1000;
+
+DataService::DataService(Connector *connector, QObject *parent)
+    : QObject(parent)
+    , m_connector(connector)
+{
+    m_expiryTimer.setInterval(10 * 60 * 1000);
+    m_expiryTimer.setTimerType(Qt::VeryCoarseTimer);
+    connect(&m_expiryTimer, &QTimer::timeout, this, &DataService::expireEntries);
+    m_expiryTimer.start();
+}
+
+DataService::~DataService() = default;
+
+qint64 DataService::timeToLive(const Entry &entry)
+{
+    if (entry.endPoint == ApiRequest::EndPoint::LastPowerData) {
+        return s_liveTimeToLive;
+    }
+
+    if (entry.queryDate.isEmpty() || QDate::fromString(entry.queryDate, Qt::ISODate) >= QDate::currentDate()) {
+        if (entry.endPoint == ApiRequest::EndPoint::OneDayPowerBySn || entry.endPoint == ApiRequest::EndPoint::OneDateEnergyBySn) {
+            return s_todayTimeToLive;
+        }
+    }
+
+    return s_staticTimeToLive;
+}
+
+int DataService::Fetch(const QString &appId,
+                       const QString &apiUrl,
+                       const QString &endPoint,
+                       const QString &sysSn,
+                       const QString &queryDate,
+                       const QString &query,
+                       QString &errorString,
+                       QByteArray &data)
+{
+    auto *configuration = m_connector->configuration();
+    if (appId != configuration->appId() || QUrl(apiUrl) != configuration->apiUrl()) {
+        sendErrorReply(QStringLiteral("de.broulik.qalphacloud.Error.WrongAccount"), QStringLiteral("The daemon is configured for a different account"));
+        return 0;
+    }
+
+    const QString key = endPoint + QLatin1Char('/') + sysSn + QLatin1Char('/') + queryDate + QLatin1Char('?') + query;
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    Entry &entry = m_entries[key];
+    entry.accessTime = now;
+
+    if (entry.fetchTime > 0 && now - entry.fetchTime < timeToLive(entry)) {
+        errorString.clear();
+        data = entry.data;
+        return static_cast<int>(ErrorCode::NoError);
+    }
+
+    entry.endPoint = endPoint;
+    entry.sysSn = sysSn;
+    entry.queryDate = queryDate;
+    entry.query = query;
+
+    setDelayedReply(true);
+    entry.pendingReplies.append(message());
+
+    if (!entry.request) {
+        sendRequest(key);
+    }
+
+    return 0;
+}
+
+void DataService::sendRequest(const QString &key)
+{
+    Entry &entry = m_entries[key];
+
+    auto *request = new ApiRequest(m_connector, entry.endPoint, this);
+    request->setSysSn(entry.sysSn);
+    if (!entry.queryDate.isEmpty()) {
+        request->setQueryDate(QDate::fromString(entry.queryDate, Qt::ISODate));
+    }
+    if (!entry.query.isEmpty()) {
+        request->setQuery(QUrlQuery(entry.query));
+    }
+
+    connect(request, &ApiRequest::finished, this, [this, request, key] {
+        auto it = m_entries.find(key);
+        if (it == m_entries.end()) {
+            return;
+        }
+
+        Entry &entry = *it;
+        entry.request.clear();
+
+        const QByteArray data = DaemonProtocol::encodeData(request->data());
+
+        // Errors aren't cached, the next request tries again.
+        if (request->error() == ErrorCode::NoError) {
+            const bool changed = entry.fetchTime == 0 || data != entry.data;
+
+            entry.data = data;
+            entry.fetchTime = QDateTime::currentMSecsSinceEpoch();
+
+            if (changed) {
+                Q_EMIT DataChanged(entry.endPoint, entry.sysSn, entry.queryDate, data);
+            }
+        }
+
+        const QVariantList arguments{static_cast<int>(request->error()), request->errorString(), data};
+
+        const auto pendingReplies = std::exchange(entry.pendingReplies, {});
+        for (const QDBusMessage &message : pendingReplies) {
+            QDBusConnection::sessionBus().send(message.createReply(arguments));
+        }
+    });
+
+    if (request->send()) {
+        entry.request = request;
+    } else {
+        const auto pendingReplies = std::exchange(entry.pendingReplies, {});
+        for (const QDBusMessage &message : pendingReplies) {
+            QDBusConnection::sessionBus().send(message.createErrorReply(QDBusError::Failed, QStringLiteral("Failed to send request")));
+        }
+    }
+}
+
+void DataService::expireEntries()
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (!it->request && now - it->accessTime > s_unusedTimeout) {
+            it = m_entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
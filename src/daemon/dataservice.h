@@ -0,0 +1,86 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QDBusContext>
+#include <QDBusMessage>
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QTimer>
+#include <QVector>
+
+#include <QAlphaCloud/QAlphaCloud>
+
+namespace QAlphaCloud
+{
+class ApiRequest;
+class Connector;
+} // namespace QAlphaCloud
+
+/**
+ * Serves API data to all applications in the session.
+ *
+ * Replies are cached for a time depending on how often the data can change,
+ * so no matter how many applications ask for the same data, the API is only
+ * asked once in that time. Concurrent requests for the same data are
+ * coalesced into one.
+ */
+class DataService : public QObject, protected QDBusContext
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "de.broulik.qalphacloud.Data")
+
+public:
+    explicit DataService(QAlphaCloud::Connector *connector, QObject *parent = nullptr);
+    ~DataService() override;
+
+public Q_SLOTS:
+    /**
+     * Returns the API error code, error string, and the data as JSON.
+     *
+     * Fails with a D-Bus error if the daemon is configured for a different account,
+     * in which case the caller should send the request on its own.
+     */
+    Q_SCRIPTABLE int Fetch(const QString &appId,
+                           const QString &apiUrl,
+                           const QString &endPoint,
+                           const QString &sysSn,
+                           const QString &queryDate,
+                           const QString &query,
+                           QString &errorString,
+                           QByteArray &data);
+
+Q_SIGNALS:
+    // Emitted when new data arrived that is different from what was cached.
+    Q_SCRIPTABLE void DataChanged(const QString &endPoint, const QString &sysSn, const QString &queryDate, const QByteArray &data);
+
+private:
+    struct Entry {
+        QString endPoint;
+        QString sysSn;
+        QString queryDate;
+        QString query;
+
+        QByteArray data;
+        qint64 fetchTime = 0; // ms since epoch
+        qint64 accessTime = 0; // ms since epoch
+
+        QPointer<QAlphaCloud::ApiRequest> request;
+        QVector<QDBusMessage> pendingReplies;
+    };
+
+    static qint64 timeToLive(const Entry &entry);
+
+    void sendRequest(const QString &key);
+    void expireEntries();
+
+    QAlphaCloud::Connector *m_connector;
+    QHash<QString, Entry> m_entries;
+    QTimer m_expiryTimer;
+};
@@ -0,0 +1,65 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDBusConnection>
+#include <QNetworkAccessManager>
+
+#include <iostream>
+
+#include <QAlphaCloud/Configuration>
+#include <QAlphaCloud/Connector>
+
+#include "daemonprotocol_p.h"
+#include "dataservice.h"
+#include "qalphacloud_version.h"
+
+using namespace QAlphaCloud;
+using namespace std;
+
+int main(int argc, char **argv)
+{
+    // We are the daemon, don't talk to ourself.
+    qputenv("QALPHACLOUD_NO_DAEMON", "1");
+
+    QCoreApplication app(argc, argv);
+    app.setApplicationVersion(QALPHACLOUD_VERSION_STRING);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Shares Alpha Cloud data between all applications in the session"));
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.process(app);
+
+    Configuration config;
+    if (!config.loadDefault()) {
+        cerr << "No valid API configuration found" << endl;
+        return 1;
+    }
+
+    QNetworkAccessManager manager;
+    manager.setRedirectPolicy(QNetworkRequest::NoLessSafeRedirectPolicy);
+
+    Connector connector;
+    connector.setConfiguration(&config);
+    connector.setNetworkAccessManager(&manager);
+    connector.setUseDaemon(false);
+
+    DataService service(&connector);
+
+    auto bus = QDBusConnection::sessionBus();
+    if (!bus.registerObject(DaemonProtocol::objectPath(), &service, QDBusConnection::ExportScriptableContents)) {
+        cerr << "Failed to register object on the session bus: " << qPrintable(bus.lastError().message()) << endl;
+        return 1;
+    }
+
+    if (!bus.registerService(DaemonProtocol::serviceName())) {
+        cerr << "Failed to register service, is the daemon already running? " << qPrintable(bus.lastError().message()) << endl;
+        return 1;
+    }
+
+    return app.exec();
+}
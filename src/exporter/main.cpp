@@ -0,0 +1,138 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QHostAddress>
+#include <QNetworkAccessManager>
+
+#include <iostream>
+
+#include <QAlphaCloud/Configuration>
+#include <QAlphaCloud/Connector>
+
+#include "metricscollector.h"
+#include "metricsserver.h"
+#include "qalphacloud_version.h"
+
+using namespace QAlphaCloud;
+using namespace std;
+
+// The cloud doesn't update its data more often than that anyway.
+static constexpr int s_minimumLiveInterval = 10; // s
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationVersion(QALPHACLOUD_VERSION_STRING);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Serves Prometheus metrics for Alpha Cloud storage systems"));
+
+    QCommandLineOption apiUrlOpt({QStringLiteral("u"), QStringLiteral("url")}, QStringLiteral("API URL"), QStringLiteral("apiUrl"));
+    parser.addOption(apiUrlOpt);
+    QCommandLineOption apiKeyOpt({QStringLiteral("k"), QStringLiteral("key")}, QStringLiteral("App ID"), QStringLiteral("appId"));
+    parser.addOption(apiKeyOpt);
+    QCommandLineOption apiSecretOpt({QStringLiteral("p"), QStringLiteral("secret")}, QStringLiteral("App Secret"), QStringLiteral("appSecret"));
+    parser.addOption(apiSecretOpt);
+
+    QCommandLineOption serialOpt({QStringLiteral("s"), QStringLiteral("sn")},
+                                 QStringLiteral("Serial Number, can be given multiple times. All systems are exported by default."),
+                                 QStringLiteral("serialNumber"));
+    parser.addOption(serialOpt);
+
+    QCommandLineOption listenOpt(QStringLiteral("listen"), QStringLiteral("Address to listen on"), QStringLiteral("address"), QStringLiteral("127.0.0.1"));
+    parser.addOption(listenOpt);
+    QCommandLineOption portOpt(QStringLiteral("port"), QStringLiteral("Port to listen on"), QStringLiteral("port"), QStringLiteral("9523"));
+    parser.addOption(portOpt);
+
+    QCommandLineOption intervalOpt(QStringLiteral("interval"),
+                                   QStringLiteral("How often to fetch live data in seconds, at least %1").arg(s_minimumLiveInterval),
+                                   QStringLiteral("seconds"),
+                                   QStringLiteral("30"));
+    parser.addOption(intervalOpt);
+    QCommandLineOption energyIntervalOpt(QStringLiteral("energy-interval"),
+                                         QStringLiteral("How often to fetch today's energy in seconds"),
+                                         QStringLiteral("seconds"),
+                                         QStringLiteral("300"));
+    parser.addOption(energyIntervalOpt);
+
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.process(app);
+
+    const QUrl apiUrl = QUrl(parser.value(apiUrlOpt));
+    const QString apiKey = parser.value(apiKeyOpt);
+    const QString apiSecret = parser.value(apiSecretOpt);
+
+    Configuration config;
+    config.loadDefault();
+
+    if (!apiUrl.isEmpty()) {
+        config.setApiUrl(apiUrl);
+    }
+    if (!apiKey.isEmpty()) {
+        config.setAppId(apiKey);
+    }
+    if (!apiSecret.isEmpty()) {
+        config.setAppSecret(apiSecret);
+    }
+
+    if (!config.valid()) {
+        cerr << "No valid API configuration provided" << endl;
+        parser.showHelp(1);
+    }
+
+    bool ok = false;
+    const int liveInterval = parser.value(intervalOpt).toInt(&ok);
+    if (!ok || liveInterval < s_minimumLiveInterval) {
+        cerr << "Invalid interval provided, must be at least " << s_minimumLiveInterval << " seconds" << endl;
+        return 1;
+    }
+
+    const int energyInterval = parser.value(energyIntervalOpt).toInt(&ok);
+    if (!ok || energyInterval < liveInterval) {
+        cerr << "Invalid energy interval provided, must be at least the live interval" << endl;
+        return 1;
+    }
+
+    const QHostAddress address(parser.value(listenOpt));
+    if (address.isNull()) {
+        cerr << "Invalid address provided: " << qPrintable(parser.value(listenOpt)) << endl;
+        return 1;
+    }
+
+    const int port = parser.value(portOpt).toInt(&ok);
+    if (!ok || port <= 0 || port > 65535) {
+        cerr << "Invalid port provided" << endl;
+        return 1;
+    }
+
+    QNetworkAccessManager manager;
+    manager.setRedirectPolicy(QNetworkRequest::NoLessSafeRedirectPolicy);
+
+    Connector connector;
+    connector.setConfiguration(&config);
+    connector.setNetworkAccessManager(&manager);
+    // Scrapes should reflect what the API reports, not what the daemon cached for the desktop.
+    connector.setUseDaemon(false);
+
+    MetricsCollector collector(&connector);
+    collector.setSerialNumbers(parser.values(serialOpt));
+    collector.setLiveInterval(liveInterval * 1000);
+    collector.setEnergyInterval(energyInterval * 1000);
+
+    MetricsServer server(&collector);
+    if (!server.listen(address, static_cast<quint16>(port))) {
+        cerr << "Failed to listen on " << qPrintable(address.toString()) << ":" << port << ": " << qPrintable(server.errorString()) << endl;
+        return 1;
+    }
+
+    cerr << "Serving metrics on http://" << qPrintable(address.toString()) << ":" << port << "/metrics" << endl;
+
+    collector.start();
+
+    return app.exec();
+}
@@ -0,0 +1,380 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "metricscollector.h"
+
+#include <QDateTime>
+#include <QMetaEnum>
+
+#include <algorithm>
+
+#include <QAlphaCloud/Connector>
+#include <QAlphaCloud/LastPowerData>
+#include <QAlphaCloud/OneDateEnergy>
+#include <QAlphaCloud/StorageSystemsModel>
+
+using namespace QAlphaCloud;
+
+static QByteArray escapeLabel(const QString &value)
+{
+    QByteArray escaped = value.toUtf8();
+    escaped.replace('\\', "\\\\");
+    escaped.replace('"', "\\\"");
+    escaped.replace('\n', "\\n");
+    return escaped;
+}
+
+static void writeHeader(QByteArray &out, const char *name, const char *type, const char *help)
+{
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += ' ';
+    out += type;
+    out += '\n';
+}
+
+static void writeSample(QByteArray &out, const char *name, const QByteArray &labels, double value)
+{
+    out += name;
+    if (!labels.isEmpty()) {
+        out += '{';
+        out += labels;
+        out += '}';
+    }
+    out += ' ';
+    out += QByteArray::number(value, 'g', 10);
+    out += '\n';
+}
+
+static QByteArray serialLabel(const QString &serialNumber)
+{
+    return "serial=\"" + escapeLabel(serialNumber) + '"';
+}
+
+MetricsCollector::MetricsCollector(Connector *connector, QObject *parent)
+    : QObject(parent)
+    , m_connector(connector)
+    , m_systemsModel(new StorageSystemsModel(connector, this))
+{
+    m_systemsModel->setCached(false);
+
+    connect(m_systemsModel, &StorageSystemsModel::statusChanged, this, [this](RequestStatus status) {
+        if (status == RequestStatus::Finished) {
+            updateSystems();
+        }
+        invalidate();
+    });
+
+    connect(m_connector, &Connector::requestFinished, this, &MetricsCollector::recordRequest);
+
+    m_liveTimer.setInterval(30000);
+    m_liveTimer.setTimerType(Qt::CoarseTimer);
+    connect(&m_liveTimer, &QTimer::timeout, this, &MetricsCollector::pollLive);
+
+    m_energyTimer.setInterval(300000);
+    m_energyTimer.setTimerType(Qt::CoarseTimer);
+    connect(&m_energyTimer, &QTimer::timeout, this, &MetricsCollector::pollEnergy);
+
+    m_systemsTimer.setInterval(3600000);
+    m_systemsTimer.setTimerType(Qt::VeryCoarseTimer);
+    connect(&m_systemsTimer, &QTimer::timeout, m_systemsModel, &StorageSystemsModel::reload);
+}
+
+MetricsCollector::~MetricsCollector() = default;
+
+void MetricsCollector::setSerialNumbers(const QStringList &serialNumbers)
+{
+    m_serialNumbers = serialNumbers;
+}
+
+void MetricsCollector::setLiveInterval(int interval)
+{
+    m_liveTimer.setInterval(interval);
+}
+
+void MetricsCollector::setEnergyInterval(int interval)
+{
+    m_energyTimer.setInterval(interval);
+}
+
+void MetricsCollector::setSystemsInterval(int interval)
+{
+    m_systemsTimer.setInterval(interval);
+}
+
+void MetricsCollector::start()
+{
+    m_liveTimer.start();
+    m_energyTimer.start();
+    m_systemsTimer.start();
+
+    // The systems are polled once they are known.
+    m_systemsModel->reload();
+}
+
+QByteArray MetricsCollector::snapshot()
+{
+    if (m_dirty) {
+        m_snapshot = render();
+        m_dirty = false;
+    }
+    return m_snapshot;
+}
+
+void MetricsCollector::updateSystems()
+{
+    QStringList serialNumbers;
+    for (const StorageSystem &system : m_systemsModel->storageSystems()) {
+        if (m_serialNumbers.isEmpty() || m_serialNumbers.contains(system.serialNumber)) {
+            serialNumbers.append(system.serialNumber);
+        }
+    }
+
+    m_systems.erase(std::remove_if(m_systems.begin(),
+                                   m_systems.end(),
+                                   [&serialNumbers](const std::unique_ptr<System> &system) {
+                                       return !serialNumbers.contains(system->serialNumber);
+                                   }),
+                    m_systems.end());
+
+    bool added = false;
+    for (const QString &serialNumber : std::as_const(serialNumbers)) {
+        auto it = std::find_if(m_systems.cbegin(), m_systems.cend(), [&serialNumber](const std::unique_ptr<System> &system) {
+            return system->serialNumber == serialNumber;
+        });
+        if (it != m_systems.cend()) {
+            continue;
+        }
+
+        auto system = std::make_unique<System>();
+        system->serialNumber = serialNumber;
+
+        system->live = std::make_unique<LastPowerData>(m_connector, serialNumber);
+        connect(system->live.get(), &LastPowerData::statusChanged, this, &MetricsCollector::invalidate);
+
+        system->energy = std::make_unique<OneDateEnergy>(m_connector, serialNumber, QDate::currentDate());
+        system->energy->setCached(false);
+        connect(system->energy.get(), &OneDateEnergy::statusChanged, this, &MetricsCollector::invalidate);
+
+        m_systems.push_back(std::move(system));
+        added = true;
+    }
+
+    if (added) {
+        pollLive();
+        pollEnergy();
+    }
+}
+
+void MetricsCollector::pollLive()
+{
+    for (const auto &system : m_systems) {
+        // Never pile up requests when the API is slow.
+        if (system->live->status() != RequestStatus::Loading) {
+            system->live->reload();
+        }
+    }
+}
+
+void MetricsCollector::pollEnergy()
+{
+    for (const auto &system : m_systems) {
+        if (system->energy->status() != RequestStatus::Loading) {
+            // Follow the current day.
+            system->energy->resetDate();
+            system->energy->reload();
+        }
+    }
+}
+
+void MetricsCollector::recordRequest(const QString &endPoint, ErrorCode error, qint64 elapsedTime, qint64 bytesReceived)
+{
+    RequestStats &stats = m_requestStats[endPoint];
+    ++stats.count;
+    if (error != ErrorCode::NoError) {
+        ++stats.errors[error];
+    }
+    stats.bytesReceived += bytesReceived;
+    stats.totalDuration += std::max(qint64(0), elapsedTime);
+
+    for (std::size_t i = 0; i < s_durationBuckets.size(); ++i) {
+        if (elapsedTime <= s_durationBuckets.at(i)) {
+            ++stats.buckets[i];
+        }
+    }
+
+    invalidate();
+}
+
+void MetricsCollector::invalidate()
+{
+    m_dirty = true;
+}
+
+QByteArray MetricsCollector::render() const
+{
+    QByteArray out;
+    out.reserve(m_snapshot.size() + 1024);
+
+    const auto systems = m_systemsModel->storageSystems();
+
+    writeHeader(out, "alphacloud_system_info", "gauge", "Storage system information");
+    for (const StorageSystem &system : systems) {
+        if (!m_serialNumbers.isEmpty() && !m_serialNumbers.contains(system.serialNumber)) {
+            continue;
+        }
+
+        const char *statusKey = QMetaEnum::fromType<SystemStatus>().valueToKey(static_cast<int>(system.status));
+
+        const QByteArray labels = serialLabel(system.serialNumber) + ",inverter_model=\"" + escapeLabel(system.inverterModel) + "\",battery_model=\""
+            + escapeLabel(system.batteryModel) + "\",status=\"" + QByteArray(statusKey ? statusKey : "") + '"';
+        writeSample(out, "alphacloud_system_info", labels, 1);
+    }
+
+    struct SystemMetric {
+        qreal (*value)(const StorageSystem &system);
+        const char *name;
+        const char *help;
+    };
+    static const SystemMetric systemMetrics[] = {
+        {[](const StorageSystem &system) -> qreal {
+             return system.inverterPower;
+         },
+         "alphacloud_inverter_power_watts",
+         "Gross power of the inverter"},
+        {[](const StorageSystem &system) -> qreal {
+             return system.grossBatteryCapacity;
+         },
+         "alphacloud_battery_gross_capacity_watthours",
+         "Gross battery capacity"},
+        {[](const StorageSystem &system) -> qreal {
+             return system.remainingBatteryCapacity;
+         },
+         "alphacloud_battery_remaining_capacity_watthours",
+         "Remaining battery capacity"},
+        {[](const StorageSystem &system) -> qreal {
+             return system.usableBatteryCapacity;
+         },
+         "alphacloud_battery_usable_capacity_percent",
+         "Usable battery capacity"},
+        {[](const StorageSystem &system) -> qreal {
+             return system.photovoltaicPower;
+         },
+         "alphacloud_photovoltaic_installed_power_watts",
+         "Gross power of the photovoltaic system"},
+    };
+
+    for (const SystemMetric &metric : systemMetrics) {
+        writeHeader(out, metric.name, "gauge", metric.help);
+        for (const StorageSystem &system : systems) {
+            if (!m_serialNumbers.isEmpty() && !m_serialNumbers.contains(system.serialNumber)) {
+                continue;
+            }
+            writeSample(out, metric.name, serialLabel(system.serialNumber), metric.value(system));
+        }
+    }
+
+    struct LiveMetric {
+        int (LastPowerData::*getter)() const;
+        const char *name;
+        const char *help;
+    };
+    static const LiveMetric liveMetrics[] = {
+        {&LastPowerData::photovoltaicPower, "alphacloud_photovoltaic_power_watts", "Current photovoltaic production"},
+        {&LastPowerData::currentLoad, "alphacloud_load_power_watts", "Current load"},
+        {&LastPowerData::gridPower, "alphacloud_grid_power_watts", "Current grid power, positive when consuming from the grid"},
+        {&LastPowerData::batteryPower, "alphacloud_battery_power_watts", "Current battery power"},
+    };
+
+    for (const LiveMetric &metric : liveMetrics) {
+        writeHeader(out, metric.name, "gauge", metric.help);
+        for (const auto &system : m_systems) {
+            if (system->live->valid()) {
+                writeSample(out, metric.name, serialLabel(system->serialNumber), (system->live.get()->*metric.getter)());
+            }
+        }
+    }
+
+    writeHeader(out, "alphacloud_battery_soc_percent", "gauge", "Current battery state of charge");
+    for (const auto &system : m_systems) {
+        if (system->live->valid()) {
+            writeSample(out, "alphacloud_battery_soc_percent", serialLabel(system->serialNumber), system->live->batterySoc());
+        }
+    }
+
+    struct EnergyMetric {
+        int (OneDateEnergy::*getter)() const;
+        const char *name;
+        const char *help;
+    };
+    static const EnergyMetric energyMetrics[] = {
+        {&OneDateEnergy::photovoltaic, "alphacloud_today_photovoltaic_watthours", "Photovoltaic production today"},
+        {&OneDateEnergy::totalLoad, "alphacloud_today_load_watthours", "Total load today"},
+        {&OneDateEnergy::input, "alphacloud_today_grid_input_watthours", "Energy consumed from the grid today"},
+        {&OneDateEnergy::output, "alphacloud_today_grid_output_watthours", "Energy fed into the grid today"},
+        {&OneDateEnergy::charge, "alphacloud_today_battery_charge_watthours", "Energy charged into the battery today"},
+        {&OneDateEnergy::discharge, "alphacloud_today_battery_discharge_watthours", "Energy discharged from the battery today"},
+        {&OneDateEnergy::gridCharge, "alphacloud_today_battery_grid_charge_watthours", "Energy charged into the battery from the grid today"},
+    };
+
+    for (const EnergyMetric &metric : energyMetrics) {
+        writeHeader(out, metric.name, "gauge", metric.help);
+        for (const auto &system : m_systems) {
+            if (system->energy->valid()) {
+                writeSample(out, metric.name, serialLabel(system->serialNumber), (system->energy.get()->*metric.getter)());
+            }
+        }
+    }
+
+    writeHeader(out, "alphacloud_up", "gauge", "Whether the last request for the system succeeded");
+    for (const auto &system : m_systems) {
+        writeSample(out, "alphacloud_up", serialLabel(system->serialNumber), system->live->status() == RequestStatus::Error ? 0 : 1);
+    }
+
+    // Sorted for a stable output.
+    QStringList endPoints = m_requestStats.keys();
+    endPoints.sort();
+
+    writeHeader(out, "alphacloud_api_requests_total", "counter", "API requests sent");
+    for (const QString &endPoint : std::as_const(endPoints)) {
+        writeSample(out, "alphacloud_api_requests_total", "endpoint=\"" + escapeLabel(endPoint) + '"', m_requestStats.constFind(endPoint)->count);
+    }
+
+    writeHeader(out, "alphacloud_api_request_errors_total", "counter", "API requests that failed, by error code");
+    for (const QString &endPoint : std::as_const(endPoints)) {
+        const RequestStats &stats = *m_requestStats.constFind(endPoint);
+        for (auto it = stats.errors.cbegin(), end = stats.errors.cend(); it != end; ++it) {
+            const char *key = QMetaEnum::fromType<ErrorCode>().valueToKey(static_cast<int>(it.key()));
+            const QByteArray error = key ? QByteArray(key) : QByteArray::number(static_cast<int>(it.key()));
+            writeSample(out, "alphacloud_api_request_errors_total", "endpoint=\"" + escapeLabel(endPoint) + "\",error=\"" + error + '"', it.value());
+        }
+    }
+
+    writeHeader(out, "alphacloud_api_response_bytes_total", "counter", "Bytes received from the API");
+    for (const QString &endPoint : std::as_const(endPoints)) {
+        writeSample(out, "alphacloud_api_response_bytes_total", "endpoint=\"" + escapeLabel(endPoint) + '"', m_requestStats.constFind(endPoint)->bytesReceived);
+    }
+
+    writeHeader(out, "alphacloud_api_request_duration_seconds", "histogram", "API request duration");
+    for (const QString &endPoint : std::as_const(endPoints)) {
+        const RequestStats &stats = *m_requestStats.constFind(endPoint);
+        const QByteArray endPointLabel = "endpoint=\"" + escapeLabel(endPoint) + '"';
+        for (std::size_t i = 0; i < s_durationBuckets.size(); ++i) {
+            writeSample(out,
+                        "alphacloud_api_request_duration_seconds_bucket",
+                        endPointLabel + ",le=\"" + QByteArray::number(s_durationBuckets.at(i) / 1000.0) + '"',
+                        stats.buckets.at(i));
+        }
+        writeSample(out, "alphacloud_api_request_duration_seconds_bucket", endPointLabel + ",le=\"+Inf\"", stats.count);
+        writeSample(out, "alphacloud_api_request_duration_seconds_sum", endPointLabel, stats.totalDuration / 1000.0);
+        writeSample(out, "alphacloud_api_request_duration_seconds_count", endPointLabel, stats.count);
+    }
+
+    return out;
+}
@@ -0,0 +1,98 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QMap>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include <QAlphaCloud/QAlphaCloud>
+
+namespace QAlphaCloud
+{
+class Connector;
+class LastPowerData;
+class OneDateEnergy;
+class StorageSystemsModel;
+} // namespace QAlphaCloud
+
+/**
+ * Polls the API on a fixed schedule and keeps an in-memory snapshot
+ * of the values in Prometheus text exposition format.
+ *
+ * Scraping only ever returns the snapshot, no matter how often it happens,
+ * it never causes any requests to the API.
+ */
+class MetricsCollector : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MetricsCollector(QAlphaCloud::Connector *connector, QObject *parent = nullptr);
+    ~MetricsCollector() override;
+
+    // Only export these systems, all if empty.
+    void setSerialNumbers(const QStringList &serialNumbers);
+
+    // All in milliseconds.
+    void setLiveInterval(int interval);
+    void setEnergyInterval(int interval);
+    void setSystemsInterval(int interval);
+
+    void start();
+
+    // Returns the current metrics, rendering them only if anything changed.
+    QByteArray snapshot();
+
+private:
+    struct System {
+        QString serialNumber;
+        std::unique_ptr<QAlphaCloud::LastPowerData> live;
+        std::unique_ptr<QAlphaCloud::OneDateEnergy> energy;
+    };
+
+    // Upper bounds of the request duration histogram in milliseconds.
+    static constexpr std::array<int, 8> s_durationBuckets{100, 250, 500, 1000, 2500, 5000, 10000, 30000};
+
+    struct RequestStats {
+        quint64 count = 0;
+        QMap<QAlphaCloud::ErrorCode, quint64> errors;
+        qint64 bytesReceived = 0;
+        qint64 totalDuration = 0; // ms
+        std::array<quint64, s_durationBuckets.size()> buckets{};
+    };
+
+    void updateSystems();
+    void pollLive();
+    void pollEnergy();
+    void recordRequest(const QString &endPoint, QAlphaCloud::ErrorCode error, qint64 elapsedTime, qint64 bytesReceived);
+
+    void invalidate();
+    QByteArray render() const;
+
+    QAlphaCloud::Connector *m_connector;
+    QAlphaCloud::StorageSystemsModel *m_systemsModel;
+
+    QStringList m_serialNumbers;
+    std::vector<std::unique_ptr<System>> m_systems;
+
+    QTimer m_liveTimer;
+    QTimer m_energyTimer;
+    QTimer m_systemsTimer;
+
+    QHash<QString, RequestStats> m_requestStats;
+
+    QByteArray m_snapshot;
+    bool m_dirty = true;
+};
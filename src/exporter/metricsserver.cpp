@@ -0,0 +1,117 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "metricsserver.h"
+
+#include "metricscollector.h"
+
+#include <QTcpSocket>
+#include <QTimer>
+
+// Anything larger than that isn't a scrape.
+static constexpr int s_maximumRequestSize = 8 * 1024;
+static constexpr int s_requestTimeout = 5000; // ms
+
+MetricsServer::MetricsServer(MetricsCollector *collector, QObject *parent)
+    : QObject(parent)
+    , m_collector(collector)
+{
+    connect(&m_server, &QTcpServer::newConnection, this, [this] {
+        while (QTcpSocket *socket = m_server.nextPendingConnection()) {
+            handleConnection(socket);
+        }
+    });
+}
+
+MetricsServer::~MetricsServer() = default;
+
+bool MetricsServer::listen(const QHostAddress &address, quint16 port)
+{
+    return m_server.listen(address, port);
+}
+
+QString MetricsServer::errorString() const
+{
+    return m_server.errorString();
+}
+
+void MetricsServer::handleConnection(QTcpSocket *socket)
+{
+    connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+
+    // Don't let idle clients keep connections open.
+    QTimer::singleShot(s_requestTimeout, socket, [socket] {
+        socket->abort();
+        socket->deleteLater();
+    });
+
+    connect(socket, &QTcpSocket::readyRead, this, [this, socket] {
+        if (socket->property("handled").toBool()) {
+            socket->readAll();
+            return;
+        }
+
+        // Only the request line matters, headers and body are ignored.
+        if (!socket->canReadLine()) {
+            if (socket->bytesAvailable() > s_maximumRequestSize) {
+                sendResponse(socket, QByteArrayLiteral("431 Request Header Fields Too Large"), QByteArrayLiteral("text/plain"), QByteArray(), false);
+            }
+            return;
+        }
+
+        socket->setProperty("handled", true);
+        handleRequest(socket, socket->readLine(s_maximumRequestSize).trimmed());
+    });
+}
+
+void MetricsServer::handleRequest(QTcpSocket *socket, const QByteArray &requestLine)
+{
+    const QList<QByteArray> parts = requestLine.split(' ');
+    if (parts.count() != 3 || !parts.at(2).startsWith("HTTP/")) {
+        sendResponse(socket, QByteArrayLiteral("400 Bad Request"), QByteArrayLiteral("text/plain"), QByteArrayLiteral("Bad Request\n"), true);
+        return;
+    }
+
+    const QByteArray &method = parts.at(0);
+    const bool head = method == "HEAD";
+    if (method != "GET" && !head) {
+        sendResponse(socket, QByteArrayLiteral("405 Method Not Allowed"), QByteArrayLiteral("text/plain"), QByteArrayLiteral("Method Not Allowed\n"), true);
+        return;
+    }
+
+    QByteArray path = parts.at(1);
+    const int queryIdx = path.indexOf('?');
+    if (queryIdx > -1) {
+        path.truncate(queryIdx);
+    }
+
+    if (path == "/metrics") {
+        sendResponse(socket, QByteArrayLiteral("200 OK"), QByteArrayLiteral("text/plain; version=0.0.4; charset=utf-8"), m_collector->snapshot(), !head);
+    } else if (path == "/") {
+        sendResponse(socket,
+                     QByteArrayLiteral("200 OK"),
+                     QByteArrayLiteral("text/html; charset=utf-8"),
+                     QByteArrayLiteral("<html><body><h1>QAlphaCloud Exporter</h1><a href=\"/metrics\">Metrics</a></body></html>\n"),
+                     !head);
+    } else {
+        sendResponse(socket, QByteArrayLiteral("404 Not Found"), QByteArrayLiteral("text/plain"), QByteArrayLiteral("Not Found\n"), !head);
+    }
+}
+
+void MetricsServer::sendResponse(QTcpSocket *socket, const QByteArray &status, const QByteArray &contentType, const QByteArray &body, bool includeBody)
+{
+    QByteArray header;
+    header.reserve(128);
+    header += "HTTP/1.1 " + status + "\r\n";
+    header += "Content-Type: " + contentType + "\r\n";
+    header += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+    header += "Connection: close\r\n\r\n";
+
+    socket->write(header);
+    if (includeBody) {
+        socket->write(body);
+    }
+    socket->disconnectFromHost();
+}
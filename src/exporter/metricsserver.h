@@ -0,0 +1,40 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <QHostAddress>
+#include <QObject>
+#include <QTcpServer>
+
+class MetricsCollector;
+
+class QTcpSocket;
+
+/**
+ * A minimal HTTP server that serves the collector's snapshot on /metrics.
+ *
+ * Only GET and HEAD requests are supported, every connection is
+ * closed after the response has been sent.
+ */
+class MetricsServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MetricsServer(MetricsCollector *collector, QObject *parent = nullptr);
+    ~MetricsServer() override;
+
+    bool listen(const QHostAddress &address, quint16 port);
+    QString errorString() const;
+
+private:
+    void handleConnection(QTcpSocket *socket);
+    void handleRequest(QTcpSocket *socket, const QByteArray &requestLine);
+    void sendResponse(QTcpSocket *socket, const QByteArray &status, const QByteArray &contentType, const QByteArray &body, bool includeBody);
+
+    MetricsCollector *m_collector;
+    QTcpServer m_server;
+};
@@ -16,7 +16,6 @@ import org.kde.ksysguard.formatter 1.0 as Formatter
 import org.kde.ksysguard.faces 1.0 as Faces
 
 import de.broulik.qalphacloud 1.0 as QAlphaCloud
-import de.broulik.qalphacloud.private.kcm 1.0 as KCMPrivate
 
 KCM.SimpleKCM {
     id: root
@@ -79,6 +78,8 @@ KCM.SimpleKCM {
 
     QAlphaCloud.Connector {
         id: cloudConnector
+        // Don't let a single slow reply keep the view loading.
+        hedgeRequests: true
         configuration: QAlphaCloud.Configuration {
             id: cloudConfig
         }
@@ -140,7 +141,7 @@ KCM.SimpleKCM {
         date: root.currentDate
     }
 
-    Charts.ModelSource {
+    Charts.ArraySource {
         id: batterySocSource
         readonly property color color: root.batteryGreen
         readonly property string name: qsTr("Battery %")
@@ -148,61 +149,70 @@ KCM.SimpleKCM {
         // TODO remember this in a config file.
         property bool enabled: false
 
-        model: KCMPrivate.BatterySocScaleProxyModel {
-            sourceModel: historyModel
-            max: historyChart.yRange.to
+        readonly property QtObject series: QAlphaCloud.PowerSeries {
+            model: historyModel
+            role: batterySocSource.role
+            scale: historyChart.yRange.to / 100
         }
-        roleName: "batterySoc"
+        array: series.values
     }
-    Charts.ModelSource {
+    Charts.ArraySource {
         id: currentLoadSource
         readonly property color color: root.loadBlue
         readonly property string name: qsTr("Current Load")
         readonly property int role: QAlphaCloud.OneDayPowerModel.Roles.CurrentLoad
         property bool enabled: true
 
-        model: historyModel
-        roleName: "currentLoad"
+        readonly property QtObject series: QAlphaCloud.PowerSeries {
+            model: historyModel
+            role: currentLoadSource.role
+        }
+        array: series.values
     }
-    Charts.ModelSource {
+    Charts.ArraySource {
         id: gridFeedSource
         readonly property color color: root.feedPurple
         readonly property string name: qsTr("Grid Feed")
         readonly property int role: QAlphaCloud.OneDayPowerModel.Roles.GridFeed
         property bool enabled: true
 
-        model: historyModel
-        roleName: "gridFeed"
+        readonly property QtObject series: QAlphaCloud.PowerSeries {
+            model: historyModel
+            role: gridFeedSource.role
+        }
+        array: series.values
     }
-    Charts.ModelSource {
+    Charts.ArraySource {
         id: gridChargeSource
         readonly property color color: root.gridRed
         readonly property string name: qsTr("Grid Charge")
         readonly property int role: QAlphaCloud.OneDayPowerModel.Roles.GridCharge
         property bool enabled: true
 
-        model: historyModel
-        roleName: "gridCharge"
+        readonly property QtObject series: QAlphaCloud.PowerSeries {
+            model: historyModel
+            role: gridChargeSource.role
+        }
+        array: series.values
     }
-    Charts.ModelSource {
+    Charts.ArraySource {
         id: photovoltaicEnergySource
         readonly property color color: root.solarYellow
         readonly property string name: qsTr("Photovoltaic")
         readonly property int role: QAlphaCloud.OneDayPowerModel.Roles.PhotovoltaicEnergy
         property bool enabled: true
 
-        model: historyModel
-        roleName: "photovoltaicEnergy"
+        readonly property QtObject series: QAlphaCloud.PowerSeries {
+            model: historyModel
+            role: photovoltaicEnergySource.role
+        }
+        array: series.values
     }
 
-    Timer {
-        interval: 10000
-        running: Qt.application.active
-        repeat: true
-        triggeredOnStart: true
-        onTriggered: {
-            liveData.reload();
-        }
+    QAlphaCloud.AdaptivePoller {
+        target: liveData
+        // Polls right away when the window becomes visible again.
+        running: Qt.application.active && !liveData.paused
         onRunningChanged: {
             root.isToday = Qt.binding(() => {
                 return root.isDateToday(root.currentDate);
@@ -210,18 +220,16 @@ KCM.SimpleKCM {
         }
     }
 
-    Timer {
-        // We get history model data every 5 minutes.
+    QAlphaCloud.AdaptivePoller {
+        target: historyModel
+        // We get history model data every 5 minutes, the poller figures out when exactly.
         interval: 5 * 60 * 1000
         // Not stopping on application inactive, otherwise the window
         // would have to be focussed for 10 minutes to update at all.
-        running: true
-        repeat: true
-        onTriggered: {
-            if (Qt.application.active) {
-                cumulativeData.reload();
-                historyModel.reload();
-            }
+        // Past days don't change anymore.
+        running: root.isToday && !historyModel.paused
+        onPollRequested: {
+            cumulativeData.reload();
         }
     }
 
@@ -0,0 +1,389 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "adaptivepoller.h"
+
+#include "lastpowerdata.h"
+#include "onedaypowermodel.h"
+#include "qalphacloud.h"
+#include "qalphacloud_log.h"
+
+#include <QPointer>
+#include <QTimer>
+#include <QVector>
+
+#include <algorithm>
+
+namespace QAlphaCloud
+{
+
+// How many updates to keep around for learning the period.
+static constexpr int s_maximumUpdates = 8;
+// Never poll more often than this.
+static constexpr qint64 s_minimumDelay = 500; // ms
+// After this many polls in a row that didn't see the expected update, start learning from scratch.
+static constexpr int s_maximumMissedPolls = 6;
+// Limit for doubling intervals on errors and when idle.
+static constexpr int s_maximumBackoffLevel = 6;
+
+class AdaptivePollerPrivate
+{
+public:
+    explicit AdaptivePollerPrivate(AdaptivePoller *qq);
+
+    void connectTarget();
+    void poll();
+    void reschedule();
+    void updateLearnedPeriod();
+    void setNextPollTime(const QDateTime &nextPollTime);
+
+    AdaptivePoller *const q;
+
+    QPointer<QObject> m_target;
+    bool m_running = false;
+    int m_interval = 10000;
+    int m_maximumInterval = 10 * 60 * 1000;
+
+    int m_learnedPeriod = 0;
+    QDateTime m_nextPollTime;
+
+    // Recorded update times in ms since epoch.
+    QVector<qint64> m_updates;
+
+    int m_missedPolls = 0;
+    int m_idlePolls = 0;
+    int m_errorCount = 0;
+
+    // For estimating when data without a timestamp changed.
+    qint64 m_pollTime = 0;
+    qint64 m_previousPollTime = 0;
+    bool m_changed = false;
+
+    QTimer m_timer;
+};
+
+AdaptivePollerPrivate::AdaptivePollerPrivate(AdaptivePoller *qq)
+    : q(qq)
+{
+    m_timer.setSingleShot(true);
+    // We want to hit just after the expected update.
+    m_timer.setTimerType(Qt::PreciseTimer);
+    QObject::connect(&m_timer, &QTimer::timeout, q, [this] {
+        poll();
+    });
+}
+
+void AdaptivePollerPrivate::connectTarget()
+{
+    if (auto *liveData = qobject_cast<LastPowerData *>(m_target)) {
+        QObject::connect(liveData, &LastPowerData::rawJsonChanged, q, [this] {
+            m_changed = true;
+        });
+        QObject::connect(liveData, &LastPowerData::statusChanged, q, [this, liveData](RequestStatus status) {
+            if (status == RequestStatus::Error) {
+                q->recordError();
+            } else if (status == RequestStatus::Finished) {
+                if (m_changed) {
+                    // There is no timestamp in the data, but it must have changed after the previous poll.
+                    const qint64 updateTime = m_previousPollTime > 0 ? m_previousPollTime : QDateTime::currentMSecsSinceEpoch();
+                    q->recordUpdate(QDateTime::fromMSecsSinceEpoch(updateTime));
+                } else {
+                    q->recordNoChange(liveData->photovoltaicPower() == 0);
+                }
+            }
+        });
+    } else if (auto *model = qobject_cast<OneDayPowerModel *>(m_target)) {
+        QObject::connect(model, &OneDayPowerModel::statusChanged, q, [this, model](RequestStatus status) {
+            if (status == RequestStatus::Error) {
+                q->recordError();
+            } else if (status == RequestStatus::Finished) {
+                const QDateTime uploadTime = model->toDateTime();
+                if (uploadTime.isValid() && (m_updates.isEmpty() || uploadTime.toMSecsSinceEpoch() > m_updates.constLast())) {
+                    q->recordUpdate(uploadTime);
+                } else {
+                    const int photovoltaic = model->rowCount() > 0
+                        ? model->index(model->rowCount() - 1, 0).data(static_cast<int>(OneDayPowerModel::Roles::PhotovoltaicEnergy)).toInt()
+                        : 0;
+                    q->recordNoChange(photovoltaic == 0);
+                }
+            }
+        });
+    } else if (m_target) {
+        qCWarning(QALPHACLOUD_LOG) << "AdaptivePoller cannot observe target" << m_target << "only reloading it";
+    }
+}
+
+void AdaptivePollerPrivate::poll()
+{
+    m_previousPollTime = m_pollTime;
+    m_pollTime = QDateTime::currentMSecsSinceEpoch();
+    m_changed = false;
+
+    // Should we not hear back, poll again eventually.
+    reschedule();
+
+    Q_EMIT q->pollRequested();
+
+    if (m_target) {
+        bool ok = false;
+        QMetaObject::invokeMethod(m_target, "reload", Q_RETURN_ARG(bool, ok));
+        if (!ok) {
+            q->recordError();
+        }
+    }
+}
+
+void AdaptivePollerPrivate::reschedule()
+{
+    if (!m_running) {
+        return;
+    }
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    qint64 delay = m_interval;
+
+    if (m_errorCount > 0) {
+        delay = qint64(m_interval) << std::min(m_errorCount, s_maximumBackoffLevel);
+    } else if (m_learnedPeriod > 0) {
+        const qint64 period = m_learnedPeriod;
+        // Give the cloud a moment to actually have the data.
+        const qint64 margin = std::clamp(period / 20, qint64(500), qint64(5000));
+
+        if (m_missedPolls > 0) {
+            // The update is late, check again shortly.
+            delay = std::min(margin << m_missedPolls, period);
+        } else {
+            qint64 expected = m_updates.constLast() + period;
+            if (expected + margin <= now) {
+                expected += ((now - expected - margin) / period + 1) * period;
+            }
+            delay = expected + margin - now;
+        }
+    }
+
+    if (m_idlePolls > 0) {
+        delay = std::max(delay, qint64(m_interval)) << std::min(m_idlePolls, s_maximumBackoffLevel);
+    }
+
+    delay = std::clamp(delay, s_minimumDelay, std::max(s_minimumDelay, qint64(m_maximumInterval)));
+
+    m_timer.start(static_cast<int>(delay));
+    setNextPollTime(QDateTime::fromMSecsSinceEpoch(now + delay));
+}
+
+void AdaptivePollerPrivate::updateLearnedPeriod()
+{
+    int learnedPeriod = 0;
+
+    // Need at least two intervals to tell anything.
+    if (m_updates.count() >= 3) {
+        QVector<qint64> differences;
+        differences.reserve(m_updates.count() - 1);
+        for (int i = 1; i < m_updates.count(); ++i) {
+            differences.append(m_updates.at(i) - m_updates.at(i - 1));
+        }
+
+        // Median is robust against the occasional missed or delayed update.
+        auto middle = differences.begin() + differences.count() / 2;
+        std::nth_element(differences.begin(), middle, differences.end());
+        learnedPeriod = static_cast<int>(std::clamp(*middle, s_minimumDelay, qint64(m_maximumInterval)));
+    }
+
+    if (m_learnedPeriod != learnedPeriod) {
+        m_learnedPeriod = learnedPeriod;
+        Q_EMIT q->learnedPeriodChanged(learnedPeriod);
+    }
+}
+
+void AdaptivePollerPrivate::setNextPollTime(const QDateTime &nextPollTime)
+{
+    if (m_nextPollTime != nextPollTime) {
+        m_nextPollTime = nextPollTime;
+        Q_EMIT q->nextPollTimeChanged(nextPollTime);
+    }
+}
+
+AdaptivePoller::AdaptivePoller(QObject *parent)
+    : AdaptivePoller(nullptr, parent)
+{
+}
+
+AdaptivePoller::AdaptivePoller(QObject *target, QObject *parent)
+    : QObject(parent)
+    , d(std::make_unique<AdaptivePollerPrivate>(this))
+{
+    setTarget(target);
+}
+
+AdaptivePoller::~AdaptivePoller() = default;
+
+QObject *AdaptivePoller::target() const
+{
+    return d->m_target;
+}
+
+void AdaptivePoller::setTarget(QObject *target)
+{
+    if (d->m_target == target) {
+        return;
+    }
+
+    if (d->m_target) {
+        disconnect(d->m_target, nullptr, this, nullptr);
+    }
+
+    d->m_target = target;
+    // Different target, different cadence.
+    d->m_updates.clear();
+    d->m_missedPolls = 0;
+    d->m_idlePolls = 0;
+    d->m_errorCount = 0;
+    d->m_pollTime = 0;
+    d->m_previousPollTime = 0;
+    d->updateLearnedPeriod();
+
+    d->connectTarget();
+
+    Q_EMIT targetChanged(target);
+
+    if (d->m_running) {
+        d->poll();
+    }
+}
+
+bool AdaptivePoller::running() const
+{
+    return d->m_running;
+}
+
+void AdaptivePoller::setRunning(bool running)
+{
+    if (running) {
+        start();
+    } else {
+        stop();
+    }
+}
+
+int AdaptivePoller::interval() const
+{
+    return d->m_interval;
+}
+
+void AdaptivePoller::setInterval(int interval)
+{
+    if (d->m_interval == interval) {
+        return;
+    }
+
+    d->m_interval = interval;
+    Q_EMIT intervalChanged(interval);
+}
+
+int AdaptivePoller::maximumInterval() const
+{
+    return d->m_maximumInterval;
+}
+
+void AdaptivePoller::setMaximumInterval(int maximumInterval)
+{
+    if (d->m_maximumInterval == maximumInterval) {
+        return;
+    }
+
+    d->m_maximumInterval = maximumInterval;
+    Q_EMIT maximumIntervalChanged(maximumInterval);
+}
+
+int AdaptivePoller::learnedPeriod() const
+{
+    return d->m_learnedPeriod;
+}
+
+QDateTime AdaptivePoller::nextPollTime() const
+{
+    return d->m_nextPollTime;
+}
+
+void AdaptivePoller::recordUpdate(const QDateTime &updateTime)
+{
+    if (!updateTime.isValid()) {
+        return;
+    }
+
+    const qint64 time = updateTime.toMSecsSinceEpoch();
+    if (!d->m_updates.isEmpty() && time <= d->m_updates.constLast()) {
+        return;
+    }
+
+    d->m_updates.append(time);
+    if (d->m_updates.count() > s_maximumUpdates) {
+        d->m_updates.removeFirst();
+    }
+
+    d->m_missedPolls = 0;
+    d->m_idlePolls = 0;
+    d->m_errorCount = 0;
+
+    d->updateLearnedPeriod();
+    d->reschedule();
+}
+
+void AdaptivePoller::recordNoChange(bool idle)
+{
+    d->m_errorCount = 0;
+
+    if (idle) {
+        d->m_missedPolls = 0;
+        d->m_idlePolls = std::min(d->m_idlePolls + 1, s_maximumBackoffLevel);
+    } else {
+        d->m_idlePolls = 0;
+
+        if (d->m_learnedPeriod > 0) {
+            ++d->m_missedPolls;
+
+            if (d->m_missedPolls > s_maximumMissedPolls) {
+                qCDebug(QALPHACLOUD_LOG) << "AdaptivePoller missed too many updates, learning update period again";
+                d->m_updates.remove(0, d->m_updates.count() - 1);
+                d->m_missedPolls = 0;
+                d->updateLearnedPeriod();
+            }
+        }
+    }
+
+    d->reschedule();
+}
+
+void AdaptivePoller::recordError()
+{
+    d->m_errorCount = std::min(d->m_errorCount + 1, s_maximumBackoffLevel);
+    d->reschedule();
+}
+
+void AdaptivePoller::start()
+{
+    if (d->m_running) {
+        return;
+    }
+
+    d->m_running = true;
+    Q_EMIT runningChanged(true);
+
+    d->poll();
+}
+
+void AdaptivePoller::stop()
+{
+    if (!d->m_running) {
+        return;
+    }
+
+    d->m_running = false;
+    d->m_timer.stop();
+    d->setNextPollTime(QDateTime());
+    Q_EMIT runningChanged(false);
+}
+
+} // namespace QAlphaCloud
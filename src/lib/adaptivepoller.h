@@ -0,0 +1,166 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <QDateTime>
+#include <QObject>
+
+#include <memory>
+
+#include "qalphacloud_export.h"
+
+namespace QAlphaCloud
+{
+
+class AdaptivePollerPrivate;
+
+/**
+ * @brief Polls data in sync with the cloud
+ *
+ * Rather than reloading data on a fixed interval, this learns how often and when
+ * the cloud actually updates its data and schedules the next poll just after
+ * the next update is expected. This results in fewer requests that return
+ * the same data as well as in data being more up to date.
+ *
+ * When the photovoltaic system produces no power and nothing changes, e.g. at night,
+ * polling gradually slows down.
+ *
+ * Supported targets are LastPowerData and OneDayPowerModel. For the latter the
+ * upload time of the last entry is used to learn the update cadence.
+ *
+ * Alternatively, no target can be set and updates can be fed manually
+ * using recordUpdate() in response to pollRequested().
+ */
+class QALPHACLOUD_EXPORT AdaptivePoller : public QObject
+{
+    Q_OBJECT
+
+    /**
+     * @brief The object to poll
+     *
+     * Either a LastPowerData or OneDayPowerModel instance.
+     */
+    Q_PROPERTY(QObject *target READ target WRITE setTarget NOTIFY targetChanged)
+
+    /**
+     * @brief Whether polling is active
+     *
+     * Default is false.
+     */
+    Q_PROPERTY(bool running READ running WRITE setRunning NOTIFY runningChanged)
+
+    /**
+     * @brief Poll interval in milliseconds until the update period has been learned
+     *
+     * Default is 10,000 ms.
+     */
+    Q_PROPERTY(int interval READ interval WRITE setInterval NOTIFY intervalChanged)
+    /**
+     * @brief Maximum poll interval in milliseconds when backing off
+     *
+     * Default is 600,000 ms (10 minutes).
+     */
+    Q_PROPERTY(int maximumInterval READ maximumInterval WRITE setMaximumInterval NOTIFY maximumIntervalChanged)
+
+    /**
+     * @brief The learned update period of the cloud in milliseconds
+     *
+     * This is 0 until enough updates have been observed.
+     */
+    Q_PROPERTY(int learnedPeriod READ learnedPeriod NOTIFY learnedPeriodChanged)
+
+    /**
+     * @brief When the next poll happens
+     *
+     * This is invalid when not running.
+     */
+    Q_PROPERTY(QDateTime nextPollTime READ nextPollTime NOTIFY nextPollTimeChanged)
+
+public:
+    /**
+     * @brief Creates an AdaptivePoller instance
+     * @param parent The owner
+     */
+    explicit AdaptivePoller(QObject *parent = nullptr);
+    /**
+     * @brief Creates an AdaptivePoller instance
+     * @param target The object to poll
+     * @param parent The owner
+     */
+    explicit AdaptivePoller(QObject *target, QObject *parent);
+    ~AdaptivePoller() override;
+
+    Q_REQUIRED_RESULT QObject *target() const;
+    void setTarget(QObject *target);
+    Q_SIGNAL void targetChanged(QObject *target);
+
+    Q_REQUIRED_RESULT bool running() const;
+    void setRunning(bool running);
+    Q_SIGNAL void runningChanged(bool running);
+
+    Q_REQUIRED_RESULT int interval() const;
+    void setInterval(int interval);
+    Q_SIGNAL void intervalChanged(int interval);
+
+    Q_REQUIRED_RESULT int maximumInterval() const;
+    void setMaximumInterval(int maximumInterval);
+    Q_SIGNAL void maximumIntervalChanged(int maximumInterval);
+
+    Q_REQUIRED_RESULT int learnedPeriod() const;
+    Q_SIGNAL void learnedPeriodChanged(int learnedPeriod);
+
+    Q_REQUIRED_RESULT QDateTime nextPollTime() const;
+    Q_SIGNAL void nextPollTimeChanged(const QDateTime &nextPollTime);
+
+    /**
+     * @brief Record that the cloud updated its data
+     * @param updateTime When the data was updated
+     *
+     * This is done automatically when a target is set.
+     * Times not newer than the last recorded update are ignored.
+     */
+    Q_INVOKABLE void recordUpdate(const QDateTime &updateTime);
+
+    /**
+     * @brief Record that a poll returned no new data
+     * @param idle Whether the system is idle, e.g. no photovoltaic production
+     *
+     * This is done automatically when a target is set.
+     */
+    Q_INVOKABLE void recordNoChange(bool idle = false);
+
+    /**
+     * @brief Record that a poll failed
+     *
+     * Polling backs off until a poll succeeds again.
+     * This is done automatically when a target is set.
+     */
+    Q_INVOKABLE void recordError();
+
+    /**
+     * @brief Emitted when it is time to poll
+     *
+     * If a target is set, it is reloaded automatically.
+     */
+    Q_SIGNAL void pollRequested();
+
+public Q_SLOTS:
+    /**
+     * @brief Start polling
+     *
+     * Polls immediately.
+     */
+    void start();
+    /**
+     * @brief Stop polling
+     */
+    void stop();
+
+private:
+    std::unique_ptr<AdaptivePollerPrivate> const d;
+};
+
+} // namespace QAlphaCloud
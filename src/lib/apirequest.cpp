@@ -5,21 +5,35 @@
 
 #include "apirequest.h"
 
+#include "config-alphacloud.h"
 #include "connector.h"
+#include "connector_p.h"
 #include "qalphacloud_log.h"
+#include "requestgroup.h"
 
+#if HAVE_QTDBUS
+#include "daemonclient_p.h"
+#endif
+
+#include <QCoreApplication>
 #include <QCryptographicHash>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QLocale>
 #include <QMetaEnum>
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QNetworkRequest>
 #include <QPointer>
 #include <QScopeGuard>
+#include <QThread>
+#include <QTimer>
 #include <QUrlQuery>
 
+#include <functional>
+
 namespace QAlphaCloud
 {
 
@@ -29,6 +43,15 @@ public:
     explicit ApiRequestPrivate(ApiRequest *q)
         : q(q)
     {
+        m_hedgeTimer.setSingleShot(true);
+        QObject::connect(&m_hedgeTimer, &QTimer::timeout, q, [this] {
+            sendHedgeRequest();
+        });
+
+        m_queueTimer.setSingleShot(true);
+        QObject::connect(&m_queueTimer, &QTimer::timeout, q, [this] {
+            queueTimedOut();
+        });
     }
 
     void finalize()
@@ -38,10 +61,43 @@ public:
         }
     }
 
+    // Sends the request to the daemon or network, unless the circuit breaker says not to.
+    void dispatch();
+    void sendQueued();
+    // Held back for longer than the request timeout.
+    void queueTimedOut();
+    QNetworkReply *createReply();
+    void sendNetworkRequest();
+    void sendHedgeRequest();
+    void processNetworkReply(QNetworkReply *reply);
+#if HAVE_QTDBUS
+    bool sendToDaemon();
+#endif
+    void processReply(const QByteArray &replyData, const QUrl &url);
+    void emitResult(const QUrl &url);
+
+    // Circuit breaker for unreachable storage systems, see ConnectorPrivate.
+    QString circuitKey() const;
+    // Only live data is worth providing in its stead, history can just be requested later.
+    bool keepsLastData() const;
+    void shortCircuit();
+
+    // Fail without sending anything, e.g. when the RequestGroup was canceled.
+    void reject(ErrorCode error);
+    void setCanceledError();
+    // Result that doesn't involve the network is emitted asynchronously, too.
+    void scheduleLocalResult(const std::function<void()> &emitLocalResult);
+
     ApiRequest *const q;
     QPointer<QNetworkReply> m_reply;
+    // Duplicate request sent when the first one is slow, see Connector::hedgeRequests.
+    QPointer<QNetworkReply> m_hedgeReply;
+    QTimer m_hedgeTimer;
+    QTimer m_queueTimer;
 
     Connector *m_connector = nullptr;
+    QPointer<RequestGroup> m_requestGroup;
+    QMetaObject::Connection m_requestGroupConnection;
     QString m_endPoint;
     bool m_autoDelete = true;
 
@@ -52,8 +108,448 @@ public:
     QAlphaCloud::ErrorCode m_error = QAlphaCloud::ErrorCode::NoError;
     QString m_errorString;
     QJsonValue m_data;
+
+    QElapsedTimer m_timer;
+    qint64 m_elapsedTime = -1; // ms
+    qint64 m_bytesReceived = 0;
+    qint64 m_parseTime = 0; // µs
+
+    bool m_circuitProbe = false;
+    bool m_localResultPending = false;
+    bool m_stale = false;
+    CircuitState m_circuitState = CircuitState::Closed;
+    // Held back while offline, see Connector::online.
+    bool m_queued = false;
+    // Sent again with the server's time after the API rejected ours.
+    bool m_timestampRetried = false;
+
+#if HAVE_QTDBUS
+    bool m_daemonCallPending = false;
+#endif
 };
 
+// e.g. "Sun, 06 Nov 1994 08:49:37 GMT", always in English and GMT.
+static QDateTime parseHttpDate(const QByteArray &httpDate)
+{
+    if (httpDate.isEmpty()) {
+        return QDateTime();
+    }
+
+    QDateTime dateTime = QLocale::c().toDateTime(QString::fromLatin1(httpDate), QStringLiteral("ddd, dd MMM yyyy hh:mm:ss 'GMT'"));
+    dateTime.setTimeSpec(Qt::UTC);
+    return dateTime;
+}
+
+// The order in which requests held back while offline are sent.
+static int queuePriority(const QString &endPoint)
+{
+    // Needed to know what else to ask for.
+    if (endPoint == ApiRequest::EndPoint::EssList) {
+        return 0;
+    }
+    // What the user is most likely looking at.
+    if (endPoint == ApiRequest::EndPoint::LastPowerData) {
+        return 1;
+    }
+    if (endPoint == ApiRequest::EndPoint::OneDayPowerBySn) {
+        return 2;
+    }
+    if (endPoint == ApiRequest::EndPoint::OneDateEnergyBySn) {
+        return 3;
+    }
+    return 4;
+}
+
+void ApiRequestPrivate::dispatch()
+{
+    // Don't bother the API while the storage system is unreachable.
+    m_circuitProbe = false;
+    if (!m_sysSn.isEmpty() && !ConnectorPrivate::get(m_connector)->circuitAllowsRequest(circuitKey(), &m_circuitProbe)) {
+        qCDebug(QALPHACLOUD_LOG) << "Not sending API request for" << circuitKey() << "as the storage system is unreachable";
+        scheduleLocalResult([this] {
+            shortCircuit();
+        });
+        return;
+    }
+
+#if HAVE_QTDBUS
+    // Share the data with other applications through the daemon, if it's running.
+    if (sendToDaemon()) {
+        return;
+    }
+#endif
+
+    sendNetworkRequest();
+}
+
+void ApiRequestPrivate::sendQueued()
+{
+    if (!m_queued) { // aborted.
+        return;
+    }
+    m_queued = false;
+    m_queueTimer.stop();
+
+    qCDebug(QALPHACLOUD_LOG) << "Sending API request for endpoint" << m_endPoint << "that was held back";
+    // Don't count the time spent waiting.
+    m_timer.start();
+    dispatch();
+}
+
+void ApiRequestPrivate::queueTimedOut()
+{
+    if (!m_queued) { // already sent.
+        return;
+    }
+
+    ConnectorPrivate::get(m_connector)->dequeueRequest(q);
+    m_queued = false;
+
+    qCWarning(QALPHACLOUD_LOG) << "API request for endpoint" << m_endPoint << "timed out while being held back";
+    m_elapsedTime = m_timer.elapsed();
+    m_error = static_cast<QAlphaCloud::ErrorCode>(QNetworkReply::TimeoutError);
+    m_errorString = QAlphaCloud::errorText(m_error);
+
+    // Not emitting Connector::requestFinished, nothing was sent.
+    Q_EMIT q->errorOccurred();
+    Q_EMIT q->finished();
+}
+
+QNetworkReply *ApiRequestPrivate::createReply()
+{
+    // The Configuration object itself must not be touched from a different thread.
+    const ConfigurationSnapshot configuration = ConnectorPrivate::get(m_connector)->configurationSnapshot();
+
+    // Calculate Header fields (appId, timeStamp, sign).
+    // Our clock might be off, use what the server thinks the time is.
+    const QByteArray timeStampStr = QByteArray::number(ConnectorPrivate::get(m_connector)->serverSecsSinceEpoch(), 'f', 0);
+
+    const QByteArray appId = configuration.appId().toUtf8(); // toLatin1?
+    const QByteArray secret = configuration.appSecret().toUtf8();
+
+    const QByteArray sign = appId + secret + timeStampStr;
+    const QByteArray hashedSign = QCryptographicHash::hash(sign, QCryptographicHash::Sha512).toHex();
+
+    // Generate URL.
+    QUrl url = configuration.apiUrl();
+
+    url.setPath(QDir::cleanPath(url.path() + QLatin1Char('/') + m_endPoint));
+
+    // Add any additional request parameters.
+    QUrlQuery query = m_query;
+    if (!m_sysSn.isEmpty()) {
+        query.addQueryItem(QStringLiteral("sysSn"), m_sysSn);
+    }
+    if (m_queryDate.isValid()) {
+        query.addQueryItem(QStringLiteral("queryDate"), m_queryDate.toString(QStringLiteral("yyyy-MM-dd")));
+    }
+    url.setQuery(query);
+
+    QNetworkRequest request(url);
+    request.setTransferTimeout(configuration.requestTimeout());
+
+    // request.setAttribute(QNetworkRequest::Http2AllowedAttribute, false);
+
+    // TODO allow spoofing stuff like User Agent.
+    request.setHeader(QNetworkRequest::ContentLengthHeader, 0);
+    request.setHeader(QNetworkRequest::ContentTypeHeader, QStringLiteral("application/json"));
+
+    request.setRawHeader(QByteArrayLiteral("appId"), appId);
+    request.setRawHeader(QByteArrayLiteral("timeStamp"), timeStampStr);
+    request.setRawHeader(QByteArrayLiteral("sign"), hashedSign);
+
+    qCDebug(QALPHACLOUD_LOG) << "Sending API request to" << url;
+
+    auto *reply = m_connector->networkAccessManager()->get(request);
+    QObject::connect(reply, &QNetworkReply::finished, q, [this, reply] {
+        processNetworkReply(reply);
+    });
+    QObject::connect(reply, &QNetworkReply::finished, reply, &QNetworkReply::deleteLater);
+
+    return reply;
+}
+
+void ApiRequestPrivate::sendNetworkRequest()
+{
+    m_reply = createReply();
+
+    auto *connectorPrivate = ConnectorPrivate::get(m_connector);
+    connectorPrivate->earnHedgeBudget();
+
+    const int hedgeDelay = connectorPrivate->hedgeDelay(m_endPoint);
+    if (hedgeDelay > -1) {
+        m_hedgeTimer.start(hedgeDelay);
+    }
+}
+
+void ApiRequestPrivate::sendHedgeRequest()
+{
+    if (!m_reply || m_hedgeReply) {
+        return;
+    }
+
+    if (!ConnectorPrivate::get(m_connector)->acquireHedgeBudget()) {
+        qCDebug(QALPHACLOUD_LOG) << "API request for endpoint" << m_endPoint << "is slow but the hedge budget is exhausted";
+        return;
+    }
+
+    qCDebug(QALPHACLOUD_LOG) << "API request for endpoint" << m_endPoint << "is slow, sending it again";
+    m_hedgeReply = createReply();
+}
+
+void ApiRequestPrivate::processNetworkReply(QNetworkReply *reply)
+{
+    // The other one already won.
+    if (reply != m_reply && reply != m_hedgeReply) {
+        return;
+    }
+
+    QPointer<QNetworkReply> &otherReply = reply == m_reply ? m_hedgeReply : m_reply;
+
+    if (otherReply && reply->error() != QNetworkReply::NoError && reply->error() != QNetworkReply::OperationCanceledError) {
+        qCDebug(QALPHACLOUD_LOG) << "API request for endpoint" << reply->url() << "failed with network error" << reply->errorString()
+                                 << "waiting for the other one";
+        if (reply == m_reply) {
+            m_reply = nullptr;
+        } else {
+            m_hedgeReply = nullptr;
+        }
+        return;
+    }
+
+    m_hedgeTimer.stop();
+    if (otherReply) {
+        QNetworkReply *loser = otherReply;
+        otherReply = nullptr;
+        loser->abort();
+    }
+
+    m_elapsedTime = m_timer.elapsed();
+
+    if (reply->error() != QNetworkReply::NoError) {
+        if (reply->error() == QNetworkReply::OperationCanceledError) {
+            qCDebug(QALPHACLOUD_LOG) << "API request for endpoint" << reply->url() << "was canceled";
+            setCanceledError();
+        } else {
+            qCWarning(QALPHACLOUD_LOG) << "API request for endpoint" << reply->url() << "failed with network error" << reply->errorString();
+            m_error = static_cast<QAlphaCloud::ErrorCode>(reply->error());
+            m_errorString = reply->errorString();
+        }
+    } else {
+        processReply(reply->readAll(), reply->url());
+    }
+
+    const QDateTime serverDate = parseHttpDate(reply->rawHeader(QByteArrayLiteral("Date")));
+    if (serverDate.isValid()) {
+        ConnectorPrivate::get(m_connector)->recordServerDate(serverDate, m_error == QAlphaCloud::ErrorCode::TimestampError);
+    }
+
+    // Rather than failing every request until the clock is fixed, sign it again with the server's time.
+    if (m_error == QAlphaCloud::ErrorCode::TimestampError && serverDate.isValid() && !m_timestampRetried) {
+        qCWarning(QALPHACLOUD_LOG) << "API request for endpoint" << reply->url() << "was rejected as our clock is off by"
+                                   << QDateTime::currentDateTimeUtc().secsTo(serverDate) << "s, sending it again";
+        m_timestampRetried = true;
+        m_error = QAlphaCloud::ErrorCode::NoError;
+        m_errorString.clear();
+        m_data = QJsonObject();
+        m_elapsedTime = -1;
+        m_hedgeReply = nullptr;
+        m_reply = createReply();
+        return;
+    }
+
+    // Two round-trips aren't representative.
+    if (m_error == QAlphaCloud::ErrorCode::NoError && !m_timestampRetried) {
+        ConnectorPrivate::get(m_connector)->recordLatency(m_endPoint, m_elapsedTime);
+    }
+
+    emitResult(reply->url());
+}
+
+void ApiRequestPrivate::processReply(const QByteArray &replyData, const QUrl &url)
+{
+    int code = -1;
+    m_bytesReceived = replyData.size();
+
+    QElapsedTimer parseTimer;
+    parseTimer.start();
+
+    QJsonParseError error;
+    QJsonDocument jsonDocument = QJsonDocument::fromJson(replyData, &error);
+
+    if (error.error != QJsonParseError::NoError) {
+        m_error = ErrorCode::JsonParseError;
+        m_errorString = QAlphaCloud::errorText(m_error, error.errorString());
+    } else if (!jsonDocument.isObject()) {
+        m_error = ErrorCode::UnexpectedJsonDataError;
+        m_errorString = QAlphaCloud::errorText(m_error, jsonDocument);
+    } else {
+        const QJsonObject jsonObject = jsonDocument.object();
+        if (jsonObject.isEmpty()) {
+            m_error = ErrorCode::EmptyJsonObjectError;
+        } else {
+            code = jsonObject.value(QStringLiteral("code")).toInt();
+            if (code != 200) {
+                m_error = static_cast<QAlphaCloud::ErrorCode>(code);
+                const QString msg = jsonObject.value(QStringLiteral("msg")).toString();
+                m_errorString = QAlphaCloud::errorText(m_error, msg);
+            }
+
+            m_data = jsonObject.value(QStringLiteral("data"));
+        }
+    }
+
+    m_parseTime = parseTimer.nsecsElapsed() / 1000;
+
+    if (m_error != QAlphaCloud::ErrorCode::NoError) {
+        qCWarning(QALPHACLOUD_LOG) << "API request for endpoint" << url << "failed with API error" << m_error << code << m_errorString;
+    }
+}
+
+QString ApiRequestPrivate::circuitKey() const
+{
+    return m_sysSn + QLatin1Char('/') + m_endPoint;
+}
+
+bool ApiRequestPrivate::keepsLastData() const
+{
+    if (m_endPoint == ApiRequest::EndPoint::LastPowerData) {
+        return true;
+    }
+    if (m_endPoint == ApiRequest::EndPoint::OneDateEnergyBySn) {
+        return m_queryDate == QDate::currentDate();
+    }
+    return false;
+}
+
+void ApiRequestPrivate::shortCircuit()
+{
+    auto *connectorPrivate = ConnectorPrivate::get(m_connector);
+    m_circuitState = connectorPrivate->circuitState(circuitKey());
+
+    // Serve the last known data instead, if any.
+    if (keepsLastData() && connectorPrivate->lastData(circuitKey(), m_queryDate, &m_data)) {
+        m_stale = true;
+        Q_EMIT q->result();
+    } else {
+        m_error = connectorPrivate->circuitError(circuitKey(), &m_errorString);
+        Q_EMIT q->errorOccurred();
+    }
+
+    // Not emitting Connector::requestFinished, nothing was sent.
+    Q_EMIT q->finished();
+}
+
+void ApiRequestPrivate::reject(ErrorCode error)
+{
+    scheduleLocalResult([this, error] {
+        if (error == static_cast<QAlphaCloud::ErrorCode>(QNetworkReply::OperationCanceledError)) {
+            setCanceledError();
+        } else {
+            m_error = error;
+            m_errorString = QAlphaCloud::errorText(error);
+        }
+        Q_EMIT q->errorOccurred();
+        Q_EMIT q->finished();
+    });
+}
+
+void ApiRequestPrivate::setCanceledError()
+{
+    // Let the user know that it wasn't them who aborted it.
+    if (m_requestGroup && m_requestGroup->deadlineExceeded()) {
+        m_error = QAlphaCloud::ErrorCode::DeadlineExceededError;
+        m_errorString = QAlphaCloud::errorText(m_error);
+    } else {
+        m_error = static_cast<QAlphaCloud::ErrorCode>(QNetworkReply::OperationCanceledError);
+        m_errorString = QCoreApplication::translate("QNetworkReply", "Operation canceled");
+    }
+}
+
+void ApiRequestPrivate::scheduleLocalResult(const std::function<void()> &emitLocalResult)
+{
+    m_localResultPending = true;
+    QMetaObject::invokeMethod(
+        q,
+        [this, emitLocalResult] {
+            if (!m_localResultPending) { // aborted.
+                return;
+            }
+            m_localResultPending = false;
+            m_elapsedTime = 0;
+
+            emitLocalResult();
+        },
+        Qt::QueuedConnection);
+}
+
+void ApiRequestPrivate::emitResult(const QUrl &url)
+{
+    if (!m_sysSn.isEmpty()) {
+        auto *connectorPrivate = ConnectorPrivate::get(m_connector);
+        connectorPrivate->reportCircuitResult(circuitKey(), m_circuitProbe, m_error, m_errorString);
+        if (m_error == QAlphaCloud::ErrorCode::NoError && keepsLastData()) {
+            connectorPrivate->storeLastData(circuitKey(), m_data, m_queryDate, static_cast<int>(m_bytesReceived));
+        }
+        m_circuitState = connectorPrivate->circuitState(circuitKey());
+    }
+
+    if (m_error != QAlphaCloud::ErrorCode::NoError) {
+        Q_EMIT q->errorOccurred();
+    } else {
+        qCDebug(QALPHACLOUD_LOG) << "API request for endpoint" << url << "succeeded";
+        Q_EMIT q->result();
+    }
+
+    Q_EMIT m_connector->requestFinished(m_endPoint, m_error, m_elapsedTime, m_bytesReceived);
+
+    Q_EMIT q->finished();
+}
+
+#if HAVE_QTDBUS
+bool ApiRequestPrivate::sendToDaemon()
+{
+    if (!m_connector->useDaemon()) {
+        return false;
+    }
+
+    // The D-Bus connection is tied to the main thread.
+    if (!qApp || QThread::currentThread() != qApp->thread()) {
+        return false;
+    }
+
+    auto *daemon = DaemonClient::instance();
+    if (!daemon->available()) {
+        return false;
+    }
+
+    m_daemonCallPending = true;
+
+    daemon->fetch(m_connector, m_endPoint, m_sysSn, m_queryDate, m_query, q, [this](const DaemonClient::Result &result) {
+        if (!m_daemonCallPending) { // aborted.
+            return;
+        }
+        m_daemonCallPending = false;
+
+        // The daemon couldn't handle it, e.g. because it uses a different account.
+        if (!result.handled) {
+            sendNetworkRequest();
+            return;
+        }
+
+        m_elapsedTime = m_timer.elapsed();
+        m_bytesReceived = result.bytesReceived;
+        m_error = result.error;
+        m_errorString = result.errorString;
+        m_data = result.data;
+
+        emitResult(QUrl(m_endPoint));
+    });
+
+    return true;
+}
+#endif
+
 ApiRequest::ApiRequest(Connector *connector, QObject *parent)
     : ApiRequest(connector, QString(), parent)
 {
@@ -72,7 +568,12 @@ ApiRequest::ApiRequest(Connector *connector, const QString &endPoint, QObject *p
     });
 }
 
-ApiRequest::~ApiRequest() = default;
+ApiRequest::~ApiRequest()
+{
+    if (d->m_queued) {
+        ConnectorPrivate::get(d->m_connector)->dequeueRequest(this);
+    }
+}
 
 QString ApiRequest::endPoint() const
 {
@@ -139,6 +640,41 @@ QJsonValue ApiRequest::data() const
     return d->m_data;
 }
 
+qint64 ApiRequest::elapsedTime() const
+{
+    return d->m_elapsedTime;
+}
+
+qint64 ApiRequest::bytesReceived() const
+{
+    return d->m_bytesReceived;
+}
+
+qint64 ApiRequest::parseTime() const
+{
+    return d->m_parseTime;
+}
+
+bool ApiRequest::stale() const
+{
+    return d->m_stale;
+}
+
+CircuitState ApiRequest::circuitState() const
+{
+    return d->m_circuitState;
+}
+
+RequestGroup *ApiRequest::requestGroup() const
+{
+    return d->m_requestGroup;
+}
+
+void ApiRequest::setRequestGroup(RequestGroup *requestGroup)
+{
+    d->m_requestGroup = requestGroup;
+}
+
 bool ApiRequest::send()
 {
     auto cleanup = qScopeGuard([this] {
@@ -150,124 +686,114 @@ bool ApiRequest::send()
         return false;
     }
 
-    auto *configuration = d->m_connector->configuration();
-    if (!configuration) {
+    const ConfigurationSnapshot configuration = ConnectorPrivate::get(d->m_connector)->configurationSnapshot();
+    if (configuration.isNull()) {
         qCCritical(QALPHACLOUD_LOG) << "Cannot send request on a Connector with no configuration";
         return false;
     }
 
-    if (!configuration->valid()) {
+    if (!configuration.valid()) {
         qCCritical(QALPHACLOUD_LOG) << "Cannot send request on a Connector with an invalid configuration";
         return false;
     }
 
-    // Calculate Header fields (appId, timeStamp, sign).
-    const QByteArray timeStampStr = QByteArray::number(QDateTime::currentSecsSinceEpoch(), 'f', 0);
-
-    const QByteArray appId = configuration->appId().toUtf8(); // toLatin1?
-    const QByteArray secret = configuration->appSecret().toUtf8();
-
-    const QByteArray sign = appId + secret + timeStampStr;
-    const QByteArray hashedSign = QCryptographicHash::hash(sign, QCryptographicHash::Sha512).toHex();
-
-    // Generate URL.
-    QUrl url = configuration->apiUrl();
-
-    url.setPath(QDir::cleanPath(url.path() + QLatin1Char('/') + d->m_endPoint));
-
-    // Add any additional request parameters.
-    QUrlQuery query = d->m_query;
-    if (!d->m_sysSn.isEmpty()) {
-        query.addQueryItem(QStringLiteral("sysSn"), d->m_sysSn);
-    }
-    if (d->m_queryDate.isValid()) {
-        query.addQueryItem(QStringLiteral("queryDate"), d->m_queryDate.toString(QStringLiteral("yyyy-MM-dd")));
-    }
-    url.setQuery(query);
-
-    QNetworkRequest request(url);
-    request.setTransferTimeout(configuration->requestTimeout());
-
-    // request.setAttribute(QNetworkRequest::Http2AllowedAttribute, false);
-
-    // TODO allow spoofing stuff like User Agent.
-    request.setHeader(QNetworkRequest::ContentLengthHeader, 0);
-    request.setHeader(QNetworkRequest::ContentTypeHeader, QStringLiteral("application/json"));
-
-    request.setRawHeader(QByteArrayLiteral("appId"), appId);
-    request.setRawHeader(QByteArrayLiteral("timeStamp"), timeStampStr);
-    request.setRawHeader(QByteArrayLiteral("sign"), hashedSign);
-
-    qCDebug(QALPHACLOUD_LOG) << "Sending API request to" << url;
-
     d->m_error = QAlphaCloud::ErrorCode::NoError;
     d->m_errorString.clear();
     d->m_data = QJsonObject();
+    d->m_elapsedTime = -1;
+    d->m_bytesReceived = 0;
+    d->m_parseTime = 0;
+    d->m_stale = false;
+    d->m_circuitState = CircuitState::Closed;
+    d->m_timestampRetried = false;
+    d->m_timer.start();
 
-    auto *reply = d->m_connector->networkAccessManager()->get(request);
-    connect(reply, &QNetworkReply::finished, this, [this, reply] {
-        if (reply->error() != QNetworkReply::NoError) {
-            if (reply->error() == QNetworkReply::OperationCanceledError) {
-                qCDebug(QALPHACLOUD_LOG) << "API request for endpoint" << reply->url() << "was canceled";
-            } else {
-                qCWarning(QALPHACLOUD_LOG) << "API request for endpoint" << reply->url() << "failed with network error" << reply->errorString();
-            }
-            d->m_error = static_cast<QAlphaCloud::ErrorCode>(reply->error());
-            d->m_errorString = reply->errorString();
-            Q_EMIT errorOccurred();
-        } else {
-            int code = -1;
-            QJsonParseError error;
-            QJsonDocument jsonDocument = QJsonDocument::fromJson(reply->readAll(), &error);
-
-            if (error.error != QJsonParseError::NoError) {
-                d->m_error = ErrorCode::JsonParseError;
-                d->m_errorString = QAlphaCloud::errorText(d->m_error, error.errorString());
-            } else if (!jsonDocument.isObject()) {
-                d->m_error = ErrorCode::UnexpectedJsonDataError;
-                d->m_errorString = QAlphaCloud::errorText(d->m_error, jsonDocument);
-            } else {
-                const QJsonObject jsonObject = jsonDocument.object();
-                if (jsonObject.isEmpty()) {
-                    d->m_error = ErrorCode::EmptyJsonObjectError;
-                } else {
-                    code = jsonObject.value(QStringLiteral("code")).toInt();
-                    if (code != 200) {
-                        d->m_error = static_cast<QAlphaCloud::ErrorCode>(code);
-                        const QString msg = jsonObject.value(QStringLiteral("msg")).toString();
-                        d->m_errorString = QAlphaCloud::errorText(d->m_error, msg);
-                    }
-
-                    d->m_data = jsonObject.value(QStringLiteral("data"));
-                }
-            }
+    cleanup.dismiss();
 
-            if (d->m_error != QAlphaCloud::ErrorCode::NoError) {
-                qCWarning(QALPHACLOUD_LOG) << "API request for endpoint" << reply->url() << "failed with API error" << d->m_error << code << d->m_errorString;
-                Q_EMIT errorOccurred();
-            } else {
-                qCDebug(QALPHACLOUD_LOG) << "API request for endpoint" << reply->url() << "succeeded";
-                Q_EMIT result();
-            }
+    QObject::disconnect(d->m_requestGroupConnection);
+    if (d->m_requestGroup) {
+        if (d->m_requestGroup->canceled()) {
+            qCDebug(QALPHACLOUD_LOG) << "Not sending API request for endpoint" << d->m_endPoint << "as its request group was canceled";
+            d->reject(static_cast<QAlphaCloud::ErrorCode>(QNetworkReply::OperationCanceledError));
+            return true;
         }
 
-        Q_EMIT finished();
-    });
-    connect(reply, &QNetworkReply::finished, reply, &QNetworkReply::deleteLater);
+        // Don't send it if nobody will be around for the result anymore.
+        const qint64 remainingTime = d->m_requestGroup->remainingTime();
+        const qint64 typicalLatency = ConnectorPrivate::get(d->m_connector)->typicalLatency(d->m_endPoint);
+        if (remainingTime == 0 || (remainingTime > 0 && remainingTime < typicalLatency)) {
+            qCDebug(QALPHACLOUD_LOG) << "Not sending API request for endpoint" << d->m_endPoint << "as it typically takes" << typicalLatency
+                                     << "ms but the deadline is in" << remainingTime << "ms";
+            d->reject(QAlphaCloud::ErrorCode::DeadlineExceededError);
+            return true;
+        }
 
-    d->m_reply = reply;
+        d->m_requestGroupConnection = connect(d->m_requestGroup, &RequestGroup::canceledChanged, this, [this](bool canceled) {
+            if (canceled) {
+                abort();
+            }
+        });
+    }
 
-    cleanup.dismiss();
+    // Hold it back while offline and until the requests held back before it have been sent.
+    const auto sendQueued = [this] {
+        d->sendQueued();
+    };
+    if (ConnectorPrivate::get(d->m_connector)->enqueueRequest(this, queuePriority(d->m_endPoint), sendQueued)) {
+        qCDebug(QALPHACLOUD_LOG) << "Holding back API request for endpoint" << d->m_endPoint;
+        d->m_queued = true;
+        // Don't wait forever for the connection to come back.
+        if (configuration.requestTimeout() > 0) {
+            d->m_queueTimer.start(configuration.requestTimeout());
+        }
+        return true;
+    }
 
+    d->dispatch();
     return true;
 }
 
 void ApiRequest::abort()
 {
-    if (d->m_reply) {
-        d->m_reply->abort();
-        d->m_reply = nullptr;
+    d->m_hedgeTimer.stop();
+    d->m_queueTimer.stop();
+
+    if (d->m_queued) {
+        ConnectorPrivate::get(d->m_connector)->dequeueRequest(this);
+    }
+
+    // Behave like an aborted network request.
+    if (d->m_queued || d->m_localResultPending) {
+        d->m_queued = false;
+        d->m_localResultPending = false;
+        d->setCanceledError();
+        Q_EMIT errorOccurred();
+        Q_EMIT finished();
+    }
+
+    // Only report one of them as canceled.
+    if (d->m_reply && d->m_hedgeReply) {
+        QNetworkReply *hedgeReply = d->m_hedgeReply;
+        d->m_hedgeReply = nullptr;
+        hedgeReply->abort();
+    }
+
+    QNetworkReply *reply = d->m_reply ? d->m_reply : d->m_hedgeReply;
+    if (reply) {
+        reply->abort();
+    }
+    d->m_reply = nullptr;
+    d->m_hedgeReply = nullptr;
+
+#if HAVE_QTDBUS
+    // Behave like an aborted network request.
+    if (d->m_daemonCallPending) {
+        d->m_daemonCallPending = false;
+        d->m_elapsedTime = d->m_timer.elapsed();
+        d->setCanceledError();
+        d->emitResult(QUrl(d->m_endPoint));
     }
+#endif
 
     d->finalize();
 }
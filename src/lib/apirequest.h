@@ -20,6 +20,7 @@ namespace QAlphaCloud
 
 class ApiRequestPrivate;
 class Connector;
+class RequestGroup;
 
 /**
  * @brief API request job
@@ -40,6 +41,8 @@ public:
      * @brief The API endpoints
      */
     struct EndPoint {
+        static constexpr QLatin1String ChargeConfigInfo{"getChargeConfigInfo"};
+        static constexpr QLatin1String DischargeConfigInfo{"getDisChargeConfigInfo"};
         static constexpr QLatin1String EssList{"getEssList"};
         static constexpr QLatin1String LastPowerData{"getLastPowerData"};
         static constexpr QLatin1String OneDayPowerBySn{"getOneDayPowerBySn"};
@@ -140,6 +143,53 @@ public:
      */
     QJsonValue data() const;
 
+    /**
+     * @brief Time in milliseconds from sending the request until the reply finished.
+     *
+     * This is -1 until the request finished.
+     */
+    qint64 elapsedTime() const;
+    /**
+     * @brief Size of the reply body in bytes.
+     */
+    qint64 bytesReceived() const;
+    /**
+     * @brief Time in microseconds it took to parse the reply.
+     */
+    qint64 parseTime() const;
+
+    /**
+     * @brief Whether data() is outdated
+     *
+     * After a storage system repeatedly reported to be offline, requests
+     * for it are no longer sent for a while. Instead, the last data received
+     * for the same request is returned, if any, and this is true.
+     * Otherwise, the error it last reported occurs.
+     */
+    bool stale() const;
+
+    /**
+     * @brief State of the circuit breaker for this storage system and endpoint
+     *
+     * As of when the request finished. Always CircuitState::Closed when no sysSn is set.
+     */
+    CircuitState circuitState() const;
+
+    /**
+     * @brief The request group this request belongs to, if any
+     */
+    RequestGroup *requestGroup() const;
+    /**
+     * @brief Set the request group this request belongs to
+     *
+     * When the group is canceled, the request is aborted. If it was already
+     * canceled or the request is unlikely to finish before the deadline of
+     * the group, it is not sent at all but fails right away.
+     *
+     * This must be set before send() is called.
+     */
+    void setRequestGroup(RequestGroup *requestGroup);
+
     /**
      * @brief Send the event
      *
@@ -0,0 +1,99 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "autorefresh_p.h"
+
+#include "connector.h"
+
+#include <algorithm>
+
+namespace QAlphaCloud
+{
+
+AutoRefresh::AutoRefresh(const std::function<bool()> &reload)
+    : m_reload(reload)
+{
+    m_timer.setSingleShot(true);
+    QObject::connect(&m_timer, &QTimer::timeout, &m_timer, [this] {
+        if (!m_reload()) {
+            // Try again after another interval rather than right away.
+            restart();
+        }
+    });
+}
+
+int AutoRefresh::interval() const
+{
+    return m_interval;
+}
+
+bool AutoRefresh::setInterval(int interval)
+{
+    interval = std::max(0, interval);
+    if (m_interval == interval) {
+        return false;
+    }
+
+    m_interval = interval;
+    schedule();
+    return true;
+}
+
+bool AutoRefresh::paused() const
+{
+    return m_paused;
+}
+
+bool AutoRefresh::setPaused(bool paused)
+{
+    if (m_paused == paused) {
+        return false;
+    }
+
+    m_paused = paused;
+    schedule();
+    return true;
+}
+
+void AutoRefresh::setConnector(Connector *connector)
+{
+    QObject::disconnect(m_onlineConnection);
+
+    m_offline = connector && !connector->online();
+    if (connector) {
+        m_onlineConnection = QObject::connect(connector, &Connector::onlineChanged, &m_timer, [this](bool online) {
+            m_offline = !online;
+            schedule();
+        });
+    }
+
+    schedule();
+}
+
+void AutoRefresh::restart()
+{
+    m_lastRefresh.start();
+    schedule();
+}
+
+void AutoRefresh::stop()
+{
+    m_lastRefresh.invalidate();
+    m_timer.stop();
+}
+
+void AutoRefresh::schedule()
+{
+    if (m_paused || m_offline || m_interval <= 0 || !m_lastRefresh.isValid()) {
+        m_timer.stop();
+        return;
+    }
+
+    const qint64 remaining = m_interval - m_lastRefresh.elapsed();
+    // Also covers unpausing or coming back online after a reload became due.
+    m_timer.start(static_cast<int>(std::max(qint64(0), remaining)));
+}
+
+} // namespace QAlphaCloud
@@ -0,0 +1,63 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QTimer>
+
+#include <functional>
+
+namespace QAlphaCloud
+{
+
+class Connector;
+
+/**
+ * Periodically reloads an object.
+ *
+ * The interval counts from the most recent reload, regardless of whether it
+ * was triggered automatically or manually. While paused, no reloads happen;
+ * when unpaused, a reload that became due in the meantime happens immediately.
+ * The same applies while the connector is offline.
+ *
+ * Nothing is reloaded automatically until the object has been loaded once.
+ */
+class AutoRefresh
+{
+public:
+    explicit AutoRefresh(const std::function<bool()> &reload);
+
+    int interval() const;
+    // Returns whether the interval changed.
+    bool setInterval(int interval);
+
+    bool paused() const;
+    // Returns whether the paused state changed.
+    bool setPaused(bool paused);
+
+    // Call this whenever the connector of the object changes.
+    void setConnector(Connector *connector);
+
+    // Call this whenever the object is reloaded.
+    void restart();
+    // Call this when the object is reset.
+    void stop();
+
+private:
+    void schedule();
+
+    std::function<bool()> m_reload;
+
+    int m_interval = 0; // ms
+    bool m_paused = false;
+    bool m_offline = false;
+    QMetaObject::Connection m_onlineConnection;
+
+    QElapsedTimer m_lastRefresh;
+    QTimer m_timer;
+};
+
+} // namespace QAlphaCloud
@@ -0,0 +1,204 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "chargeconfiginfo.h"
+
+#include "apirequest.h"
+#include "configinfo_p.h"
+#include "utils_p.h"
+
+namespace QAlphaCloud
+{
+
+class ChargeConfigInfoPrivate : public ConfigInfoPrivate<ChargeConfigInfo>
+{
+public:
+    explicit ChargeConfigInfoPrivate(ChargeConfigInfo *q);
+
+    bool m_gridChargeEnabled = false; // gridCharge
+    qreal m_chargeLimit = 0.0; // batHighCap
+    QTime m_period1Start; // timeChaf1
+    QTime m_period1End; // timeChae1
+    QTime m_period2Start; // timeChaf2
+    QTime m_period2End; // timeChae2
+
+protected:
+    bool processFields(const QJsonObject &json) override;
+};
+
+ChargeConfigInfoPrivate::ChargeConfigInfoPrivate(ChargeConfigInfo *q)
+    : ConfigInfoPrivate(q, ApiRequest::EndPoint::ChargeConfigInfo)
+{
+}
+
+bool ChargeConfigInfoPrivate::processFields(const QJsonObject &json)
+{
+    bool valid = false;
+
+    const auto gridChargeValue = json.value(QStringLiteral("gridCharge"));
+    Utils::updateField(m_gridChargeEnabled, gridChargeValue.toInt() != 0, q, &ChargeConfigInfo::gridChargeEnabledChanged);
+    valid = valid || (!gridChargeValue.isUndefined() && !gridChargeValue.isNull());
+
+    const auto chargeLimitValue = json.value(QStringLiteral("batHighCap"));
+    Utils::updateField(m_chargeLimit, chargeLimitValue.toDouble(), q, &ChargeConfigInfo::chargeLimitChanged);
+    valid = valid || (!chargeLimitValue.isUndefined() && !chargeLimitValue.isNull());
+
+    const QString timeFormat = QStringLiteral("HH:mm");
+
+    const QTime period1Start = QTime::fromString(json.value(QStringLiteral("timeChaf1")).toString(), timeFormat);
+    if (m_period1Start != period1Start) {
+        m_period1Start = period1Start;
+        Q_EMIT q->period1StartChanged(period1Start);
+    }
+
+    const QTime period1End = QTime::fromString(json.value(QStringLiteral("timeChae1")).toString(), timeFormat);
+    if (m_period1End != period1End) {
+        m_period1End = period1End;
+        Q_EMIT q->period1EndChanged(period1End);
+    }
+
+    const QTime period2Start = QTime::fromString(json.value(QStringLiteral("timeChaf2")).toString(), timeFormat);
+    if (m_period2Start != period2Start) {
+        m_period2Start = period2Start;
+        Q_EMIT q->period2StartChanged(period2Start);
+    }
+
+    const QTime period2End = QTime::fromString(json.value(QStringLiteral("timeChae2")).toString(), timeFormat);
+    if (m_period2End != period2End) {
+        m_period2End = period2End;
+        Q_EMIT q->period2EndChanged(period2End);
+    }
+
+    return valid;
+}
+
+ChargeConfigInfo::ChargeConfigInfo(QObject *parent)
+    : ChargeConfigInfo(nullptr, QString(), parent)
+{
+}
+
+ChargeConfigInfo::ChargeConfigInfo(Connector *connector, const QString &serialNumber, QObject *parent)
+    : QObject(parent)
+    , d(std::make_unique<ChargeConfigInfoPrivate>(this))
+{
+    d->m_connector = connector;
+    d->m_serialNumber = serialNumber;
+
+    d->connectStore();
+}
+
+ChargeConfigInfo::~ChargeConfigInfo() = default;
+
+Connector *ChargeConfigInfo::connector() const
+{
+    return d->m_connector;
+}
+
+void ChargeConfigInfo::setConnector(Connector *connector)
+{
+    d->setConnector(connector);
+}
+
+RequestGroup *ChargeConfigInfo::requestGroup() const
+{
+    return d->m_requestGroup;
+}
+
+void ChargeConfigInfo::setRequestGroup(RequestGroup *requestGroup)
+{
+    d->setRequestGroup(requestGroup);
+}
+
+QString ChargeConfigInfo::serialNumber() const
+{
+    return d->m_serialNumber;
+}
+
+void ChargeConfigInfo::setSerialNumber(const QString &serialNumber)
+{
+    d->setSerialNumber(serialNumber);
+}
+
+bool ChargeConfigInfo::cached() const
+{
+    return d->m_cached;
+}
+
+void ChargeConfigInfo::setCached(bool cached)
+{
+    d->setCached(cached);
+}
+
+bool ChargeConfigInfo::gridChargeEnabled() const
+{
+    return d->m_gridChargeEnabled;
+}
+
+qreal ChargeConfigInfo::chargeLimit() const
+{
+    return d->m_chargeLimit;
+}
+
+QTime ChargeConfigInfo::period1Start() const
+{
+    return d->m_period1Start;
+}
+
+QTime ChargeConfigInfo::period1End() const
+{
+    return d->m_period1End;
+}
+
+QTime ChargeConfigInfo::period2Start() const
+{
+    return d->m_period2Start;
+}
+
+QTime ChargeConfigInfo::period2End() const
+{
+    return d->m_period2End;
+}
+
+QJsonObject ChargeConfigInfo::rawJson() const
+{
+    return d->m_json;
+}
+
+bool ChargeConfigInfo::valid() const
+{
+    return d->m_valid;
+}
+
+RequestStatus ChargeConfigInfo::status() const
+{
+    return d->m_status;
+}
+
+ErrorCode ChargeConfigInfo::error() const
+{
+    return d->m_error;
+}
+
+QString ChargeConfigInfo::errorString() const
+{
+    return d->m_errorString;
+}
+
+bool ChargeConfigInfo::reload()
+{
+    return d->reload();
+}
+
+bool ChargeConfigInfo::forceReload()
+{
+    return d->forceReload();
+}
+
+void ChargeConfigInfo::reset()
+{
+    d->reset();
+}
+
+} // namespace QAlphaCloud
@@ -0,0 +1,238 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <QJsonObject>
+#include <QObject>
+#include <QString>
+#include <QTime>
+
+#include <memory>
+
+#include "connector.h"
+#include "qalphacloud.h"
+#include "qalphacloud_export.h"
+#include "requestgroup.h"
+
+namespace QAlphaCloud
+{
+
+class ChargeConfigInfoPrivate;
+
+/**
+ * @brief Battery charge configuration.
+ *
+ * Provides information about when and how far the battery is charged.
+ *
+ * Since the configuration rarely changes, it is cached for several hours
+ * and persisted to disk. Multiple instances querying the same storage system
+ * share a single request. Requests that fail because of network issues are
+ * retried automatically.
+ *
+ * Wraps the @c /getChargeConfigInfo API endpoint.
+ */
+class QALPHACLOUD_EXPORT ChargeConfigInfo : public QObject
+{
+    Q_OBJECT
+
+    /**
+     * @brief The connector to use
+     */
+    Q_PROPERTY(QAlphaCloud::Connector *connector READ connector WRITE setConnector NOTIFY connectorChanged REQUIRED)
+
+    /**
+     * @brief The request group
+     *
+     * Optional. Requests are sent as part of this group
+     * so that they can be canceled together with others.
+     *
+     * As instances querying the same storage system share a single request,
+     * it is only aborted once the groups of all of them have been canceled.
+     */
+    Q_PROPERTY(QAlphaCloud::RequestGroup *requestGroup READ requestGroup WRITE setRequestGroup NOTIFY requestGroupChanged)
+
+    /**
+     * @brief The serial number
+     *
+     * The serial number of the storage system whose data should be queried.
+     */
+    Q_PROPERTY(QString serialNumber READ serialNumber WRITE setSerialNumber NOTIFY serialNumberChanged REQUIRED)
+
+    /**
+     * @brief Cache data
+     *
+     * Whether to use cached data, default is true.
+     */
+    Q_PROPERTY(bool cached READ cached WRITE setCached NOTIFY cachedChanged)
+
+    /**
+     * @brief Whether the battery is charged from the grid
+     *
+     * During the configured charge periods.
+     */
+    Q_PROPERTY(bool gridChargeEnabled READ gridChargeEnabled NOTIFY gridChargeEnabledChanged)
+    /**
+     * @brief Charge limit in percent
+     *
+     * The state of charge up to which the battery is charged.
+     */
+    Q_PROPERTY(qreal chargeLimit READ chargeLimit NOTIFY chargeLimitChanged)
+
+    /**
+     * @brief Start of the first charge period
+     */
+    Q_PROPERTY(QTime period1Start READ period1Start NOTIFY period1StartChanged)
+    /**
+     * @brief End of the first charge period
+     */
+    Q_PROPERTY(QTime period1End READ period1End NOTIFY period1EndChanged)
+    /**
+     * @brief Start of the second charge period
+     */
+    Q_PROPERTY(QTime period2Start READ period2Start NOTIFY period2StartChanged)
+    /**
+     * @brief End of the second charge period
+     */
+    Q_PROPERTY(QTime period2End READ period2End NOTIFY period2EndChanged)
+
+    /**
+     * @brief Raw JSON
+     *
+     * The raw JSON returned by the API, useful for extracting data
+     * that isn't provided through the API yet.
+     */
+    Q_PROPERTY(QJsonObject rawJson READ rawJson NOTIFY rawJsonChanged)
+
+    /**
+     * @brief Whether this object contains data
+     *
+     * This is independent of the status. The status can be QAlphaCloud::Error
+     * when a subsequent request fails but any data isn't cleared unless
+     * new data is loaded successfully.
+     */
+    Q_PROPERTY(bool valid READ valid NOTIFY validChanged STORED false)
+
+    /**
+     * @brief The current request status
+     */
+    Q_PROPERTY(QAlphaCloud::RequestStatus status READ status NOTIFY statusChanged)
+
+    /**
+     * @brief The error, if any
+     *
+     * There can still be valid data in this object from a previous
+     * successful request.
+     */
+    Q_PROPERTY(QAlphaCloud::ErrorCode error READ error NOTIFY errorChanged)
+    /**
+     * @brief The error string, if any
+     *
+     * @note Not every error code has an errorString associated with it.
+     */
+    Q_PROPERTY(QString errorString READ errorString NOTIFY errorStringChanged)
+
+public:
+    /**
+     * @brief Creates a ChargeConfigInfo instance
+     * @param parent The owner
+     *
+     * @note A connector and serialNumber must be set before requests can be made.
+     */
+    explicit ChargeConfigInfo(QObject *parent = nullptr);
+    /**
+     * @brief Creates a ChargeConfigInfo instance
+     * @param connector The connector
+     * @param serialNumber The serial number of the storage system whose data should be queried
+     * @param parent The owner
+     */
+    ChargeConfigInfo(Connector *connector, const QString &serialNumber, QObject *parent = nullptr);
+    ~ChargeConfigInfo() override;
+
+    Q_REQUIRED_RESULT Connector *connector() const;
+    void setConnector(Connector *connector);
+    Q_SIGNAL void connectorChanged(Connector *connector);
+
+    Q_REQUIRED_RESULT QAlphaCloud::RequestGroup *requestGroup() const;
+    void setRequestGroup(QAlphaCloud::RequestGroup *requestGroup);
+    Q_SIGNAL void requestGroupChanged(QAlphaCloud::RequestGroup *requestGroup);
+
+    Q_REQUIRED_RESULT QString serialNumber() const;
+    void setSerialNumber(const QString &serialNumber);
+    Q_SIGNAL void serialNumberChanged(const QString &serialNumber);
+
+    Q_REQUIRED_RESULT bool cached() const;
+    void setCached(bool cached);
+    Q_SIGNAL void cachedChanged(bool cached);
+
+    Q_REQUIRED_RESULT bool gridChargeEnabled() const;
+    Q_SIGNAL void gridChargeEnabledChanged(bool gridChargeEnabled);
+
+    Q_REQUIRED_RESULT qreal chargeLimit() const;
+    Q_SIGNAL void chargeLimitChanged(qreal chargeLimit);
+
+    Q_REQUIRED_RESULT QTime period1Start() const;
+    Q_SIGNAL void period1StartChanged(const QTime &period1Start);
+
+    Q_REQUIRED_RESULT QTime period1End() const;
+    Q_SIGNAL void period1EndChanged(const QTime &period1End);
+
+    Q_REQUIRED_RESULT QTime period2Start() const;
+    Q_SIGNAL void period2StartChanged(const QTime &period2Start);
+
+    Q_REQUIRED_RESULT QTime period2End() const;
+    Q_SIGNAL void period2EndChanged(const QTime &period2End);
+
+    Q_REQUIRED_RESULT QJsonObject rawJson() const;
+    Q_SIGNAL void rawJsonChanged();
+
+    Q_REQUIRED_RESULT bool valid() const;
+    Q_SIGNAL void validChanged(bool valid);
+
+    Q_REQUIRED_RESULT QAlphaCloud::RequestStatus status() const;
+    Q_SIGNAL void statusChanged(QAlphaCloud::RequestStatus status);
+
+    QAlphaCloud::ErrorCode error() const;
+    Q_SIGNAL void errorChanged(QAlphaCloud::ErrorCode error);
+
+    QString errorString() const;
+    Q_SIGNAL void errorStringChanged(const QString &errorString);
+
+public Q_SLOTS:
+    /**
+     * @brief (Re)load data
+     *
+     * In QML, this is done automatically on component completion if the
+     * @a active property (not documented here) is true, which is the default.
+     *
+     * When fresh data is cached, it is used right away without sending a request.
+     *
+     * @return Whether the request was sent.
+     *
+     * @note You must set a connector and a serialNumber before requests can be sent.
+     *
+     * @note When the request fails, the current data is not cleared.
+     */
+    bool reload();
+    /**
+     * @brief Force a reload
+     *
+     * Reloads the data, ignoring the cache.
+     *
+     * @return Whether the request was sent.
+     */
+    bool forceReload();
+    /**
+     * @brief Reset object
+     *
+     * This clears all data and resets the object back to its initial state.
+     */
+    void reset();
+
+private:
+    std::unique_ptr<ChargeConfigInfoPrivate> const d;
+};
+
+} // namespace QAlphaCloud
@@ -0,0 +1,258 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <QCoreApplication>
+#include <QJsonObject>
+#include <QNetworkReply>
+#include <QPointer>
+#include <QString>
+
+#include "configinfostore_p.h"
+#include "qalphacloud.h"
+#include "qalphacloud_log.h"
+#include "requestgroup.h"
+
+namespace QAlphaCloud
+{
+
+class Connector;
+
+/**
+ * Common plumbing of ChargeConfigInfo and DischargeConfigInfo.
+ *
+ * Handles status, error, connector, and serial number, and talks to the ConfigInfoStore.
+ * Subclasses only parse their fields in processFields().
+ */
+template<typename Public>
+class ConfigInfoPrivate
+{
+public:
+    ConfigInfoPrivate(Public *q, const QString &endPoint)
+        : q(q)
+        , m_endPoint(endPoint)
+    {
+    }
+    virtual ~ConfigInfoPrivate() = default;
+
+    QString key() const
+    {
+        return ConfigInfoStore::key(m_connector, m_endPoint, m_serialNumber);
+    }
+
+    void connectStore()
+    {
+        auto *store = ConfigInfoStore::instance();
+
+        // The store also delivers results of requests made by other instances, and of retries.
+        QObject::connect(store, &ConfigInfoStore::result, q, [this](const QString &key, const QJsonObject &data) {
+            if (m_status == RequestStatus::NoRequest || key != this->key()) {
+                return;
+            }
+            // Nobody is interested in it anymore.
+            if (m_requestGroup && m_requestGroup->canceled()) {
+                return;
+            }
+
+            setError(ErrorCode::NoError);
+            setErrorString(QString());
+            processApiResult(data);
+        });
+
+        QObject::connect(store, &ConfigInfoStore::errorOccurred, q, [this](const QString &key, ErrorCode error, const QString &errorString) {
+            if (m_status != RequestStatus::Loading || key != this->key()) {
+                return;
+            }
+
+            setError(error);
+            setErrorString(errorString);
+            setStatus(RequestStatus::Error);
+        });
+    }
+
+    void setConnector(Connector *connector)
+    {
+        if (m_connector == connector) {
+            return;
+        }
+
+        m_connector = connector;
+        reset();
+        Q_EMIT q->connectorChanged(connector);
+    }
+
+    void setRequestGroup(RequestGroup *requestGroup)
+    {
+        if (m_requestGroup == requestGroup) {
+            return;
+        }
+
+        QObject::disconnect(m_requestGroupConnection);
+        m_requestGroup = requestGroup;
+
+        if (requestGroup) {
+            // The shared request may still be needed by others, so just stop waiting for it.
+            m_requestGroupConnection = QObject::connect(requestGroup, &RequestGroup::canceledChanged, q, [this](bool canceled) {
+                if (canceled && m_status == RequestStatus::Loading) {
+                    setCanceledError();
+                }
+            });
+        }
+
+        Q_EMIT q->requestGroupChanged(requestGroup);
+    }
+
+    void setCanceledError()
+    {
+        if (m_requestGroup && m_requestGroup->deadlineExceeded()) {
+            setError(ErrorCode::DeadlineExceededError);
+            setErrorString(errorText(ErrorCode::DeadlineExceededError));
+        } else {
+            setError(static_cast<ErrorCode>(QNetworkReply::OperationCanceledError));
+            setErrorString(QCoreApplication::translate("QNetworkReply", "Operation canceled"));
+        }
+        setStatus(RequestStatus::Error);
+    }
+
+    void setSerialNumber(const QString &serialNumber)
+    {
+        if (m_serialNumber == serialNumber) {
+            return;
+        }
+
+        m_serialNumber = serialNumber;
+        reset();
+        Q_EMIT q->serialNumberChanged(serialNumber);
+    }
+
+    void setCached(bool cached)
+    {
+        if (m_cached == cached) {
+            return;
+        }
+
+        m_cached = cached;
+        Q_EMIT q->cachedChanged(cached);
+    }
+
+    void setStatus(RequestStatus status)
+    {
+        if (m_status != status) {
+            m_status = status;
+            Q_EMIT q->statusChanged(status);
+        }
+    }
+
+    void setError(ErrorCode error)
+    {
+        if (m_error != error) {
+            m_error = error;
+            Q_EMIT q->errorChanged(error);
+        }
+    }
+
+    void setErrorString(const QString &errorString)
+    {
+        if (m_errorString != errorString) {
+            m_errorString = errorString;
+            Q_EMIT q->errorStringChanged(errorString);
+        }
+    }
+
+    void processApiResult(const QJsonObject &json)
+    {
+        const bool valid = processFields(json);
+
+        if (m_json != json) {
+            m_json = json;
+            Q_EMIT q->rawJsonChanged();
+        }
+
+        if (m_valid != valid) {
+            m_valid = valid;
+            Q_EMIT q->validChanged(valid);
+        }
+
+        setStatus(RequestStatus::Finished);
+    }
+
+    bool reload()
+    {
+        if (!m_connector) {
+            qCWarning(QALPHACLOUD_LOG) << "Cannot load" << Public::staticMetaObject.className() << "without a connector";
+            return false;
+        }
+
+        if (m_serialNumber.isEmpty()) {
+            qCWarning(QALPHACLOUD_LOG) << "Cannot load" << Public::staticMetaObject.className() << "without a serial number";
+            return false;
+        }
+
+        auto *store = ConfigInfoStore::instance();
+
+        if (m_cached) {
+            const auto cachedData = store->cachedData(key());
+            if (!cachedData.isEmpty()) {
+                setError(ErrorCode::NoError);
+                setErrorString(QString());
+                processApiResult(cachedData);
+                return true;
+            }
+        }
+
+        if (m_requestGroup && m_requestGroup->canceled()) {
+            qCDebug(QALPHACLOUD_LOG) << "Not loading" << Public::staticMetaObject.className() << "as its request group was canceled";
+            return false;
+        }
+
+        const bool ok = store->fetch(m_connector, m_endPoint, m_serialNumber, m_requestGroup);
+
+        if (ok) {
+            setStatus(RequestStatus::Loading);
+        }
+
+        return ok;
+    }
+
+    bool forceReload()
+    {
+        if (m_connector && !m_serialNumber.isEmpty()) {
+            ConfigInfoStore::instance()->invalidate(key());
+        }
+        return reload();
+    }
+
+    void reset()
+    {
+        processApiResult(QJsonObject());
+        setStatus(RequestStatus::NoRequest);
+    }
+
+    Public *const q;
+
+    // TODO QPointer?
+    Connector *m_connector = nullptr;
+    QPointer<RequestGroup> m_requestGroup;
+    QMetaObject::Connection m_requestGroupConnection;
+    QString m_serialNumber;
+    bool m_cached = true;
+
+    QJsonObject m_json;
+    RequestStatus m_status = RequestStatus::NoRequest;
+    ErrorCode m_error = ErrorCode::NoError;
+    QString m_errorString;
+
+    bool m_valid = false;
+
+protected:
+    // Updates the fields from the given JSON, returns whether it contained any valid data.
+    virtual bool processFields(const QJsonObject &json) = 0;
+
+private:
+    const QString m_endPoint;
+};
+
+} // namespace QAlphaCloud
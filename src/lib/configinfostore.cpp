@@ -0,0 +1,293 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "configinfostore_p.h"
+
+#include "apirequest.h"
+#include "connector.h"
+#include "connector_p.h"
+#include "qalphacloud_log.h"
+#include "requestgroup.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QJsonDocument>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QNetworkReply>
+#include <QStandardPaths>
+#include <QThreadStorage>
+#include <QTimer>
+
+#include <algorithm>
+
+namespace QAlphaCloud
+{
+
+// The configuration is changed rarely and only by the user.
+static constexpr qint64 s_timeToLive = 6 * 60 * 60 * 1000; // 6 hours.
+static constexpr int s_initialRetryDelay = 30 * 1000; // ms
+static constexpr int s_maximumRetryDelay = 60 * 60 * 1000; // 1 hour.
+static constexpr int s_maximumRetries = 8;
+
+// Every thread gets its own store since its requests and timers are bound to it.
+static QThreadStorage<ConfigInfoStore *> s_configInfoStore;
+// Guards the cache file which is shared by all of them.
+static QMutex s_cacheFileMutex;
+
+ConfigInfoStore::ConfigInfoStore() = default;
+
+ConfigInfoStore::~ConfigInfoStore() = default;
+
+ConfigInfoStore *ConfigInfoStore::instance()
+{
+    if (!s_configInfoStore.hasLocalData()) {
+        s_configInfoStore.setLocalData(new ConfigInfoStore);
+    }
+    return s_configInfoStore.localData();
+}
+
+QString ConfigInfoStore::key(Connector *connector, const QString &endPoint, const QString &serialNumber)
+{
+    QString appId;
+    if (connector) {
+        appId = ConnectorPrivate::get(connector)->configurationSnapshot().appId();
+    }
+    return appId + QLatin1Char('/') + endPoint + QLatin1Char('/') + serialNumber;
+}
+
+QString ConfigInfoStore::cachePath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QLatin1String("/qalphacloud_configinfo.json");
+}
+
+void ConfigInfoStore::loadFromCache()
+{
+    m_cacheLoaded = true;
+
+    const QString path = cachePath();
+
+    QMutexLocker locker(&s_cacheFileMutex);
+
+    QFile cacheFile(path);
+    if (!cacheFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        // Not a warning, cache may just not exist.
+        qCDebug(QALPHACLOUD_LOG) << "Failed to open config info cache" << path << "for reading" << cacheFile.errorString();
+        return;
+    }
+
+    QJsonParseError error;
+    const QJsonDocument doc = QJsonDocument::fromJson(cacheFile.readAll(), &error);
+    if (error.error != QJsonParseError::NoError) {
+        qCWarning(QALPHACLOUD_LOG) << "Failed to parse config info cache" << error.errorString();
+        return;
+    }
+
+    const QJsonObject entries = doc.object();
+    for (auto it = entries.begin(), end = entries.end(); it != end; ++it) {
+        const QJsonObject entryJson = it.value().toObject();
+
+        Entry &entry = m_entries[it.key()];
+        // Don't override anything we fetched in the meantime.
+        if (entry.fetchTime == 0) {
+            entry.data = entryJson.value(QStringLiteral("data")).toObject();
+            entry.fetchTime = static_cast<qint64>(entryJson.value(QStringLiteral("fetchTime")).toDouble());
+        }
+    }
+
+    qCDebug(QALPHACLOUD_LOG) << "Loaded config info cache from" << path;
+}
+
+void ConfigInfoStore::writeToCache()
+{
+    QJsonObject entries;
+    for (auto it = m_entries.cbegin(), end = m_entries.cend(); it != end; ++it) {
+        if (it->fetchTime == 0 || it->data.isEmpty()) {
+            continue;
+        }
+
+        entries.insert(it.key(),
+                       QJsonObject{
+                           {QStringLiteral("data"), it->data},
+                           {QStringLiteral("fetchTime"), static_cast<double>(it->fetchTime)},
+                       });
+    }
+
+    const QString path = cachePath();
+
+    QMutexLocker locker(&s_cacheFileMutex);
+
+    QFile cacheFile(path);
+    if (!cacheFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qCWarning(QALPHACLOUD_LOG) << "Failed to open config info cache" << path << "for writing" << cacheFile.errorString();
+        return;
+    }
+
+    const QByteArray data = QJsonDocument(entries).toJson(QJsonDocument::Compact);
+    if (cacheFile.write(data) != data.size()) {
+        qCWarning(QALPHACLOUD_LOG) << "Failed to write config info cache data";
+        return;
+    }
+
+    qCDebug(QALPHACLOUD_LOG) << "Cached config info to" << path;
+}
+
+QJsonObject ConfigInfoStore::cachedData(const QString &key)
+{
+    if (!m_cacheLoaded) {
+        loadFromCache();
+    }
+
+    const auto it = m_entries.constFind(key);
+    if (it == m_entries.constEnd() || it->fetchTime == 0) {
+        return {};
+    }
+
+    if (QDateTime::currentMSecsSinceEpoch() - it->fetchTime > s_timeToLive) {
+        return {};
+    }
+
+    return it->data;
+}
+
+bool ConfigInfoStore::fetch(Connector *connector, const QString &endPoint, const QString &serialNumber, RequestGroup *requestGroup)
+{
+    const QString key = ConfigInfoStore::key(connector, endPoint, serialNumber);
+
+    Entry &entry = m_entries[key];
+    if (entry.request) {
+        // Someone else asked for it already, they'll all get the result.
+        addWaiter(key, requestGroup);
+        return true;
+    }
+
+    auto *request = new ApiRequest(connector, endPoint);
+    request->setSysSn(serialNumber);
+
+    // The connector could go away while we wait for a retry.
+    QPointer<Connector> guardedConnector = connector;
+
+    connect(request, &ApiRequest::errorOccurred, this, [this, request, key, guardedConnector, endPoint, serialNumber] {
+        Q_EMIT errorOccurred(key, request->error(), request->errorString());
+
+        const ErrorCode error = request->error();
+        // Only retry errors that may go away on their own, not when nobody wanted it anymore.
+        const bool canceled = error == static_cast<ErrorCode>(QNetworkReply::OperationCanceledError);
+        const bool transient = !canceled && (static_cast<int>(error) < 1000 || error == ErrorCode::TooManyRequests || error == ErrorCode::SystemOffline);
+        if (transient && guardedConnector) {
+            scheduleRetry(key, guardedConnector, endPoint, serialNumber);
+        }
+    });
+
+    connect(request, &ApiRequest::result, this, [this, request, key] {
+        Entry &entry = m_entries[key];
+        entry.data = request->data().toObject();
+        entry.fetchTime = QDateTime::currentMSecsSinceEpoch();
+        entry.retryCount = 0;
+
+        writeToCache();
+
+        Q_EMIT result(key, entry.data);
+    });
+
+    if (!request->send()) {
+        return false;
+    }
+
+    entry.request = request;
+    entry.requestGroups.clear();
+    entry.ungrouped = false;
+    addWaiter(key, requestGroup);
+    return true;
+}
+
+void ConfigInfoStore::addWaiter(const QString &key, RequestGroup *requestGroup)
+{
+    Entry &entry = m_entries[key];
+
+    if (!requestGroup) {
+        entry.ungrouped = true;
+        return;
+    }
+
+    if (entry.requestGroups.contains(requestGroup)) {
+        return;
+    }
+    entry.requestGroups.append(requestGroup);
+
+    // Bound to the request, so it goes away once it's finished.
+    connect(requestGroup, &RequestGroup::canceledChanged, entry.request, [this, key](bool canceled) {
+        if (canceled) {
+            abortIfUnwanted(key);
+        }
+    });
+    // Destroying a group cancels its requests, too.
+    connect(requestGroup, &QObject::destroyed, entry.request, [this, key] {
+        abortIfUnwanted(key);
+    });
+}
+
+void ConfigInfoStore::abortIfUnwanted(const QString &key)
+{
+    const auto it = m_entries.constFind(key);
+    if (it == m_entries.constEnd() || !it->request || it->ungrouped) {
+        return;
+    }
+
+    const bool wanted = std::any_of(it->requestGroups.cbegin(), it->requestGroups.cend(), [](const QPointer<RequestGroup> &requestGroup) {
+        return requestGroup && !requestGroup->canceled();
+    });
+    if (wanted) {
+        return;
+    }
+
+    qCDebug(QALPHACLOUD_LOG) << "Aborting request for" << key << "as the request groups of everyone waiting for it were canceled";
+    it->request->abort();
+}
+
+bool ConfigInfoStore::isFetching(const QString &key) const
+{
+    const auto it = m_entries.constFind(key);
+    return it != m_entries.constEnd() && (it->request || it->retryPending);
+}
+
+void ConfigInfoStore::invalidate(const QString &key)
+{
+    auto it = m_entries.find(key);
+    if (it != m_entries.end()) {
+        it->fetchTime = 0;
+    }
+}
+
+void ConfigInfoStore::scheduleRetry(const QString &key, Connector *connector, const QString &endPoint, const QString &serialNumber)
+{
+    Entry &entry = m_entries[key];
+    if (entry.retryPending) {
+        return;
+    }
+
+    if (entry.retryCount >= s_maximumRetries) {
+        qCWarning(QALPHACLOUD_LOG) << "Giving up on fetching" << endPoint << "for" << serialNumber;
+        entry.retryCount = 0;
+        return;
+    }
+
+    const int delay = std::min(s_maximumRetryDelay, s_initialRetryDelay << entry.retryCount);
+    ++entry.retryCount;
+    entry.retryPending = true;
+
+    qCDebug(QALPHACLOUD_LOG) << "Retrying" << endPoint << "for" << serialNumber << "in" << delay << "ms";
+
+    QPointer<Connector> guardedConnector = connector;
+    QTimer::singleShot(delay, this, [this, key, guardedConnector, endPoint, serialNumber] {
+        m_entries[key].retryPending = false;
+        // Someone might have fetched it successfully in the meantime.
+        if (guardedConnector && cachedData(key).isEmpty()) {
+            fetch(guardedConnector, endPoint, serialNumber);
+        }
+    });
+}
+
+} // namespace QAlphaCloud
@@ -0,0 +1,84 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <QHash>
+#include <QJsonObject>
+#include <QObject>
+#include <QPointer>
+#include <QVector>
+
+#include "qalphacloud.h"
+
+namespace QAlphaCloud
+{
+
+class ApiRequest;
+class Connector;
+class RequestGroup;
+
+/**
+ * Shared storage for the charge and discharge configuration.
+ *
+ * The configuration rarely changes, so it is cached for a long time, also on disk.
+ * Concurrent requests for the same system are coalesced into one and failed requests
+ * are retried with an increasing delay.
+ *
+ * Data is keyed by App ID, endpoint, and serial number.
+ */
+class ConfigInfoStore : public QObject
+{
+    Q_OBJECT
+
+public:
+    ConfigInfoStore();
+    ~ConfigInfoStore() override;
+
+    static ConfigInfoStore *instance();
+
+    static QString key(Connector *connector, const QString &endPoint, const QString &serialNumber);
+
+    // Returns the cached data if it hasn't expired yet, an empty object otherwise.
+    QJsonObject cachedData(const QString &key);
+
+    // Fetches data unless a request for it is already in-flight.
+    // The request is only aborted once all request groups waiting for it have been canceled,
+    // never if anyone waits for it without a group.
+    bool fetch(Connector *connector, const QString &endPoint, const QString &serialNumber, RequestGroup *requestGroup = nullptr);
+    bool isFetching(const QString &key) const;
+
+    void invalidate(const QString &key);
+
+Q_SIGNALS:
+    void result(const QString &key, const QJsonObject &data);
+    void errorOccurred(const QString &key, QAlphaCloud::ErrorCode error, const QString &errorString);
+
+private:
+    struct Entry {
+        QJsonObject data;
+        qint64 fetchTime = 0; // ms since epoch
+        QPointer<ApiRequest> request;
+        // Who is waiting for the request.
+        QVector<QPointer<RequestGroup>> requestGroups;
+        bool ungrouped = false;
+        int retryCount = 0;
+        bool retryPending = false;
+    };
+
+    static QString cachePath();
+    void loadFromCache();
+    void writeToCache();
+
+    void addWaiter(const QString &key, RequestGroup *requestGroup);
+    void abortIfUnwanted(const QString &key);
+
+    void scheduleRetry(const QString &key, Connector *connector, const QString &endPoint, const QString &serialNumber);
+
+    QHash<QString, Entry> m_entries;
+    bool m_cacheLoaded = false;
+};
+
+} // namespace QAlphaCloud
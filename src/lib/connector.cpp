@@ -4,19 +4,452 @@
  */
 
 #include "connector.h"
+#include "connector_p.h"
 
 #include "qalphacloud_log.h"
 
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QPointer>
+#include <QThread>
+#include <QThreadStorage>
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 3, 0)
+#include <QNetworkInformation>
+#elif QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+#include <QNetworkConfigurationManager>
+#endif
+
+#include <algorithm>
+#include <cmath>
+
 namespace QAlphaCloud
 {
 
-class ConnectorPrivate
+class ConfigurationSnapshot::Data : public QSharedData
 {
 public:
-    Configuration *configuration = nullptr;
-    QNetworkAccessManager *networkAccessManager = nullptr;
+    bool null = true;
+    bool valid = false;
+    QUrl apiUrl;
+    QString appId;
+    QString appSecret;
+    int requestTimeout = 0;
 };
 
+ConfigurationSnapshot::ConfigurationSnapshot()
+    : d(new Data)
+{
+}
+
+ConfigurationSnapshot::ConfigurationSnapshot(const Configuration *configuration)
+    : d(new Data)
+{
+    if (configuration) {
+        d->null = false;
+        d->valid = configuration->valid();
+        d->apiUrl = configuration->apiUrl();
+        d->appId = configuration->appId();
+        d->appSecret = configuration->appSecret();
+        d->requestTimeout = configuration->requestTimeout();
+    }
+}
+
+ConfigurationSnapshot::ConfigurationSnapshot(const ConfigurationSnapshot &other) = default;
+ConfigurationSnapshot &ConfigurationSnapshot::operator=(const ConfigurationSnapshot &other) = default;
+ConfigurationSnapshot::~ConfigurationSnapshot() = default;
+
+bool ConfigurationSnapshot::isNull() const
+{
+    return d->null;
+}
+
+bool ConfigurationSnapshot::valid() const
+{
+    return d->valid;
+}
+
+QUrl ConfigurationSnapshot::apiUrl() const
+{
+    return d->apiUrl;
+}
+
+QString ConfigurationSnapshot::appId() const
+{
+    return d->appId;
+}
+
+QString ConfigurationSnapshot::appSecret() const
+{
+    return d->appSecret;
+}
+
+int ConfigurationSnapshot::requestTimeout() const
+{
+    return d->requestTimeout;
+}
+
+// The latency of the last this many successful requests per endpoint is considered.
+static constexpr int s_latencySamples = 50;
+// Don't hedge before we have a rough idea of how long requests usually take.
+static constexpr int s_minimumLatencySamples = 10;
+static constexpr qint64 s_minimumHedgeDelay = 100; // ms
+// Send at most one duplicate request for every 20 requests.
+static constexpr qreal s_hedgeBudgetPerRequest = 0.05;
+static constexpr qreal s_maximumHedgeBudget = 5.0;
+
+// Storage systems are considered unreachable after this many such errors in a row.
+static constexpr int s_circuitFailureThreshold = 3;
+static constexpr int s_circuitInitialOpenInterval = 60 * 1000; // ms
+static constexpr int s_circuitMaximumOpenInterval = 30 * 60 * 1000; // 30 minutes.
+static constexpr int s_lastDataCacheSize = 1024 * 1024; // bytes
+
+// Weight of a new measurement in the estimated offset to the server clock.
+static constexpr qreal s_clockOffsetSmoothing = 0.2;
+
+// When back online, send the requests held back one at a time, so as not to run into the API's rate limit.
+static constexpr int s_queuedRequestInterval = 250; // ms
+
+static bool isCircuitError(ErrorCode error)
+{
+    return error == ErrorCode::SystemOffline || error == ErrorCode::SystemSnDoesNotExist;
+}
+
+// Used on threads other than the one the assigned QNetworkAccessManager lives in.
+// QThreadStorage deletes it when the thread exits.
+static QThreadStorage<QNetworkAccessManager *> s_threadNetworkAccessManager;
+
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+QT_WARNING_PUSH
+QT_WARNING_DISABLE_DEPRECATED
+// Every QNetworkConfigurationManager makes the bearer plug-ins poll the network interfaces,
+// which can trigger Wi-Fi scans, so all connectors share one that is created on first use.
+// It stays around for as long as the application, even when no connector is left.
+// Only available on the main thread, connectors created elsewhere are always considered online.
+static QNetworkConfigurationManager *sharedConfigurationManager()
+{
+    static QPointer<QNetworkConfigurationManager> s_configurationManager;
+
+    if (!qApp || QThread::currentThread() != qApp->thread()) {
+        return nullptr;
+    }
+
+    if (!s_configurationManager) {
+        s_configurationManager = new QNetworkConfigurationManager(qApp);
+    }
+    return s_configurationManager;
+}
+QT_WARNING_POP
+#endif
+
+ConnectorPrivate *ConnectorPrivate::get(Connector *connector)
+{
+    return connector->d.get();
+}
+
+ConfigurationSnapshot ConnectorPrivate::configurationSnapshot() const
+{
+    QReadLocker locker(&lock);
+    return snapshot;
+}
+
+QNetworkAccessManager *ConnectorPrivate::networkAccessManagerForCurrentThread() const
+{
+    {
+        QReadLocker locker(&lock);
+        if (!networkAccessManager) {
+            return nullptr;
+        }
+
+        if (networkAccessManager->thread() == QThread::currentThread()) {
+            return networkAccessManager;
+        }
+    }
+
+    // QNetworkAccessManager cannot be used across threads.
+    if (!s_threadNetworkAccessManager.hasLocalData()) {
+        qCDebug(QALPHACLOUD_LOG) << "Creating QNetworkAccessManager for thread" << QThread::currentThread();
+        auto *networkAccessManager = new QNetworkAccessManager;
+        networkAccessManager->setRedirectPolicy(QNetworkRequest::NoLessSafeRedirectPolicy);
+        s_threadNetworkAccessManager.setLocalData(networkAccessManager);
+    }
+    return s_threadNetworkAccessManager.localData();
+}
+
+void ConnectorPrivate::updateConfigurationSnapshot()
+{
+    // Replace rather than modify it, requests in other threads may still hold on to the old one.
+    const ConfigurationSnapshot newSnapshot(configuration);
+
+    QWriteLocker locker(&lock);
+    snapshot = newSnapshot;
+}
+
+int ConnectorPrivate::hedgeDelay(const QString &endPoint) const
+{
+    {
+        QReadLocker locker(&lock);
+        if (!hedgeRequests) {
+            return -1;
+        }
+    }
+
+    QMutexLocker locker(&hedgeMutex);
+
+    const auto it = latencies.constFind(endPoint);
+    if (it == latencies.constEnd() || it->samples.count() < s_minimumLatencySamples) {
+        return -1;
+    }
+
+    // 95th percentile.
+    QVector<qint64> samples = it->samples;
+    const int index = std::min(samples.count() - 1, static_cast<int>(std::ceil(samples.count() * 0.95)) - 1);
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+
+    return static_cast<int>(std::max(s_minimumHedgeDelay, samples.at(index)));
+}
+
+qint64 ConnectorPrivate::typicalLatency(const QString &endPoint) const
+{
+    QMutexLocker locker(&hedgeMutex);
+
+    const auto it = latencies.constFind(endPoint);
+    if (it == latencies.constEnd() || it->samples.count() < s_minimumLatencySamples) {
+        return -1;
+    }
+
+    QVector<qint64> samples = it->samples;
+    const int index = samples.count() / 2;
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+
+    return samples.at(index);
+}
+
+void ConnectorPrivate::recordLatency(const QString &endPoint, qint64 elapsedTime)
+{
+    QMutexLocker locker(&hedgeMutex);
+
+    LatencyHistory &history = latencies[endPoint];
+    if (history.samples.count() < s_latencySamples) {
+        history.samples.append(elapsedTime);
+    } else {
+        history.samples[history.next] = elapsedTime;
+    }
+    history.next = (history.next + 1) % s_latencySamples;
+}
+
+void ConnectorPrivate::earnHedgeBudget()
+{
+    QMutexLocker locker(&hedgeMutex);
+    hedgeBudget = std::min(s_maximumHedgeBudget, hedgeBudget + s_hedgeBudgetPerRequest);
+}
+
+bool ConnectorPrivate::acquireHedgeBudget()
+{
+    QMutexLocker locker(&hedgeMutex);
+    if (hedgeBudget < 1.0) {
+        return false;
+    }
+
+    hedgeBudget -= 1.0;
+    return true;
+}
+
+bool ConnectorPrivate::circuitAllowsRequest(const QString &key, bool *probe)
+{
+    *probe = false;
+
+    QMutexLocker locker(&circuitMutex);
+
+    auto it = circuits.find(key);
+    if (it == circuits.end() || !it->open) {
+        return true;
+    }
+
+    if (it->probing || QDateTime::currentMSecsSinceEpoch() < it->retryTime) {
+        return false;
+    }
+
+    it->probing = true;
+    *probe = true;
+    return true;
+}
+
+void ConnectorPrivate::reportCircuitResult(const QString &key, bool probe, ErrorCode error, const QString &errorString)
+{
+    QMutexLocker locker(&circuitMutex);
+
+    auto it = circuits.find(key);
+
+    if (error == static_cast<ErrorCode>(QNetworkReply::OperationCanceledError) || error == ErrorCode::DeadlineExceededError) {
+        if (probe && it != circuits.end()) {
+            it->probing = false;
+        }
+        return;
+    }
+
+    if (error == ErrorCode::NoError) {
+        if (it != circuits.end()) {
+            if (it->open) {
+                qCDebug(QALPHACLOUD_LOG) << "Storage system for" << key << "is reachable again";
+            }
+            circuits.erase(it);
+        }
+        return;
+    }
+
+    if (!isCircuitError(error)) {
+        // Inconclusive, try again later.
+        if (probe && it != circuits.end()) {
+            it->probing = false;
+            it->retryTime = QDateTime::currentMSecsSinceEpoch() + it->openInterval;
+        }
+        return;
+    }
+
+    Circuit &circuit = circuits[key];
+    circuit.error = error;
+    circuit.errorString = errorString;
+
+    if (circuit.open) {
+        circuit.probing = false;
+        circuit.openInterval = std::min(s_circuitMaximumOpenInterval, circuit.openInterval * 2);
+        circuit.retryTime = QDateTime::currentMSecsSinceEpoch() + circuit.openInterval;
+        return;
+    }
+
+    ++circuit.failures;
+    if (circuit.failures >= s_circuitFailureThreshold) {
+        qCWarning(QALPHACLOUD_LOG) << "Storage system for" << key << "appears to be unreachable" << error << "checking less often";
+        circuit.open = true;
+        circuit.openInterval = s_circuitInitialOpenInterval;
+        circuit.retryTime = QDateTime::currentMSecsSinceEpoch() + circuit.openInterval;
+    }
+}
+
+ErrorCode ConnectorPrivate::circuitError(const QString &key, QString *errorString) const
+{
+    QMutexLocker locker(&circuitMutex);
+
+    const auto it = circuits.constFind(key);
+    if (it == circuits.constEnd()) {
+        return ErrorCode::NoError;
+    }
+
+    *errorString = it->errorString;
+    return it->error;
+}
+
+CircuitState ConnectorPrivate::circuitState(const QString &key) const
+{
+    QMutexLocker locker(&circuitMutex);
+
+    const auto it = circuits.constFind(key);
+    if (it == circuits.constEnd() || !it->open) {
+        return CircuitState::Closed;
+    }
+
+    if (it->probing || QDateTime::currentMSecsSinceEpoch() >= it->retryTime) {
+        return CircuitState::HalfOpen;
+    }
+
+    return CircuitState::Open;
+}
+
+void ConnectorPrivate::storeLastData(const QString &key, const QJsonValue &data, const QDate &date, int cost)
+{
+    QMutexLocker locker(&circuitMutex);
+    lastDataCache.insert(key, new LastData{data, date}, std::max(1, cost));
+}
+
+bool ConnectorPrivate::lastData(const QString &key, const QDate &date, QJsonValue *data) const
+{
+    QMutexLocker locker(&circuitMutex);
+
+    const LastData *cachedData = lastDataCache.object(key);
+    // Yesterday's energy is not today's.
+    if (!cachedData || cachedData->date != date) {
+        return false;
+    }
+
+    *data = cachedData->data;
+    return true;
+}
+
+qint64 ConnectorPrivate::serverSecsSinceEpoch() const
+{
+    QMutexLocker locker(&clockMutex);
+    return (QDateTime::currentMSecsSinceEpoch() + clockOffset) / 1000;
+}
+
+void ConnectorPrivate::recordServerDate(const QDateTime &serverDate, bool reset)
+{
+    // The Date header has a resolution of seconds, assume the middle of it.
+    const qint64 offset = serverDate.toMSecsSinceEpoch() + 500 - QDateTime::currentMSecsSinceEpoch();
+
+    QMutexLocker locker(&clockMutex);
+
+    if (reset || !clockOffsetKnown) {
+        clockOffset = offset;
+        clockOffsetKnown = true;
+        return;
+    }
+
+    // Smooth out network latency jitter.
+    clockOffset += qRound64((offset - clockOffset) * s_clockOffsetSmoothing);
+}
+
+bool ConnectorPrivate::enqueueRequest(ApiRequest *request, int priority, const std::function<void()> &send)
+{
+    QMutexLocker locker(&queueMutex);
+
+    if (online && !draining) {
+        return false;
+    }
+
+    // Behind all requests of the same priority.
+    const auto it = std::upper_bound(queuedRequests.begin(), queuedRequests.end(), priority, [](int priority, const QueuedRequest &queuedRequest) {
+        return priority < queuedRequest.priority;
+    });
+    queuedRequests.insert(it, QueuedRequest{request, priority, send});
+    return true;
+}
+
+void ConnectorPrivate::dequeueRequest(ApiRequest *request)
+{
+    QMutexLocker locker(&queueMutex);
+
+    queuedRequests.erase(std::remove_if(queuedRequests.begin(),
+                                        queuedRequests.end(),
+                                        [request](const QueuedRequest &queuedRequest) {
+                                            return queuedRequest.request == request;
+                                        }),
+                         queuedRequests.end());
+}
+
+void ConnectorPrivate::releaseQueuedRequest()
+{
+    QMutexLocker locker(&queueMutex);
+
+    if (!online) {
+        queueTimer.stop();
+        return;
+    }
+
+    if (queuedRequests.isEmpty()) {
+        draining = false;
+        queueTimer.stop();
+        return;
+    }
+
+    const QueuedRequest queuedRequest = queuedRequests.takeFirst();
+    // Still holding the lock, so the request cannot be destroyed before this is posted.
+    // Should it be destroyed afterwards, the pending call is discarded along with it.
+    QMetaObject::invokeMethod(queuedRequest.request, queuedRequest.send, Qt::QueuedConnection);
+}
+
 Connector::Connector(QObject *parent)
     : Connector(nullptr, parent)
 {
@@ -26,10 +459,45 @@ Connector::Connector(Configuration *configuration, QObject *parent)
     : QObject(parent)
     , d(std::make_unique<ConnectorPrivate>())
 {
-    d->configuration = configuration;
-    if (d->configuration) {
-        d->configuration->setParent(this);
+    d->lastDataCache.setMaxCost(s_lastDataCacheSize);
+
+    d->queueTimer.setInterval(s_queuedRequestInterval);
+    connect(&d->queueTimer, &QTimer::timeout, this, [this] {
+        d->releaseQueuedRequest();
+    });
+
+    // Signals are emitted across threads when requests are sent from a different thread.
+    qRegisterMetaType<QAlphaCloud::ErrorCode>();
+    qRegisterMetaType<QAlphaCloud::RequestStatus>();
+
+    if (configuration) {
+        configuration->setParent(this);
     }
+    setConfiguration(configuration);
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 3, 0)
+    if (QNetworkInformation::loadBackendByFeatures(QNetworkInformation::Feature::Reachability)) {
+        auto *networkInformation = QNetworkInformation::instance();
+        const auto updateOnline = [this, networkInformation] {
+            const auto reachability = networkInformation->reachability();
+            // Only a local network or captive portal isn't enough to reach the API.
+            setOnline(reachability == QNetworkInformation::Reachability::Online || reachability == QNetworkInformation::Reachability::Unknown);
+        };
+        connect(networkInformation, &QNetworkInformation::reachabilityChanged, this, updateOnline);
+        updateOnline();
+    }
+#elif QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+    QT_WARNING_PUSH
+    QT_WARNING_DISABLE_DEPRECATED
+    if (auto *configurationManager = sharedConfigurationManager()) {
+        connect(configurationManager, &QNetworkConfigurationManager::onlineStateChanged, this, &Connector::setOnline);
+        // Without a bearer backend, nothing is known about the network, don't claim to be offline then.
+        if (!configurationManager->allConfigurations().isEmpty()) {
+            setOnline(configurationManager->isOnline());
+        }
+    }
+    QT_WARNING_POP
+#endif
 }
 
 Connector::~Connector() = default;
@@ -52,7 +520,18 @@ void Connector::setConfiguration(Configuration *configuration)
     const bool oldValid = valid();
     d->configuration = configuration;
 
+    d->updateConfigurationSnapshot();
+
     if (d->configuration) {
+        const auto updateSnapshot = [this] {
+            d->updateConfigurationSnapshot();
+        };
+        connect(d->configuration, &Configuration::apiUrlChanged, this, updateSnapshot);
+        connect(d->configuration, &Configuration::appIdChanged, this, updateSnapshot);
+        connect(d->configuration, &Configuration::appSecretChanged, this, updateSnapshot);
+        connect(d->configuration, &Configuration::requestTimeoutChanged, this, updateSnapshot);
+        connect(d->configuration, &Configuration::validChanged, this, updateSnapshot);
+
         // TODO only emit if it effectively changed.
         connect(d->configuration, &Configuration::validChanged, this, &Connector::validChanged);
     }
@@ -66,12 +545,83 @@ void Connector::setConfiguration(Configuration *configuration)
 
 bool Connector::valid() const
 {
-    return d->configuration && d->configuration->valid() && d->networkAccessManager != nullptr;
+    QReadLocker locker(&d->lock);
+    return d->snapshot.valid() && d->networkAccessManager != nullptr;
+}
+
+bool Connector::hedgeRequests() const
+{
+    QReadLocker locker(&d->lock);
+    return d->hedgeRequests;
+}
+
+void Connector::setHedgeRequests(bool hedgeRequests)
+{
+    {
+        QWriteLocker locker(&d->lock);
+        if (d->hedgeRequests == hedgeRequests) {
+            return;
+        }
+        d->hedgeRequests = hedgeRequests;
+    }
+
+    Q_EMIT hedgeRequestsChanged(hedgeRequests);
+}
+
+bool Connector::useDaemon() const
+{
+    QReadLocker locker(&d->lock);
+    return d->useDaemon;
+}
+
+void Connector::setUseDaemon(bool useDaemon)
+{
+    {
+        QWriteLocker locker(&d->lock);
+        if (d->useDaemon == useDaemon) {
+            return;
+        }
+        d->useDaemon = useDaemon;
+    }
+
+    Q_EMIT useDaemonChanged(useDaemon);
+}
+
+bool Connector::online() const
+{
+    QMutexLocker locker(&d->queueMutex);
+    return d->online;
+}
+
+void Connector::setOnline(bool online)
+{
+    bool draining = false;
+    {
+        QMutexLocker locker(&d->queueMutex);
+        if (d->online == online) {
+            return;
+        }
+        d->online = online;
+        d->draining = online && !d->queuedRequests.isEmpty();
+        draining = d->draining;
+    }
+
+    if (online) {
+        if (draining) {
+            qCDebug(QALPHACLOUD_LOG) << "Back online, sending requests held back";
+            d->queueTimer.start();
+        }
+    } else {
+        qCDebug(QALPHACLOUD_LOG) << "Offline, holding back requests";
+        d->queueTimer.stop();
+    }
+
+    Q_EMIT onlineChanged(online);
 }
 
 QNetworkAccessManager *Connector::networkAccessManager() const
 {
-    return d->networkAccessManager;
+    return d->networkAccessManagerForCurrentThread();
 }
 
 void Connector::setNetworkAccessManager(QNetworkAccessManager *networkAccessManager)
@@ -81,7 +631,10 @@ void Connector::setNetworkAccessManager(QNetworkAccessManager *networkAccessMana
     }
 
     const bool oldValid = valid();
-    d->networkAccessManager = networkAccessManager;
+    {
+        QWriteLocker locker(&d->lock);
+        d->networkAccessManager = networkAccessManager;
+    }
 
     if (oldValid != valid()) {
         Q_EMIT validChanged(valid());
@@ -34,6 +34,10 @@ class ConnectorPrivate;
  *
  * In QML, the @a QNetworkAccessManager is automatically assigned from the
  * current QQmlEngine on component completion.
+ *
+ * A connector can be shared by objects living in different threads,
+ * e.g. to fetch data for many storage systems in parallel. Changing its
+ * configuration must still be done in the thread the connector lives in.
  */
 class QALPHACLOUD_EXPORT Connector : public QObject
 {
@@ -51,6 +55,65 @@ class QALPHACLOUD_EXPORT Connector : public QObject
      */
     Q_PROPERTY(bool valid READ valid NOTIFY validChanged)
 
+    /**
+     * @brief Whether to hedge slow requests
+     *
+     * When enabled, a request whose reply takes longer than 95 % of recent
+     * requests to the same endpoint did is sent a second time. Whichever
+     * reply arrives first is used and the other one is canceled.
+     *
+     * This avoids an occasional slow reply holding up the user interface.
+     * The duplicate requests are limited to a small share of all requests
+     * sent, so as not to run into the API's rate limit.
+     *
+     * Default is false.
+     */
+    Q_PROPERTY(bool hedgeRequests READ hedgeRequests WRITE setHedgeRequests NOTIFY hedgeRequestsChanged)
+
+    /**
+     * @brief Whether to fetch data through the session daemon
+     *
+     * When enabled, requests sent from the main thread are passed on to
+     * qalphacloud-daemon, if it is running or can be started, so that all
+     * applications in the session share its connection and cache.
+     *
+     * Disable this when the requests must actually reach the API, e.g. to
+     * measure its performance, or when bulk-fetching data that is of no use
+     * to anyone else.
+     *
+     * Has no effect when built without D-Bus support or when the
+     * @c QALPHACLOUD_NO_DAEMON environment variable is set.
+     *
+     * Default is true.
+     */
+    Q_PROPERTY(bool useDaemon READ useDaemon WRITE setUseDaemon NOTIFY useDaemonChanged)
+
+    /**
+     * @brief Whether the API can be reached
+     *
+     * While offline, no requests are sent. Instead, they are held back
+     * and objects don't reload automatically. When back online, the requests
+     * are sent in order of importance, e.g. live data before historic data,
+     * and spaced out so as not to run into the API's rate limit.
+     *
+     * Requests of a RequestGroup with a deadline fail once it is reached.
+     *
+     * Requests held back fail with QNetworkReply::TimeoutError when
+     * they couldn't be sent within the Configuration::requestTimeout.
+     *
+     * This is updated automatically based on the reachability reported by
+     * QNetworkInformation when built with Qt 6.3 or later, or by
+     * QNetworkConfigurationManager with Qt 5, if supported on the platform.
+     * With Qt 5, a single QNetworkConfigurationManager is shared by all
+     * connectors created on the main thread and kept until the application
+     * quits, as it makes the system check the network interfaces periodically.
+     * Connectors created on other threads aren't updated then.
+     * It can also be set manually, which is the only option with Qt 6.0 to 6.2.
+     *
+     * Default is true.
+     */
+    Q_PROPERTY(bool online READ online WRITE setOnline NOTIFY onlineChanged)
+
 public:
     explicit Connector(QObject *parent = nullptr);
     explicit Connector(Configuration *configuration, QObject *parent = nullptr);
@@ -63,6 +126,27 @@ public:
     Q_REQUIRED_RESULT bool valid() const;
     Q_SIGNAL void validChanged(bool valid);
 
+    Q_REQUIRED_RESULT bool hedgeRequests() const;
+    void setHedgeRequests(bool hedgeRequests);
+    Q_SIGNAL void hedgeRequestsChanged(bool hedgeRequests);
+
+    Q_REQUIRED_RESULT bool useDaemon() const;
+    void setUseDaemon(bool useDaemon);
+    Q_SIGNAL void useDaemonChanged(bool useDaemon);
+
+    Q_REQUIRED_RESULT bool online() const;
+    void setOnline(bool online);
+    Q_SIGNAL void onlineChanged(bool online);
+
+    /**
+     * @brief The QNetworkAccessManager for the calling thread
+     *
+     * This is the one assigned by setNetworkAccessManager() when called
+     * from the thread it lives in. Since a QNetworkAccessManager cannot be
+     * used across threads, every other thread gets its own.
+     *
+     * Returns null if none has been assigned.
+     */
     Q_REQUIRED_RESULT QNetworkAccessManager *networkAccessManager() const;
     /**
      * @brief Set the QNetworkAccessManager
@@ -76,7 +160,23 @@ public:
      */
     void setNetworkAccessManager(QNetworkAccessManager *networkAccessManager);
 
+    /**
+     * @brief Emitted when a request sent through this connector finished
+     *
+     * This is emitted for every request, successful or not, and can be used
+     * to collect statistics about the API usage.
+     *
+     * @param endPoint The API endpoint.
+     * @param error The error code, QAlphaCloud::ErrorCode::NoError on success.
+     * @param elapsedTime How long the request took in milliseconds.
+     * @param bytesReceived How many bytes were received.
+     *
+     * @note This is emitted from the thread the request was sent from.
+     */
+    Q_SIGNAL void requestFinished(const QString &endPoint, QAlphaCloud::ErrorCode error, qint64 elapsedTime, qint64 bytesReceived);
+
 private:
+    friend ConnectorPrivate;
     std::unique_ptr<ConnectorPrivate> const d;
 };
 
@@ -0,0 +1,171 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <QCache>
+#include <QDateTime>
+#include <QHash>
+#include <QJsonValue>
+#include <QMutex>
+#include <QReadWriteLock>
+#include <QSharedDataPointer>
+#include <QString>
+#include <QTimer>
+#include <QUrl>
+#include <QVector>
+
+#include <functional>
+
+#include "connector.h"
+#include "qalphacloud.h"
+
+class QNetworkAccessManager;
+
+namespace QAlphaCloud
+{
+
+class ApiRequest;
+
+/**
+ * Immutable copy of a Configuration.
+ *
+ * Unlike the Configuration itself, this can be read from any thread.
+ * Copies are cheap as they share the same data.
+ */
+class ConfigurationSnapshot
+{
+public:
+    ConfigurationSnapshot();
+    explicit ConfigurationSnapshot(const Configuration *configuration);
+    ConfigurationSnapshot(const ConfigurationSnapshot &other);
+    ConfigurationSnapshot &operator=(const ConfigurationSnapshot &other);
+    ~ConfigurationSnapshot();
+
+    // Whether it was created from a Configuration at all.
+    bool isNull() const;
+    bool valid() const;
+
+    QUrl apiUrl() const;
+    QString appId() const;
+    QString appSecret() const;
+    int requestTimeout() const;
+
+private:
+    class Data;
+    QSharedDataPointer<Data> d;
+};
+
+class ConnectorPrivate
+{
+public:
+    static ConnectorPrivate *get(Connector *connector);
+
+    // Thread-safe.
+    ConfigurationSnapshot configurationSnapshot() const;
+    QNetworkAccessManager *networkAccessManagerForCurrentThread() const;
+
+    void updateConfigurationSnapshot();
+
+    // Request hedging, see Connector::hedgeRequests. Thread-safe.
+    // How long to wait for a reply before sending the request again, -1 if it shouldn't be.
+    int hedgeDelay(const QString &endPoint) const;
+    void recordLatency(const QString &endPoint, qint64 elapsedTime);
+    // Median time in ms a request to the endpoint takes, -1 if unknown. Also used for RequestGroup deadlines.
+    qint64 typicalLatency(const QString &endPoint) const;
+    // Every request sent allows for a fraction of a duplicate request.
+    void earnHedgeBudget();
+    bool acquireHedgeBudget();
+
+    // Circuit breaker for storage systems that are offline. Thread-safe.
+    // Whether a request may be sent, if so, probe says whether it is the one request
+    // checking whether an open circuit can be closed again.
+    bool circuitAllowsRequest(const QString &key, bool *probe);
+    void reportCircuitResult(const QString &key, bool probe, ErrorCode error, const QString &errorString);
+    ErrorCode circuitError(const QString &key, QString *errorString) const;
+    CircuitState circuitState(const QString &key) const;
+
+    // Last known data of live endpoints served while the circuit is open. Thread-safe.
+    // Only the most recent data per circuit is kept, date is the query date it was for, if any.
+    // The cost is the size of its JSON in bytes.
+    void storeLastData(const QString &key, const QJsonValue &data, const QDate &date, int cost);
+    bool lastData(const QString &key, const QDate &date, QJsonValue *data) const;
+
+    // Clock of the API server, estimated from the Date header of its replies. Thread-safe.
+    // Requests are signed with this time, so a local clock that is off doesn't make them fail.
+    qint64 serverSecsSinceEpoch() const;
+    // Discards the previous estimate if reset is true, e.g. because the API rejected our time.
+    void recordServerDate(const QDateTime &serverDate, bool reset);
+
+    // Requests held back while offline, see Connector::online. Thread-safe.
+    // Returns false if the request should be sent right away instead.
+    // Otherwise, send is invoked in the thread of the request once it's its turn.
+    bool enqueueRequest(ApiRequest *request, int priority, const std::function<void()> &send);
+    void dequeueRequest(ApiRequest *request);
+    // Must be called from the thread the connector lives in.
+    void releaseQueuedRequest();
+
+    Configuration *configuration = nullptr;
+
+    // Guards the members below, which are read from other threads.
+    mutable QReadWriteLock lock;
+    ConfigurationSnapshot snapshot;
+    QNetworkAccessManager *networkAccessManager = nullptr;
+    bool hedgeRequests = false;
+    bool useDaemon = true;
+
+    struct LatencyHistory {
+        QVector<qint64> samples; // ms
+        int next = 0;
+    };
+
+    // Guards the members below.
+    mutable QMutex hedgeMutex;
+    QHash<QString, LatencyHistory> latencies;
+    qreal hedgeBudget = 0.0;
+
+    struct Circuit {
+        int failures = 0;
+        bool open = false;
+        bool probing = false;
+        qint64 retryTime = 0; // ms since epoch
+        int openInterval = 0; // ms
+        ErrorCode error = ErrorCode::NoError;
+        QString errorString;
+    };
+
+    struct LastData {
+        QJsonValue data;
+        QDate date;
+    };
+
+    // Guards the members below.
+    mutable QMutex circuitMutex;
+    QHash<QString, Circuit> circuits;
+    QCache<QString, LastData> lastDataCache;
+
+    // Guards the members below.
+    mutable QMutex clockMutex;
+    qint64 clockOffset = 0; // ms, server minus local time.
+    bool clockOffsetKnown = false;
+
+    struct QueuedRequest {
+        ApiRequest *request = nullptr;
+        int priority = 0; // lower is more important.
+        std::function<void()> send;
+    };
+
+    // Guards the members below.
+    mutable QMutex queueMutex;
+    bool online = true;
+    // After coming back online, new requests wait their turn, too, until the queue is empty.
+    bool draining = false;
+    QVector<QueuedRequest> queuedRequests; // sorted by priority.
+
+    // Only used from the thread the connector lives in.
+    QTimer queueTimer;
+};
+
+} // namespace QAlphaCloud
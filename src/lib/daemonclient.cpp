@@ -0,0 +1,158 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "daemonclient_p.h"
+
+#include "connector.h"
+#include "connector_p.h"
+#include "daemonprotocol_p.h"
+#include "qalphacloud_log.h"
+
+#include <QDBusConnection>
+#include <QDBusConnectionInterface>
+#include <QDBusError>
+#include <QDBusMessage>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
+#include <QDBusServiceWatcher>
+
+#include <limits>
+
+namespace QAlphaCloud
+{
+
+Q_GLOBAL_STATIC(DaemonClient, s_daemonClient)
+
+// How much longer than the request timeout to wait for the daemon to reply.
+static constexpr int s_callTimeoutMargin = 5000; // ms
+
+DaemonClient::DaemonClient()
+{
+    if (qEnvironmentVariableIsSet("QALPHACLOUD_NO_DAEMON")) {
+        return;
+    }
+
+    auto bus = QDBusConnection::sessionBus();
+    if (!bus.isConnected()) {
+        return;
+    }
+
+    m_watcher = new QDBusServiceWatcher(DaemonProtocol::serviceName(), bus, QDBusServiceWatcher::WatchForOwnerChange, this);
+    connect(m_watcher, &QDBusServiceWatcher::serviceOwnerChanged, this, [this](const QString &service, const QString &oldOwner, const QString &newOwner) {
+        Q_UNUSED(service);
+        Q_UNUSED(oldOwner);
+        m_running = !newOwner.isEmpty();
+        qCDebug(QALPHACLOUD_LOG) << "Daemon running changed to" << m_running.load();
+    });
+
+    bus.connect(DaemonProtocol::serviceName(),
+                DaemonProtocol::objectPath(),
+                DaemonProtocol::interfaceName(),
+                QStringLiteral("DataChanged"),
+                this,
+                SLOT(onDataChanged(QString, QString, QString, QByteArray)));
+
+    // Don't block, requests are sent directly until we know.
+    auto *watcher = new QDBusPendingCallWatcher(bus.interface()->asyncCall(QStringLiteral("NameHasOwner"), DaemonProtocol::serviceName()), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this](QDBusPendingCallWatcher *watcher) {
+        QDBusPendingReply<bool> reply = *watcher;
+        watcher->deleteLater();
+
+        if (!reply.isError()) {
+            m_running = reply.value();
+            qCDebug(QALPHACLOUD_LOG) << "Daemon running" << m_running.load();
+        }
+    });
+
+    auto *activatableWatcher = new QDBusPendingCallWatcher(bus.interface()->asyncCall(QStringLiteral("ListActivatableNames")), this);
+    connect(activatableWatcher, &QDBusPendingCallWatcher::finished, this, [this](QDBusPendingCallWatcher *watcher) {
+        QDBusPendingReply<QStringList> reply = *watcher;
+        watcher->deleteLater();
+
+        if (!reply.isError()) {
+            m_activatable = reply.value().contains(DaemonProtocol::serviceName());
+            qCDebug(QALPHACLOUD_LOG) << "Daemon activatable" << m_activatable.load();
+        }
+    });
+}
+
+DaemonClient::~DaemonClient() = default;
+
+DaemonClient *DaemonClient::instance()
+{
+    return s_daemonClient();
+}
+
+bool DaemonClient::available() const
+{
+    return m_running || m_activatable;
+}
+
+void DaemonClient::onDataChanged(const QString &endPoint, const QString &sysSn, const QString &queryDate, const QByteArray &data)
+{
+    Q_EMIT dataChanged(endPoint, sysSn, QDate::fromString(queryDate, Qt::ISODate), DaemonProtocol::decodeData(data));
+}
+
+void DaemonClient::fetch(Connector *connector,
+                         const QString &endPoint,
+                         const QString &sysSn,
+                         const QDate &queryDate,
+                         const QUrlQuery &query,
+                         QObject *context,
+                         const Callback &callback)
+{
+    const ConfigurationSnapshot configuration = ConnectorPrivate::get(connector)->configurationSnapshot();
+
+    QDBusMessage message = QDBusMessage::createMethodCall(DaemonProtocol::serviceName(),
+                                                          DaemonProtocol::objectPath(),
+                                                          DaemonProtocol::interfaceName(),
+                                                          QStringLiteral("Fetch"));
+    // The daemon only serves requests for the account it is configured with.
+    message.setArguments({
+        configuration.appId(),
+        configuration.apiUrl().toString(),
+        endPoint,
+        sysSn,
+        queryDate.isValid() ? queryDate.toString(Qt::ISODate) : QString(),
+        query.toString(QUrl::FullyEncoded),
+    });
+
+    // The daemon sends the request with the same timeout, give it some time on top to reply.
+    // Without a timeout the request could take forever, too, and so could the call.
+    const int requestTimeout = configuration.requestTimeout();
+    const int timeout = requestTimeout > 0 ? requestTimeout + s_callTimeoutMargin : std::numeric_limits<int>::max();
+
+    auto *watcher = new QDBusPendingCallWatcher(QDBusConnection::sessionBus().asyncCall(message, timeout), context);
+    connect(watcher, &QDBusPendingCallWatcher::finished, context, [this, callback](QDBusPendingCallWatcher *watcher) {
+        QDBusPendingReply<int, QString, QByteArray> reply = *watcher;
+        watcher->deleteLater();
+
+        Result result;
+
+        if (reply.isError()) {
+            qCDebug(QALPHACLOUD_LOG) << "Daemon failed to handle request, sending it directly" << reply.error().name() << reply.error().message();
+
+            // Don't try starting it for every request if that didn't work.
+            if (!m_running && (reply.error().type() == QDBusError::ServiceUnknown || reply.error().name().startsWith(QLatin1String("org.freedesktop.DBus.Error.Spawn")))) {
+                m_activatable = false;
+            }
+
+            callback(result);
+            return;
+        }
+
+        result.handled = true;
+        result.error = static_cast<QAlphaCloud::ErrorCode>(reply.argumentAt<0>());
+        result.errorString = reply.argumentAt<1>();
+
+        const QByteArray data = reply.argumentAt<2>();
+        result.bytesReceived = data.size();
+        result.data = DaemonProtocol::decodeData(data);
+
+        callback(result);
+    });
+}
+
+} // namespace QAlphaCloud
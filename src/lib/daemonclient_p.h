@@ -0,0 +1,86 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <QDate>
+#include <QJsonValue>
+#include <QObject>
+#include <QString>
+#include <QUrlQuery>
+
+#include <atomic>
+#include <functional>
+
+#include "qalphacloud.h"
+
+class QDBusServiceWatcher;
+
+namespace QAlphaCloud
+{
+
+class Connector;
+
+/**
+ * Talks to qalphacloud-daemon, if it is running.
+ *
+ * The daemon owns a single connection to the API for the entire session
+ * and shares the data it fetched between all applications, so that several
+ * applications showing the same data don't each poll the API on their own.
+ *
+ * If it isn't running, D-Bus starts it on the first request.
+ *
+ * Setting the QALPHACLOUD_NO_DAEMON environment variable disables this,
+ * Connector::useDaemon does so for an individual connector.
+ */
+class DaemonClient : public QObject
+{
+    Q_OBJECT
+
+public:
+    DaemonClient();
+    ~DaemonClient() override;
+
+    static DaemonClient *instance();
+
+    // Whether the daemon is running, or can be started on demand, and should be used.
+    bool available() const;
+
+    struct Result {
+        // When false, the daemon couldn't handle the request and it should be sent directly.
+        bool handled = false;
+        QAlphaCloud::ErrorCode error = QAlphaCloud::ErrorCode::NoError;
+        QString errorString;
+        QJsonValue data;
+        qint64 bytesReceived = 0;
+    };
+    using Callback = std::function<void(const Result &result)>;
+
+    // The callback is not called if context is destroyed.
+    void fetch(Connector *connector,
+               const QString &endPoint,
+               const QString &sysSn,
+               const QDate &queryDate,
+               const QUrlQuery &query,
+               QObject *context,
+               const Callback &callback);
+
+    // Emitted when the daemon fetched new data that is different from what it had before.
+    // The query date is invalid for endpoints that don't take one.
+    Q_SIGNAL void dataChanged(const QString &endPoint, const QString &sysSn, const QDate &queryDate, const QJsonValue &data);
+
+private:
+    Q_SLOT void onDataChanged(const QString &endPoint, const QString &sysSn, const QString &queryDate, const QByteArray &data);
+
+
+    QDBusServiceWatcher *m_watcher = nullptr;
+    // Read from any thread requests are sent from.
+    // Whether the daemon is currently running.
+    std::atomic_bool m_running{false};
+    // Whether D-Bus can start the daemon, cleared when that failed, e.g. as it isn't configured.
+    std::atomic_bool m_activatable{false};
+};
+
+} // namespace QAlphaCloud
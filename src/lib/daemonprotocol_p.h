@@ -0,0 +1,65 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QString>
+
+namespace QAlphaCloud
+{
+
+/**
+ * What DaemonClient and qalphacloud-daemon agree on.
+ *
+ * Header-only as the daemon is built against the public library API.
+ */
+namespace DaemonProtocol
+{
+
+inline QString serviceName()
+{
+    return QStringLiteral("de.broulik.qalphacloud");
+}
+
+inline QString objectPath()
+{
+    return QStringLiteral("/Data");
+}
+
+inline QString interfaceName()
+{
+    return QStringLiteral("de.broulik.qalphacloud.Data");
+}
+
+// The data is serialized as compact JSON, "null" if neither an object nor an array.
+inline QByteArray encodeData(const QJsonValue &data)
+{
+    if (data.isArray()) {
+        return QJsonDocument(data.toArray()).toJson(QJsonDocument::Compact);
+    } else if (data.isObject()) {
+        return QJsonDocument(data.toObject()).toJson(QJsonDocument::Compact);
+    }
+    return QByteArrayLiteral("null");
+}
+
+inline QJsonValue decodeData(const QByteArray &data)
+{
+    const QJsonDocument document = QJsonDocument::fromJson(data);
+    if (document.isArray()) {
+        return document.array();
+    } else if (document.isObject()) {
+        return document.object();
+    }
+    return QJsonValue(QJsonValue::Null);
+}
+
+} // namespace DaemonProtocol
+
+} // namespace QAlphaCloud
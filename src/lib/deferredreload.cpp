@@ -0,0 +1,53 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "deferredreload_p.h"
+
+namespace QAlphaCloud
+{
+
+DeferredReload::DeferredReload(const std::function<bool()> &reload)
+    : m_reload(reload)
+{
+    m_timer.setSingleShot(true);
+    m_timer.setInterval(0);
+    QObject::connect(&m_timer, &QTimer::timeout, &m_timer, [this] {
+        m_reload();
+    });
+}
+
+bool DeferredReload::schedule()
+{
+    if (m_timer.isActive()) {
+        ++m_suppressedCount;
+        return false;
+    }
+
+    m_timer.start();
+    return true;
+}
+
+bool DeferredReload::cancel()
+{
+    if (!m_timer.isActive()) {
+        return false;
+    }
+
+    m_timer.stop();
+    ++m_suppressedCount;
+    return true;
+}
+
+bool DeferredReload::isPending() const
+{
+    return m_timer.isActive();
+}
+
+int DeferredReload::suppressedCount() const
+{
+    return m_suppressedCount;
+}
+
+} // namespace QAlphaCloud
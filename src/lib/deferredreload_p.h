@@ -0,0 +1,43 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <QTimer>
+
+#include <functional>
+
+namespace QAlphaCloud
+{
+
+/**
+ * Folds reloads requested within the same event loop iteration into one.
+ *
+ * This way changing several properties in a row, e.g. serial number and date,
+ * results in a single request rather than one being sent and aborted for each.
+ */
+class DeferredReload
+{
+public:
+    explicit DeferredReload(const std::function<bool()> &reload);
+
+    // Returns false when a reload was already scheduled.
+    bool schedule();
+    // Drops a scheduled reload, e.g. because the object was reloaded in the meantime.
+    // Returns whether one was scheduled.
+    bool cancel();
+
+    bool isPending() const;
+
+    // How many reloads were folded into another one.
+    int suppressedCount() const;
+
+private:
+    std::function<bool()> m_reload;
+    QTimer m_timer;
+    int m_suppressedCount = 0;
+};
+
+} // namespace QAlphaCloud
@@ -0,0 +1,204 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "dischargeconfiginfo.h"
+
+#include "apirequest.h"
+#include "configinfo_p.h"
+#include "utils_p.h"
+
+namespace QAlphaCloud
+{
+
+class DischargeConfigInfoPrivate : public ConfigInfoPrivate<DischargeConfigInfo>
+{
+public:
+    explicit DischargeConfigInfoPrivate(DischargeConfigInfo *q);
+
+    bool m_dischargeControlEnabled = false; // ctrDis
+    qreal m_dischargeLimit = 0.0; // batUseCap
+    QTime m_period1Start; // timeDisf1
+    QTime m_period1End; // timeDise1
+    QTime m_period2Start; // timeDisf2
+    QTime m_period2End; // timeDise2
+
+protected:
+    bool processFields(const QJsonObject &json) override;
+};
+
+DischargeConfigInfoPrivate::DischargeConfigInfoPrivate(DischargeConfigInfo *q)
+    : ConfigInfoPrivate(q, ApiRequest::EndPoint::DischargeConfigInfo)
+{
+}
+
+bool DischargeConfigInfoPrivate::processFields(const QJsonObject &json)
+{
+    bool valid = false;
+
+    const auto dischargeControlValue = json.value(QStringLiteral("ctrDis"));
+    Utils::updateField(m_dischargeControlEnabled, dischargeControlValue.toInt() != 0, q, &DischargeConfigInfo::dischargeControlEnabledChanged);
+    valid = valid || (!dischargeControlValue.isUndefined() && !dischargeControlValue.isNull());
+
+    const auto dischargeLimitValue = json.value(QStringLiteral("batUseCap"));
+    Utils::updateField(m_dischargeLimit, dischargeLimitValue.toDouble(), q, &DischargeConfigInfo::dischargeLimitChanged);
+    valid = valid || (!dischargeLimitValue.isUndefined() && !dischargeLimitValue.isNull());
+
+    const QString timeFormat = QStringLiteral("HH:mm");
+
+    const QTime period1Start = QTime::fromString(json.value(QStringLiteral("timeDisf1")).toString(), timeFormat);
+    if (m_period1Start != period1Start) {
+        m_period1Start = period1Start;
+        Q_EMIT q->period1StartChanged(period1Start);
+    }
+
+    const QTime period1End = QTime::fromString(json.value(QStringLiteral("timeDise1")).toString(), timeFormat);
+    if (m_period1End != period1End) {
+        m_period1End = period1End;
+        Q_EMIT q->period1EndChanged(period1End);
+    }
+
+    const QTime period2Start = QTime::fromString(json.value(QStringLiteral("timeDisf2")).toString(), timeFormat);
+    if (m_period2Start != period2Start) {
+        m_period2Start = period2Start;
+        Q_EMIT q->period2StartChanged(period2Start);
+    }
+
+    const QTime period2End = QTime::fromString(json.value(QStringLiteral("timeDise2")).toString(), timeFormat);
+    if (m_period2End != period2End) {
+        m_period2End = period2End;
+        Q_EMIT q->period2EndChanged(period2End);
+    }
+
+    return valid;
+}
+
+DischargeConfigInfo::DischargeConfigInfo(QObject *parent)
+    : DischargeConfigInfo(nullptr, QString(), parent)
+{
+}
+
+DischargeConfigInfo::DischargeConfigInfo(Connector *connector, const QString &serialNumber, QObject *parent)
+    : QObject(parent)
+    , d(std::make_unique<DischargeConfigInfoPrivate>(this))
+{
+    d->m_connector = connector;
+    d->m_serialNumber = serialNumber;
+
+    d->connectStore();
+}
+
+DischargeConfigInfo::~DischargeConfigInfo() = default;
+
+Connector *DischargeConfigInfo::connector() const
+{
+    return d->m_connector;
+}
+
+void DischargeConfigInfo::setConnector(Connector *connector)
+{
+    d->setConnector(connector);
+}
+
+RequestGroup *DischargeConfigInfo::requestGroup() const
+{
+    return d->m_requestGroup;
+}
+
+void DischargeConfigInfo::setRequestGroup(RequestGroup *requestGroup)
+{
+    d->setRequestGroup(requestGroup);
+}
+
+QString DischargeConfigInfo::serialNumber() const
+{
+    return d->m_serialNumber;
+}
+
+void DischargeConfigInfo::setSerialNumber(const QString &serialNumber)
+{
+    d->setSerialNumber(serialNumber);
+}
+
+bool DischargeConfigInfo::cached() const
+{
+    return d->m_cached;
+}
+
+void DischargeConfigInfo::setCached(bool cached)
+{
+    d->setCached(cached);
+}
+
+bool DischargeConfigInfo::dischargeControlEnabled() const
+{
+    return d->m_dischargeControlEnabled;
+}
+
+qreal DischargeConfigInfo::dischargeLimit() const
+{
+    return d->m_dischargeLimit;
+}
+
+QTime DischargeConfigInfo::period1Start() const
+{
+    return d->m_period1Start;
+}
+
+QTime DischargeConfigInfo::period1End() const
+{
+    return d->m_period1End;
+}
+
+QTime DischargeConfigInfo::period2Start() const
+{
+    return d->m_period2Start;
+}
+
+QTime DischargeConfigInfo::period2End() const
+{
+    return d->m_period2End;
+}
+
+QJsonObject DischargeConfigInfo::rawJson() const
+{
+    return d->m_json;
+}
+
+bool DischargeConfigInfo::valid() const
+{
+    return d->m_valid;
+}
+
+RequestStatus DischargeConfigInfo::status() const
+{
+    return d->m_status;
+}
+
+ErrorCode DischargeConfigInfo::error() const
+{
+    return d->m_error;
+}
+
+QString DischargeConfigInfo::errorString() const
+{
+    return d->m_errorString;
+}
+
+bool DischargeConfigInfo::reload()
+{
+    return d->reload();
+}
+
+bool DischargeConfigInfo::forceReload()
+{
+    return d->forceReload();
+}
+
+void DischargeConfigInfo::reset()
+{
+    d->reset();
+}
+
+} // namespace QAlphaCloud
@@ -0,0 +1,948 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "energyhistorymodel.h"
+
+#include "apirequest.h"
+#include "connector.h"
+#include "deferredreload_p.h"
+#include "qalphacloud.h"
+#include "qalphacloud_log.h"
+#include "utils_p.h"
+
+#include <QFile>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMetaEnum>
+#include <QPointer>
+#include <QStandardPaths>
+#include <QTimer>
+#include <QUrl>
+#include <QVector>
+
+#include <algorithm>
+#include <cmath>
+
+namespace QAlphaCloud
+{
+
+struct DayEnergy {
+    static DayEnergy fromJson(const QJsonObject &json)
+    {
+        DayEnergy day;
+
+        const auto readWh = [&json, &day](const QString &key) {
+            const QJsonValue value = json.value(key);
+            day.valid = day.valid || (!value.isUndefined() && !value.isNull());
+            return static_cast<int>(std::round(value.toDouble() * 1000));
+        };
+
+        day.photovoltaic = readWh(QStringLiteral("epv"));
+        day.input = readWh(QStringLiteral("eInput"));
+        day.output = readWh(QStringLiteral("eOutput"));
+        day.charge = readWh(QStringLiteral("eCharge"));
+        day.discharge = readWh(QStringLiteral("eDischarge"));
+        day.gridCharge = readWh(QStringLiteral("eGridCharge"));
+
+        return day;
+    }
+
+    // The disk cache stores a compact array of Wh values.
+    static DayEnergy fromCache(const QJsonArray &array)
+    {
+        DayEnergy day;
+        if (array.count() != 6) {
+            return day;
+        }
+
+        day.photovoltaic = array.at(0).toInt();
+        day.input = array.at(1).toInt();
+        day.output = array.at(2).toInt();
+        day.charge = array.at(3).toInt();
+        day.discharge = array.at(4).toInt();
+        day.gridCharge = array.at(5).toInt();
+        day.valid = true;
+        return day;
+    }
+
+    QJsonArray toCache() const
+    {
+        return QJsonArray{photovoltaic, input, output, charge, discharge, gridCharge};
+    }
+
+    int totalLoad() const
+    {
+        return photovoltaic + discharge + input - output - charge;
+    }
+
+    bool valid = false;
+
+    int photovoltaic = 0; // epv
+    int input = 0; // eInput
+    int output = 0; // eOutput
+    int charge = 0; // eCharge
+    int discharge = 0; // eDischarge
+    int gridCharge = 0; // eGridCharge
+};
+
+struct EnergyTotals {
+    void add(const DayEnergy &day, int sign = 1)
+    {
+        photovoltaic += sign * day.photovoltaic;
+        input += sign * day.input;
+        output += sign * day.output;
+        charge += sign * day.charge;
+        discharge += sign * day.discharge;
+        gridCharge += sign * day.gridCharge;
+        loadedDays += sign;
+    }
+
+    void subtract(const DayEnergy &day)
+    {
+        add(day, -1);
+    }
+
+    int totalLoad() const
+    {
+        return photovoltaic + discharge + input - output - charge;
+    }
+
+    qreal selfSufficiency() const
+    {
+        const int load = totalLoad();
+        if (load <= 0) {
+            return 0.0;
+        }
+        return std::clamp((load - input) / qreal(load), 0.0, 1.0);
+    }
+
+    int photovoltaic = 0;
+    int input = 0;
+    int output = 0;
+    int charge = 0;
+    int discharge = 0;
+    int gridCharge = 0;
+
+    int loadedDays = 0;
+};
+
+struct EnergyBucket {
+    QDate startDate;
+    QDate endDate;
+    EnergyTotals totals;
+};
+
+} // namespace QAlphaCloud
+
+Q_DECLARE_TYPEINFO(QAlphaCloud::DayEnergy, Q_MOVABLE_TYPE);
+Q_DECLARE_TYPEINFO(QAlphaCloud::EnergyBucket, Q_MOVABLE_TYPE);
+
+namespace QAlphaCloud
+{
+
+static constexpr int s_tooManyRequestsBackoff = 1000; // ms
+
+class EnergyHistoryModelPrivate
+{
+public:
+    explicit EnergyHistoryModelPrivate(EnergyHistoryModel *qq);
+
+    static QDate bucketStart(const QDate &date, EnergyHistoryModel::Granularity granularity);
+    static QDate nextBucketStart(const QDate &start, EnergyHistoryModel::Granularity granularity);
+
+    QString cachePath() const;
+    void loadFromCache();
+    void writeToCache();
+
+    void setStatus(RequestStatus status);
+    void setError(ErrorCode error);
+    void setErrorString(const QString &errorString);
+    void setTotals(const EnergyTotals &totals);
+    void setTotalDays(int totalDays);
+
+    void rebuildBuckets();
+    int bucketForDate(const QDate &date) const;
+    void applyDay(const QDate &date, const DayEnergy &day);
+
+    void abortRequests();
+    void dispatch();
+    void sendRequest(const QDate &date);
+    void checkFinished();
+
+    EnergyHistoryModel *const q;
+
+    // TODO QPointer?
+    Connector *m_connector = nullptr;
+    QPointer<RequestGroup> m_requestGroup;
+    QString m_serialNumber;
+    QDate m_fromDate;
+    QDate m_toDate;
+    EnergyHistoryModel::Granularity m_granularity = EnergyHistoryModel::Granularity::Day;
+    int m_maximumConcurrentRequests = 8;
+    bool m_cached = true;
+
+    // All days loaded for the current serial number, regardless of range.
+    QHash<QDate, DayEnergy> m_days;
+    bool m_cacheLoaded = false;
+    bool m_cacheDirty = false;
+
+    QVector<EnergyBucket> m_buckets;
+    EnergyTotals m_totals;
+    int m_totalDays = 0;
+
+    QList<QDate> m_pendingDates;
+    QVector<QPointer<ApiRequest>> m_requests;
+    // Lowered temporarily when the server asks us to slow down.
+    int m_concurrency = 0;
+    QTimer m_backoffTimer;
+    int m_failedDays = 0;
+
+    RequestStatus m_status = RequestStatus::NoRequest;
+    ErrorCode m_error = ErrorCode::NoError;
+    QString m_errorString;
+
+    DeferredReload m_deferredReload;
+};
+
+EnergyHistoryModelPrivate::EnergyHistoryModelPrivate(EnergyHistoryModel *qq)
+    : q(qq)
+    , m_deferredReload([qq] {
+        return qq->reload();
+    })
+{
+    m_backoffTimer.setSingleShot(true);
+    m_backoffTimer.setInterval(s_tooManyRequestsBackoff);
+    QObject::connect(&m_backoffTimer, &QTimer::timeout, q, [this] {
+        dispatch();
+    });
+}
+
+QDate EnergyHistoryModelPrivate::bucketStart(const QDate &date, EnergyHistoryModel::Granularity granularity)
+{
+    switch (granularity) {
+    case EnergyHistoryModel::Granularity::Day:
+        return date;
+    case EnergyHistoryModel::Granularity::Week:
+        return date.addDays(1 - date.dayOfWeek());
+    case EnergyHistoryModel::Granularity::Month:
+        return QDate(date.year(), date.month(), 1);
+    case EnergyHistoryModel::Granularity::Year:
+        return QDate(date.year(), 1, 1);
+    }
+
+    Q_UNREACHABLE();
+    return date;
+}
+
+QDate EnergyHistoryModelPrivate::nextBucketStart(const QDate &start, EnergyHistoryModel::Granularity granularity)
+{
+    switch (granularity) {
+    case EnergyHistoryModel::Granularity::Day:
+        return start.addDays(1);
+    case EnergyHistoryModel::Granularity::Week:
+        return start.addDays(7);
+    case EnergyHistoryModel::Granularity::Month:
+        return start.addMonths(1);
+    case EnergyHistoryModel::Granularity::Year:
+        return start.addYears(1);
+    }
+
+    Q_UNREACHABLE();
+    return start;
+}
+
+QString EnergyHistoryModelPrivate::cachePath() const
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QLatin1String("/qalphacloud_energyhistory_")
+        + QString::fromLatin1(QUrl::toPercentEncoding(m_serialNumber)) + QLatin1String(".json");
+}
+
+void EnergyHistoryModelPrivate::loadFromCache()
+{
+    m_cacheLoaded = true;
+
+    const QString path = cachePath();
+
+    QFile cacheFile(path);
+    if (!cacheFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        // Not a warning, cache may just not exist.
+        qCDebug(QALPHACLOUD_LOG) << "Failed to open EnergyHistoryModel cache" << path << "for reading" << cacheFile.errorString();
+        return;
+    }
+
+    QJsonParseError error;
+    const QJsonDocument doc = QJsonDocument::fromJson(cacheFile.readAll(), &error);
+    if (error.error != QJsonParseError::NoError) {
+        qCWarning(QALPHACLOUD_LOG) << "Failed to parse EnergyHistoryModel cache" << error.errorString();
+        return;
+    }
+
+    const QJsonObject days = doc.object();
+    m_days.reserve(m_days.count() + days.count());
+    for (auto it = days.begin(), end = days.end(); it != end; ++it) {
+        const QDate date = QDate::fromString(it.key(), Qt::ISODate);
+        const DayEnergy day = DayEnergy::fromCache(it.value().toArray());
+        if (date.isValid() && day.valid && !m_days.contains(date)) {
+            m_days.insert(date, day);
+        }
+    }
+
+    qCDebug(QALPHACLOUD_LOG) << "Loaded" << days.count() << "days from EnergyHistoryModel cache" << path;
+}
+
+void EnergyHistoryModelPrivate::writeToCache()
+{
+    m_cacheDirty = false;
+
+    const QDate today = QDate::currentDate();
+
+    QJsonObject days;
+    for (auto it = m_days.cbegin(), end = m_days.cend(); it != end; ++it) {
+        // Don't cache today's data as it will gain new data as the day progresses.
+        // Also don't cache if there is no valid data.
+        if (it.key() < today && it->valid) {
+            days.insert(it.key().toString(Qt::ISODate), it->toCache());
+        }
+    }
+
+    const QString path = cachePath();
+
+    QFile cacheFile(path);
+    if (!cacheFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qCWarning(QALPHACLOUD_LOG) << "Failed to open EnergyHistoryModel cache" << path << "for writing" << cacheFile.errorString();
+        return;
+    }
+
+    const QByteArray data = QJsonDocument(days).toJson(QJsonDocument::Compact);
+    if (cacheFile.write(data) != data.size()) {
+        qCWarning(QALPHACLOUD_LOG) << "Failed to write EnergyHistoryModel cache data";
+        return;
+    }
+
+    qCDebug(QALPHACLOUD_LOG) << "Cached" << days.count() << "days of EnergyHistoryModel to" << path;
+}
+
+void EnergyHistoryModelPrivate::setStatus(RequestStatus status)
+{
+    if (m_status != status) {
+        m_status = status;
+        Q_EMIT q->statusChanged(status);
+    }
+}
+
+void EnergyHistoryModelPrivate::setError(ErrorCode error)
+{
+    if (m_error != error) {
+        m_error = error;
+        Q_EMIT q->errorChanged(error);
+    }
+}
+
+void EnergyHistoryModelPrivate::setErrorString(const QString &errorString)
+{
+    if (m_errorString != errorString) {
+        m_errorString = errorString;
+        Q_EMIT q->errorStringChanged(errorString);
+    }
+}
+
+void EnergyHistoryModelPrivate::setTotals(const EnergyTotals &totals)
+{
+    const EnergyTotals oldTotals = m_totals;
+    m_totals = totals;
+
+    if (oldTotals.photovoltaic != totals.photovoltaic) {
+        Q_EMIT q->photovoltaicChanged(totals.photovoltaic);
+    }
+    if (oldTotals.totalLoad() != totals.totalLoad()) {
+        Q_EMIT q->totalLoadChanged(totals.totalLoad());
+    }
+    if (oldTotals.input != totals.input) {
+        Q_EMIT q->inputChanged(totals.input);
+    }
+    if (oldTotals.output != totals.output) {
+        Q_EMIT q->outputChanged(totals.output);
+    }
+    if (oldTotals.charge != totals.charge) {
+        Q_EMIT q->chargeChanged(totals.charge);
+    }
+    if (oldTotals.discharge != totals.discharge) {
+        Q_EMIT q->dischargeChanged(totals.discharge);
+    }
+    if (oldTotals.gridCharge != totals.gridCharge) {
+        Q_EMIT q->gridChargeChanged(totals.gridCharge);
+    }
+    if (!qFuzzyCompare(1.0 + oldTotals.selfSufficiency(), 1.0 + totals.selfSufficiency())) {
+        Q_EMIT q->selfSufficiencyChanged(totals.selfSufficiency());
+    }
+    if (oldTotals.loadedDays != totals.loadedDays) {
+        Q_EMIT q->loadedDaysChanged(totals.loadedDays);
+    }
+}
+
+void EnergyHistoryModelPrivate::setTotalDays(int totalDays)
+{
+    if (m_totalDays != totalDays) {
+        m_totalDays = totalDays;
+        Q_EMIT q->totalDaysChanged(totalDays);
+    }
+}
+
+void EnergyHistoryModelPrivate::rebuildBuckets()
+{
+    QVector<EnergyBucket> buckets;
+    EnergyTotals totals;
+    int totalDays = 0;
+
+    if (m_fromDate.isValid() && m_toDate.isValid() && m_fromDate <= m_toDate) {
+        totalDays = m_fromDate.daysTo(m_toDate) + 1;
+
+        for (QDate start = bucketStart(m_fromDate, m_granularity); start <= m_toDate; start = nextBucketStart(start, m_granularity)) {
+            EnergyBucket bucket;
+            bucket.startDate = std::max(start, m_fromDate);
+            bucket.endDate = std::min(nextBucketStart(start, m_granularity).addDays(-1), m_toDate);
+
+            for (QDate date = bucket.startDate; date <= bucket.endDate; date = date.addDays(1)) {
+                const auto it = m_days.constFind(date);
+                if (it != m_days.constEnd()) {
+                    bucket.totals.add(*it);
+                }
+            }
+
+            totals.photovoltaic += bucket.totals.photovoltaic;
+            totals.input += bucket.totals.input;
+            totals.output += bucket.totals.output;
+            totals.charge += bucket.totals.charge;
+            totals.discharge += bucket.totals.discharge;
+            totals.gridCharge += bucket.totals.gridCharge;
+            totals.loadedDays += bucket.totals.loadedDays;
+
+            buckets.append(bucket);
+        }
+    }
+
+    q->beginResetModel();
+    m_buckets = buckets;
+    q->endResetModel();
+
+    setTotals(totals);
+    setTotalDays(totalDays);
+}
+
+int EnergyHistoryModelPrivate::bucketForDate(const QDate &date) const
+{
+    if (date < m_fromDate || date > m_toDate) {
+        return -1;
+    }
+
+    // Find the last bucket that starts on or before date.
+    auto it = std::upper_bound(m_buckets.cbegin(), m_buckets.cend(), date, [](const QDate &date, const EnergyBucket &bucket) {
+        return date < bucket.startDate;
+    });
+    if (it == m_buckets.cbegin()) {
+        return -1;
+    }
+    return static_cast<int>(std::prev(it) - m_buckets.cbegin());
+}
+
+void EnergyHistoryModelPrivate::applyDay(const QDate &date, const DayEnergy &day)
+{
+    EnergyTotals totals = m_totals;
+    const int row = bucketForDate(date);
+
+    // Only touch the affected bucket and the running totals, never rescan.
+    const auto oldIt = m_days.constFind(date);
+    if (oldIt != m_days.constEnd()) {
+        if (row > -1) {
+            m_buckets[row].totals.subtract(*oldIt);
+            totals.subtract(*oldIt);
+        }
+    }
+
+    m_days.insert(date, day);
+
+    if (day.valid && date < QDate::currentDate()) {
+        m_cacheDirty = true;
+    }
+
+    if (row > -1) {
+        m_buckets[row].totals.add(day);
+        totals.add(day);
+
+        const QModelIndex index = q->index(row, 0);
+        Q_EMIT q->dataChanged(index, index);
+    }
+
+    setTotals(totals);
+}
+
+void EnergyHistoryModelPrivate::abortRequests()
+{
+    m_backoffTimer.stop();
+    m_pendingDates.clear();
+
+    const auto requests = m_requests;
+    m_requests.clear();
+    for (const auto &request : requests) {
+        if (request) {
+            // Don't count cancelled days as errors.
+            QObject::disconnect(request, nullptr, q, nullptr);
+            request->abort();
+        }
+    }
+}
+
+void EnergyHistoryModelPrivate::dispatch()
+{
+    while (!m_pendingDates.isEmpty() && m_requests.count() < m_concurrency && !m_backoffTimer.isActive()) {
+        sendRequest(m_pendingDates.takeFirst());
+    }
+
+    checkFinished();
+}
+
+void EnergyHistoryModelPrivate::sendRequest(const QDate &date)
+{
+    auto *request = new ApiRequest(m_connector, ApiRequest::EndPoint::OneDateEnergyBySn, q);
+    request->setRequestGroup(m_requestGroup);
+    request->setSysSn(m_serialNumber);
+    request->setQueryDate(date);
+
+    QObject::connect(request, &ApiRequest::errorOccurred, q, [this, request, date] {
+        if (request->error() == ErrorCode::TooManyRequests) {
+            // Try this day again later and don't push as hard.
+            m_pendingDates.prepend(date);
+            m_concurrency = std::max(1, m_concurrency / 2);
+            m_backoffTimer.start();
+            return;
+        }
+
+        ++m_failedDays;
+        setError(request->error());
+        setErrorString(request->errorString());
+    });
+
+    QObject::connect(request, &ApiRequest::result, q, [this, request, date] {
+        applyDay(date, DayEnergy::fromJson(request->data().toObject()));
+
+        // Ramp up again after the server asked us to slow down.
+        if (m_concurrency < m_maximumConcurrentRequests && !m_backoffTimer.isActive()) {
+            ++m_concurrency;
+        }
+    });
+
+    QObject::connect(request, &ApiRequest::finished, q, [this, request] {
+        m_requests.removeOne(request);
+        dispatch();
+    });
+
+    if (request->send()) {
+        m_requests.append(request);
+    } else {
+        ++m_failedDays;
+    }
+}
+
+void EnergyHistoryModelPrivate::checkFinished()
+{
+    if (!m_pendingDates.isEmpty() || !m_requests.isEmpty()) {
+        return;
+    }
+
+    if (m_cached && m_cacheDirty) {
+        writeToCache();
+    }
+
+    if (m_status == RequestStatus::Loading) {
+        setStatus(m_failedDays > 0 ? RequestStatus::Error : RequestStatus::Finished);
+    }
+}
+
+EnergyHistoryModel::EnergyHistoryModel(QObject *parent)
+    : EnergyHistoryModel(nullptr, QString(), QDate(QDate::currentDate().year(), 1, 1), QDate::currentDate(), parent)
+{
+}
+
+EnergyHistoryModel::EnergyHistoryModel(Connector *connector, const QString &serialNumber, const QDate &fromDate, const QDate &toDate, QObject *parent)
+    : QAbstractListModel(parent)
+    , d(std::make_unique<EnergyHistoryModelPrivate>(this))
+{
+    setConnector(connector);
+
+    d->m_serialNumber = serialNumber;
+    d->m_fromDate = fromDate;
+    d->m_toDate = toDate;
+
+    connect(this, &EnergyHistoryModel::rowsInserted, this, &EnergyHistoryModel::countChanged);
+    connect(this, &EnergyHistoryModel::rowsRemoved, this, &EnergyHistoryModel::countChanged);
+    connect(this, &EnergyHistoryModel::modelReset, this, &EnergyHistoryModel::countChanged);
+}
+
+EnergyHistoryModel::~EnergyHistoryModel()
+{
+    d->abortRequests();
+}
+
+Connector *EnergyHistoryModel::connector() const
+{
+    return d->m_connector;
+}
+
+void EnergyHistoryModel::setConnector(Connector *connector)
+{
+    if (d->m_connector == connector) {
+        return;
+    }
+
+    d->m_connector = connector;
+    d->m_days.clear();
+    d->m_cacheLoaded = false;
+    reset();
+    Q_EMIT connectorChanged(connector);
+}
+
+RequestGroup *EnergyHistoryModel::requestGroup() const
+{
+    return d->m_requestGroup;
+}
+
+void EnergyHistoryModel::setRequestGroup(RequestGroup *requestGroup)
+{
+    if (d->m_requestGroup == requestGroup) {
+        return;
+    }
+
+    d->m_requestGroup = requestGroup;
+    Q_EMIT requestGroupChanged(requestGroup);
+}
+
+QString EnergyHistoryModel::serialNumber() const
+{
+    return d->m_serialNumber;
+}
+
+void EnergyHistoryModel::setSerialNumber(const QString &serialNumber)
+{
+    if (d->m_serialNumber == serialNumber) {
+        return;
+    }
+
+    if (d->m_cached && d->m_cacheDirty && !d->m_serialNumber.isEmpty()) {
+        d->writeToCache();
+    }
+
+    d->m_serialNumber = serialNumber;
+    d->m_days.clear();
+    d->m_cacheLoaded = false;
+    reset();
+    Q_EMIT serialNumberChanged(serialNumber);
+}
+
+QDate EnergyHistoryModel::fromDate() const
+{
+    return d->m_fromDate;
+}
+
+void EnergyHistoryModel::setFromDate(const QDate &fromDate)
+{
+    if (d->m_fromDate == fromDate) {
+        return;
+    }
+
+    d->m_fromDate = fromDate;
+    reset();
+    Q_EMIT fromDateChanged(fromDate);
+}
+
+void EnergyHistoryModel::resetFromDate()
+{
+    setFromDate(QDate(QDate::currentDate().year(), 1, 1));
+}
+
+QDate EnergyHistoryModel::toDate() const
+{
+    return d->m_toDate;
+}
+
+void EnergyHistoryModel::setToDate(const QDate &toDate)
+{
+    if (d->m_toDate == toDate) {
+        return;
+    }
+
+    d->m_toDate = toDate;
+    reset();
+    Q_EMIT toDateChanged(toDate);
+}
+
+void EnergyHistoryModel::resetToDate()
+{
+    setToDate(QDate::currentDate());
+}
+
+EnergyHistoryModel::Granularity EnergyHistoryModel::granularity() const
+{
+    return d->m_granularity;
+}
+
+void EnergyHistoryModel::setGranularity(Granularity granularity)
+{
+    if (d->m_granularity == granularity) {
+        return;
+    }
+
+    d->m_granularity = granularity;
+    // Re-aggregate what we have, any requests in-flight will be applied to the new rows.
+    if (!d->m_buckets.isEmpty()) {
+        d->rebuildBuckets();
+    }
+    Q_EMIT granularityChanged(granularity);
+}
+
+int EnergyHistoryModel::maximumConcurrentRequests() const
+{
+    return d->m_maximumConcurrentRequests;
+}
+
+void EnergyHistoryModel::setMaximumConcurrentRequests(int maximumConcurrentRequests)
+{
+    maximumConcurrentRequests = std::max(1, maximumConcurrentRequests);
+    if (d->m_maximumConcurrentRequests == maximumConcurrentRequests) {
+        return;
+    }
+
+    d->m_maximumConcurrentRequests = maximumConcurrentRequests;
+    d->m_concurrency = maximumConcurrentRequests;
+    Q_EMIT maximumConcurrentRequestsChanged(maximumConcurrentRequests);
+
+    d->dispatch();
+}
+
+bool EnergyHistoryModel::cached() const
+{
+    return d->m_cached;
+}
+
+void EnergyHistoryModel::setCached(bool cached)
+{
+    if (d->m_cached == cached) {
+        return;
+    }
+
+    d->m_cached = cached;
+    Q_EMIT cachedChanged(cached);
+}
+
+int EnergyHistoryModel::photovoltaic() const
+{
+    return d->m_totals.photovoltaic;
+}
+
+int EnergyHistoryModel::totalLoad() const
+{
+    return d->m_totals.totalLoad();
+}
+
+int EnergyHistoryModel::input() const
+{
+    return d->m_totals.input;
+}
+
+int EnergyHistoryModel::output() const
+{
+    return d->m_totals.output;
+}
+
+int EnergyHistoryModel::charge() const
+{
+    return d->m_totals.charge;
+}
+
+int EnergyHistoryModel::discharge() const
+{
+    return d->m_totals.discharge;
+}
+
+int EnergyHistoryModel::gridCharge() const
+{
+    return d->m_totals.gridCharge;
+}
+
+qreal EnergyHistoryModel::selfSufficiency() const
+{
+    return d->m_totals.selfSufficiency();
+}
+
+int EnergyHistoryModel::loadedDays() const
+{
+    return d->m_totals.loadedDays;
+}
+
+int EnergyHistoryModel::totalDays() const
+{
+    return d->m_totalDays;
+}
+
+RequestStatus EnergyHistoryModel::status() const
+{
+    return d->m_status;
+}
+
+ErrorCode EnergyHistoryModel::error() const
+{
+    return d->m_error;
+}
+
+QString EnergyHistoryModel::errorString() const
+{
+    return d->m_errorString;
+}
+
+int EnergyHistoryModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+
+    return d->m_buckets.count();
+}
+
+QVariant EnergyHistoryModel::data(const QModelIndex &index, int role) const
+{
+    if (!checkIndex(index, QAbstractItemModel::CheckIndexOption::IndexIsValid)) {
+        return {};
+    }
+
+    const auto &item = d->m_buckets.at(index.row());
+
+    switch (static_cast<Roles>(role)) {
+    case Roles::StartDate:
+        return item.startDate;
+    case Roles::EndDate:
+        return item.endDate;
+    case Roles::Photovoltaic:
+        return item.totals.photovoltaic;
+    case Roles::TotalLoad:
+        return item.totals.totalLoad();
+    case Roles::Input:
+        return item.totals.input;
+    case Roles::Output:
+        return item.totals.output;
+    case Roles::Charge:
+        return item.totals.charge;
+    case Roles::Discharge:
+        return item.totals.discharge;
+    case Roles::GridCharge:
+        return item.totals.gridCharge;
+    case Roles::SelfSufficiency:
+        return item.totals.selfSufficiency();
+    case Roles::LoadedDays:
+        return item.totals.loadedDays;
+    case Roles::DayCount:
+        return item.startDate.daysTo(item.endDate) + 1;
+    }
+
+    return {};
+}
+
+QHash<int, QByteArray> EnergyHistoryModel::roleNames() const
+{
+    return Utils::roleNamesFromEnum(QMetaEnum::fromType<Roles>());
+}
+
+int EnergyHistoryModel::suppressedReloadCount() const
+{
+    return d->m_deferredReload.suppressedCount();
+}
+
+bool EnergyHistoryModel::reload()
+{
+    if (d->m_deferredReload.cancel()) {
+        Q_EMIT suppressedReloadCountChanged(d->m_deferredReload.suppressedCount());
+    }
+
+    if (!d->m_connector) {
+        qCWarning(QALPHACLOUD_LOG) << "Cannot load EnergyHistoryModel without a connector";
+        return false;
+    }
+
+    if (d->m_serialNumber.isEmpty()) {
+        qCWarning(QALPHACLOUD_LOG) << "Cannot load EnergyHistoryModel without a serial number";
+        return false;
+    }
+
+    if (!d->m_fromDate.isValid() || !d->m_toDate.isValid() || d->m_fromDate > d->m_toDate) {
+        qCWarning(QALPHACLOUD_LOG) << "Cannot load EnergyHistoryModel without a valid date range";
+        return false;
+    }
+
+    if (!d->m_requests.isEmpty()) {
+        qCDebug(QALPHACLOUD_LOG) << "Cancelling" << d->m_requests.count() << "EnergyHistoryModel requests in-flight";
+    }
+    d->abortRequests();
+
+    if (d->m_cached && !d->m_cacheLoaded) {
+        d->loadFromCache();
+    }
+
+    d->rebuildBuckets();
+
+    const QDate today = QDate::currentDate();
+    // No point in asking for the future.
+    const QDate lastDate = std::min(d->m_toDate, today);
+    for (QDate date = d->m_fromDate; date <= lastDate; date = date.addDays(1)) {
+        // Today's data changes throughout the day, always fetch it.
+        if (date == today || !d->m_days.contains(date)) {
+            d->m_pendingDates.append(date);
+        }
+    }
+
+    d->m_failedDays = 0;
+    d->m_concurrency = d->m_maximumConcurrentRequests;
+    d->setError(ErrorCode::NoError);
+    d->setErrorString(QString());
+
+    if (d->m_pendingDates.isEmpty()) {
+        d->setStatus(RequestStatus::Finished);
+        return true;
+    }
+
+    qCDebug(QALPHACLOUD_LOG) << "Loading" << d->m_pendingDates.count() << "days of EnergyHistoryModel";
+
+    d->setStatus(RequestStatus::Loading);
+    d->dispatch();
+
+    return true;
+}
+
+void EnergyHistoryModel::scheduleReload()
+{
+    if (!d->m_deferredReload.schedule()) {
+        Q_EMIT suppressedReloadCountChanged(d->m_deferredReload.suppressedCount());
+    }
+}
+
+bool EnergyHistoryModel::forceReload()
+{
+    d->m_days.clear();
+    return reload();
+}
+
+void EnergyHistoryModel::reset()
+{
+    d->abortRequests();
+
+    beginResetModel();
+    d->m_buckets.clear();
+    endResetModel();
+
+    d->setTotals(EnergyTotals());
+    d->setTotalDays(0);
+    d->setStatus(RequestStatus::NoRequest);
+}
+
+} // namespace QAlphaCloud
@@ -0,0 +1,354 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <QAbstractListModel>
+#include <QDate>
+
+#include <memory>
+
+#include "connector.h"
+#include "qalphacloud.h"
+#include "qalphacloud_export.h"
+#include "requestgroup.h"
+
+namespace QAlphaCloud
+{
+
+class EnergyHistoryModelPrivate;
+
+/**
+ * @brief Cumulative energy information over a date range
+ *
+ * Provides cumulative energy information, such as the amount of energy
+ * produced, for every day in a date range, aggregated by day, week, month, or year.
+ *
+ * Days are fetched in parallel and the model is updated incrementally as
+ * results arrive. Data of past days is cached on disk so subsequent loads
+ * only need to fetch what is missing.
+ *
+ * Wraps the @c /getOneDateEnergy API endpoint.
+ */
+class QALPHACLOUD_EXPORT EnergyHistoryModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+    /**
+     * @brief The connector to use
+     */
+    Q_PROPERTY(QAlphaCloud::Connector *connector READ connector WRITE setConnector NOTIFY connectorChanged REQUIRED)
+
+    /**
+     * @brief The request group
+     *
+     * Optional. Requests are sent as part of this group
+     * so that they can be canceled together with others.
+     */
+    Q_PROPERTY(QAlphaCloud::RequestGroup *requestGroup READ requestGroup WRITE setRequestGroup NOTIFY requestGroupChanged)
+
+    /**
+     * @brief The serial number
+     *
+     * The serial number of the storage system whose data should be queried.
+     */
+    Q_PROPERTY(QString serialNumber READ serialNumber WRITE setSerialNumber NOTIFY serialNumberChanged REQUIRED)
+
+    /**
+     * @brief The first date of the range
+     *
+     * Default is the first day of the current year.
+     */
+    Q_PROPERTY(QDate fromDate READ fromDate WRITE setFromDate RESET resetFromDate NOTIFY fromDateChanged)
+    /**
+     * @brief The last date of the range (inclusive)
+     *
+     * Default is the current date.
+     */
+    Q_PROPERTY(QDate toDate READ toDate WRITE setToDate RESET resetToDate NOTIFY toDateChanged)
+
+    /**
+     * @brief How to aggregate the days
+     *
+     * Default is Day, i.e. one row per day.
+     *
+     * Changing this does not cause any data to be fetched again.
+     */
+    Q_PROPERTY(QAlphaCloud::EnergyHistoryModel::Granularity granularity READ granularity WRITE setGranularity NOTIFY granularityChanged)
+
+    /**
+     * @brief The maximum number of requests sent at the same time
+     *
+     * Default is 8.
+     */
+    Q_PROPERTY(int maximumConcurrentRequests READ maximumConcurrentRequests WRITE setMaximumConcurrentRequests NOTIFY maximumConcurrentRequestsChanged)
+
+    /**
+     * @brief Cache data on disk
+     *
+     * Whether to cache the returned data of past days on disk, default is true.
+     *
+     * Data from the current day is never cached as data is collected throughout
+     * the day.
+     */
+    Q_PROPERTY(bool cached READ cached WRITE setCached NOTIFY cachedChanged)
+
+    /**
+     * @brief Photovoltaic production in Wh over the entire range.
+     */
+    Q_PROPERTY(int photovoltaic READ photovoltaic NOTIFY photovoltaicChanged)
+    /**
+     * @brief Total load in Wh over the entire range.
+     */
+    Q_PROPERTY(int totalLoad READ totalLoad NOTIFY totalLoadChanged)
+    /**
+     * @brief Power input from grid in Wh over the entire range.
+     */
+    Q_PROPERTY(int input READ input NOTIFY inputChanged)
+    /**
+     * @brief Power output to the grid in Wh over the entire range.
+     */
+    Q_PROPERTY(int output READ output NOTIFY outputChanged)
+    /**
+     * @brief Energy charged into the battery in Wh over the entire range.
+     */
+    Q_PROPERTY(int charge READ charge NOTIFY chargeChanged)
+    /**
+     * @brief Energy discharged from the battery in Wh over the entire range.
+     */
+    Q_PROPERTY(int discharge READ discharge NOTIFY dischargeChanged)
+    /**
+     * @brief Battery charge from grid in Wh over the entire range.
+     */
+    Q_PROPERTY(int gridCharge READ gridCharge NOTIFY gridChargeChanged)
+    /**
+     * @brief Self-sufficiency over the entire range
+     *
+     * The share of the total load that was not drawn from the grid, from 0 to 1.
+     */
+    Q_PROPERTY(qreal selfSufficiency READ selfSufficiency NOTIFY selfSufficiencyChanged)
+
+    /**
+     * @brief The number of days for which data has been loaded
+     *
+     * Together with totalDays this can be used for displaying progress.
+     */
+    Q_PROPERTY(int loadedDays READ loadedDays NOTIFY loadedDaysChanged)
+    /**
+     * @brief The number of days in the range
+     */
+    Q_PROPERTY(int totalDays READ totalDays NOTIFY totalDaysChanged)
+
+    /**
+     * @brief The number of items in the model
+     */
+    Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
+
+    /**
+     * @brief Number of reloads that were folded into another one
+     *
+     * See scheduleReload(). This is for diagnostics.
+     */
+    Q_PROPERTY(int suppressedReloadCount READ suppressedReloadCount NOTIFY suppressedReloadCountChanged)
+
+    /**
+     * @brief The current request status
+     *
+     * This is Loading until all days in the range have been loaded.
+     */
+    Q_PROPERTY(QAlphaCloud::RequestStatus status READ status NOTIFY statusChanged)
+
+    /**
+     * @brief The error, if any
+     *
+     * This is the last error that occurred. Days that failed to load
+     * do not contribute to the totals.
+     */
+    Q_PROPERTY(QAlphaCloud::ErrorCode error READ error NOTIFY errorChanged)
+    /**
+     * @brief The error string, if any
+     *
+     * @note Not every error code has an errorString associated with it.
+     */
+    Q_PROPERTY(QString errorString READ errorString NOTIFY errorStringChanged)
+
+public:
+    /**
+     * @brief Creates an EnergyHistoryModel instance
+     * @param parent The owner
+     *
+     * @note A connector and serialNumber must be set before requests can be made.
+     */
+    explicit EnergyHistoryModel(QObject *parent = nullptr);
+    /**
+     * @brief Creates an EnergyHistoryModel instance
+     * @param connector The connector
+     * @param serialNumber The serial number of the storage system whose data should be queried
+     * @param fromDate The first date of the range
+     * @param toDate The last date of the range (inclusive)
+     * @param parent The owner
+     */
+    EnergyHistoryModel(Connector *connector, const QString &serialNumber, const QDate &fromDate, const QDate &toDate, QObject *parent = nullptr);
+    ~EnergyHistoryModel() override;
+
+    /**
+     * @brief Aggregation granularity
+     */
+    enum class Granularity {
+        Day = 0, ///< One row per day
+        Week, ///< One row per week, starting on Monday
+        Month, ///< One row per month
+        Year, ///< One row per year
+    };
+    Q_ENUM(Granularity)
+
+    /**
+     * @brief The model roles
+     */
+    enum class Roles {
+        StartDate = Qt::UserRole, ///< The first date in this row, clamped to the range (QDate)
+        EndDate, ///< The last date in this row, clamped to the range (QDate)
+        Photovoltaic, ///< Photovoltaic production in Wh (int)
+        TotalLoad, ///< Total load in Wh (int)
+        Input, ///< Power input from grid in Wh (int)
+        Output, ///< Power output to the grid in Wh (int)
+        Charge, ///< Energy charged into the battery in Wh (int)
+        Discharge, ///< Energy discharged from the battery in Wh (int)
+        GridCharge, ///< Battery charge from grid in Wh (int)
+        SelfSufficiency, ///< Share of the total load not drawn from the grid, from 0 to 1 (qreal)
+        LoadedDays, ///< The number of days in this row for which data has been loaded (int)
+        DayCount, ///< The number of days in this row (int)
+    };
+    Q_ENUM(Roles)
+
+    Q_REQUIRED_RESULT Connector *connector() const;
+    void setConnector(Connector *connector);
+    Q_SIGNAL void connectorChanged(Connector *connector);
+
+    Q_REQUIRED_RESULT QAlphaCloud::RequestGroup *requestGroup() const;
+    void setRequestGroup(QAlphaCloud::RequestGroup *requestGroup);
+    Q_SIGNAL void requestGroupChanged(QAlphaCloud::RequestGroup *requestGroup);
+
+    Q_REQUIRED_RESULT QString serialNumber() const;
+    void setSerialNumber(const QString &serialNumber);
+    Q_SIGNAL void serialNumberChanged(const QString &serialNumber);
+
+    Q_REQUIRED_RESULT QDate fromDate() const;
+    void setFromDate(const QDate &fromDate);
+    void resetFromDate();
+    Q_SIGNAL void fromDateChanged(const QDate &fromDate);
+
+    Q_REQUIRED_RESULT QDate toDate() const;
+    void setToDate(const QDate &toDate);
+    void resetToDate();
+    Q_SIGNAL void toDateChanged(const QDate &toDate);
+
+    Q_REQUIRED_RESULT Granularity granularity() const;
+    void setGranularity(Granularity granularity);
+    Q_SIGNAL void granularityChanged(QAlphaCloud::EnergyHistoryModel::Granularity granularity);
+
+    Q_REQUIRED_RESULT int maximumConcurrentRequests() const;
+    void setMaximumConcurrentRequests(int maximumConcurrentRequests);
+    Q_SIGNAL void maximumConcurrentRequestsChanged(int maximumConcurrentRequests);
+
+    Q_REQUIRED_RESULT bool cached() const;
+    void setCached(bool cached);
+    Q_SIGNAL void cachedChanged(bool cached);
+
+    Q_REQUIRED_RESULT int photovoltaic() const;
+    Q_SIGNAL void photovoltaicChanged(int photovoltaic);
+
+    Q_REQUIRED_RESULT int totalLoad() const;
+    Q_SIGNAL void totalLoadChanged(int totalLoad);
+
+    Q_REQUIRED_RESULT int input() const;
+    Q_SIGNAL void inputChanged(int input);
+
+    Q_REQUIRED_RESULT int output() const;
+    Q_SIGNAL void outputChanged(int output);
+
+    Q_REQUIRED_RESULT int charge() const;
+    Q_SIGNAL void chargeChanged(int charge);
+
+    Q_REQUIRED_RESULT int discharge() const;
+    Q_SIGNAL void dischargeChanged(int discharge);
+
+    Q_REQUIRED_RESULT int gridCharge() const;
+    Q_SIGNAL void gridChargeChanged(int gridCharge);
+
+    Q_REQUIRED_RESULT qreal selfSufficiency() const;
+    Q_SIGNAL void selfSufficiencyChanged(qreal selfSufficiency);
+
+    Q_REQUIRED_RESULT int loadedDays() const;
+    Q_SIGNAL void loadedDaysChanged(int loadedDays);
+
+    Q_REQUIRED_RESULT int totalDays() const;
+    Q_SIGNAL void totalDaysChanged(int totalDays);
+
+    Q_REQUIRED_RESULT int suppressedReloadCount() const;
+    Q_SIGNAL void suppressedReloadCountChanged(int suppressedReloadCount);
+
+    QAlphaCloud::RequestStatus status() const;
+    Q_SIGNAL void statusChanged(QAlphaCloud::RequestStatus status);
+
+    QAlphaCloud::ErrorCode error() const;
+    Q_SIGNAL void errorChanged(QAlphaCloud::ErrorCode error);
+
+    QString errorString() const;
+    Q_SIGNAL void errorStringChanged(const QString &errorString);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+public Q_SLOTS:
+
+    /**
+     * @brief (Re)load data
+     *
+     * In QML, this is done automatically on component completion if the
+     * @a active property (not documented here) is true, which is the default.
+     * @return Whether loading started.
+     *
+     * Only days that have not been loaded yet, and the current day, are fetched.
+     *
+     * @note You must set a connector and a serialNumber before requests can be sent.
+     */
+    bool reload();
+    /**
+     * @brief Reload data once control returns to the event loop
+     *
+     * Calling this several times, e.g. when changing multiple properties
+     * in a row, results in a single reload. A reload() in the meantime
+     * makes the scheduled one unnecessary.
+     *
+     * In QML, this is done automatically when a property changes if the
+     * @a active property (not documented here) is true, which is the default.
+     */
+    void scheduleReload();
+    /**
+     * @brief Force a reload
+     *
+     * Reloads all days in the range, ignoring the cache.
+     *
+     * @return Whether loading started.
+     */
+    bool forceReload();
+    /**
+     * @brief Reset object
+     *
+     * This clears all data and resets the object back to its initial state.
+     */
+    void reset();
+
+Q_SIGNALS:
+    void countChanged();
+
+private:
+    friend EnergyHistoryModelPrivate;
+    std::unique_ptr<EnergyHistoryModelPrivate> const d;
+};
+
+} // namespace QAlphaCloud
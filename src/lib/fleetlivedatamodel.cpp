@@ -0,0 +1,693 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "fleetlivedatamodel.h"
+
+#include "apirequest.h"
+#include "qalphacloud_log.h"
+#include "utils_p.h"
+
+#include <QDateTime>
+#include <QHash>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QMetaEnum>
+#include <QPointer>
+#include <QTimer>
+#include <QVector>
+
+#include <algorithm>
+
+namespace QAlphaCloud
+{
+
+// Kept small as there can be thousands of them.
+struct FleetRow {
+    QString serialNumber;
+    qint64 lastUpdate = 0; // ms since epoch
+    qint32 photovoltaicPower = 0;
+    qint32 currentLoad = 0;
+    qint32 gridPower = 0;
+    qint32 batteryPower = 0;
+    float batterySoc = 0.0f;
+    ErrorCode error = ErrorCode::NoError;
+    bool valid = false;
+    // Waiting in the queue or request in-flight.
+    bool queued = false;
+    // Polled since the last reload.
+    bool polled = false;
+};
+
+} // namespace QAlphaCloud
+
+Q_DECLARE_TYPEINFO(QAlphaCloud::FleetRow, Q_MOVABLE_TYPE);
+
+namespace QAlphaCloud
+{
+
+struct FleetStatistics {
+    qint64 photovoltaicPower = 0;
+    qint64 currentLoad = 0;
+    qint64 gridPower = 0;
+    qint64 batteryPower = 0;
+    qreal batterySocSum = 0.0;
+    int validCount = 0;
+    int errorCount = 0;
+
+    void add(const FleetRow &row, int sign)
+    {
+        if (row.valid) {
+            photovoltaicPower += sign * row.photovoltaicPower;
+            currentLoad += sign * row.currentLoad;
+            gridPower += sign * row.gridPower;
+            batteryPower += sign * row.batteryPower;
+            batterySocSum += sign * static_cast<qreal>(row.batterySoc);
+            validCount += sign;
+        }
+        if (row.error != ErrorCode::NoError) {
+            errorCount += sign;
+        }
+    }
+
+    qreal batterySoc() const
+    {
+        return validCount > 0 ? batterySocSum / validCount : 0.0;
+    }
+};
+
+static constexpr int s_defaultInterval = 30 * 1000; // ms
+static constexpr int s_defaultMaximumConcurrentRequests = 4;
+// Don't wake up more often than this to poll the next batch of systems.
+static constexpr int s_minimumTickInterval = 250; // ms
+static constexpr int s_tooManyRequestsBackoff = 1000; // ms
+
+class FleetLiveDataModelPrivate
+{
+public:
+    explicit FleetLiveDataModelPrivate(FleetLiveDataModel *qq);
+
+    void setStatus(RequestStatus status);
+    void setStatistics(const FleetStatistics &statistics);
+    void recalculateStatistics();
+
+    void updateRow(int row, const FleetRow &newRow);
+    void markPolled(int row);
+
+    void abortRequests();
+    void enqueue(int row);
+    void dispatch();
+    bool sendRequest(int row);
+    void startPolling();
+    void pollNextBatch();
+
+    FleetLiveDataModel *const q;
+
+    // TODO QPointer?
+    Connector *m_connector = nullptr;
+    QPointer<RequestGroup> m_requestGroup;
+    QStringList m_serialNumbers;
+    int m_interval = s_defaultInterval;
+    int m_maximumConcurrentRequests = s_defaultMaximumConcurrentRequests;
+
+    QVector<FleetRow> m_rows;
+    QHash<QString, int> m_rowIndex;
+    FleetStatistics m_statistics;
+
+    QList<int> m_queue;
+    QVector<QPointer<ApiRequest>> m_requests;
+    // Lowered temporarily when the server asks us to slow down.
+    int m_concurrency = s_defaultMaximumConcurrentRequests;
+    QTimer m_backoffTimer;
+
+    // Polls a batch of systems every tick, so all of them are polled once per interval.
+    QTimer m_pollTimer;
+    int m_batchSize = 1;
+    int m_cursor = 0;
+    int m_unpolledCount = 0;
+
+    RequestStatus m_status = RequestStatus::NoRequest;
+};
+
+FleetLiveDataModelPrivate::FleetLiveDataModelPrivate(FleetLiveDataModel *qq)
+    : q(qq)
+{
+    m_backoffTimer.setSingleShot(true);
+    m_backoffTimer.setInterval(s_tooManyRequestsBackoff);
+    QObject::connect(&m_backoffTimer, &QTimer::timeout, q, [this] {
+        dispatch();
+    });
+
+    QObject::connect(&m_pollTimer, &QTimer::timeout, q, [this] {
+        pollNextBatch();
+    });
+}
+
+void FleetLiveDataModelPrivate::setStatus(RequestStatus status)
+{
+    if (m_status != status) {
+        m_status = status;
+        Q_EMIT q->statusChanged(status);
+    }
+}
+
+void FleetLiveDataModelPrivate::setStatistics(const FleetStatistics &statistics)
+{
+    const FleetStatistics oldStatistics = m_statistics;
+    m_statistics = statistics;
+
+    if (oldStatistics.photovoltaicPower != statistics.photovoltaicPower) {
+        Q_EMIT q->photovoltaicPowerChanged(q->photovoltaicPower());
+    }
+    if (oldStatistics.currentLoad != statistics.currentLoad) {
+        Q_EMIT q->currentLoadChanged(q->currentLoad());
+    }
+    if (oldStatistics.gridPower != statistics.gridPower) {
+        Q_EMIT q->gridPowerChanged(q->gridPower());
+    }
+    if (oldStatistics.batteryPower != statistics.batteryPower) {
+        Q_EMIT q->batteryPowerChanged(q->batteryPower());
+    }
+    if (!qFuzzyCompare(1.0 + oldStatistics.batterySoc(), 1.0 + statistics.batterySoc())) {
+        Q_EMIT q->batterySocChanged(statistics.batterySoc());
+    }
+    if (oldStatistics.validCount != statistics.validCount) {
+        Q_EMIT q->validCountChanged(statistics.validCount);
+    }
+    if (oldStatistics.errorCount != statistics.errorCount) {
+        Q_EMIT q->errorCountChanged(statistics.errorCount);
+    }
+}
+
+void FleetLiveDataModelPrivate::recalculateStatistics()
+{
+    FleetStatistics statistics;
+    for (const FleetRow &row : std::as_const(m_rows)) {
+        statistics.add(row, 1);
+    }
+    setStatistics(statistics);
+}
+
+void FleetLiveDataModelPrivate::updateRow(int row, const FleetRow &newRow)
+{
+    FleetRow &oldRow = m_rows[row];
+
+    QVector<int> roles;
+    if (oldRow.photovoltaicPower != newRow.photovoltaicPower) {
+        roles.append(static_cast<int>(FleetLiveDataModel::Roles::PhotovoltaicPower));
+    }
+    if (oldRow.currentLoad != newRow.currentLoad) {
+        roles.append(static_cast<int>(FleetLiveDataModel::Roles::CurrentLoad));
+    }
+    if (oldRow.gridPower != newRow.gridPower) {
+        roles.append(static_cast<int>(FleetLiveDataModel::Roles::GridPower));
+    }
+    if (oldRow.batteryPower != newRow.batteryPower) {
+        roles.append(static_cast<int>(FleetLiveDataModel::Roles::BatteryPower));
+    }
+    if (!qFuzzyCompare(1.0f + oldRow.batterySoc, 1.0f + newRow.batterySoc)) {
+        roles.append(static_cast<int>(FleetLiveDataModel::Roles::BatterySoc));
+    }
+    if (oldRow.valid != newRow.valid) {
+        roles.append(static_cast<int>(FleetLiveDataModel::Roles::Valid));
+    }
+    if (oldRow.lastUpdate != newRow.lastUpdate) {
+        roles.append(static_cast<int>(FleetLiveDataModel::Roles::LastUpdate));
+    }
+    if (oldRow.error != newRow.error) {
+        roles.append(static_cast<int>(FleetLiveDataModel::Roles::Error));
+    }
+
+    if (roles.isEmpty()) {
+        return;
+    }
+
+    FleetStatistics statistics = m_statistics;
+    statistics.add(oldRow, -1);
+    statistics.add(newRow, 1);
+
+    oldRow = newRow;
+
+    const QModelIndex index = q->index(row, 0);
+    Q_EMIT q->dataChanged(index, index, roles);
+
+    setStatistics(statistics);
+}
+
+void FleetLiveDataModelPrivate::markPolled(int row)
+{
+    FleetRow &item = m_rows[row];
+    if (item.polled) {
+        return;
+    }
+
+    item.polled = true;
+    --m_unpolledCount;
+    if (m_unpolledCount == 0 && m_status == RequestStatus::Loading) {
+        setStatus(RequestStatus::Finished);
+    }
+}
+
+void FleetLiveDataModelPrivate::abortRequests()
+{
+    m_backoffTimer.stop();
+    m_queue.clear();
+
+    const auto requests = m_requests;
+    m_requests.clear();
+    for (const auto &request : requests) {
+        if (request) {
+            QObject::disconnect(request, nullptr, q, nullptr);
+            request->abort();
+        }
+    }
+
+    for (FleetRow &row : m_rows) {
+        row.queued = false;
+    }
+}
+
+void FleetLiveDataModelPrivate::enqueue(int row)
+{
+    FleetRow &item = m_rows[row];
+    // Still waiting for its previous turn.
+    if (item.queued) {
+        return;
+    }
+
+    item.queued = true;
+    m_queue.append(row);
+}
+
+void FleetLiveDataModelPrivate::dispatch()
+{
+    while (!m_queue.isEmpty() && m_requests.count() < m_concurrency && !m_backoffTimer.isActive()) {
+        const int row = m_queue.takeFirst();
+        if (!sendRequest(row)) {
+            // The connector cannot send anything right now, try again next time.
+            m_rows[row].queued = false;
+            for (int queuedRow : std::as_const(m_queue)) {
+                m_rows[queuedRow].queued = false;
+            }
+            m_queue.clear();
+            break;
+        }
+    }
+}
+
+bool FleetLiveDataModelPrivate::sendRequest(int row)
+{
+    auto *request = new ApiRequest(m_connector, ApiRequest::EndPoint::LastPowerData, q);
+    request->setRequestGroup(m_requestGroup);
+    request->setSysSn(m_rows.at(row).serialNumber);
+
+    QObject::connect(request, &ApiRequest::errorOccurred, q, [this, request, row] {
+        if (request->error() == ErrorCode::TooManyRequests) {
+            // Try this system again later and don't push as hard.
+            m_queue.prepend(row);
+            m_concurrency = std::max(1, m_concurrency / 2);
+            m_backoffTimer.start();
+            return;
+        }
+
+        m_rows[row].queued = false;
+
+        FleetRow newRow = m_rows.at(row);
+        newRow.error = request->error();
+        updateRow(row, newRow);
+        markPolled(row);
+    });
+
+    QObject::connect(request, &ApiRequest::result, q, [this, request, row] {
+        const QJsonObject json = request->data().toObject();
+
+        m_rows[row].queued = false;
+
+        FleetRow newRow = m_rows.at(row);
+        newRow.photovoltaicPower = json.value(QStringLiteral("ppv")).toInt();
+        newRow.currentLoad = json.value(QStringLiteral("pload")).toInt();
+        newRow.gridPower = json.value(QStringLiteral("pgrid")).toInt();
+        newRow.batteryPower = json.value(QStringLiteral("pbat")).toInt();
+        newRow.batterySoc = static_cast<float>(json.value(QStringLiteral("soc")).toDouble());
+
+        // Same as LastPowerData.
+        bool valid = false;
+        for (const auto &key : {QStringLiteral("pload"), QStringLiteral("soc"), QStringLiteral("pgrid"), QStringLiteral("pbat")}) {
+            const QJsonValue value = json.value(key);
+            valid = valid || (!value.isUndefined() && !value.isNull());
+        }
+        newRow.valid = valid;
+        newRow.error = ErrorCode::NoError;
+        if (!request->stale()) {
+            newRow.lastUpdate = QDateTime::currentMSecsSinceEpoch();
+        }
+
+        updateRow(row, newRow);
+        markPolled(row);
+
+        // Ramp up again after the server asked us to slow down.
+        if (m_concurrency < m_maximumConcurrentRequests && !m_backoffTimer.isActive()) {
+            ++m_concurrency;
+        }
+    });
+
+    QObject::connect(request, &ApiRequest::finished, q, [this, request] {
+        m_requests.removeOne(request);
+        dispatch();
+    });
+
+    if (!request->send()) {
+        return false;
+    }
+
+    m_requests.append(request);
+    return true;
+}
+
+void FleetLiveDataModelPrivate::startPolling()
+{
+    m_pollTimer.stop();
+    m_cursor = 0;
+
+    if (m_interval <= 0 || m_rows.isEmpty()) {
+        return;
+    }
+
+    const qint64 rowCount = m_rows.count();
+    const int tickInterval = static_cast<int>(std::max<qint64>(s_minimumTickInterval, m_interval / rowCount));
+    m_batchSize = static_cast<int>(std::max<qint64>(1, (rowCount * tickInterval + m_interval - 1) / m_interval));
+
+    qCDebug(QALPHACLOUD_LOG) << "Polling" << rowCount << "systems in batches of" << m_batchSize << "every" << tickInterval << "ms";
+
+    m_pollTimer.start(tickInterval);
+}
+
+void FleetLiveDataModelPrivate::pollNextBatch()
+{
+    if (m_rows.isEmpty()) {
+        return;
+    }
+
+    for (int i = 0; i < m_batchSize; ++i) {
+        enqueue(m_cursor);
+        m_cursor = (m_cursor + 1) % m_rows.count();
+    }
+
+    dispatch();
+}
+
+FleetLiveDataModel::FleetLiveDataModel(QObject *parent)
+    : FleetLiveDataModel(nullptr, QStringList(), parent)
+{
+}
+
+FleetLiveDataModel::FleetLiveDataModel(Connector *connector, const QStringList &serialNumbers, QObject *parent)
+    : QAbstractListModel(parent)
+    , d(std::make_unique<FleetLiveDataModelPrivate>(this))
+{
+    setConnector(connector);
+    setSerialNumbers(serialNumbers);
+}
+
+FleetLiveDataModel::~FleetLiveDataModel()
+{
+    d->abortRequests();
+}
+
+Connector *FleetLiveDataModel::connector() const
+{
+    return d->m_connector;
+}
+
+void FleetLiveDataModel::setConnector(Connector *connector)
+{
+    if (d->m_connector == connector) {
+        return;
+    }
+
+    d->m_connector = connector;
+    reset();
+    Q_EMIT connectorChanged(connector);
+}
+
+RequestGroup *FleetLiveDataModel::requestGroup() const
+{
+    return d->m_requestGroup;
+}
+
+void FleetLiveDataModel::setRequestGroup(RequestGroup *requestGroup)
+{
+    if (d->m_requestGroup == requestGroup) {
+        return;
+    }
+
+    d->m_requestGroup = requestGroup;
+    Q_EMIT requestGroupChanged(requestGroup);
+}
+
+QStringList FleetLiveDataModel::serialNumbers() const
+{
+    return d->m_serialNumbers;
+}
+
+void FleetLiveDataModel::setSerialNumbers(const QStringList &serialNumbers)
+{
+    if (d->m_serialNumbers == serialNumbers) {
+        return;
+    }
+
+    // Row numbers change, in-flight requests would update the wrong row.
+    d->abortRequests();
+
+    const int oldCount = d->m_rows.count();
+
+    beginResetModel();
+
+    QVector<FleetRow> rows;
+    rows.reserve(serialNumbers.count());
+    QHash<QString, int> rowIndex;
+    rowIndex.reserve(serialNumbers.count());
+
+    for (const QString &serialNumber : serialNumbers) {
+        if (serialNumber.isEmpty() || rowIndex.contains(serialNumber)) {
+            continue;
+        }
+
+        const int oldRow = d->m_rowIndex.value(serialNumber, -1);
+        if (oldRow > -1) {
+            rows.append(d->m_rows.at(oldRow));
+        } else {
+            FleetRow row;
+            row.serialNumber = serialNumber;
+            rows.append(row);
+        }
+        rowIndex.insert(serialNumber, rows.count() - 1);
+    }
+
+    d->m_rows = rows;
+    d->m_rowIndex = rowIndex;
+    d->m_serialNumbers = serialNumbers;
+
+    endResetModel();
+
+    d->recalculateStatistics();
+
+    if (oldCount != d->m_rows.count()) {
+        Q_EMIT countChanged();
+    }
+
+    Q_EMIT serialNumbersChanged(serialNumbers);
+
+    // Keep polling the new set of systems.
+    if (d->m_status != RequestStatus::NoRequest) {
+        if (!reload()) {
+            d->m_pollTimer.stop();
+            d->setStatus(RequestStatus::NoRequest);
+        }
+    }
+}
+
+int FleetLiveDataModel::interval() const
+{
+    return d->m_interval;
+}
+
+void FleetLiveDataModel::setInterval(int interval)
+{
+    interval = std::max(0, interval);
+    if (d->m_interval == interval) {
+        return;
+    }
+
+    d->m_interval = interval;
+    if (d->m_status != RequestStatus::NoRequest) {
+        d->startPolling();
+    }
+    Q_EMIT intervalChanged(interval);
+}
+
+int FleetLiveDataModel::maximumConcurrentRequests() const
+{
+    return d->m_maximumConcurrentRequests;
+}
+
+void FleetLiveDataModel::setMaximumConcurrentRequests(int maximumConcurrentRequests)
+{
+    maximumConcurrentRequests = std::max(1, maximumConcurrentRequests);
+    if (d->m_maximumConcurrentRequests == maximumConcurrentRequests) {
+        return;
+    }
+
+    d->m_maximumConcurrentRequests = maximumConcurrentRequests;
+    d->m_concurrency = maximumConcurrentRequests;
+    Q_EMIT maximumConcurrentRequestsChanged(maximumConcurrentRequests);
+
+    d->dispatch();
+}
+
+int FleetLiveDataModel::photovoltaicPower() const
+{
+    return static_cast<int>(d->m_statistics.photovoltaicPower);
+}
+
+int FleetLiveDataModel::currentLoad() const
+{
+    return static_cast<int>(d->m_statistics.currentLoad);
+}
+
+int FleetLiveDataModel::gridPower() const
+{
+    return static_cast<int>(d->m_statistics.gridPower);
+}
+
+int FleetLiveDataModel::batteryPower() const
+{
+    return static_cast<int>(d->m_statistics.batteryPower);
+}
+
+qreal FleetLiveDataModel::batterySoc() const
+{
+    return d->m_statistics.batterySoc();
+}
+
+int FleetLiveDataModel::validCount() const
+{
+    return d->m_statistics.validCount;
+}
+
+int FleetLiveDataModel::errorCount() const
+{
+    return d->m_statistics.errorCount;
+}
+
+RequestStatus FleetLiveDataModel::status() const
+{
+    return d->m_status;
+}
+
+int FleetLiveDataModel::indexOf(const QString &serialNumber) const
+{
+    return d->m_rowIndex.value(serialNumber, -1);
+}
+
+int FleetLiveDataModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+
+    return d->m_rows.count();
+}
+
+QVariant FleetLiveDataModel::data(const QModelIndex &index, int role) const
+{
+    if (!checkIndex(index, QAbstractItemModel::CheckIndexOption::IndexIsValid)) {
+        return {};
+    }
+
+    const auto &item = d->m_rows.at(index.row());
+
+    switch (static_cast<Roles>(role)) {
+    case Roles::SerialNumber:
+        return item.serialNumber;
+    case Roles::PhotovoltaicPower:
+        return item.photovoltaicPower;
+    case Roles::CurrentLoad:
+        return item.currentLoad;
+    case Roles::GridPower:
+        return item.gridPower;
+    case Roles::BatteryPower:
+        return item.batteryPower;
+    case Roles::BatterySoc:
+        return static_cast<qreal>(item.batterySoc);
+    case Roles::Valid:
+        return item.valid;
+    case Roles::LastUpdate:
+        if (item.lastUpdate > 0) {
+            return QDateTime::fromMSecsSinceEpoch(item.lastUpdate);
+        }
+        return QDateTime();
+    case Roles::Error:
+        return QVariant::fromValue(item.error);
+    }
+
+    return {};
+}
+
+QHash<int, QByteArray> FleetLiveDataModel::roleNames() const
+{
+    return Utils::roleNamesFromEnum(QMetaEnum::fromType<Roles>());
+}
+
+bool FleetLiveDataModel::reload()
+{
+    if (!d->m_connector) {
+        qCWarning(QALPHACLOUD_LOG) << "Cannot load FleetLiveDataModel without a connector";
+        return false;
+    }
+
+    if (d->m_rows.isEmpty()) {
+        qCWarning(QALPHACLOUD_LOG) << "Cannot load FleetLiveDataModel without serial numbers";
+        return false;
+    }
+
+    d->abortRequests();
+    d->m_concurrency = d->m_maximumConcurrentRequests;
+
+    for (int row = 0; row < d->m_rows.count(); ++row) {
+        d->m_rows[row].polled = false;
+        d->enqueue(row);
+    }
+    d->m_unpolledCount = d->m_rows.count();
+
+    d->dispatch();
+
+    if (d->m_requests.isEmpty()) {
+        d->abortRequests();
+        return false;
+    }
+
+    d->setStatus(RequestStatus::Loading);
+    d->startPolling();
+    return true;
+}
+
+void FleetLiveDataModel::reset()
+{
+    d->abortRequests();
+    d->m_pollTimer.stop();
+
+    beginResetModel();
+    for (FleetRow &row : d->m_rows) {
+        const QString serialNumber = row.serialNumber;
+        row = FleetRow();
+        row.serialNumber = serialNumber;
+    }
+    endResetModel();
+
+    d->setStatistics(FleetStatistics());
+    d->setStatus(RequestStatus::NoRequest);
+}
+
+} // namespace QAlphaCloud
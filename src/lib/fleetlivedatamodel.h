@@ -0,0 +1,240 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <QAbstractListModel>
+#include <QStringList>
+
+#include <memory>
+
+#include "connector.h"
+#include "qalphacloud.h"
+#include "qalphacloud_export.h"
+#include "requestgroup.h"
+
+namespace QAlphaCloud
+{
+
+class FleetLiveDataModelPrivate;
+
+/**
+ * @brief Live data of many storage systems
+ *
+ * Provides the current photovoltaic production, load, battery, and grid
+ * power of every storage system in serialNumbers, one row per system,
+ * together with totals over all of them.
+ *
+ * Unlike using one LastPowerData per system, this scales to thousands of
+ * systems: rows are stored compactly, only a limited number of requests
+ * is sent at the same time, and the requests are spread evenly across
+ * the interval rather than being sent all at once.
+ *
+ * Wraps the @c /getLastPowerData API endpoint.
+ */
+class QALPHACLOUD_EXPORT FleetLiveDataModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+    /**
+     * @brief The connector to use
+     */
+    Q_PROPERTY(QAlphaCloud::Connector *connector READ connector WRITE setConnector NOTIFY connectorChanged REQUIRED)
+
+    /**
+     * @brief The request group
+     *
+     * Optional. Requests are sent as part of this group
+     * so that they can be canceled together with others.
+     */
+    Q_PROPERTY(QAlphaCloud::RequestGroup *requestGroup READ requestGroup WRITE setRequestGroup NOTIFY requestGroupChanged)
+
+    /**
+     * @brief The serial numbers
+     *
+     * The serial numbers of the storage systems whose data should be queried.
+     *
+     * Data of systems that remain in the list is kept when it is changed.
+     */
+    Q_PROPERTY(QStringList serialNumbers READ serialNumbers WRITE setSerialNumbers NOTIFY serialNumbersChanged REQUIRED)
+
+    /**
+     * @brief Interval in ms in which every system is polled
+     *
+     * The requests are spread evenly over the interval.
+     *
+     * Default is 30 seconds. 0 means systems are only polled on reload().
+     */
+    Q_PROPERTY(int interval READ interval WRITE setInterval NOTIFY intervalChanged)
+
+    /**
+     * @brief The maximum number of requests sent at the same time
+     *
+     * Default is 4.
+     */
+    Q_PROPERTY(int maximumConcurrentRequests READ maximumConcurrentRequests WRITE setMaximumConcurrentRequests NOTIFY maximumConcurrentRequestsChanged)
+
+    /**
+     * @brief Total photovoltaic production in W of all systems
+     */
+    Q_PROPERTY(int photovoltaicPower READ photovoltaicPower NOTIFY photovoltaicPowerChanged)
+    /**
+     * @brief Total current load in W of all systems
+     */
+    Q_PROPERTY(int currentLoad READ currentLoad NOTIFY currentLoadChanged)
+    /**
+     * @brief Total grid power in W of all systems
+     */
+    Q_PROPERTY(int gridPower READ gridPower NOTIFY gridPowerChanged)
+    /**
+     * @brief Total battery power in W of all systems
+     */
+    Q_PROPERTY(int batteryPower READ batteryPower NOTIFY batteryPowerChanged)
+    /**
+     * @brief Average battery state of charge in per-cent % of all systems
+     */
+    Q_PROPERTY(qreal batterySoc READ batterySoc NOTIFY batterySocChanged)
+
+    /**
+     * @brief The number of systems with valid data
+     *
+     * Only those contribute to the totals.
+     */
+    Q_PROPERTY(int validCount READ validCount NOTIFY validCountChanged)
+    /**
+     * @brief The number of systems whose last request failed
+     */
+    Q_PROPERTY(int errorCount READ errorCount NOTIFY errorCountChanged)
+
+    /**
+     * @brief The number of items in the model
+     */
+    Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
+
+    /**
+     * @brief The current request status
+     *
+     * This is Loading until every system has been polled once after reload().
+     * Errors are reported per system, see the Error role and errorCount.
+     */
+    Q_PROPERTY(QAlphaCloud::RequestStatus status READ status NOTIFY statusChanged)
+
+public:
+    /**
+     * @brief Creates a FleetLiveDataModel instance
+     * @param parent The owner
+     *
+     * @note A connector and serialNumbers must be set before requests can be made.
+     */
+    explicit FleetLiveDataModel(QObject *parent = nullptr);
+    /**
+     * @brief Creates a FleetLiveDataModel instance
+     * @param connector The connector
+     * @param serialNumbers The serial numbers of the storage systems whose data should be queried
+     * @param parent The owner
+     */
+    FleetLiveDataModel(Connector *connector, const QStringList &serialNumbers, QObject *parent = nullptr);
+    ~FleetLiveDataModel() override;
+
+    /**
+     * @brief The model roles
+     */
+    enum class Roles {
+        SerialNumber = Qt::UserRole, ///< The serial number (QString)
+        PhotovoltaicPower, ///< The photovoltaic production in W (int)
+        CurrentLoad, ///< The current load in W (int)
+        GridPower, ///< The current grid power in W (int)
+        BatteryPower, ///< The current battery power in W (int)
+        BatterySoc, ///< The battery state of charge in per-cent % (qreal)
+        Valid, ///< Whether valid data has been received (bool)
+        LastUpdate, ///< When data was last received for this system (QDateTime)
+        Error, ///< The error of the last request, if any (QAlphaCloud::ErrorCode)
+    };
+    Q_ENUM(Roles)
+
+    Q_REQUIRED_RESULT Connector *connector() const;
+    void setConnector(Connector *connector);
+    Q_SIGNAL void connectorChanged(Connector *connector);
+
+    Q_REQUIRED_RESULT QAlphaCloud::RequestGroup *requestGroup() const;
+    void setRequestGroup(QAlphaCloud::RequestGroup *requestGroup);
+    Q_SIGNAL void requestGroupChanged(QAlphaCloud::RequestGroup *requestGroup);
+
+    Q_REQUIRED_RESULT QStringList serialNumbers() const;
+    void setSerialNumbers(const QStringList &serialNumbers);
+    Q_SIGNAL void serialNumbersChanged(const QStringList &serialNumbers);
+
+    Q_REQUIRED_RESULT int interval() const;
+    void setInterval(int interval);
+    Q_SIGNAL void intervalChanged(int interval);
+
+    Q_REQUIRED_RESULT int maximumConcurrentRequests() const;
+    void setMaximumConcurrentRequests(int maximumConcurrentRequests);
+    Q_SIGNAL void maximumConcurrentRequestsChanged(int maximumConcurrentRequests);
+
+    Q_REQUIRED_RESULT int photovoltaicPower() const;
+    Q_SIGNAL void photovoltaicPowerChanged(int photovoltaicPower);
+
+    Q_REQUIRED_RESULT int currentLoad() const;
+    Q_SIGNAL void currentLoadChanged(int currentLoad);
+
+    Q_REQUIRED_RESULT int gridPower() const;
+    Q_SIGNAL void gridPowerChanged(int gridPower);
+
+    Q_REQUIRED_RESULT int batteryPower() const;
+    Q_SIGNAL void batteryPowerChanged(int batteryPower);
+
+    Q_REQUIRED_RESULT qreal batterySoc() const;
+    Q_SIGNAL void batterySocChanged(qreal batterySoc);
+
+    Q_REQUIRED_RESULT int validCount() const;
+    Q_SIGNAL void validCountChanged(int validCount);
+
+    Q_REQUIRED_RESULT int errorCount() const;
+    Q_SIGNAL void errorCountChanged(int errorCount);
+
+    QAlphaCloud::RequestStatus status() const;
+    Q_SIGNAL void statusChanged(QAlphaCloud::RequestStatus status);
+
+    /**
+     * @brief The row of a storage system
+     * @param serialNumber The serial number of the storage system
+     * @return The row, or -1 if the serial number isn't in the model.
+     */
+    Q_INVOKABLE int indexOf(const QString &serialNumber) const;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+public Q_SLOTS:
+
+    /**
+     * @brief (Re)load data
+     *
+     * Polls all systems right away and then keeps polling them every interval.
+     * In QML, this is done automatically on component completion if the
+     * @a active property (not documented here) is true, which is the default.
+     * @return Whether the requests were sent.
+     *
+     * @note You must set a connector and serialNumbers before requests can be sent.
+     */
+    bool reload();
+    /**
+     * @brief Reset object
+     *
+     * This stops polling, clears all data and resets the object back to its initial state.
+     */
+    void reset();
+
+Q_SIGNALS:
+    void countChanged();
+
+private:
+    friend FleetLiveDataModelPrivate;
+    std::unique_ptr<FleetLiveDataModelPrivate> const d;
+};
+
+} // namespace QAlphaCloud
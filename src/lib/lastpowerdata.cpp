@@ -6,6 +6,7 @@
 #include "lastpowerdata.h"
 
 #include "apirequest.h"
+#include "autorefresh_p.h"
 #include "qalphacloud_log.h"
 #include "utils_p.h"
 
@@ -22,6 +23,8 @@ public:
     void setStatus(RequestStatus status);
     void setError(ErrorCode error);
     void setErrorString(const QString &errorString);
+    void setStale(bool stale);
+    void setCircuitState(CircuitState circuitState);
 
     void processApiResult(const QJsonObject &json);
 
@@ -29,6 +32,7 @@ public:
 
     // TODO QPointer?
     Connector *m_connector = nullptr;
+    QPointer<RequestGroup> m_requestGroup;
     QString m_serialNumber;
 
     int m_photovoltaicPower = 0;
@@ -44,12 +48,19 @@ public:
     QString m_errorString;
 
     bool m_valid = false;
+    bool m_stale = false;
+    CircuitState m_circuitState = CircuitState::Closed;
 
     QPointer<ApiRequest> m_request;
+
+    AutoRefresh m_autoRefresh;
 };
 
 LastPowerDataPrivate::LastPowerDataPrivate(LastPowerData *q)
     : q(q)
+    , m_autoRefresh([q] {
+        return q->reload();
+    })
 {
 }
 
@@ -77,6 +88,22 @@ void LastPowerDataPrivate::setErrorString(const QString &errorString)
     }
 }
 
+void LastPowerDataPrivate::setStale(bool stale)
+{
+    if (m_stale != stale) {
+        m_stale = stale;
+        Q_EMIT q->staleChanged(stale);
+    }
+}
+
+void LastPowerDataPrivate::setCircuitState(CircuitState circuitState)
+{
+    if (m_circuitState != circuitState) {
+        m_circuitState = circuitState;
+        Q_EMIT q->circuitStateChanged(circuitState);
+    }
+}
+
 void LastPowerDataPrivate::processApiResult(const QJsonObject &json)
 {
     bool valid = false;
@@ -147,10 +174,26 @@ void LastPowerData::setConnector(Connector *connector)
     }
 
     d->m_connector = connector;
+    d->m_autoRefresh.setConnector(connector);
     reset();
     Q_EMIT connectorChanged(connector);
 }
 
+RequestGroup *LastPowerData::requestGroup() const
+{
+    return d->m_requestGroup;
+}
+
+void LastPowerData::setRequestGroup(RequestGroup *requestGroup)
+{
+    if (d->m_requestGroup == requestGroup) {
+        return;
+    }
+
+    d->m_requestGroup = requestGroup;
+    Q_EMIT requestGroupChanged(requestGroup);
+}
+
 QString LastPowerData::serialNumber() const
 {
     return d->m_serialNumber;
@@ -202,6 +245,16 @@ bool LastPowerData::valid() const
     return d->m_valid;
 }
 
+bool LastPowerData::stale() const
+{
+    return d->m_stale;
+}
+
+CircuitState LastPowerData::circuitState() const
+{
+    return d->m_circuitState;
+}
+
 RequestStatus LastPowerData::status() const
 {
     return d->m_status;
@@ -217,6 +270,30 @@ QString LastPowerData::errorString() const
     return d->m_errorString;
 }
 
+int LastPowerData::autoRefreshInterval() const
+{
+    return d->m_autoRefresh.interval();
+}
+
+void LastPowerData::setAutoRefreshInterval(int autoRefreshInterval)
+{
+    if (d->m_autoRefresh.setInterval(autoRefreshInterval)) {
+        Q_EMIT autoRefreshIntervalChanged(d->m_autoRefresh.interval());
+    }
+}
+
+bool LastPowerData::paused() const
+{
+    return d->m_autoRefresh.paused();
+}
+
+void LastPowerData::setPaused(bool paused)
+{
+    if (d->m_autoRefresh.setPaused(paused)) {
+        Q_EMIT pausedChanged(paused);
+    }
+}
+
 bool LastPowerData::reload()
 {
     if (!d->m_connector) {
@@ -229,6 +306,8 @@ bool LastPowerData::reload()
         return false;
     }
 
+    d->m_autoRefresh.restart();
+
     if (d->m_request) {
         qCDebug(QALPHACLOUD_LOG) << "Cancelling LastPowerData request in-flight";
         d->m_request->abort();
@@ -236,9 +315,11 @@ bool LastPowerData::reload()
     }
 
     auto *request = new ApiRequest(d->m_connector, ApiRequest::EndPoint::LastPowerData, this);
+    request->setRequestGroup(d->m_requestGroup);
     request->setSysSn(d->m_serialNumber);
 
     connect(request, &ApiRequest::errorOccurred, this, [this, request] {
+        d->setCircuitState(request->circuitState());
         d->setError(request->error());
         d->setErrorString(request->errorString());
         d->setStatus(RequestStatus::Error);
@@ -247,6 +328,8 @@ bool LastPowerData::reload()
     connect(request, &ApiRequest::result, this, [this, request] {
         const QJsonObject json = request->data().toObject();
 
+        d->setStale(request->stale());
+        d->setCircuitState(request->circuitState());
         d->processApiResult(json);
     });
 
@@ -263,10 +346,13 @@ bool LastPowerData::reload()
 
 void LastPowerData::reset()
 {
+    d->m_autoRefresh.stop();
     if (d->m_request) {
         d->m_request->abort();
         d->m_request = nullptr;
     }
+    d->setStale(false);
+    d->setCircuitState(CircuitState::Closed);
     d->processApiResult(QJsonObject());
     d->setStatus(RequestStatus::NoRequest);
 }
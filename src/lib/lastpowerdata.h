@@ -13,6 +13,7 @@
 
 #include "connector.h"
 #include "qalphacloud.h"
+#include "requestgroup.h"
 
 namespace QAlphaCloud
 {
@@ -35,6 +36,14 @@ class Q_DECL_EXPORT LastPowerData : public QObject
      */
     Q_PROPERTY(QAlphaCloud::Connector *connector READ connector WRITE setConnector NOTIFY connectorChanged REQUIRED)
 
+    /**
+     * @brief The request group
+     *
+     * Optional. Requests are sent as part of this group
+     * so that they can be canceled together with others.
+     */
+    Q_PROPERTY(QAlphaCloud::RequestGroup *requestGroup READ requestGroup WRITE setRequestGroup NOTIFY requestGroupChanged)
+
     /**
      * @brief The serial number
      *
@@ -88,6 +97,43 @@ class Q_DECL_EXPORT LastPowerData : public QObject
      */
     Q_PROPERTY(bool valid READ valid NOTIFY validChanged STORED false)
 
+    /**
+     * @brief Whether the data is outdated
+     *
+     * This is the case when the storage system has been unreachable
+     * for a while and the last known data is provided instead.
+     * It is then checked less frequently, regardless of how often
+     * this object is reloaded.
+     */
+    Q_PROPERTY(bool stale READ stale NOTIFY staleChanged)
+
+    /**
+     * @brief State of the circuit breaker for this storage system
+     *
+     * Whether requests are sent normally, or held back as the storage system is unreachable.
+     * Updated whenever a request finishes.
+     */
+    Q_PROPERTY(QAlphaCloud::CircuitState circuitState READ circuitState NOTIFY circuitStateChanged)
+
+    /**
+     * @brief Automatically reload data at this interval in milliseconds
+     *
+     * The interval counts from the most recent reload. Nothing is reloaded
+     * automatically until data has been loaded once
+     * or while the connector is offline.
+     *
+     * Default is 0, i.e. no automatic reloading.
+     */
+    Q_PROPERTY(int autoRefreshInterval READ autoRefreshInterval WRITE setAutoRefreshInterval NOTIFY autoRefreshIntervalChanged)
+    /**
+     * @brief Whether automatic reloading is paused
+     *
+     * When unpaused, data is reloaded immediately if a reload became due in the meantime.
+     *
+     * In QML, this is done automatically while the window is hidden or minimized.
+     */
+    Q_PROPERTY(bool paused READ paused WRITE setPaused NOTIFY pausedChanged)
+
     /**
      * @brief The current request status
      */
@@ -128,6 +174,10 @@ public:
     void setConnector(QAlphaCloud::Connector *connector);
     Q_SIGNAL void connectorChanged(QAlphaCloud::Connector *connector);
 
+    Q_REQUIRED_RESULT QAlphaCloud::RequestGroup *requestGroup() const;
+    void setRequestGroup(QAlphaCloud::RequestGroup *requestGroup);
+    Q_SIGNAL void requestGroupChanged(QAlphaCloud::RequestGroup *requestGroup);
+
     Q_REQUIRED_RESULT QString serialNumber() const;
     void setSerialNumber(const QString &serialNumber);
     Q_SIGNAL void serialNumberChanged(const QString &serialNumber);
@@ -153,6 +203,20 @@ public:
     Q_REQUIRED_RESULT bool valid() const;
     Q_SIGNAL void validChanged(bool valid);
 
+    Q_REQUIRED_RESULT bool stale() const;
+    Q_SIGNAL void staleChanged(bool stale);
+
+    Q_REQUIRED_RESULT QAlphaCloud::CircuitState circuitState() const;
+    Q_SIGNAL void circuitStateChanged(QAlphaCloud::CircuitState circuitState);
+
+    Q_REQUIRED_RESULT int autoRefreshInterval() const;
+    void setAutoRefreshInterval(int autoRefreshInterval);
+    Q_SIGNAL void autoRefreshIntervalChanged(int autoRefreshInterval);
+
+    Q_REQUIRED_RESULT bool paused() const;
+    void setPaused(bool paused);
+    Q_SIGNAL void pausedChanged(bool paused);
+
     Q_REQUIRED_RESULT QAlphaCloud::RequestStatus status() const;
     Q_SIGNAL void statusChanged(QAlphaCloud::RequestStatus status);
 
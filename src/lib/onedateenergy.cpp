@@ -6,6 +6,8 @@
 #include "onedateenergy.h"
 
 #include "apirequest.h"
+#include "autorefresh_p.h"
+#include "deferredreload_p.h"
 #include "qalphacloud_log.h"
 #include "utils_p.h"
 
@@ -25,6 +27,8 @@ public:
     void setStatus(RequestStatus status);
     void setError(ErrorCode error);
     void setErrorString(const QString &errorString);
+    void setStale(bool stale);
+    void setCircuitState(CircuitState circuitState);
 
     void processApiResult(const QJsonObject &json);
 
@@ -32,6 +36,7 @@ public:
 
     // TODO QPointer?
     Connector *m_connector = nullptr;
+    QPointer<RequestGroup> m_requestGroup;
     QString m_serialNumber;
     QDate m_date;
     bool m_cached = true;
@@ -49,14 +54,25 @@ public:
     QString m_errorString;
 
     bool m_valid = false;
+    bool m_stale = false;
+    CircuitState m_circuitState = CircuitState::Closed;
 
     QPointer<ApiRequest> m_request;
 
+    AutoRefresh m_autoRefresh;
+    DeferredReload m_deferredReload;
+
     QHash<QDate, QJsonObject> m_cache;
 };
 
 OneDateEnergyPrivate::OneDateEnergyPrivate(OneDateEnergy *q)
     : q(q)
+    , m_autoRefresh([q] {
+        return q->reload();
+    })
+    , m_deferredReload([q] {
+        return q->reload();
+    })
 {
 }
 
@@ -84,6 +100,22 @@ void OneDateEnergyPrivate::setErrorString(const QString &errorString)
     }
 }
 
+void OneDateEnergyPrivate::setStale(bool stale)
+{
+    if (m_stale != stale) {
+        m_stale = stale;
+        Q_EMIT q->staleChanged(stale);
+    }
+}
+
+void OneDateEnergyPrivate::setCircuitState(CircuitState circuitState)
+{
+    if (m_circuitState != circuitState) {
+        m_circuitState = circuitState;
+        Q_EMIT q->circuitStateChanged(circuitState);
+    }
+}
+
 void OneDateEnergyPrivate::processApiResult(const QJsonObject &json)
 {
     bool valid = false;
@@ -177,11 +209,27 @@ void OneDateEnergy::setConnector(Connector *connector)
     }
 
     d->m_connector = connector;
+    d->m_autoRefresh.setConnector(connector);
     d->m_cache.clear();
     reset();
     Q_EMIT connectorChanged(connector);
 }
 
+RequestGroup *OneDateEnergy::requestGroup() const
+{
+    return d->m_requestGroup;
+}
+
+void OneDateEnergy::setRequestGroup(RequestGroup *requestGroup)
+{
+    if (d->m_requestGroup == requestGroup) {
+        return;
+    }
+
+    d->m_requestGroup = requestGroup;
+    Q_EMIT requestGroupChanged(requestGroup);
+}
+
 QString OneDateEnergy::serialNumber() const
 {
     return d->m_serialNumber;
@@ -283,6 +331,16 @@ bool OneDateEnergy::valid() const
     return d->m_valid;
 }
 
+bool OneDateEnergy::stale() const
+{
+    return d->m_stale;
+}
+
+CircuitState OneDateEnergy::circuitState() const
+{
+    return d->m_circuitState;
+}
+
 RequestStatus OneDateEnergy::status() const
 {
     return d->m_status;
@@ -298,8 +356,41 @@ QString OneDateEnergy::errorString() const
     return d->m_errorString;
 }
 
+int OneDateEnergy::autoRefreshInterval() const
+{
+    return d->m_autoRefresh.interval();
+}
+
+void OneDateEnergy::setAutoRefreshInterval(int autoRefreshInterval)
+{
+    if (d->m_autoRefresh.setInterval(autoRefreshInterval)) {
+        Q_EMIT autoRefreshIntervalChanged(d->m_autoRefresh.interval());
+    }
+}
+
+bool OneDateEnergy::paused() const
+{
+    return d->m_autoRefresh.paused();
+}
+
+void OneDateEnergy::setPaused(bool paused)
+{
+    if (d->m_autoRefresh.setPaused(paused)) {
+        Q_EMIT pausedChanged(paused);
+    }
+}
+
+int OneDateEnergy::suppressedReloadCount() const
+{
+    return d->m_deferredReload.suppressedCount();
+}
+
 bool OneDateEnergy::reload()
 {
+    if (d->m_deferredReload.cancel()) {
+        Q_EMIT suppressedReloadCountChanged(d->m_deferredReload.suppressedCount());
+    }
+
     if (!d->m_connector) {
         qCWarning(QALPHACLOUD_LOG) << "Cannot load OneDateEnergy without a connector";
         return false;
@@ -316,6 +407,8 @@ bool OneDateEnergy::reload()
         return false;
     }
 
+    d->m_autoRefresh.restart();
+
     if (d->m_request) {
         qCDebug(QALPHACLOUD_LOG) << "Cancelling OneDateEnergy request in-flight";
         d->m_request->abort();
@@ -324,15 +417,18 @@ bool OneDateEnergy::reload()
 
     const auto cachedData = d->m_cache.value(date);
     if (!cachedData.isEmpty()) {
+        d->setStale(false);
         d->processApiResult(cachedData);
         return true;
     }
 
     auto *request = new ApiRequest(d->m_connector, ApiRequest::EndPoint::OneDateEnergyBySn, this);
+    request->setRequestGroup(d->m_requestGroup);
     request->setSysSn(d->m_serialNumber);
     request->setQueryDate(date);
 
     connect(request, &ApiRequest::errorOccurred, this, [this, request] {
+        d->setCircuitState(request->circuitState());
         d->setError(request->error());
         d->setErrorString(request->errorString());
         d->setStatus(RequestStatus::Error);
@@ -341,11 +437,13 @@ bool OneDateEnergy::reload()
     connect(request, &ApiRequest::result, this, [this, request, date] {
         const QJsonObject json = request->data().toObject();
 
+        d->setStale(request->stale());
+        d->setCircuitState(request->circuitState());
         d->processApiResult(json);
 
         // Don't cache today's data as it will gain new data as the day progresses.
         // Also don't cache if there is no valid data.
-        if (d->m_cached && d->m_valid && date != QDate::currentDate()) {
+        if (d->m_cached && d->m_valid && !d->m_stale && date != QDate::currentDate()) {
             d->m_cache.insert(date, json);
         }
     });
@@ -361,6 +459,13 @@ bool OneDateEnergy::reload()
     return ok;
 }
 
+void OneDateEnergy::scheduleReload()
+{
+    if (!d->m_deferredReload.schedule()) {
+        Q_EMIT suppressedReloadCountChanged(d->m_deferredReload.suppressedCount());
+    }
+}
+
 bool OneDateEnergy::forceReload()
 {
     d->m_cache.clear();
@@ -369,6 +474,9 @@ bool OneDateEnergy::forceReload()
 
 void OneDateEnergy::reset()
 {
+    d->m_autoRefresh.stop();
+    d->setStale(false);
+    d->setCircuitState(CircuitState::Closed);
     d->processApiResult(QJsonObject());
     if (d->m_request) {
         d->m_request->abort();
@@ -15,6 +15,7 @@
 #include "connector.h"
 #include "qalphacloud.h"
 #include "qalphacloud_export.h"
+#include "requestgroup.h"
 
 namespace QAlphaCloud
 {
@@ -37,6 +38,14 @@ class QALPHACLOUD_EXPORT OneDateEnergy : public QObject
      */
     Q_PROPERTY(QAlphaCloud::Connector *connector READ connector WRITE setConnector NOTIFY connectorChanged REQUIRED)
 
+    /**
+     * @brief The request group
+     *
+     * Optional. Requests are sent as part of this group
+     * so that they can be canceled together with others.
+     */
+    Q_PROPERTY(QAlphaCloud::RequestGroup *requestGroup READ requestGroup WRITE setRequestGroup NOTIFY requestGroupChanged)
+
     /**
      * @brief The serial number
      *
@@ -115,6 +124,50 @@ class QALPHACLOUD_EXPORT OneDateEnergy : public QObject
      */
     Q_PROPERTY(bool valid READ valid NOTIFY validChanged STORED false)
 
+    /**
+     * @brief Whether the data is outdated
+     *
+     * This is the case when the storage system has been unreachable
+     * for a while and the last known data is provided instead.
+     * It is then checked less frequently, regardless of how often
+     * this object is reloaded.
+     */
+    Q_PROPERTY(bool stale READ stale NOTIFY staleChanged)
+
+    /**
+     * @brief State of the circuit breaker for this storage system
+     *
+     * Whether requests are sent normally, or held back as the storage system is unreachable.
+     * Updated whenever a request finishes.
+     */
+    Q_PROPERTY(QAlphaCloud::CircuitState circuitState READ circuitState NOTIFY circuitStateChanged)
+
+    /**
+     * @brief Automatically reload data at this interval in milliseconds
+     *
+     * The interval counts from the most recent reload. Nothing is reloaded
+     * automatically until data has been loaded once
+     * or while the connector is offline.
+     *
+     * Default is 0, i.e. no automatic reloading.
+     */
+    Q_PROPERTY(int autoRefreshInterval READ autoRefreshInterval WRITE setAutoRefreshInterval NOTIFY autoRefreshIntervalChanged)
+    /**
+     * @brief Whether automatic reloading is paused
+     *
+     * When unpaused, data is reloaded immediately if a reload became due in the meantime.
+     *
+     * In QML, this is done automatically while the window is hidden or minimized.
+     */
+    Q_PROPERTY(bool paused READ paused WRITE setPaused NOTIFY pausedChanged)
+
+    /**
+     * @brief Number of reloads that were folded into another one
+     *
+     * See scheduleReload(). This is for diagnostics.
+     */
+    Q_PROPERTY(int suppressedReloadCount READ suppressedReloadCount NOTIFY suppressedReloadCountChanged)
+
     /**
      * @brief The current request status
      */
@@ -156,6 +209,10 @@ public:
     void setConnector(Connector *connector);
     Q_SIGNAL void connectorChanged(Connector *connector);
 
+    Q_REQUIRED_RESULT QAlphaCloud::RequestGroup *requestGroup() const;
+    void setRequestGroup(QAlphaCloud::RequestGroup *requestGroup);
+    Q_SIGNAL void requestGroupChanged(QAlphaCloud::RequestGroup *requestGroup);
+
     Q_REQUIRED_RESULT QString serialNumber() const;
     void setSerialNumber(const QString &serialNumber);
     Q_SIGNAL void serialNumberChanged(const QString &serialNumber);
@@ -196,6 +253,23 @@ public:
     Q_REQUIRED_RESULT bool valid() const;
     Q_SIGNAL void validChanged(bool valid);
 
+    Q_REQUIRED_RESULT bool stale() const;
+    Q_SIGNAL void staleChanged(bool stale);
+
+    Q_REQUIRED_RESULT QAlphaCloud::CircuitState circuitState() const;
+    Q_SIGNAL void circuitStateChanged(QAlphaCloud::CircuitState circuitState);
+
+    Q_REQUIRED_RESULT int autoRefreshInterval() const;
+    void setAutoRefreshInterval(int autoRefreshInterval);
+    Q_SIGNAL void autoRefreshIntervalChanged(int autoRefreshInterval);
+
+    Q_REQUIRED_RESULT bool paused() const;
+    void setPaused(bool paused);
+    Q_SIGNAL void pausedChanged(bool paused);
+
+    Q_REQUIRED_RESULT int suppressedReloadCount() const;
+    Q_SIGNAL void suppressedReloadCountChanged(int suppressedReloadCount);
+
     Q_REQUIRED_RESULT QAlphaCloud::RequestStatus status() const;
     Q_SIGNAL void statusChanged(QAlphaCloud::RequestStatus status);
 
@@ -219,6 +293,17 @@ public Q_SLOTS:
      * @note When the request fails, the current data is not cleared.
      */
     bool reload();
+    /**
+     * @brief Reload data once control returns to the event loop
+     *
+     * Calling this several times, e.g. when changing multiple properties
+     * in a row, results in a single reload. A reload() in the meantime
+     * makes the scheduled one unnecessary.
+     *
+     * In QML, this is done automatically when a property changes if the
+     * @a active property (not documented here) is true, which is the default.
+     */
+    void scheduleReload();
     /**
      * @brief Force a reload
      *
@@ -6,7 +6,10 @@
 #include "onedaypowermodel.h"
 
 #include "apirequest.h"
+#include "autorefresh_p.h"
 #include "connector.h"
+#include "deferredreload_p.h"
+#include "powerentry_p.h"
 #include "qalphacloud.h"
 #include "qalphacloud_log.h"
 #include "utils_p.h"
@@ -18,67 +21,133 @@
 #include <QMetaEnum>
 #include <QPointer>
 #include <QVector>
+#include <QtAlgorithms>
 
 #include <algorithm>
+#include <array>
 
-struct PowerEntry {
-    static PowerEntry fromJson(const QJsonObject &json)
-    {
-        const auto photovoltaicPower = int{json.value(QStringLiteral("ppv")).toInt()};
-        const auto currentLoad = int{json.value(QStringLiteral("load")).toInt()};
-        // NOTE in documentation this is just called "feed".
-        const auto gridFeed = int{json.value(QStringLiteral("feedIn")).toInt()};
-        const auto gridCharge = int{json.value(QStringLiteral("gridCharge")).toInt()};
+namespace QAlphaCloud
+{
 
-        const auto batterySoc = json.value(QStringLiteral("cbat")).toDouble();
+// Sparse table for answering minimum and maximum queries over an arbitrary
+// range in O(1) after O(n log n) preparation, plus prefix sums for the sum.
+// The data only changes when a new day is loaded, so this is cheap to rebuild.
+class RangeIndex
+{
+public:
+    void build(const QVector<qreal> &values);
+    void clear();
+
+    // from and to are inclusive.
+    qreal minimum(int from, int to) const;
+    qreal maximum(int from, int to) const;
+    qreal sum(int from, int to) const;
+
+private:
+    static int floorLog2(int value);
+
+    int m_count = 0;
+    // Level k holds min/max of the 2^k items starting at i, stored at k * m_count + i.
+    QVector<qreal> m_minimum;
+    QVector<qreal> m_maximum;
+    QVector<qreal> m_prefixSum;
+};
 
-        const QDateTime uploadTime = QDateTime::fromString(json.value(QStringLiteral("uploadTime")).toString(), Qt::ISODate);
+int RangeIndex::floorLog2(int value)
+{
+    Q_ASSERT(value > 0);
+    return 31 - qCountLeadingZeroBits(static_cast<quint32>(value));
+}
 
-        PowerEntry entry{// TODO Should we just read this from the JSON every time?
-                         json,
-                         uploadTime,
-                         photovoltaicPower,
-                         currentLoad,
-                         gridFeed,
-                         gridCharge,
-                         batterySoc};
+void RangeIndex::build(const QVector<qreal> &values)
+{
+    m_count = values.count();
 
-        return entry;
+    m_prefixSum.resize(m_count + 1);
+    m_prefixSum[0] = 0.0;
+    for (int i = 0; i < m_count; ++i) {
+        m_prefixSum[i + 1] = m_prefixSum[i] + values[i];
     }
 
-    bool operator==(const PowerEntry &other) const
-    {
-        return json == other.json;
+    if (m_count == 0) {
+        m_minimum.clear();
+        m_maximum.clear();
+        return;
     }
 
-    bool operator!=(const PowerEntry &other) const
-    {
-        return !(json == other.json);
+    const int levels = floorLog2(m_count) + 1;
+    m_minimum.resize(levels * m_count);
+    m_maximum.resize(levels * m_count);
+
+    std::copy(values.cbegin(), values.cend(), m_minimum.begin());
+    std::copy(values.cbegin(), values.cend(), m_maximum.begin());
+
+    for (int level = 1; level < levels; ++level) {
+        const int half = 1 << (level - 1);
+        const int offset = level * m_count;
+        const int previousOffset = (level - 1) * m_count;
+
+        for (int i = 0; i + (1 << level) <= m_count; ++i) {
+            m_minimum[offset + i] = std::min(m_minimum[previousOffset + i], m_minimum[previousOffset + i + half]);
+            m_maximum[offset + i] = std::max(m_maximum[previousOffset + i], m_maximum[previousOffset + i + half]);
+        }
     }
+}
 
-    QJsonObject json;
-    QDateTime uploadTime; // uploadTime
+void RangeIndex::clear()
+{
+    m_count = 0;
+    m_minimum.clear();
+    m_maximum.clear();
+    m_prefixSum.clear();
+}
 
-    // QString serialNumber; // sysSn
-    int photovoltaicPower = 1337; // ppv
-    int currentLoad = 0; // load
-    int gridFeed = 0; // feed(In)
-    int gridCharge = 0; // feed(In)
+qreal RangeIndex::minimum(int from, int to) const
+{
+    Q_ASSERT(from >= 0 && from <= to && to < m_count);
+    const int level = floorLog2(to - from + 1);
+    const int offset = level * m_count;
+    return std::min(m_minimum[offset + from], m_minimum[offset + to - (1 << level) + 1]);
+}
 
-    qreal batterySoc = 0.0; // cbat
+qreal RangeIndex::maximum(int from, int to) const
+{
+    Q_ASSERT(from >= 0 && from <= to && to < m_count);
+    const int level = floorLog2(to - from + 1);
+    const int offset = level * m_count;
+    return std::max(m_maximum[offset + from], m_maximum[offset + to - (1 << level) + 1]);
+}
 
-    // TODO chargingPile
-};
-Q_DECLARE_TYPEINFO(PowerEntry, Q_MOVABLE_TYPE);
+qreal RangeIndex::sum(int from, int to) const
+{
+    Q_ASSERT(from >= 0 && from <= to && to < m_count);
+    return m_prefixSum[to + 1] - m_prefixSum[from];
+}
 
-namespace QAlphaCloud
+bool PowerStatistics::valid() const
+{
+    return count > 0;
+}
+
+qreal PowerStatistics::average() const
 {
+    if (count == 0) {
+        return 0.0;
+    }
+    return sum / count;
+}
 
 class OneDayPowerModelPrivate
 {
 public:
     OneDayPowerModelPrivate(OneDayPowerModel *qq)
         : q(qq)
+        , m_autoRefresh([qq] {
+            return qq->reload();
+        })
+        , m_deferredReload([qq] {
+            return qq->reload();
+        })
     {
     }
 
@@ -96,10 +165,14 @@ public:
 
     void processApiResult(const QJsonArray &jsonArray);
 
+    void rebuildIndex();
+    static int indexColumn(OneDayPowerModel::Roles role);
+
     OneDayPowerModel *const q;
 
     // TODO QPointer?
     Connector *m_connector = nullptr;
+    QPointer<RequestGroup> m_requestGroup;
     QString m_serialNumber;
     QDate m_date;
     bool m_cached = true;
@@ -113,12 +186,22 @@ public:
     int m_peakGridCharge = 0;
 
     QVector<PowerEntry> m_data;
+    // Upload times in msecs since epoch for quick lookup.
+    QVector<qint64> m_timestamps;
+    // Values of each numeric role, see indexColumn().
+    std::array<QVector<qreal>, 5> m_columns;
+    // One for each numeric role, see indexColumn().
+    std::array<RangeIndex, 5> m_rangeIndices;
+
     RequestStatus m_status = RequestStatus::NoRequest;
     ErrorCode m_error = ErrorCode::NoError;
     QString m_errorString;
 
     QPointer<ApiRequest> m_request;
 
+    AutoRefresh m_autoRefresh;
+    DeferredReload m_deferredReload;
+
     QHash<QDate, QJsonArray> m_cache;
 };
 
@@ -231,6 +314,7 @@ void OneDayPowerModelPrivate::processApiResult(const QJsonArray &jsonArray)
 
     q->beginResetModel();
     m_data = entries;
+    rebuildIndex();
     q->endResetModel();
 
     QDateTime fromDateTime;
@@ -251,6 +335,54 @@ void OneDayPowerModelPrivate::processApiResult(const QJsonArray &jsonArray)
     setStatus(RequestStatus::Finished);
 }
 
+void OneDayPowerModelPrivate::rebuildIndex()
+{
+    const int count = m_data.count();
+
+    m_timestamps.resize(count);
+    for (int i = 0; i < count; ++i) {
+        m_timestamps[i] = m_data.at(i).uploadTime.toMSecsSinceEpoch();
+    }
+
+    const auto buildColumn = [this, count](OneDayPowerModel::Roles role, auto member) {
+        const int column = indexColumn(role);
+
+        QVector<qreal> &values = m_columns[column];
+        values.resize(count);
+        for (int i = 0; i < count; ++i) {
+            values[i] = m_data.at(i).*member;
+        }
+        m_rangeIndices[column].build(values);
+    };
+
+    buildColumn(OneDayPowerModel::Roles::PhotovoltaicEnergy, &PowerEntry::photovoltaicPower);
+    buildColumn(OneDayPowerModel::Roles::CurrentLoad, &PowerEntry::currentLoad);
+    buildColumn(OneDayPowerModel::Roles::GridFeed, &PowerEntry::gridFeed);
+    buildColumn(OneDayPowerModel::Roles::GridCharge, &PowerEntry::gridCharge);
+    buildColumn(OneDayPowerModel::Roles::BatterySoc, &PowerEntry::batterySoc);
+}
+
+int OneDayPowerModelPrivate::indexColumn(OneDayPowerModel::Roles role)
+{
+    switch (role) {
+    case OneDayPowerModel::Roles::PhotovoltaicEnergy:
+        return 0;
+    case OneDayPowerModel::Roles::CurrentLoad:
+        return 1;
+    case OneDayPowerModel::Roles::GridFeed:
+        return 2;
+    case OneDayPowerModel::Roles::GridCharge:
+        return 3;
+    case OneDayPowerModel::Roles::BatterySoc:
+        return 4;
+    case OneDayPowerModel::Roles::UploadTime:
+    case OneDayPowerModel::Roles::RawJson:
+        break;
+    }
+
+    return -1;
+}
+
 OneDayPowerModel::OneDayPowerModel(QObject *parent)
     : OneDayPowerModel(nullptr, QString(), QDate::currentDate(), parent)
 {
@@ -284,11 +416,27 @@ void OneDayPowerModel::setConnector(Connector *connector)
     }
 
     d->m_connector = connector;
+    d->m_autoRefresh.setConnector(connector);
     d->m_cache.clear();
     reset();
     Q_EMIT connectorChanged(connector);
 }
 
+RequestGroup *OneDayPowerModel::requestGroup() const
+{
+    return d->m_requestGroup;
+}
+
+void OneDayPowerModel::setRequestGroup(RequestGroup *requestGroup)
+{
+    if (d->m_requestGroup == requestGroup) {
+        return;
+    }
+
+    d->m_requestGroup = requestGroup;
+    Q_EMIT requestGroupChanged(requestGroup);
+}
+
 QString OneDayPowerModel::serialNumber() const
 {
     return d->m_serialNumber;
@@ -432,8 +580,144 @@ QHash<int, QByteArray> OneDayPowerModel::roleNames() const
     return Utils::roleNamesFromEnum(QMetaEnum::fromType<Roles>());
 }
 
+int OneDayPowerModel::indexForDateTime(const QDateTime &dateTime) const
+{
+    const auto &timestamps = d->m_timestamps;
+    if (timestamps.isEmpty() || !dateTime.isValid()) {
+        return -1;
+    }
+
+    const qint64 time = dateTime.toMSecsSinceEpoch();
+
+    int low = 0;
+    int high = timestamps.count() - 1;
+
+    if (time <= timestamps.at(low)) {
+        return low;
+    }
+    if (time >= timestamps.at(high)) {
+        return high;
+    }
+
+    // Invariant: timestamps[low] <= time < timestamps[high].
+    // Entries are usually evenly spaced, so interpolating typically hits the
+    // right spot immediately. Alternate with bisection so unevenly spaced data
+    // cannot degrade the search beyond O(log n).
+    bool interpolate = true;
+    while (high - low > 1) {
+        int probe;
+        if (interpolate) {
+            const qint64 span = timestamps.at(high) - timestamps.at(low);
+            probe = low + static_cast<int>((time - timestamps.at(low)) * (high - low) / span);
+            probe = std::clamp(probe, low + 1, high - 1);
+        } else {
+            probe = low + (high - low) / 2;
+        }
+        interpolate = !interpolate;
+
+        if (timestamps.at(probe) <= time) {
+            low = probe;
+        } else {
+            high = probe;
+        }
+    }
+
+    if (time - timestamps.at(low) <= timestamps.at(high) - time) {
+        return low;
+    }
+    return high;
+}
+
+Span<qreal> OneDayPowerModel::column(Roles role) const
+{
+    const int column = OneDayPowerModelPrivate::indexColumn(role);
+    if (column < 0) {
+        qCWarning(QALPHACLOUD_LOG) << "Cannot provide a column for role" << role;
+        return {};
+    }
+
+    const auto &values = d->m_columns.at(column);
+    return Span<qreal>(values.constData(), values.count());
+}
+
+Span<qint64> OneDayPowerModel::uploadTimes() const
+{
+    return Span<qint64>(d->m_timestamps.constData(), d->m_timestamps.count());
+}
+
+PowerStatistics OneDayPowerModel::rangeStatistics(Roles role, const QDateTime &from, const QDateTime &to) const
+{
+    PowerStatistics statistics;
+
+    const int column = OneDayPowerModelPrivate::indexColumn(role);
+    if (column < 0) {
+        qCWarning(QALPHACLOUD_LOG) << "Cannot compute range statistics for role" << role;
+        return statistics;
+    }
+
+    const auto &timestamps = d->m_timestamps;
+
+    auto begin = timestamps.cbegin();
+    if (from.isValid()) {
+        begin = std::lower_bound(timestamps.cbegin(), timestamps.cend(), from.toMSecsSinceEpoch());
+    }
+
+    auto end = timestamps.cend();
+    if (to.isValid()) {
+        end = std::upper_bound(begin, timestamps.cend(), to.toMSecsSinceEpoch());
+    }
+
+    if (begin >= end) {
+        return statistics;
+    }
+
+    const int first = static_cast<int>(begin - timestamps.cbegin());
+    const int last = static_cast<int>(end - timestamps.cbegin()) - 1;
+
+    const auto &index = d->m_rangeIndices.at(column);
+    statistics.count = last - first + 1;
+    statistics.minimum = index.minimum(first, last);
+    statistics.maximum = index.maximum(first, last);
+    statistics.sum = index.sum(first, last);
+
+    return statistics;
+}
+
+int OneDayPowerModel::autoRefreshInterval() const
+{
+    return d->m_autoRefresh.interval();
+}
+
+void OneDayPowerModel::setAutoRefreshInterval(int autoRefreshInterval)
+{
+    if (d->m_autoRefresh.setInterval(autoRefreshInterval)) {
+        Q_EMIT autoRefreshIntervalChanged(d->m_autoRefresh.interval());
+    }
+}
+
+bool OneDayPowerModel::paused() const
+{
+    return d->m_autoRefresh.paused();
+}
+
+void OneDayPowerModel::setPaused(bool paused)
+{
+    if (d->m_autoRefresh.setPaused(paused)) {
+        Q_EMIT pausedChanged(paused);
+    }
+}
+
+int OneDayPowerModel::suppressedReloadCount() const
+{
+    return d->m_deferredReload.suppressedCount();
+}
+
 bool OneDayPowerModel::reload()
 {
+    if (d->m_deferredReload.cancel()) {
+        Q_EMIT suppressedReloadCountChanged(d->m_deferredReload.suppressedCount());
+    }
+
     if (!d->m_connector) {
         qCWarning(QALPHACLOUD_LOG) << "Cannot load OneDayPowerModel without a connector";
         return false;
@@ -450,6 +734,8 @@ bool OneDayPowerModel::reload()
         return false;
     }
 
+    d->m_autoRefresh.restart();
+
     if (d->m_request) {
         qCDebug(QALPHACLOUD_LOG) << "Cancelling OneDayPowerModel request in-flight";
         d->m_request->abort();
@@ -463,6 +749,7 @@ bool OneDayPowerModel::reload()
     }
 
     auto *request = new ApiRequest(d->m_connector, ApiRequest::EndPoint::OneDayPowerBySn, this);
+    request->setRequestGroup(d->m_requestGroup);
     request->setSysSn(d->m_serialNumber);
     request->setQueryDate(date);
 
@@ -495,6 +782,13 @@ bool OneDayPowerModel::reload()
     return ok;
 }
 
+void OneDayPowerModel::scheduleReload()
+{
+    if (!d->m_deferredReload.schedule()) {
+        Q_EMIT suppressedReloadCountChanged(d->m_deferredReload.suppressedCount());
+    }
+}
+
 bool OneDayPowerModel::forceReload()
 {
     d->m_cache.clear();
@@ -503,12 +797,20 @@ bool OneDayPowerModel::forceReload()
 
 void OneDayPowerModel::reset()
 {
+    d->m_autoRefresh.stop();
     beginResetModel();
     if (d->m_request) {
         d->m_request->abort();
         d->m_request = nullptr;
     }
     d->m_data.clear();
+    d->m_timestamps.clear();
+    for (auto &column : d->m_columns) {
+        column.clear();
+    }
+    for (auto &index : d->m_rangeIndices) {
+        index.clear();
+    }
     d->setStatus(RequestStatus::NoRequest);
     endResetModel();
 }
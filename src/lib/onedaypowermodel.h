@@ -7,18 +7,64 @@
 
 #include <QAbstractListModel>
 #include <QDate>
+#include <QDateTime>
 
 #include <memory>
 
 #include "connector.h"
 #include "qalphacloud.h"
 #include "qalphacloud_export.h"
+#include "requestgroup.h"
+#include "span.h"
 
 namespace QAlphaCloud
 {
 
 class OneDayPowerModelPrivate;
 
+/**
+ * @brief Statistics over a range of entries
+ *
+ * Returned by OneDayPowerModel::rangeStatistics.
+ */
+struct QALPHACLOUD_EXPORT PowerStatistics {
+    Q_GADGET
+
+    /**
+     * @brief Whether the range contained any entries
+     */
+    Q_PROPERTY(bool valid READ valid)
+    /**
+     * @brief The number of entries in the range
+     */
+    Q_PROPERTY(int count MEMBER count)
+    /**
+     * @brief The smallest value in the range
+     */
+    Q_PROPERTY(qreal minimum MEMBER minimum)
+    /**
+     * @brief The largest value in the range
+     */
+    Q_PROPERTY(qreal maximum MEMBER maximum)
+    /**
+     * @brief The sum of all values in the range
+     */
+    Q_PROPERTY(qreal sum MEMBER sum)
+    /**
+     * @brief The average of all values in the range
+     */
+    Q_PROPERTY(qreal average READ average)
+
+public:
+    bool valid() const;
+    qreal average() const;
+
+    int count = 0;
+    qreal minimum = 0.0;
+    qreal maximum = 0.0;
+    qreal sum = 0.0;
+};
+
 /**
  * @brief Historic power data for a day
  *
@@ -35,6 +81,14 @@ class QALPHACLOUD_EXPORT OneDayPowerModel : public QAbstractListModel
      */
     Q_PROPERTY(QAlphaCloud::Connector *connector READ connector WRITE setConnector NOTIFY connectorChanged REQUIRED)
 
+    /**
+     * @brief The request group
+     *
+     * Optional. Requests are sent as part of this group
+     * so that they can be canceled together with others.
+     */
+    Q_PROPERTY(QAlphaCloud::RequestGroup *requestGroup READ requestGroup WRITE setRequestGroup NOTIFY requestGroupChanged)
+
     /**
      * @brief The serial number
      *
@@ -104,6 +158,32 @@ class QALPHACLOUD_EXPORT OneDayPowerModel : public QAbstractListModel
      */
     Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
 
+    /**
+     * @brief Automatically reload data at this interval in milliseconds
+     *
+     * The interval counts from the most recent reload. Nothing is reloaded
+     * automatically until data has been loaded once
+     * or while the connector is offline.
+     *
+     * Default is 0, i.e. no automatic reloading.
+     */
+    Q_PROPERTY(int autoRefreshInterval READ autoRefreshInterval WRITE setAutoRefreshInterval NOTIFY autoRefreshIntervalChanged)
+    /**
+     * @brief Whether automatic reloading is paused
+     *
+     * When unpaused, data is reloaded immediately if a reload became due in the meantime.
+     *
+     * In QML, this is done automatically while the window is hidden or minimized.
+     */
+    Q_PROPERTY(bool paused READ paused WRITE setPaused NOTIFY pausedChanged)
+
+    /**
+     * @brief Number of reloads that were folded into another one
+     *
+     * See scheduleReload(). This is for diagnostics.
+     */
+    Q_PROPERTY(int suppressedReloadCount READ suppressedReloadCount NOTIFY suppressedReloadCountChanged)
+
     /**
      * @brief The current request status
      */
@@ -160,6 +240,10 @@ public:
     void setConnector(Connector *connector);
     Q_SIGNAL void connectorChanged(Connector *connector);
 
+    Q_REQUIRED_RESULT QAlphaCloud::RequestGroup *requestGroup() const;
+    void setRequestGroup(QAlphaCloud::RequestGroup *requestGroup);
+    Q_SIGNAL void requestGroupChanged(QAlphaCloud::RequestGroup *requestGroup);
+
     Q_REQUIRED_RESULT QString serialNumber() const;
     void setSerialNumber(const QString &serialNumber);
     Q_SIGNAL void serialNumberChanged(const QString &serialNumber);
@@ -191,6 +275,17 @@ public:
     Q_REQUIRED_RESULT int peakGridCharge() const;
     Q_SIGNAL void peakGridChargeChanged(int peakGridCharge);
 
+    Q_REQUIRED_RESULT int autoRefreshInterval() const;
+    void setAutoRefreshInterval(int autoRefreshInterval);
+    Q_SIGNAL void autoRefreshIntervalChanged(int autoRefreshInterval);
+
+    Q_REQUIRED_RESULT bool paused() const;
+    void setPaused(bool paused);
+    Q_SIGNAL void pausedChanged(bool paused);
+
+    Q_REQUIRED_RESULT int suppressedReloadCount() const;
+    Q_SIGNAL void suppressedReloadCountChanged(int suppressedReloadCount);
+
     QAlphaCloud::RequestStatus status() const;
     Q_SIGNAL void statusChanged(QAlphaCloud::RequestStatus status);
 
@@ -204,6 +299,55 @@ public:
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
     QHash<int, QByteArray> roleNames() const override;
 
+    /**
+     * @brief The row closest to a given time
+     *
+     * Finds the entry whose UploadTime is closest to @p dateTime.
+     * Since entries are recorded in regular intervals, this is typically
+     * resolved in a single interpolation step.
+     *
+     * @param dateTime The time to look up.
+     * @return The row, or -1 if the model is empty or @p dateTime is invalid.
+     */
+    Q_INVOKABLE int indexForDateTime(const QDateTime &dateTime) const;
+
+    /**
+     * @brief Statistics for a role within a time range
+     *
+     * Computes minimum, maximum, and sum of all entries whose UploadTime
+     * lies within @p from and @p to (inclusive) in constant time, which makes
+     * it suitable for determining the Y axis range of a zoomed plot.
+     *
+     * @param role The role to compute statistics for. Only numeric roles are supported.
+     * @param from The start of the range, an invalid QDateTime means from the first entry.
+     * @param to The end of the range, an invalid QDateTime means up to the last entry.
+     * @return The statistics, which are not valid if there are no entries in the range
+     * or the role is not supported.
+     */
+    Q_INVOKABLE QAlphaCloud::PowerStatistics rangeStatistics(QAlphaCloud::OneDayPowerModel::Roles role, const QDateTime &from, const QDateTime &to) const;
+
+    /**
+     * @brief All values of a role
+     *
+     * Provides direct access to the values of a numeric role for all rows
+     * without going through data() for every single one of them.
+     * Integer roles are provided as qreal, too.
+     *
+     * @param role The role, only numeric roles are supported.
+     * @return The values, ordered by row, or an empty span if the role is not supported.
+     *
+     * @note The span is only valid until the model is reset.
+     */
+    Q_REQUIRED_RESULT Span<qreal> column(Roles role) const;
+    /**
+     * @brief All upload times
+     *
+     * @return The UploadTime of all rows in milliseconds since epoch, ordered by row.
+     *
+     * @note The span is only valid until the model is reset.
+     */
+    Q_REQUIRED_RESULT Span<qint64> uploadTimes() const;
+
 public Q_SLOTS:
 
     /**
@@ -218,6 +362,17 @@ public Q_SLOTS:
      * @note When the request fails, the current data is not cleared.
      */
     bool reload();
+    /**
+     * @brief Reload data once control returns to the event loop
+     *
+     * Calling this several times, e.g. when changing multiple properties
+     * in a row, results in a single reload. A reload() in the meantime
+     * makes the scheduled one unnecessary.
+     *
+     * In QML, this is done automatically when a property changes if the
+     * @a active property (not documented here) is true, which is the default.
+     */
+    void scheduleReload();
     /**
      * @brief Force a reload
      *
@@ -242,3 +397,5 @@ private:
 };
 
 } // namespace QAlphaCloud
+
+Q_DECLARE_METATYPE(QAlphaCloud::PowerStatistics)
@@ -0,0 +1,61 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <QDateTime>
+#include <QJsonObject>
+#include <QString>
+
+// A single entry returned by the getOneDayPowerBySn endpoint.
+struct PowerEntry {
+    static PowerEntry fromJson(const QJsonObject &json)
+    {
+        const auto photovoltaicPower = int{json.value(QStringLiteral("ppv")).toInt()};
+        const auto currentLoad = int{json.value(QStringLiteral("load")).toInt()};
+        // NOTE in documentation this is just called "feed".
+        const auto gridFeed = int{json.value(QStringLiteral("feedIn")).toInt()};
+        const auto gridCharge = int{json.value(QStringLiteral("gridCharge")).toInt()};
+
+        const auto batterySoc = json.value(QStringLiteral("cbat")).toDouble();
+
+        const QDateTime uploadTime = QDateTime::fromString(json.value(QStringLiteral("uploadTime")).toString(), Qt::ISODate);
+
+        PowerEntry entry{// TODO Should we just read this from the JSON every time?
+                         json,
+                         uploadTime,
+                         photovoltaicPower,
+                         currentLoad,
+                         gridFeed,
+                         gridCharge,
+                         batterySoc};
+
+        return entry;
+    }
+
+    bool operator==(const PowerEntry &other) const
+    {
+        return json == other.json;
+    }
+
+    bool operator!=(const PowerEntry &other) const
+    {
+        return !(json == other.json);
+    }
+
+    QJsonObject json;
+    QDateTime uploadTime; // uploadTime
+
+    // QString serialNumber; // sysSn
+    int photovoltaicPower = 1337; // ppv
+    int currentLoad = 0; // load
+    int gridFeed = 0; // feed(In)
+    int gridCharge = 0; // feed(In)
+
+    qreal batterySoc = 0.0; // cbat
+
+    // TODO chargingPile
+};
+Q_DECLARE_TYPEINFO(PowerEntry, Q_MOVABLE_TYPE);
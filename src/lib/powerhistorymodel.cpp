@@ -0,0 +1,505 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "powerhistorymodel.h"
+
+#include "apirequest.h"
+#include "connector.h"
+#include "powerentry_p.h"
+#include "qalphacloud.h"
+#include "qalphacloud_log.h"
+#include "utils_p.h"
+
+#include <QCache>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QMetaEnum>
+#include <QPointer>
+#include <QVector>
+
+#include <algorithm>
+
+namespace QAlphaCloud
+{
+
+// Stop going back in time after this many days in a row without any data.
+static constexpr int s_maximumEmptyDays = 7;
+// How many past days to cache when there is no maximumDays limit.
+static constexpr int s_unlimitedCachedDays = 366;
+
+struct PowerHistoryDay {
+    QDate date;
+    int count = 0; // number of entries
+};
+
+class PowerHistoryModelPrivate
+{
+public:
+    explicit PowerHistoryModelPrivate(PowerHistoryModel *qq);
+
+    void setStatus(RequestStatus status);
+    void setError(ErrorCode error);
+    void setErrorString(const QString &errorString);
+    void setHasMore(bool hasMore);
+    void updateDates();
+
+    bool fetchDay(const QDate &date);
+    void appendDay(const QDate &date, const QVector<PowerEntry> &entries);
+    void trimToMaximumDays();
+    void updateCacheSize();
+
+    PowerHistoryModel *const q;
+
+    // TODO QPointer?
+    Connector *m_connector = nullptr;
+    QPointer<RequestGroup> m_requestGroup;
+    QString m_serialNumber;
+    int m_maximumDays = 31;
+    bool m_cached = true;
+
+    // Newest first.
+    QVector<PowerEntry> m_entries;
+    QVector<PowerHistoryDay> m_days;
+
+    // The day fetchMore() loads.
+    QDate m_nextDate;
+    int m_emptyDays = 0;
+    bool m_hasMore = false;
+
+    QDate m_newestDate;
+    QDate m_oldestDate;
+
+    RequestStatus m_status = RequestStatus::NoRequest;
+    ErrorCode m_error = ErrorCode::NoError;
+    QString m_errorString;
+
+    QPointer<ApiRequest> m_request;
+
+    // Past days, newest entry first. Holds as many days as the model, see updateCacheSize().
+    QCache<QDate, QVector<PowerEntry>> m_cache;
+};
+
+PowerHistoryModelPrivate::PowerHistoryModelPrivate(PowerHistoryModel *qq)
+    : q(qq)
+{
+    updateCacheSize();
+}
+
+void PowerHistoryModelPrivate::setStatus(RequestStatus status)
+{
+    if (m_status != status) {
+        m_status = status;
+        Q_EMIT q->statusChanged(status);
+    }
+}
+
+void PowerHistoryModelPrivate::setError(ErrorCode error)
+{
+    if (m_error != error) {
+        m_error = error;
+        Q_EMIT q->errorChanged(error);
+    }
+}
+
+void PowerHistoryModelPrivate::setErrorString(const QString &errorString)
+{
+    if (m_errorString != errorString) {
+        m_errorString = errorString;
+        Q_EMIT q->errorStringChanged(errorString);
+    }
+}
+
+void PowerHistoryModelPrivate::setHasMore(bool hasMore)
+{
+    if (m_hasMore != hasMore) {
+        m_hasMore = hasMore;
+        Q_EMIT q->hasMoreChanged(hasMore);
+    }
+}
+
+void PowerHistoryModelPrivate::updateDates()
+{
+    const QDate newestDate = !m_days.isEmpty() ? m_days.constFirst().date : QDate();
+    if (m_newestDate != newestDate) {
+        m_newestDate = newestDate;
+        Q_EMIT q->newestDateChanged(newestDate);
+    }
+
+    const QDate oldestDate = !m_days.isEmpty() ? m_days.constLast().date : QDate();
+    if (m_oldestDate != oldestDate) {
+        m_oldestDate = oldestDate;
+        Q_EMIT q->oldestDateChanged(oldestDate);
+    }
+}
+
+bool PowerHistoryModelPrivate::fetchDay(const QDate &date)
+{
+    if (const auto *cachedEntries = m_cache.object(date)) {
+        appendDay(date, *cachedEntries);
+        return true;
+    }
+
+    auto *request = new ApiRequest(m_connector, ApiRequest::EndPoint::OneDayPowerBySn, q);
+    request->setRequestGroup(m_requestGroup);
+    request->setSysSn(m_serialNumber);
+    request->setQueryDate(date);
+
+    QObject::connect(request, &ApiRequest::errorOccurred, q, [this, request] {
+        m_request = nullptr;
+
+        setError(request->error());
+        setErrorString(request->errorString());
+        // Don't keep hammering the server when the view asks for more.
+        setHasMore(false);
+        setStatus(RequestStatus::Error);
+    });
+
+    QObject::connect(request, &ApiRequest::result, q, [this, request, date] {
+        m_request = nullptr;
+
+        const QJsonArray jsonArray = request->data().toArray();
+
+        QVector<PowerEntry> entries;
+        entries.reserve(jsonArray.count());
+        for (const QJsonValue &jsonValue : jsonArray) {
+            entries.append(PowerEntry::fromJson(jsonValue.toObject()));
+        }
+
+        std::sort(entries.begin(), entries.end(), [](const PowerEntry &a, const PowerEntry &b) {
+            return a.uploadTime > b.uploadTime;
+        });
+
+        // Today's data changes throughout the day, don't cache it.
+        if (m_cached && !entries.isEmpty() && date != QDate::currentDate()) {
+            m_cache.insert(date, new QVector<PowerEntry>(entries), 1 /*cost*/);
+        }
+
+        appendDay(date, entries);
+    });
+
+    if (!request->send()) {
+        return false;
+    }
+
+    m_request = request;
+    setStatus(RequestStatus::Loading);
+    return true;
+}
+
+void PowerHistoryModelPrivate::appendDay(const QDate &date, const QVector<PowerEntry> &entries)
+{
+    m_nextDate = date.addDays(-1);
+
+    if (entries.isEmpty()) {
+        ++m_emptyDays;
+        if (m_emptyDays >= s_maximumEmptyDays) {
+            qCDebug(QALPHACLOUD_LOG) << "PowerHistoryModel found no data for" << m_emptyDays << "days, assuming there is no older data";
+            setHasMore(false);
+            setStatus(RequestStatus::Finished);
+            return;
+        }
+
+        // There are no new rows, so a view won't ask for more by itself.
+        if (!fetchDay(m_nextDate)) {
+            setStatus(RequestStatus::Error);
+        }
+        return;
+    }
+
+    m_emptyDays = 0;
+
+    const int first = m_entries.count();
+    q->beginInsertRows(QModelIndex(), first, first + entries.count() - 1);
+    m_entries += entries;
+    m_days.append(PowerHistoryDay{date, static_cast<int>(entries.count())});
+    q->endInsertRows();
+
+    trimToMaximumDays();
+    updateDates();
+
+    setStatus(RequestStatus::Finished);
+}
+
+void PowerHistoryModelPrivate::trimToMaximumDays()
+{
+    if (m_maximumDays <= 0) {
+        return;
+    }
+
+    while (m_days.count() > m_maximumDays) {
+        const int count = m_days.constFirst().count;
+
+        q->beginRemoveRows(QModelIndex(), 0, count - 1);
+        m_entries.remove(0, count);
+        m_days.removeFirst();
+        q->endRemoveRows();
+    }
+}
+
+void PowerHistoryModelPrivate::updateCacheSize()
+{
+    // Each day costs 1, least recently used days are evicted first.
+    m_cache.setMaxCost(m_maximumDays > 0 ? m_maximumDays : s_unlimitedCachedDays);
+}
+
+PowerHistoryModel::PowerHistoryModel(QObject *parent)
+    : PowerHistoryModel(nullptr, QString(), parent)
+{
+}
+
+PowerHistoryModel::PowerHistoryModel(Connector *connector, const QString &serialNumber, QObject *parent)
+    : QAbstractListModel(parent)
+    , d(std::make_unique<PowerHistoryModelPrivate>(this))
+{
+    setConnector(connector);
+
+    d->m_serialNumber = serialNumber;
+
+    connect(this, &PowerHistoryModel::rowsInserted, this, &PowerHistoryModel::countChanged);
+    connect(this, &PowerHistoryModel::rowsRemoved, this, &PowerHistoryModel::countChanged);
+    connect(this, &PowerHistoryModel::modelReset, this, &PowerHistoryModel::countChanged);
+}
+
+PowerHistoryModel::~PowerHistoryModel() = default;
+
+Connector *PowerHistoryModel::connector() const
+{
+    return d->m_connector;
+}
+
+void PowerHistoryModel::setConnector(Connector *connector)
+{
+    if (d->m_connector == connector) {
+        return;
+    }
+
+    d->m_connector = connector;
+    reset();
+    Q_EMIT connectorChanged(connector);
+}
+
+RequestGroup *PowerHistoryModel::requestGroup() const
+{
+    return d->m_requestGroup;
+}
+
+void PowerHistoryModel::setRequestGroup(RequestGroup *requestGroup)
+{
+    if (d->m_requestGroup == requestGroup) {
+        return;
+    }
+
+    d->m_requestGroup = requestGroup;
+    Q_EMIT requestGroupChanged(requestGroup);
+}
+
+QString PowerHistoryModel::serialNumber() const
+{
+    return d->m_serialNumber;
+}
+
+void PowerHistoryModel::setSerialNumber(const QString &serialNumber)
+{
+    if (d->m_serialNumber == serialNumber) {
+        return;
+    }
+
+    d->m_serialNumber = serialNumber;
+    d->m_cache.clear();
+    reset();
+    Q_EMIT serialNumberChanged(serialNumber);
+}
+
+int PowerHistoryModel::maximumDays() const
+{
+    return d->m_maximumDays;
+}
+
+void PowerHistoryModel::setMaximumDays(int maximumDays)
+{
+    if (d->m_maximumDays == maximumDays) {
+        return;
+    }
+
+    d->m_maximumDays = maximumDays;
+    d->updateCacheSize();
+    d->trimToMaximumDays();
+    d->updateDates();
+    Q_EMIT maximumDaysChanged(maximumDays);
+}
+
+bool PowerHistoryModel::cached() const
+{
+    return d->m_cached;
+}
+
+void PowerHistoryModel::setCached(bool cached)
+{
+    if (d->m_cached == cached) {
+        return;
+    }
+
+    d->m_cached = cached;
+    if (!cached) {
+        d->m_cache.clear();
+    }
+    Q_EMIT cachedChanged(cached);
+}
+
+QDate PowerHistoryModel::newestDate() const
+{
+    return d->m_newestDate;
+}
+
+QDate PowerHistoryModel::oldestDate() const
+{
+    return d->m_oldestDate;
+}
+
+bool PowerHistoryModel::hasMore() const
+{
+    return d->m_hasMore;
+}
+
+RequestStatus PowerHistoryModel::status() const
+{
+    return d->m_status;
+}
+
+ErrorCode PowerHistoryModel::error() const
+{
+    return d->m_error;
+}
+
+QString PowerHistoryModel::errorString() const
+{
+    return d->m_errorString;
+}
+
+int PowerHistoryModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+
+    return d->m_entries.count();
+}
+
+QVariant PowerHistoryModel::data(const QModelIndex &index, int role) const
+{
+    if (!checkIndex(index, QAbstractItemModel::CheckIndexOption::IndexIsValid)) {
+        return {};
+    }
+
+    const auto &item = d->m_entries.at(index.row());
+
+    switch (static_cast<Roles>(role)) {
+    case Roles::PhotovoltaicEnergy:
+        return item.photovoltaicPower;
+    case Roles::CurrentLoad:
+        return item.currentLoad;
+    case Roles::GridFeed:
+        return item.gridFeed;
+    case Roles::GridCharge:
+        return item.gridCharge;
+    case Roles::BatterySoc:
+        return item.batterySoc;
+    case Roles::UploadTime:
+        return item.uploadTime;
+    case Roles::Date: {
+        int row = index.row();
+        for (const auto &day : std::as_const(d->m_days)) {
+            if (row < day.count) {
+                return day.date;
+            }
+            row -= day.count;
+        }
+        return {};
+    }
+    case Roles::RawJson:
+        return item.json;
+    }
+
+    return {};
+}
+
+QHash<int, QByteArray> PowerHistoryModel::roleNames() const
+{
+    return Utils::roleNamesFromEnum(QMetaEnum::fromType<Roles>());
+}
+
+bool PowerHistoryModel::canFetchMore(const QModelIndex &parent) const
+{
+    if (parent.isValid()) {
+        return false;
+    }
+
+    return d->m_hasMore && d->m_nextDate.isValid() && !d->m_request;
+}
+
+void PowerHistoryModel::fetchMore(const QModelIndex &parent)
+{
+    if (!canFetchMore(parent)) {
+        return;
+    }
+
+    if (!d->fetchDay(d->m_nextDate)) {
+        d->setStatus(RequestStatus::Error);
+    }
+}
+
+bool PowerHistoryModel::reload()
+{
+    if (!d->m_connector) {
+        qCWarning(QALPHACLOUD_LOG) << "Cannot load PowerHistoryModel without a connector";
+        return false;
+    }
+
+    if (d->m_serialNumber.isEmpty()) {
+        qCWarning(QALPHACLOUD_LOG) << "Cannot load PowerHistoryModel without a serial number";
+        return false;
+    }
+
+    if (d->m_request) {
+        qCDebug(QALPHACLOUD_LOG) << "Cancelling PowerHistoryModel request in-flight";
+        d->m_request->abort();
+        d->m_request = nullptr;
+    }
+
+    beginResetModel();
+    d->m_entries.clear();
+    d->m_days.clear();
+    endResetModel();
+
+    d->m_emptyDays = 0;
+    d->updateDates();
+    d->setError(ErrorCode::NoError);
+    d->setErrorString(QString());
+    d->setHasMore(true);
+
+    return d->fetchDay(QDate::currentDate());
+}
+
+void PowerHistoryModel::reset()
+{
+    if (d->m_request) {
+        d->m_request->abort();
+        d->m_request = nullptr;
+    }
+
+    beginResetModel();
+    d->m_entries.clear();
+    d->m_days.clear();
+    endResetModel();
+
+    d->m_nextDate = QDate();
+    d->m_emptyDays = 0;
+    d->updateDates();
+    d->setHasMore(false);
+    d->setStatus(RequestStatus::NoRequest);
+}
+
+} // namespace QAlphaCloud
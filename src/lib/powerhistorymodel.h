@@ -0,0 +1,233 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <QAbstractListModel>
+#include <QDate>
+
+#include <memory>
+
+#include "connector.h"
+#include "qalphacloud.h"
+#include "qalphacloud_export.h"
+#include "requestgroup.h"
+
+namespace QAlphaCloud
+{
+
+class PowerHistoryModelPrivate;
+
+/**
+ * @brief Historic power data going back in time
+ *
+ * Provides historic power data starting with the current day, newest entry first.
+ * Older days are only loaded when a view asks for them through fetchMore(),
+ * e.g. when it is scrolled to the end, which makes it suitable for
+ * an endlessly scrollable list or timeline.
+ *
+ * Only a limited number of days is kept in the model, see maximumDays.
+ * Past days are cached, so they don't have to be fetched again after a reload.
+ *
+ * Wraps the @c /getOneDayPower API endpoint.
+ */
+class QALPHACLOUD_EXPORT PowerHistoryModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+    /**
+     * @brief The connector to use
+     */
+    Q_PROPERTY(QAlphaCloud::Connector *connector READ connector WRITE setConnector NOTIFY connectorChanged REQUIRED)
+
+    /**
+     * @brief The request group
+     *
+     * Optional. Requests are sent as part of this group
+     * so that they can be canceled together with others.
+     */
+    Q_PROPERTY(QAlphaCloud::RequestGroup *requestGroup READ requestGroup WRITE setRequestGroup NOTIFY requestGroupChanged)
+
+    /**
+     * @brief The serial number
+     *
+     * The serial number of the storage system whose data should be queried.
+     */
+    Q_PROPERTY(QString serialNumber READ serialNumber WRITE setSerialNumber NOTIFY serialNumberChanged REQUIRED)
+
+    /**
+     * @brief Maximum number of days in the model
+     *
+     * When an older day is loaded and this would be exceeded,
+     * the newest day is removed from the model.
+     *
+     * Default is 31. 0 means no limit.
+     */
+    Q_PROPERTY(int maximumDays READ maximumDays WRITE setMaximumDays NOTIFY maximumDaysChanged)
+
+    /**
+     * @brief Whether to cache past days
+     *
+     * Default is true.
+     */
+    Q_PROPERTY(bool cached READ cached WRITE setCached NOTIFY cachedChanged)
+
+    /**
+     * @brief The newest day in the model
+     */
+    Q_PROPERTY(QDate newestDate READ newestDate NOTIFY newestDateChanged)
+    /**
+     * @brief The oldest day in the model
+     */
+    Q_PROPERTY(QDate oldestDate READ oldestDate NOTIFY oldestDateChanged)
+
+    /**
+     * @brief Whether there is older data to load
+     *
+     * This becomes false after several days in a row returned no data,
+     * e.g. before the storage system was installed.
+     */
+    Q_PROPERTY(bool hasMore READ hasMore NOTIFY hasMoreChanged)
+
+    /**
+     * @brief The number of items in the model
+     */
+    Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
+
+    /**
+     * @brief The current request status
+     */
+    Q_PROPERTY(QAlphaCloud::RequestStatus status READ status NOTIFY statusChanged)
+
+    /**
+     * @brief The error, if any
+     *
+     * No more days are loaded after an error until the model is reloaded.
+     */
+    Q_PROPERTY(QAlphaCloud::ErrorCode error READ error NOTIFY errorChanged)
+    /**
+     * @brief The error string, if any
+     *
+     * @note Not every error code has an errorString associated with it.
+     */
+    Q_PROPERTY(QString errorString READ errorString NOTIFY errorStringChanged)
+
+public:
+    /**
+     * @brief Creates a PowerHistoryModel instance
+     * @param parent The owner
+     *
+     * @note A connector and serialNumber must be set before requests can be made.
+     */
+    explicit PowerHistoryModel(QObject *parent = nullptr);
+    /**
+     * @brief Creates a PowerHistoryModel instance
+     * @param connector The connector
+     * @param serialNumber The serial number of the storage system whose data should be queried
+     * @param parent The owner
+     */
+    PowerHistoryModel(Connector *connector, const QString &serialNumber, QObject *parent = nullptr);
+    ~PowerHistoryModel() override;
+
+    /**
+     * @brief The model roles
+     */
+    enum class Roles {
+        PhotovoltaicEnergy = Qt::UserRole, ///< The photovoltaic production in W (int)
+        CurrentLoad, ///< The current load in W (int)
+        GridFeed, ///< The current grid feed in W (int)
+        GridCharge, ///< The current grid charge in W (int)
+        BatterySoc, ///< The battery state of charge in per-cent % (qreal)
+        UploadTime, ///< When this entry was recorded. (QDateTime)
+        Date, ///< The day this entry belongs to, useful for sections. (QDate)
+        RawJson = Qt::UserRole
+            + 99, ///< Returns the raw JSON data for this entry. Useful for extracting properties that aren't provided through the model (QJsonObject).
+    };
+    Q_ENUM(Roles)
+
+    Q_REQUIRED_RESULT Connector *connector() const;
+    void setConnector(Connector *connector);
+    Q_SIGNAL void connectorChanged(Connector *connector);
+
+    Q_REQUIRED_RESULT QAlphaCloud::RequestGroup *requestGroup() const;
+    void setRequestGroup(QAlphaCloud::RequestGroup *requestGroup);
+    Q_SIGNAL void requestGroupChanged(QAlphaCloud::RequestGroup *requestGroup);
+
+    Q_REQUIRED_RESULT QString serialNumber() const;
+    void setSerialNumber(const QString &serialNumber);
+    Q_SIGNAL void serialNumberChanged(const QString &serialNumber);
+
+    Q_REQUIRED_RESULT int maximumDays() const;
+    void setMaximumDays(int maximumDays);
+    Q_SIGNAL void maximumDaysChanged(int maximumDays);
+
+    Q_REQUIRED_RESULT bool cached() const;
+    void setCached(bool cached);
+    Q_SIGNAL void cachedChanged(bool cached);
+
+    Q_REQUIRED_RESULT QDate newestDate() const;
+    Q_SIGNAL void newestDateChanged(const QDate &newestDate);
+
+    Q_REQUIRED_RESULT QDate oldestDate() const;
+    Q_SIGNAL void oldestDateChanged(const QDate &oldestDate);
+
+    Q_REQUIRED_RESULT bool hasMore() const;
+    Q_SIGNAL void hasMoreChanged(bool hasMore);
+
+    QAlphaCloud::RequestStatus status() const;
+    Q_SIGNAL void statusChanged(QAlphaCloud::RequestStatus status);
+
+    QAlphaCloud::ErrorCode error() const;
+    Q_SIGNAL void errorChanged(QAlphaCloud::ErrorCode error);
+
+    QString errorString() const;
+    Q_SIGNAL void errorStringChanged(const QString &errorString);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    /**
+     * @brief Whether an older day can be loaded
+     *
+     * This is false while a day is loading.
+     */
+    bool canFetchMore(const QModelIndex &parent) const override;
+    /**
+     * @brief Load the next older day
+     *
+     * Its entries are appended once loaded.
+     */
+    void fetchMore(const QModelIndex &parent) override;
+
+public Q_SLOTS:
+
+    /**
+     * @brief (Re)load data
+     *
+     * Clears the model and loads the current day.
+     * In QML, this is done automatically on component completion if the
+     * @a active property (not documented here) is true, which is the default.
+     * @return Whether the request was sent.
+     *
+     * @note You must set a connector and a serialNumber before requests can be sent.
+     */
+    bool reload();
+    /**
+     * @brief Reset object
+     *
+     * This clears all data and resets the object back to its initial state.
+     */
+    void reset();
+
+Q_SIGNALS:
+    void countChanged();
+
+private:
+    friend PowerHistoryModelPrivate;
+    std::unique_ptr<PowerHistoryModelPrivate> const d;
+};
+
+} // namespace QAlphaCloud
@@ -46,6 +46,8 @@ QString errorText(ErrorCode code, const QVariant &details)
         }
         return QCoreApplication::translate("errorText", "Unexpected JSON content received.");
     }
+    case ErrorCode::DeadlineExceededError:
+        return QCoreApplication::translate("errorText", "The request could not be completed in time.");
 
     case ErrorCode::ParameterError:
         if (detailsString.isEmpty()) {
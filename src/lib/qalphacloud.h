@@ -52,6 +52,7 @@ enum class ErrorCode {
     JsonParseError = 1001, ///< Failed to parse JSON received.
     UnexpectedJsonDataError = 1002, ///< Valid JSON received but it was not an Object (perhaps null, or an Array).
     EmptyJsonObjectError = 1002, ///< Valid JSON object was received but it was empty.
+    DeadlineExceededError = 1003, ///< The request could not be completed before the deadline of its RequestGroup.
 
     // API errors
     ParameterError = 6001, ///< "Parameter error"
@@ -100,4 +101,17 @@ enum class SystemStatus {
 };
 Q_ENUM_NS(SystemStatus)
 
+/**
+ * @brief Circuit breaker state
+ *
+ * Whether requests for a storage system are sent, after it
+ * repeatedly reported to be offline or not to exist.
+ */
+enum class CircuitState {
+    Closed = 0, ///< Requests are sent normally.
+    Open, ///< Requests are not sent, the last known data or error is provided instead.
+    HalfOpen, ///< A request is sent to check whether the storage system is reachable again.
+};
+Q_ENUM_NS(CircuitState)
+
 } // namespace QAlphaCloud
@@ -0,0 +1,152 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "requestgroup.h"
+
+#include "qalphacloud_log.h"
+
+#include <QTimer>
+
+#include <algorithm>
+#include <limits>
+
+namespace QAlphaCloud
+{
+
+class RequestGroupPrivate
+{
+public:
+    explicit RequestGroupPrivate(RequestGroup *qq);
+
+    void scheduleDeadline();
+    void setCanceled(bool canceled);
+    void setDeadlineExceeded(bool deadlineExceeded);
+
+    RequestGroup *const q;
+
+    QDateTime m_deadline;
+    bool m_canceled = false;
+    bool m_deadlineExceeded = false;
+
+    QTimer m_deadlineTimer;
+};
+
+RequestGroupPrivate::RequestGroupPrivate(RequestGroup *qq)
+    : q(qq)
+{
+    m_deadlineTimer.setSingleShot(true);
+    QObject::connect(&m_deadlineTimer, &QTimer::timeout, q, [this] {
+        scheduleDeadline();
+    });
+}
+
+void RequestGroupPrivate::scheduleDeadline()
+{
+    m_deadlineTimer.stop();
+
+    if (!m_deadline.isValid() || m_canceled) {
+        return;
+    }
+
+    const qint64 remainingTime = q->remainingTime();
+    if (remainingTime > 0) {
+        // QTimer can't wait longer than that, it'll be rescheduled when it fires.
+        m_deadlineTimer.start(static_cast<int>(std::min<qint64>(remainingTime, std::numeric_limits<int>::max())));
+        return;
+    }
+
+    qCDebug(QALPHACLOUD_LOG) << "Request group reached its deadline" << m_deadline;
+    setDeadlineExceeded(true);
+    q->cancel();
+}
+
+void RequestGroupPrivate::setCanceled(bool canceled)
+{
+    if (m_canceled != canceled) {
+        m_canceled = canceled;
+        Q_EMIT q->canceledChanged(canceled);
+    }
+}
+
+void RequestGroupPrivate::setDeadlineExceeded(bool deadlineExceeded)
+{
+    if (m_deadlineExceeded != deadlineExceeded) {
+        m_deadlineExceeded = deadlineExceeded;
+        Q_EMIT q->deadlineExceededChanged(deadlineExceeded);
+    }
+}
+
+RequestGroup::RequestGroup(QObject *parent)
+    : QObject(parent)
+    , d(std::make_unique<RequestGroupPrivate>(this))
+{
+}
+
+RequestGroup::~RequestGroup()
+{
+    cancel();
+}
+
+QDateTime RequestGroup::deadline() const
+{
+    return d->m_deadline;
+}
+
+void RequestGroup::setDeadline(const QDateTime &deadline)
+{
+    if (d->m_deadline == deadline) {
+        return;
+    }
+
+    d->m_deadline = deadline;
+    Q_EMIT deadlineChanged(deadline);
+
+    d->scheduleDeadline();
+}
+
+bool RequestGroup::canceled() const
+{
+    return d->m_canceled;
+}
+
+bool RequestGroup::deadlineExceeded() const
+{
+    return d->m_deadlineExceeded;
+}
+
+void RequestGroup::setTimeout(int msec)
+{
+    setDeadline(QDateTime::currentDateTimeUtc().addMSecs(msec));
+}
+
+qint64 RequestGroup::remainingTime() const
+{
+    if (!d->m_deadline.isValid()) {
+        return -1;
+    }
+
+    return std::max<qint64>(0, QDateTime::currentDateTimeUtc().msecsTo(d->m_deadline));
+}
+
+void RequestGroup::cancel()
+{
+    d->m_deadlineTimer.stop();
+    d->setCanceled(true);
+}
+
+void RequestGroup::reset()
+{
+    d->m_deadlineTimer.stop();
+
+    if (d->m_deadline.isValid()) {
+        d->m_deadline = QDateTime();
+        Q_EMIT deadlineChanged(d->m_deadline);
+    }
+
+    d->setDeadlineExceeded(false);
+    d->setCanceled(false);
+}
+
+} // namespace QAlphaCloud
@@ -0,0 +1,112 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <QDateTime>
+#include <QObject>
+
+#include <memory>
+
+#include "qalphacloud_export.h"
+
+namespace QAlphaCloud
+{
+
+class RequestGroupPrivate;
+
+/**
+ * @brief Cancels a set of requests at once
+ *
+ * Assign the same RequestGroup to every object whose requests belong together,
+ * for instance all objects shown on a page, and call cancel() when their data
+ * is no longer needed. All of their requests in-flight are aborted and no new
+ * ones are sent until reset() is called.
+ *
+ * A deadline can be set, too. When it is reached, the group is canceled.
+ * Requests that are unlikely to finish before the deadline, based on how long
+ * requests to the same endpoint typically take, are not sent at all and fail
+ * with QAlphaCloud::ErrorCode::DeadlineExceededError right away.
+ *
+ * @note The group must live in the same thread as the requests it is used with.
+ */
+class QALPHACLOUD_EXPORT RequestGroup : public QObject
+{
+    Q_OBJECT
+
+    /**
+     * @brief When all requests in this group must have finished
+     *
+     * Default is an invalid QDateTime, i.e. no deadline.
+     */
+    Q_PROPERTY(QDateTime deadline READ deadline WRITE setDeadline NOTIFY deadlineChanged)
+
+    /**
+     * @brief Whether the group has been canceled
+     *
+     * Either by calling cancel() or because the deadline was reached.
+     */
+    Q_PROPERTY(bool canceled READ canceled NOTIFY canceledChanged)
+
+    /**
+     * @brief Whether the group was canceled because the deadline was reached
+     */
+    Q_PROPERTY(bool deadlineExceeded READ deadlineExceeded NOTIFY deadlineExceededChanged)
+
+public:
+    /**
+     * @brief Creates a RequestGroup instance
+     * @param parent The owner
+     */
+    explicit RequestGroup(QObject *parent = nullptr);
+    /**
+     * @brief Destroys the RequestGroup
+     *
+     * This cancels all of its requests.
+     */
+    ~RequestGroup() override;
+
+    Q_REQUIRED_RESULT QDateTime deadline() const;
+    void setDeadline(const QDateTime &deadline);
+    Q_SIGNAL void deadlineChanged(const QDateTime &deadline);
+
+    Q_REQUIRED_RESULT bool canceled() const;
+    Q_SIGNAL void canceledChanged(bool canceled);
+
+    Q_REQUIRED_RESULT bool deadlineExceeded() const;
+    Q_SIGNAL void deadlineExceededChanged(bool deadlineExceeded);
+
+    /**
+     * @brief Set the deadline relative to now
+     * @param msec Time in milliseconds from now
+     */
+    Q_INVOKABLE void setTimeout(int msec);
+
+    /**
+     * @brief Time in milliseconds until the deadline
+     *
+     * This is -1 if there is no deadline and 0 once it has been reached.
+     */
+    Q_INVOKABLE qint64 remainingTime() const;
+
+public Q_SLOTS:
+    /**
+     * @brief Cancel all requests in this group
+     *
+     * Requests in-flight are aborted and no new ones are sent.
+     */
+    void cancel();
+    /**
+     * @brief Reset object
+     *
+     * This clears the deadline and allows requests to be sent again.
+     */
+    void reset();
+
+private:
+    std::unique_ptr<RequestGroupPrivate> const d;
+};
+
+} // namespace QAlphaCloud
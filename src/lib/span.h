@@ -0,0 +1,73 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <QtGlobal>
+
+namespace QAlphaCloud
+{
+
+/**
+ * @brief Read-only view of contiguous data
+ *
+ * A minimal stand-in for C++20's @c std::span used by the bulk accessors
+ * of the models. It does not own the data, it is only valid for as long
+ * as the object it was obtained from says so.
+ */
+template<typename T>
+class Span
+{
+public:
+    using value_type = T;
+    using const_iterator = const T *;
+
+    constexpr Span() = default;
+    constexpr Span(const T *data, qsizetype size)
+        : m_data(data)
+        , m_size(size)
+    {
+    }
+
+    /**
+     * @brief Pointer to the first element
+     */
+    constexpr const T *data() const
+    {
+        return m_data;
+    }
+    /**
+     * @brief The number of elements
+     */
+    constexpr qsizetype size() const
+    {
+        return m_size;
+    }
+    constexpr bool isEmpty() const
+    {
+        return m_size == 0;
+    }
+
+    constexpr const T &operator[](qsizetype index) const
+    {
+        Q_ASSERT(index >= 0 && index < m_size);
+        return m_data[index];
+    }
+
+    constexpr const_iterator begin() const
+    {
+        return m_data;
+    }
+    constexpr const_iterator end() const
+    {
+        return m_data + m_size;
+    }
+
+private:
+    const T *m_data = nullptr;
+    qsizetype m_size = 0;
+};
+
+} // namespace QAlphaCloud
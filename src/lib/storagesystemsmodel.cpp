@@ -17,6 +17,7 @@
 #include <QJsonObject>
 #include <QMetaEnum>
 #include <QPointer>
+#include <QSet>
 #include <QSettings>
 #include <QStandardPaths>
 #include <QVector>
@@ -24,76 +25,47 @@
 #include <algorithm>
 #include <cmath>
 
-struct StorageSystem {
-    static StorageSystem fromJson(const QJsonObject &json)
-    {
-        const QString serialNumber = json.value(QStringLiteral("sysSn")).toString();
-
-        QAlphaCloud::SystemStatus status = QAlphaCloud::SystemStatus::UnknownStatus;
-        const QString statusString = json.value(QStringLiteral("emsStatus")).toString();
-        if (statusString == QLatin1String("Normal")) {
-            status = QAlphaCloud::SystemStatus::Normal;
-        } else if (statusString == QLatin1String("Fault")) {
-            status = QAlphaCloud::SystemStatus::Fault;
-        }
-
-        QString inverterModel = json.value(QStringLiteral("minv")).toString();
-        const auto inverterPowerKwh = json.value(QStringLiteral("poinv")).toDouble();
-
-        const QString batteryModel = json.value(QStringLiteral("mbat")).toString();
-        const auto grossBatteryCapacityKwh = json.value(QStringLiteral("cobat")).toDouble();
-        const auto remainingBatteryCapacityKwh = json.value(QStringLiteral("surplusCobat")).toDouble();
-        const auto availableBatteryCapacity = json.value(QStringLiteral("usCapacity")).toDouble();
-
-        const auto photovoltaicPowerKwh = json.value(QStringLiteral("popv")).toDouble();
-
-        StorageSystem system{
-            // TODO Should we just read this from the JSON every time?
-            json,
-            serialNumber,
-            status,
-            inverterModel,
-            static_cast<int>(std::round(inverterPowerKwh * 1000)),
-            batteryModel,
-            static_cast<int>(std::round(grossBatteryCapacityKwh * 1000)),
-            static_cast<int>(std::round(remainingBatteryCapacityKwh * 1000)),
-            availableBatteryCapacity,
-            static_cast<int>(std::round(photovoltaicPowerKwh * 1000)),
-        };
-
-        return system;
-    }
-
-    bool operator==(const StorageSystem &other) const
-    {
-        return json == other.json;
-    }
-
-    bool operator!=(const StorageSystem &other) const
-    {
-        return !(json == other.json);
-    }
+namespace QAlphaCloud
+{
 
-    QJsonObject json;
+static StorageSystem storageSystemFromJson(const QJsonObject &json)
+{
+    const QString serialNumber = json.value(QStringLiteral("sysSn")).toString();
 
-    QString serialNumber; // sysSn
     QAlphaCloud::SystemStatus status = QAlphaCloud::SystemStatus::UnknownStatus;
+    const QString statusString = json.value(QStringLiteral("emsStatus")).toString();
+    if (statusString == QLatin1String("Normal")) {
+        status = QAlphaCloud::SystemStatus::Normal;
+    } else if (statusString == QLatin1String("Fault")) {
+        status = QAlphaCloud::SystemStatus::Fault;
+    }
 
-    QString inverterModel; // minv
-    int inverterPower = 0; // poinv
-
-    QString batteryModel; // mbat
-    int grossBatteryCapacity = 0; // cobat
-    int remainingBatteryCapacity = 0; // surplusCobat
-    // TODO check if this can be deicmal.
-    qreal usableBatteryCapacity = 0.0; // usCapacity
-
-    int photovoltaicPower; // popv
-};
-Q_DECLARE_TYPEINFO(StorageSystem, Q_MOVABLE_TYPE);
-
-namespace QAlphaCloud
-{
+    QString inverterModel = json.value(QStringLiteral("minv")).toString();
+    const auto inverterPowerKwh = json.value(QStringLiteral("poinv")).toDouble();
+
+    const QString batteryModel = json.value(QStringLiteral("mbat")).toString();
+    const auto grossBatteryCapacityKwh = json.value(QStringLiteral("cobat")).toDouble();
+    const auto remainingBatteryCapacityKwh = json.value(QStringLiteral("surplusCobat")).toDouble();
+    const auto availableBatteryCapacity = json.value(QStringLiteral("usCapacity")).toDouble();
+
+    const auto photovoltaicPowerKwh = json.value(QStringLiteral("popv")).toDouble();
+
+    StorageSystem system{
+        // TODO Should we just read this from the JSON every time?
+        json,
+        serialNumber,
+        status,
+        inverterModel,
+        static_cast<int>(std::round(inverterPowerKwh * 1000)),
+        batteryModel,
+        static_cast<int>(std::round(grossBatteryCapacityKwh * 1000)),
+        static_cast<int>(std::round(remainingBatteryCapacityKwh * 1000)),
+        availableBatteryCapacity,
+        static_cast<int>(std::round(photovoltaicPowerKwh * 1000)),
+    };
+
+    return system;
+}
 
 class StorageSystemsModelPrivate
 {
@@ -110,6 +82,7 @@ public:
     void setError(ErrorCode error);
     void setErrorString(const QString &errorString);
 
+    static QVector<int> changedRoles(const StorageSystem &oldSystem, const StorageSystem &newSystem);
     void processApiResult(const QJsonArray &jsonArray);
 
     bool loadFromCache();
@@ -118,6 +91,7 @@ public:
     StorageSystemsModel *const q;
 
     Connector *m_connector = nullptr;
+    QPointer<RequestGroup> m_requestGroup;
     bool m_cached = true;
 
     RequestStatus m_status = RequestStatus::NoRequest;
@@ -158,46 +132,126 @@ void StorageSystemsModelPrivate::setErrorString(const QString &errorString)
     }
 }
 
+QVector<int> StorageSystemsModelPrivate::changedRoles(const StorageSystem &oldSystem, const StorageSystem &newSystem)
+{
+    using Roles = StorageSystemsModel::Roles;
+
+    QVector<int> roles;
+
+    if (oldSystem.status != newSystem.status) {
+        roles << static_cast<int>(Roles::Status);
+    }
+    if (oldSystem.inverterModel != newSystem.inverterModel) {
+        roles << static_cast<int>(Roles::InverterModel);
+    }
+    if (oldSystem.inverterPower != newSystem.inverterPower) {
+        roles << static_cast<int>(Roles::InverterPower);
+    }
+    if (oldSystem.batteryModel != newSystem.batteryModel) {
+        roles << static_cast<int>(Roles::BatteryModel);
+    }
+    if (oldSystem.grossBatteryCapacity != newSystem.grossBatteryCapacity) {
+        roles << static_cast<int>(Roles::BatteryGrossCapacity);
+    }
+    if (oldSystem.remainingBatteryCapacity != newSystem.remainingBatteryCapacity) {
+        roles << static_cast<int>(Roles::BatteryRemainingCapacity);
+    }
+    if (!qFuzzyCompare(oldSystem.usableBatteryCapacity, newSystem.usableBatteryCapacity)) {
+        roles << static_cast<int>(Roles::BatteryUsableCapacity);
+    }
+    if (oldSystem.photovoltaicPower != newSystem.photovoltaicPower) {
+        roles << static_cast<int>(Roles::PhotovoltaicPower);
+    }
+    if (oldSystem.json != newSystem.json) {
+        roles << static_cast<int>(Roles::RawJson);
+    }
+
+    return roles;
+}
+
 void StorageSystemsModelPrivate::processApiResult(const QJsonArray &jsonArray)
 {
-    bool dirty = false;
+    const QString oldPrimarySerialNumber = q->primarySerialNumber();
 
-    // Check whether the data actually changed.
-    // TODO proper delta update of the model.
-    if (m_data.count() != jsonArray.count()) {
-        dirty = true;
-    } else {
-        for (int i = 0; i < jsonArray.count(); ++i) {
-            const QJsonObject newJson = jsonArray.at(i).toObject();
-            const QJsonObject oldJson = m_data.at(i).json;
+    QVector<StorageSystem> newData;
+    newData.reserve(jsonArray.count());
 
-            if (newJson != oldJson) {
-                dirty = true;
-                break;
-            }
-        }
+    QSet<QString> newSerialNumbers;
+    newSerialNumbers.reserve(jsonArray.count());
+
+    for (const QJsonValue &systemValue : jsonArray) {
+        const StorageSystem system = storageSystemFromJson(systemValue.toObject());
+        newSerialNumbers.insert(system.serialNumber);
+        newData << system;
     }
 
-    if (dirty) {
-        const QString oldPrimarySerialNumber = q->primarySerialNumber();
+    // Systems we already know must still be in the same order for a delta update.
+    QSet<QString> oldSerialNumbers;
+    oldSerialNumbers.reserve(m_data.count());
 
-        q->beginResetModel();
+    QStringList remainingSerialNumbers;
+    for (const StorageSystem &system : std::as_const(m_data)) {
+        oldSerialNumbers.insert(system.serialNumber);
+        if (newSerialNumbers.contains(system.serialNumber)) {
+            remainingSerialNumbers << system.serialNumber;
+        }
+    }
 
-        m_data.clear();
+    QStringList knownSerialNumbers;
+    for (const StorageSystem &system : std::as_const(newData)) {
+        if (oldSerialNumbers.contains(system.serialNumber)) {
+            knownSerialNumbers << system.serialNumber;
+        }
+    }
 
-        m_data.reserve(jsonArray.count());
+    const bool canUpdate = !remainingSerialNumbers.isEmpty() && remainingSerialNumbers == knownSerialNumbers
+        && newSerialNumbers.count() == newData.count(); // No duplicates.
 
-        for (const QJsonValue &systemValue : jsonArray) {
-            m_data << StorageSystem::fromJson(systemValue.toObject());
+    if (!canUpdate) {
+        bool dirty = m_data.count() != newData.count();
+        for (int i = 0; !dirty && i < newData.count(); ++i) {
+            dirty = m_data.at(i).json != newData.at(i).json;
+        }
+
+        if (dirty) {
+            q->beginResetModel();
+            m_data = newData;
+            q->endResetModel();
+        }
+    } else {
+        // Remove systems that are gone.
+        for (int i = m_data.count() - 1; i >= 0; --i) {
+            if (!newSerialNumbers.contains(m_data.at(i).serialNumber)) {
+                q->beginRemoveRows(QModelIndex(), i, i);
+                m_data.remove(i);
+                q->endRemoveRows();
+            }
         }
 
-        q->endResetModel();
+        // m_data is now an ordered subset of newData, insert new systems and update existing ones.
+        for (int i = 0; i < newData.count(); ++i) {
+            const StorageSystem &newSystem = newData.at(i);
 
-        if (oldPrimarySerialNumber != q->primarySerialNumber()) {
-            Q_EMIT q->primarySerialNumberChanged(q->primarySerialNumber());
+            if (i >= m_data.count() || m_data.at(i).serialNumber != newSystem.serialNumber) {
+                q->beginInsertRows(QModelIndex(), i, i);
+                m_data.insert(i, newSystem);
+                q->endInsertRows();
+                continue;
+            }
+
+            const QVector<int> roles = changedRoles(m_data.at(i), newSystem);
+            if (!roles.isEmpty()) {
+                m_data[i] = newSystem;
+                const QModelIndex index = q->index(i, 0);
+                Q_EMIT q->dataChanged(index, index, roles);
+            }
         }
     }
 
+    if (oldPrimarySerialNumber != q->primarySerialNumber()) {
+        Q_EMIT q->primarySerialNumberChanged(q->primarySerialNumber());
+    }
+
     setStatus(QAlphaCloud::RequestStatus::Finished);
 }
 
@@ -289,6 +343,21 @@ void StorageSystemsModel::setConnector(Connector *connector)
     Q_EMIT connectorChanged(connector);
 }
 
+RequestGroup *StorageSystemsModel::requestGroup() const
+{
+    return d->m_requestGroup;
+}
+
+void StorageSystemsModel::setRequestGroup(RequestGroup *requestGroup)
+{
+    if (d->m_requestGroup == requestGroup) {
+        return;
+    }
+
+    d->m_requestGroup = requestGroup;
+    Q_EMIT requestGroupChanged(requestGroup);
+}
+
 bool StorageSystemsModel::cached() const
 {
     return d->m_cached;
@@ -375,6 +444,11 @@ QVariant StorageSystemsModel::data(const QModelIndex &index, int role) const
     return {};
 }
 
+Span<StorageSystem> StorageSystemsModel::storageSystems() const
+{
+    return Span<StorageSystem>(d->m_data.constData(), d->m_data.count());
+}
+
 QHash<int, QByteArray> StorageSystemsModel::roleNames() const
 {
     return Utils::roleNamesFromEnum(QMetaEnum::fromType<Roles>());
@@ -394,6 +468,7 @@ bool StorageSystemsModel::reload()
     }
 
     auto *request = new ApiRequest(d->m_connector, ApiRequest::EndPoint::EssList, this);
+    request->setRequestGroup(d->m_requestGroup);
 
     connect(request, &ApiRequest::errorOccurred, this, [this, request] {
         d->setError(request->error());
@@ -6,19 +6,75 @@
 #pragma once
 
 #include <QAbstractListModel>
+#include <QJsonObject>
 
 #include <memory>
 
 #include "qalphacloud.h"
 #include "qalphacloud_export.h"
+#include "span.h"
 
 #include "connector.h"
+#include "requestgroup.h"
 
 namespace QAlphaCloud
 {
 
 class StorageSystemsModelPrivate;
 
+/**
+ * @brief A storage system
+ *
+ * Returned by StorageSystemsModel::storageSystems.
+ * The members correspond to the model roles.
+ */
+struct QALPHACLOUD_EXPORT StorageSystem {
+    /**
+     * @brief The raw JSON returned by the API for this system
+     */
+    QJsonObject json;
+
+    /**
+     * @brief System serial number
+     */
+    QString serialNumber; // sysSn
+    /**
+     * @brief Status of the energy management system
+     */
+    QAlphaCloud::SystemStatus status = QAlphaCloud::SystemStatus::UnknownStatus;
+
+    /**
+     * @brief Inverter model
+     */
+    QString inverterModel; // minv
+    /**
+     * @brief Gross power of the inverter system in W
+     */
+    int inverterPower = 0; // poinv
+
+    /**
+     * @brief Battery model
+     */
+    QString batteryModel; // mbat
+    /**
+     * @brief Gross battery capacity in Wh
+     */
+    int grossBatteryCapacity = 0; // cobat
+    /**
+     * @brief Remaining battery capacity in Wh
+     */
+    int remainingBatteryCapacity = 0; // surplusCobat
+    /**
+     * @brief Usable battery capacity in per-cent %
+     */
+    qreal usableBatteryCapacity = 0.0; // usCapacity
+
+    /**
+     * @brief Gross power provided by the photovoltaic system in W
+     */
+    int photovoltaicPower = 0; // popv
+};
+
 /**
  * @brief Storage Systems Model
  *
@@ -35,6 +91,14 @@ class QALPHACLOUD_EXPORT StorageSystemsModel : public QAbstractListModel
      */
     Q_PROPERTY(QAlphaCloud::Connector *connector READ connector WRITE setConnector NOTIFY connectorChanged REQUIRED)
 
+    /**
+     * @brief The request group
+     *
+     * Optional. Requests are sent as part of this group
+     * so that they can be canceled together with others.
+     */
+    Q_PROPERTY(QAlphaCloud::RequestGroup *requestGroup READ requestGroup WRITE setRequestGroup NOTIFY requestGroupChanged)
+
     /**
      * @brief Cache the data on disk
      *
@@ -118,6 +182,10 @@ public:
     void setConnector(QAlphaCloud::Connector *connector);
     Q_SIGNAL void connectorChanged(QAlphaCloud::Connector *connector);
 
+    Q_REQUIRED_RESULT QAlphaCloud::RequestGroup *requestGroup() const;
+    void setRequestGroup(QAlphaCloud::RequestGroup *requestGroup);
+    Q_SIGNAL void requestGroupChanged(QAlphaCloud::RequestGroup *requestGroup);
+
     Q_REQUIRED_RESULT bool cached() const;
     void setCached(bool cached);
     Q_SIGNAL void cachedChanged(bool cached);
@@ -138,6 +206,19 @@ public:
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
     QHash<int, QByteArray> roleNames() const override;
 
+    /**
+     * @brief All storage systems
+     *
+     * Provides direct access to all systems without going through data()
+     * for every single role.
+     *
+     * @return The systems, ordered by row.
+     *
+     * @note The span is only valid until the model changes, i.e. until
+     * rows are inserted, removed, or their data changes.
+     */
+    Q_REQUIRED_RESULT Span<StorageSystem> storageSystems() const;
+
 public Q_SLOTS:
     /**
      * @brief (Re)load data
@@ -160,3 +241,5 @@ private:
 };
 
 } // namespace QAlphaCloud
+
+Q_DECLARE_TYPEINFO(QAlphaCloud::StorageSystem, Q_MOVABLE_TYPE);
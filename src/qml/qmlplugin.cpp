@@ -3,15 +3,29 @@
  * SPDX-License-Identifier: LGPL-2.1-or-later
  */
 
+#include <QPointer>
 #include <QQmlEngine>
 #include <QQmlExtensionPlugin>
 #include <QQmlParserStatus>
+#include <QQuickItem>
+#include <QQuickWindow>
+#include <QTimer>
 
+#include <algorithm>
+#include <functional>
+
+#include <QAlphaCloud/AdaptivePoller>
+#include <QAlphaCloud/ChargeConfigInfo>
 #include <QAlphaCloud/Configuration>
 #include <QAlphaCloud/Connector>
+#include <QAlphaCloud/DischargeConfigInfo>
+#include <QAlphaCloud/EnergyHistoryModel>
+#include <QAlphaCloud/FleetLiveDataModel>
 #include <QAlphaCloud/LastPowerData>
 #include <QAlphaCloud/OneDateEnergy>
 #include <QAlphaCloud/OneDayPowerModel>
+#include <QAlphaCloud/PowerHistoryModel>
+#include <QAlphaCloud/RequestGroup>
 #include <QAlphaCloud/StorageSystemsModel>
 
 class QAlphaCloudQmlPlugin : public QQmlExtensionPlugin
@@ -30,6 +44,59 @@ public:
 
 using namespace QAlphaCloud;
 
+// Reports whether the window an object is shown in is hidden or minimized.
+// Non-visual objects get the Item or Window they are declared in as QObject parent.
+class WindowVisibilityWatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    WindowVisibilityWatcher(QObject *object, const std::function<void(bool hidden)> &callback)
+        : QObject(object)
+        , m_callback(callback)
+    {
+        for (QObject *parent = object->parent(); parent; parent = parent->parent()) {
+            if (auto *item = qobject_cast<QQuickItem *>(parent)) {
+                connect(item, &QQuickItem::windowChanged, this, &WindowVisibilityWatcher::setWindow);
+                setWindow(item->window());
+                return;
+            }
+            if (auto *window = qobject_cast<QWindow *>(parent)) {
+                setWindow(window);
+                return;
+            }
+        }
+    }
+
+private:
+    void setWindow(QWindow *window)
+    {
+        if (m_window == window) {
+            return;
+        }
+
+        if (m_window) {
+            disconnect(m_window, nullptr, this, nullptr);
+        }
+
+        m_window = window;
+
+        if (m_window) {
+            connect(m_window, &QWindow::visibilityChanged, this, &WindowVisibilityWatcher::update);
+        }
+        update();
+    }
+
+    void update()
+    {
+        const bool hidden = m_window && (m_window->visibility() == QWindow::Hidden || m_window->visibility() == QWindow::Minimized);
+        m_callback(hidden);
+    }
+
+    std::function<void(bool hidden)> m_callback;
+    QPointer<QWindow> m_window;
+};
+
 class QmlConfiguration : public QAlphaCloud::Configuration, public QQmlParserStatus
 {
     Q_INTERFACES(QQmlParserStatus)
@@ -93,6 +160,10 @@ public:
 
     void componentComplete() override
     {
+        new WindowVisibilityWatcher(this, [this](bool hidden) {
+            setPaused(hidden);
+        });
+
         connect(this, &QmlLastPowerData::serialNumberChanged, this, &QmlLastPowerData::reloadIfActive);
         // Suppress warnings on autoload.
         if (connector() && connector()->configuration() && connector()->configuration()->valid() && !serialNumber().isEmpty()) {
@@ -132,6 +203,10 @@ public:
 
     void componentComplete() override
     {
+        new WindowVisibilityWatcher(this, [this](bool hidden) {
+            setPaused(hidden);
+        });
+
         connect(this, &QmlOneDateEnergy::serialNumberChanged, this, &QmlOneDateEnergy::reloadIfActive);
         connect(this, &QmlOneDateEnergy::dateChanged, this, &QmlOneDateEnergy::reloadIfActive);
         // Suppress warnings on autoload.
@@ -144,10 +219,11 @@ Q_SIGNALS:
     void activeChanged(bool active);
 
 private:
+    // Property changes often come in batches, e.g. serial number and date, which should only result in one request.
     void reloadIfActive()
     {
         if (m_active) {
-            reload();
+            scheduleReload();
         }
     }
     bool m_active = true;
@@ -172,6 +248,10 @@ public:
 
     void componentComplete() override
     {
+        new WindowVisibilityWatcher(this, [this](bool hidden) {
+            setPaused(hidden);
+        });
+
         connect(this, &QmlOneDayPowerModel::serialNumberChanged, this, &QmlOneDayPowerModel::reloadIfActive);
         connect(this, &QmlOneDayPowerModel::dateChanged, this, &QmlOneDayPowerModel::reloadIfActive);
         // Suppress warnings on autoload.
@@ -183,6 +263,174 @@ public:
 Q_SIGNALS:
     void activeChanged(bool active);
 
+private:
+    void reloadIfActive()
+    {
+        if (m_active) {
+            scheduleReload();
+        }
+    }
+
+    bool m_active = true;
+};
+
+class QmlEnergyHistoryModel : public QAlphaCloud::EnergyHistoryModel, public QQmlParserStatus
+{
+    Q_OBJECT
+    Q_INTERFACES(QQmlParserStatus)
+
+    Q_PROPERTY(bool active MEMBER m_active NOTIFY activeChanged)
+
+public:
+    explicit QmlEnergyHistoryModel(QObject *parent = nullptr)
+        : QAlphaCloud::EnergyHistoryModel(parent)
+    {
+    }
+
+    void classBegin() override
+    {
+    }
+
+    void componentComplete() override
+    {
+        connect(this, &QmlEnergyHistoryModel::serialNumberChanged, this, &QmlEnergyHistoryModel::reloadIfActive);
+        connect(this, &QmlEnergyHistoryModel::fromDateChanged, this, &QmlEnergyHistoryModel::reloadIfActive);
+        connect(this, &QmlEnergyHistoryModel::toDateChanged, this, &QmlEnergyHistoryModel::reloadIfActive);
+        // Suppress warnings on autoload.
+        if (connector() && connector()->configuration() && connector()->configuration()->valid() && !serialNumber().isEmpty() && fromDate().isValid()
+            && toDate().isValid()) {
+            reloadIfActive();
+        }
+    }
+
+Q_SIGNALS:
+    void activeChanged(bool active);
+
+private:
+    void reloadIfActive()
+    {
+        if (m_active) {
+            scheduleReload();
+        }
+    }
+
+    bool m_active = true;
+};
+
+class QmlPowerHistoryModel : public QAlphaCloud::PowerHistoryModel, public QQmlParserStatus
+{
+    Q_OBJECT
+    Q_INTERFACES(QQmlParserStatus)
+
+    Q_PROPERTY(bool active MEMBER m_active NOTIFY activeChanged)
+
+public:
+    explicit QmlPowerHistoryModel(QObject *parent = nullptr)
+        : QAlphaCloud::PowerHistoryModel(parent)
+    {
+    }
+
+    void classBegin() override
+    {
+    }
+
+    void componentComplete() override
+    {
+        connect(this, &QmlPowerHistoryModel::serialNumberChanged, this, &QmlPowerHistoryModel::reloadIfActive);
+        // Suppress warnings on autoload.
+        if (connector() && connector()->configuration() && connector()->configuration()->valid() && !serialNumber().isEmpty()) {
+            reloadIfActive();
+        }
+    }
+
+Q_SIGNALS:
+    void activeChanged(bool active);
+
+private:
+    void reloadIfActive()
+    {
+        if (m_active) {
+            reload();
+        }
+    }
+
+    bool m_active = true;
+};
+
+class QmlFleetLiveDataModel : public QAlphaCloud::FleetLiveDataModel, public QQmlParserStatus
+{
+    Q_OBJECT
+    Q_INTERFACES(QQmlParserStatus)
+
+    Q_PROPERTY(bool active MEMBER m_active NOTIFY activeChanged)
+
+public:
+    explicit QmlFleetLiveDataModel(QObject *parent = nullptr)
+        : QAlphaCloud::FleetLiveDataModel(parent)
+    {
+    }
+
+    void classBegin() override
+    {
+    }
+
+    void componentComplete() override
+    {
+        // Once polling, the model picks up new serial numbers by itself.
+        connect(this, &QmlFleetLiveDataModel::serialNumbersChanged, this, [this] {
+            if (status() == QAlphaCloud::RequestStatus::NoRequest) {
+                reloadIfActive();
+            }
+        });
+        // Suppress warnings on autoload.
+        if (connector() && connector()->configuration() && connector()->configuration()->valid() && rowCount() > 0) {
+            reloadIfActive();
+        }
+    }
+
+Q_SIGNALS:
+    void activeChanged(bool active);
+
+private:
+    void reloadIfActive()
+    {
+        if (m_active) {
+            reload();
+        }
+    }
+
+    bool m_active = true;
+};
+
+class QmlChargeConfigInfo : public QAlphaCloud::ChargeConfigInfo, public QQmlParserStatus
+{
+    Q_OBJECT
+    Q_INTERFACES(QQmlParserStatus)
+
+    Q_PROPERTY(bool active MEMBER m_active NOTIFY activeChanged)
+
+public:
+    explicit QmlChargeConfigInfo(QObject *parent = nullptr)
+        : QAlphaCloud::ChargeConfigInfo(parent)
+    {
+    }
+
+    void classBegin() override
+    {
+    }
+
+    void componentComplete() override
+    {
+        connect(this, &QmlChargeConfigInfo::serialNumberChanged, this, &QmlChargeConfigInfo::reloadIfActive);
+        // Suppress warnings on autoload.
+        if (connector() && connector()->configuration() && connector()->configuration()->valid() && !serialNumber().isEmpty()) {
+            reloadIfActive();
+        }
+    }
+
+Q_SIGNALS:
+    void activeChanged(bool active);
+
 private:
     void reloadIfActive()
     {
@@ -194,14 +442,328 @@ private:
     bool m_active = true;
 };
 
+class QmlDischargeConfigInfo : public QAlphaCloud::DischargeConfigInfo, public QQmlParserStatus
+{
+    Q_OBJECT
+    Q_INTERFACES(QQmlParserStatus)
+
+    Q_PROPERTY(bool active MEMBER m_active NOTIFY activeChanged)
+
+public:
+    explicit QmlDischargeConfigInfo(QObject *parent = nullptr)
+        : QAlphaCloud::DischargeConfigInfo(parent)
+    {
+    }
+
+    void classBegin() override
+    {
+    }
+
+    void componentComplete() override
+    {
+        connect(this, &QmlDischargeConfigInfo::serialNumberChanged, this, &QmlDischargeConfigInfo::reloadIfActive);
+        // Suppress warnings on autoload.
+        if (connector() && connector()->configuration() && connector()->configuration()->valid() && !serialNumber().isEmpty()) {
+            reloadIfActive();
+        }
+    }
+
+Q_SIGNALS:
+    void activeChanged(bool active);
+
+private:
+    void reloadIfActive()
+    {
+        if (m_active) {
+            reload();
+        }
+    }
+
+    bool m_active = true;
+};
+
+// Provides the values of one role of a OneDayPowerModel as a plain array
+// for Charts.ArraySource, so that charts don't call data() for every point
+// on every update. Only rows that actually changed are read again.
+// Changes are compressed into a single valuesChanged() per event loop iteration
+// as QML copies the entire array whenever it is emitted.
+class QmlPowerSeries : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(QAlphaCloud::OneDayPowerModel *model READ model WRITE setModel NOTIFY modelChanged)
+    Q_PROPERTY(int role READ role WRITE setRole NOTIFY roleChanged)
+    // All values are multiplied by this, e.g. to fit a percentage into the chart's range.
+    Q_PROPERTY(qreal scale READ scale WRITE setScale NOTIFY scaleChanged)
+
+    Q_PROPERTY(QVariantList values READ values NOTIFY valuesChanged)
+    Q_PROPERTY(qreal minimum READ minimum NOTIFY minimumChanged)
+    Q_PROPERTY(qreal maximum READ maximum NOTIFY maximumChanged)
+
+public:
+    explicit QmlPowerSeries(QObject *parent = nullptr)
+        : QObject(parent)
+    {
+        m_notifyTimer.setSingleShot(true);
+        m_notifyTimer.setInterval(0);
+        connect(&m_notifyTimer, &QTimer::timeout, this, &QmlPowerSeries::notify);
+    }
+
+    QAlphaCloud::OneDayPowerModel *model() const
+    {
+        return m_model.data();
+    }
+    void setModel(QAlphaCloud::OneDayPowerModel *model)
+    {
+        if (m_model == model) {
+            return;
+        }
+
+        if (m_model) {
+            disconnect(m_model, nullptr, this, nullptr);
+        }
+
+        m_model = model;
+
+        if (m_model) {
+            connect(m_model, &QAbstractItemModel::modelReset, this, &QmlPowerSeries::rebuild);
+            connect(m_model, &QAbstractItemModel::layoutChanged, this, &QmlPowerSeries::rebuild);
+            connect(m_model, &QAbstractItemModel::rowsMoved, this, &QmlPowerSeries::rebuild);
+            connect(m_model, &QAbstractItemModel::rowsInserted, this, [this](const QModelIndex &parent, int first, int last) {
+                Q_UNUSED(parent);
+                const auto column = m_model->column(static_cast<OneDayPowerModel::Roles>(m_role));
+                if (column.size() != m_values.count() + (last - first + 1)) {
+                    rebuild();
+                    return;
+                }
+
+                const bool wasEmpty = m_values.isEmpty();
+                for (int i = first; i <= last; ++i) {
+                    const qreal value = column[i] * m_scale;
+                    m_values.insert(i, value);
+
+                    if (wasEmpty && i == first) {
+                        m_minimum = value;
+                        m_maximum = value;
+                    } else {
+                        m_minimum = std::min(m_minimum, value);
+                        m_maximum = std::max(m_maximum, value);
+                    }
+                }
+
+                scheduleNotify();
+            });
+            connect(m_model, &QAbstractItemModel::rowsRemoved, this, [this](const QModelIndex &parent, int first, int last) {
+                Q_UNUSED(parent);
+                if (last >= m_values.count()) {
+                    rebuild();
+                    return;
+                }
+
+                // Only when the current minimum or maximum went away does it need to be searched again.
+                bool rescan = false;
+                for (int i = first; i <= last; ++i) {
+                    const qreal value = m_values.at(i).toReal();
+                    if (value <= m_minimum || value >= m_maximum) {
+                        rescan = true;
+                        break;
+                    }
+                }
+
+                m_values.erase(m_values.begin() + first, m_values.begin() + last + 1);
+
+                if (rescan) {
+                    rescanRange();
+                }
+                scheduleNotify();
+            });
+            connect(m_model,
+                    &QAbstractItemModel::dataChanged,
+                    this,
+                    [this](const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles) {
+                        if (!roles.isEmpty() && !roles.contains(m_role)) {
+                            return;
+                        }
+
+                        const auto column = m_model->column(static_cast<OneDayPowerModel::Roles>(m_role));
+                        if (column.size() != m_values.count()) {
+                            rebuild();
+                            return;
+                        }
+
+                        bool changed = false;
+                        bool rescan = false;
+                        for (int i = topLeft.row(); i <= bottomRight.row(); ++i) {
+                            const qreal oldValue = m_values.at(i).toReal();
+                            const qreal value = column[i] * m_scale;
+                            if (oldValue == value) {
+                                continue;
+                            }
+
+                            m_values[i] = value;
+                            changed = true;
+
+                            // Overwriting the current minimum or maximum with something less extreme
+                            // means another row might be the new one now.
+                            if ((oldValue <= m_minimum && value > oldValue) || (oldValue >= m_maximum && value < oldValue)) {
+                                rescan = true;
+                            }
+                            m_minimum = std::min(m_minimum, value);
+                            m_maximum = std::max(m_maximum, value);
+                        }
+
+                        if (!changed) {
+                            return;
+                        }
+
+                        if (rescan) {
+                            rescanRange();
+                        }
+                        scheduleNotify();
+                    });
+            connect(m_model, &QObject::destroyed, this, [this] {
+                setModel(nullptr);
+            });
+        }
+
+        rebuild();
+        Q_EMIT modelChanged(model);
+    }
+    Q_SIGNAL void modelChanged(QAlphaCloud::OneDayPowerModel *model);
+
+    int role() const
+    {
+        return m_role;
+    }
+    void setRole(int role)
+    {
+        if (m_role != role) {
+            m_role = role;
+            rebuild();
+            Q_EMIT roleChanged(role);
+        }
+    }
+    Q_SIGNAL void roleChanged(int role);
+
+    qreal scale() const
+    {
+        return m_scale;
+    }
+    void setScale(qreal scale)
+    {
+        if (!qFuzzyCompare(m_scale, scale)) {
+            m_scale = scale;
+            rebuild();
+            Q_EMIT scaleChanged(scale);
+        }
+    }
+    Q_SIGNAL void scaleChanged(qreal scale);
+
+    QVariantList values() const
+    {
+        return m_values;
+    }
+    Q_SIGNAL void valuesChanged();
+
+    qreal minimum() const
+    {
+        return m_minimum;
+    }
+    Q_SIGNAL void minimumChanged(qreal minimum);
+
+    qreal maximum() const
+    {
+        return m_maximum;
+    }
+    Q_SIGNAL void maximumChanged(qreal maximum);
+
+private:
+    void rebuild()
+    {
+        QVariantList values;
+
+        if (m_model) {
+            const auto column = m_model->column(static_cast<OneDayPowerModel::Roles>(m_role));
+            values.reserve(column.size());
+            for (qreal value : column) {
+                values.append(value * m_scale);
+            }
+        }
+
+        if (values == m_values) {
+            return;
+        }
+
+        m_values = values;
+        rescanRange();
+        scheduleNotify();
+    }
+
+    void rescanRange()
+    {
+        m_minimum = 0.0;
+        m_maximum = 0.0;
+
+        // Scan the model's contiguous array rather than the list of variants.
+        if (m_model) {
+            const auto column = m_model->column(static_cast<OneDayPowerModel::Roles>(m_role));
+            if (!column.isEmpty()) {
+                const auto minMax = std::minmax_element(column.begin(), column.end());
+                m_minimum = std::min(*minMax.first * m_scale, *minMax.second * m_scale);
+                m_maximum = std::max(*minMax.first * m_scale, *minMax.second * m_scale);
+            }
+        }
+    }
+
+    void scheduleNotify()
+    {
+        m_notifyTimer.start();
+    }
+
+    void notify()
+    {
+        Q_EMIT valuesChanged();
+
+        if (m_notifiedMinimum != m_minimum) {
+            m_notifiedMinimum = m_minimum;
+            Q_EMIT minimumChanged(m_minimum);
+        }
+        if (m_notifiedMaximum != m_maximum) {
+            m_notifiedMaximum = m_maximum;
+            Q_EMIT maximumChanged(m_maximum);
+        }
+    }
+
+    QPointer<QAlphaCloud::OneDayPowerModel> m_model;
+    int m_role = static_cast<int>(OneDayPowerModel::Roles::PhotovoltaicEnergy);
+    qreal m_scale = 1.0;
+
+    QVariantList m_values;
+    qreal m_minimum = 0.0;
+    qreal m_maximum = 0.0;
+
+    // What QML was last told about.
+    qreal m_notifiedMinimum = 0.0;
+    qreal m_notifiedMaximum = 0.0;
+    QTimer m_notifyTimer;
+};
+
 void QAlphaCloudQmlPlugin::registerTypes(const char *uri)
 {
     //@uri de.broulik.qalphacloudpl
+    qmlRegisterType<QAlphaCloud::AdaptivePoller>(uri, 1, 0, "AdaptivePoller");
+    qmlRegisterType<QmlChargeConfigInfo>(uri, 1, 0, "ChargeConfigInfo");
     qmlRegisterType<QmlConfiguration>(uri, 1, 0, "Configuration");
     qmlRegisterType<QmlConnector>(uri, 1, 0, "Connector");
+    qmlRegisterType<QmlDischargeConfigInfo>(uri, 1, 0, "DischargeConfigInfo");
+    qmlRegisterType<QmlEnergyHistoryModel>(uri, 1, 0, "EnergyHistoryModel");
+    qmlRegisterType<QmlFleetLiveDataModel>(uri, 1, 0, "FleetLiveDataModel");
     qmlRegisterType<QmlLastPowerData>(uri, 1, 0, "LastPowerData");
     qmlRegisterType<QmlOneDateEnergy>(uri, 1, 0, "OneDateEnergy");
     qmlRegisterType<QmlOneDayPowerModel>(uri, 1, 0, "OneDayPowerModel");
+    qmlRegisterType<QmlPowerHistoryModel>(uri, 1, 0, "PowerHistoryModel");
+    qmlRegisterType<QmlPowerSeries>(uri, 1, 0, "PowerSeries");
+    qmlRegisterType<QAlphaCloud::RequestGroup>(uri, 1, 0, "RequestGroup");
     // TODO figure out autoload, i.e. wait for Connector to become valid (when its QNAM is set) and then reload.
     qmlRegisterType<QAlphaCloud::StorageSystemsModel>(uri, 1, 0, "StorageSystemsModel");
 
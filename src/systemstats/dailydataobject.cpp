@@ -17,23 +17,19 @@
 #include <systemstats/SensorProperty.h>
 
 #include "config-alphacloud.h"
+#include "pollscheduler.h"
 
 using namespace QAlphaCloud;
+using namespace std::chrono_literals;
 
-DailyDataObject::DailyDataObject(QAlphaCloud::Connector *connector, const QString &serialNumber, KSysGuard::SensorContainer *parent)
+// TODO Investigate how often this updates. OneDateEnergyModel is in 5 minute intervals.
+static constexpr std::chrono::milliseconds s_pollInterval = 1min;
+
+DailyDataObject::DailyDataObject(QAlphaCloud::Connector *connector, const QString &serialNumber, PollScheduler *scheduler, KSysGuard::SensorContainer *parent)
     : SensorObject(serialNumber + QLatin1String("_daily"), parent)
     , m_dailyData(new OneDateEnergy(connector, serialNumber, QDate::currentDate(), this))
+    , m_scheduler(scheduler)
 {
-    // TODO Investigate how often this updates. OneDateEnergyModel is in 5 minute intervals.
-    m_rateLimitTimer.setInterval(1 * 60 * 1000); // 1 min.
-    m_rateLimitTimer.setSingleShot(true);
-    connect(&m_rateLimitTimer, &QTimer::timeout, this, [this] {
-        if (m_updatePending) {
-            m_updatePending = false;
-            reload();
-        }
-    });
-
     // Photovoltaic energy production:
     m_photovoltaicProperty = new KSysGuard::SensorProperty(QStringLiteral("photovoltaic"), tr("Photovoltaic Energy"), 0, this);
     m_photovoltaicProperty->setShortName(tr("Photovoltaic"));
@@ -41,7 +37,7 @@ DailyDataObject::DailyDataObject(QAlphaCloud::Connector *connector, const QStrin
     m_photovoltaicProperty->setUnit(KSysGuard::Unit::UnitWattHour);
     m_photovoltaicProperty->setVariantType(QVariant::Int);
     m_photovoltaicProperty->setMin(0);
-    connect(m_photovoltaicProperty, &KSysGuard::SensorProperty::subscribedChanged, this, &DailyDataObject::update);
+    connect(m_photovoltaicProperty, &KSysGuard::SensorProperty::subscribedChanged, this, &DailyDataObject::schedulePoll);
 
     // Total load:
     m_totalLoadProperty = new KSysGuard::SensorProperty(QStringLiteral("totalLoad"), tr("Total Load"), 0, this);
@@ -50,7 +46,7 @@ DailyDataObject::DailyDataObject(QAlphaCloud::Connector *connector, const QStrin
     m_totalLoadProperty->setUnit(KSysGuard::Unit::UnitWattHour);
     m_totalLoadProperty->setVariantType(QVariant::Int);
     m_totalLoadProperty->setMin(0);
-    connect(m_totalLoadProperty, &KSysGuard::SensorProperty::subscribedChanged, this, &DailyDataObject::update);
+    connect(m_totalLoadProperty, &KSysGuard::SensorProperty::subscribedChanged, this, &DailyDataObject::schedulePoll);
 
     // Power input from grid:
     m_inputProperty = new KSysGuard::SensorProperty(QStringLiteral("input"), tr("Energy Input"), 0, this);
@@ -59,7 +55,7 @@ DailyDataObject::DailyDataObject(QAlphaCloud::Connector *connector, const QStrin
     m_inputProperty->setUnit(KSysGuard::Unit::UnitWattHour);
     m_inputProperty->setVariantType(QVariant::Int);
     m_inputProperty->setMin(0);
-    connect(m_inputProperty, &KSysGuard::SensorProperty::subscribedChanged, this, &DailyDataObject::update);
+    connect(m_inputProperty, &KSysGuard::SensorProperty::subscribedChanged, this, &DailyDataObject::schedulePoll);
 
     // Power output to grid:
     m_outputProperty = new KSysGuard::SensorProperty(QStringLiteral("output"), tr("Energy Output"), 0, this);
@@ -68,7 +64,7 @@ DailyDataObject::DailyDataObject(QAlphaCloud::Connector *connector, const QStrin
     m_outputProperty->setUnit(KSysGuard::Unit::UnitWattHour);
     m_outputProperty->setVariantType(QVariant::Int);
     m_outputProperty->setMin(0);
-    connect(m_outputProperty, &KSysGuard::SensorProperty::subscribedChanged, this, &DailyDataObject::update);
+    connect(m_outputProperty, &KSysGuard::SensorProperty::subscribedChanged, this, &DailyDataObject::schedulePoll);
 
     // Battery charge:
     m_chargeProperty = new KSysGuard::SensorProperty(QStringLiteral("charge"), tr("Battery Charge"), 0, this);
@@ -77,7 +73,7 @@ DailyDataObject::DailyDataObject(QAlphaCloud::Connector *connector, const QStrin
     m_chargeProperty->setUnit(KSysGuard::Unit::UnitWattHour);
     m_chargeProperty->setVariantType(QVariant::Int);
     m_chargeProperty->setMin(0);
-    connect(m_chargeProperty, &KSysGuard::SensorProperty::subscribedChanged, this, &DailyDataObject::update);
+    connect(m_chargeProperty, &KSysGuard::SensorProperty::subscribedChanged, this, &DailyDataObject::schedulePoll);
 
     // Battery discharge:
     m_dischargeProperty = new KSysGuard::SensorProperty(QStringLiteral("discharge"), tr("Battery Discharge"), 0, this);
@@ -86,7 +82,7 @@ DailyDataObject::DailyDataObject(QAlphaCloud::Connector *connector, const QStrin
     m_dischargeProperty->setUnit(KSysGuard::Unit::UnitWattHour);
     m_dischargeProperty->setVariantType(QVariant::Int);
     m_dischargeProperty->setMin(0);
-    connect(m_dischargeProperty, &KSysGuard::SensorProperty::subscribedChanged, this, &DailyDataObject::update);
+    connect(m_dischargeProperty, &KSysGuard::SensorProperty::subscribedChanged, this, &DailyDataObject::schedulePoll);
 
     // Battery charge:
     m_gridChargeProperty = new KSysGuard::SensorProperty(QStringLiteral("gridCharge"), tr("Grid Charge"), 0, this);
@@ -95,7 +91,7 @@ DailyDataObject::DailyDataObject(QAlphaCloud::Connector *connector, const QStrin
     m_gridChargeProperty->setUnit(KSysGuard::Unit::UnitWattHour);
     m_gridChargeProperty->setVariantType(QVariant::Int);
     m_gridChargeProperty->setMin(0);
-    connect(m_gridChargeProperty, &KSysGuard::SensorProperty::subscribedChanged, this, &DailyDataObject::update);
+    connect(m_gridChargeProperty, &KSysGuard::SensorProperty::subscribedChanged, this, &DailyDataObject::schedulePoll);
 
 #if PRESENTATION_BUILD
     //: Sensor object name with daily data
@@ -105,17 +101,26 @@ DailyDataObject::DailyDataObject(QAlphaCloud::Connector *connector, const QStrin
     setName(tr("%1 (Daily)").arg(serialNumber));
 #endif
 
-    // Update once initially but make sure the subscriptions have been processed.
-    // TODO check if this actually works.
-    QMetaObject::invokeMethod(this, &DailyDataObject::update, Qt::QueuedConnection);
+    connect(m_dailyData, &OneDateEnergy::statusChanged, this, [this](RequestStatus status) {
+        if (status == RequestStatus::Finished) {
+            m_scheduler->reportSuccess(this);
+        } else if (status == RequestStatus::Error) {
+            m_scheduler->reportError(this, m_dailyData->error());
+        }
+    });
+
+    m_scheduler->addClient(this, s_pollInterval, [this] {
+        return poll();
+    });
+
+    // Poll once initially but make sure the subscriptions have been processed.
+    QMetaObject::invokeMethod(this, &DailyDataObject::schedulePoll, Qt::QueuedConnection);
 }
 
 // Update all values in lock-step when ksystemstats asks us to rather than updating them
 // when the relevant property change is emitted.
 void DailyDataObject::update()
 {
-    reload();
-
     if (!m_dailyData->valid()) {
         return;
     }
@@ -129,20 +134,18 @@ void DailyDataObject::update()
     m_gridChargeProperty->setValue(m_dailyData->gridCharge());
 }
 
-void DailyDataObject::reload()
+void DailyDataObject::schedulePoll()
+{
+    m_scheduler->schedule(this);
+}
+
+bool DailyDataObject::poll()
 {
     if (!m_photovoltaicProperty->isSubscribed() && !m_totalLoadProperty->isSubscribed() && !m_inputProperty->isSubscribed() && !m_outputProperty->isSubscribed()
         && !m_chargeProperty->isSubscribed() && !m_dischargeProperty->isSubscribed() && !m_gridChargeProperty->isSubscribed()) {
-        return;
-    }
-
-    if (m_rateLimitTimer.isActive()) {
-        m_updatePending = true;
-        return;
+        return false;
     }
 
     m_dailyData->resetDate();
-    m_dailyData->reload();
-
-    m_rateLimitTimer.start();
+    return m_dailyData->reload();
 }
@@ -9,8 +9,6 @@
 
 #include <QAlphaCloud/QAlphaCloud>
 
-#include <QTimer>
-
 namespace KSysGuard
 {
 class SensorContainer;
@@ -25,18 +23,22 @@ class OneDateEnergy;
 
 class QModelIndex;
 
+class PollScheduler;
+
 class DailyDataObject : public KSysGuard::SensorObject
 {
 public:
-    DailyDataObject(QAlphaCloud::Connector *connector, const QString &serialNumber, KSysGuard::SensorContainer *parent);
+    DailyDataObject(QAlphaCloud::Connector *connector, const QString &serialNumber, PollScheduler *scheduler, KSysGuard::SensorContainer *parent);
 
     void update();
     void updateSystem(const QModelIndex &index);
 
 private:
-    void reload();
+    bool poll();
+    void schedulePoll();
 
     QAlphaCloud::OneDateEnergy *m_dailyData = nullptr;
+    PollScheduler *m_scheduler = nullptr;
 
     KSysGuard::SensorProperty *m_photovoltaicProperty = nullptr;
 
@@ -48,7 +50,4 @@ private:
     KSysGuard::SensorProperty *m_chargeProperty = nullptr;
     KSysGuard::SensorProperty *m_dischargeProperty = nullptr;
     KSysGuard::SensorProperty *m_gridChargeProperty = nullptr;
-
-    QTimer m_rateLimitTimer;
-    bool m_updatePending = false;
 };
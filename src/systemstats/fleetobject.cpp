@@ -0,0 +1,125 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "fleetobject.h"
+
+#include <systemstats/SensorContainer.h>
+#include <systemstats/SensorProperty.h>
+
+bool FleetObject::Contribution::operator==(const Contribution &other) const
+{
+    return photovoltaicPower == other.photovoltaicPower && currentLoad == other.currentLoad && gridFeed == other.gridFeed
+        && gridConsumption == other.gridConsumption && batteryEnergy == other.batteryEnergy && batteryCapacity == other.batteryCapacity;
+}
+
+bool FleetObject::Contribution::operator!=(const Contribution &other) const
+{
+    return !(*this == other);
+}
+
+FleetObject::FleetObject(KSysGuard::SensorContainer *parent)
+    : SensorObject(QStringLiteral("fleet"), parent)
+{
+    m_photovoltaicPowerProperty = new KSysGuard::SensorProperty(QStringLiteral("photovoltaicPower"), tr("Total Photovoltaic Power"), 0, this);
+    m_photovoltaicPowerProperty->setShortName(tr("Photovoltaic"));
+    m_photovoltaicPowerProperty->setDescription(tr("Amount of power that is currently supplied by all photovoltaic systems"));
+    m_photovoltaicPowerProperty->setUnit(KSysGuard::Unit::UnitWatt);
+    m_photovoltaicPowerProperty->setVariantType(QVariant::Int);
+    m_photovoltaicPowerProperty->setMin(0);
+
+    m_currentLoadProperty = new KSysGuard::SensorProperty(QStringLiteral("currentLoad"), tr("Total Load"), 0, this);
+    m_currentLoadProperty->setShortName(tr("Load"));
+    m_currentLoadProperty->setDescription(tr("Amount of power that is currently consumed across all systems"));
+    m_currentLoadProperty->setUnit(KSysGuard::Unit::UnitWatt);
+    m_currentLoadProperty->setVariantType(QVariant::Int);
+    m_currentLoadProperty->setMin(0);
+
+    m_gridFeedProperty = new KSysGuard::SensorProperty(QStringLiteral("gridFeed"), tr("Total Grid Feed"), 0, this);
+    m_gridFeedProperty->setShortName(tr("Feed"));
+    m_gridFeedProperty->setDescription(tr("Amount of power that all systems currently feed into the grid"));
+    m_gridFeedProperty->setUnit(KSysGuard::Unit::UnitWatt);
+    m_gridFeedProperty->setVariantType(QVariant::Int);
+    m_gridFeedProperty->setMin(0);
+
+    m_gridConsumptionProperty = new KSysGuard::SensorProperty(QStringLiteral("gridConsumption"), tr("Total Grid Consumption"), 0, this);
+    m_gridConsumptionProperty->setShortName(tr("Consumption"));
+    m_gridConsumptionProperty->setDescription(tr("Amount of power that all systems currently consume from the grid"));
+    m_gridConsumptionProperty->setUnit(KSysGuard::Unit::UnitWatt);
+    m_gridConsumptionProperty->setVariantType(QVariant::Int);
+    m_gridConsumptionProperty->setMin(0);
+
+    m_batterySocProperty = new KSysGuard::SensorProperty(QStringLiteral("batterySoc"), tr("Combined State of Charge"), 0, this);
+    m_batterySocProperty->setShortName(tr("SOC"));
+    m_batterySocProperty->setDescription(tr("Percentage all batteries are charged, weighted by their capacity"));
+    m_batterySocProperty->setUnit(KSysGuard::Unit::UnitPercent);
+    m_batterySocProperty->setVariantType(QVariant::Double);
+    m_batterySocProperty->setMax(100.0);
+    m_batterySocProperty->setMin(0.0);
+
+    m_batteryEnergyProperty = new KSysGuard::SensorProperty(QStringLiteral("batteryEnergy"), tr("Total Battery Energy"), 0, this);
+    m_batteryEnergyProperty->setShortName(tr("Energy"));
+    m_batteryEnergyProperty->setDescription(tr("Amount of energy that is currently stored in all batteries"));
+    m_batteryEnergyProperty->setUnit(KSysGuard::Unit::UnitWattHour);
+    m_batteryEnergyProperty->setVariantType(QVariant::Int);
+    m_batteryEnergyProperty->setMin(0);
+
+    //: Sensor object name with combined data of all storage systems
+    setName(tr("All Systems"));
+}
+
+void FleetObject::add(const Contribution &contribution, int sign)
+{
+    m_photovoltaicPower += sign * contribution.photovoltaicPower;
+    m_currentLoad += sign * contribution.currentLoad;
+    m_gridFeed += sign * contribution.gridFeed;
+    m_gridConsumption += sign * contribution.gridConsumption;
+    m_batteryEnergy += sign * contribution.batteryEnergy;
+    m_batteryCapacity += sign * contribution.batteryCapacity;
+}
+
+void FleetObject::setContribution(const QString &serialNumber, const Contribution &contribution)
+{
+    auto it = m_contributions.find(serialNumber);
+    if (it == m_contributions.end()) {
+        it = m_contributions.insert(serialNumber, Contribution());
+    } else if (*it == contribution) {
+        return;
+    }
+
+    add(*it, -1);
+    add(contribution, 1);
+    *it = contribution;
+}
+
+void FleetObject::removeContribution(const QString &serialNumber)
+{
+    auto it = m_contributions.find(serialNumber);
+    if (it == m_contributions.end()) {
+        return;
+    }
+
+    add(*it, -1);
+    m_contributions.erase(it);
+}
+
+bool FleetObject::isSubscribed() const
+{
+    return m_photovoltaicPowerProperty->isSubscribed() || m_currentLoadProperty->isSubscribed() || m_gridFeedProperty->isSubscribed()
+        || m_gridConsumptionProperty->isSubscribed() || m_batterySocProperty->isSubscribed() || m_batteryEnergyProperty->isSubscribed();
+}
+
+void FleetObject::update()
+{
+    m_photovoltaicPowerProperty->setValue(static_cast<int>(m_photovoltaicPower));
+    m_currentLoadProperty->setValue(static_cast<int>(m_currentLoad));
+    m_gridFeedProperty->setValue(static_cast<int>(m_gridFeed));
+    m_gridConsumptionProperty->setValue(static_cast<int>(m_gridConsumption));
+
+    m_batteryEnergyProperty->setValue(static_cast<int>(m_batteryEnergy));
+    m_batteryEnergyProperty->setMax(static_cast<int>(m_batteryCapacity));
+    if (m_batteryCapacity > 0) {
+        m_batterySocProperty->setValue(m_batteryEnergy * 100.0 / m_batteryCapacity);
+    }
+}
@@ -0,0 +1,69 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include <systemstats/SensorObject.h>
+
+#include <QHash>
+
+namespace KSysGuard
+{
+class SensorContainer;
+class SensorProperty;
+} // namespace KSysGuard
+
+/**
+ * Combined live data of all storage systems.
+ *
+ * Every system reports its share and the totals are adjusted by the difference
+ * to its previous share, so the cost doesn't depend on the number of systems.
+ */
+class FleetObject : public KSysGuard::SensorObject
+{
+public:
+    struct Contribution {
+        int photovoltaicPower = 0; // W
+        int currentLoad = 0; // W
+        int gridFeed = 0; // W
+        int gridConsumption = 0; // W
+        int batteryEnergy = 0; // Wh
+        int batteryCapacity = 0; // Wh
+
+        bool operator==(const Contribution &other) const;
+        bool operator!=(const Contribution &other) const;
+    };
+
+    explicit FleetObject(KSysGuard::SensorContainer *parent);
+
+    // Called by every system whenever its data changed.
+    void setContribution(const QString &serialNumber, const Contribution &contribution);
+    void removeContribution(const QString &serialNumber);
+
+    // Whether any of the combined sensors is subscribed, which needs every system to be polled.
+    bool isSubscribed() const;
+
+    void update();
+
+private:
+    void add(const Contribution &contribution, int sign);
+
+    KSysGuard::SensorProperty *m_photovoltaicPowerProperty = nullptr;
+    KSysGuard::SensorProperty *m_currentLoadProperty = nullptr;
+    KSysGuard::SensorProperty *m_gridFeedProperty = nullptr;
+    KSysGuard::SensorProperty *m_gridConsumptionProperty = nullptr;
+    KSysGuard::SensorProperty *m_batterySocProperty = nullptr;
+    KSysGuard::SensorProperty *m_batteryEnergyProperty = nullptr;
+
+    QHash<QString, Contribution> m_contributions;
+
+    // Running totals.
+    qint64 m_photovoltaicPower = 0;
+    qint64 m_currentLoad = 0;
+    qint64 m_gridFeed = 0;
+    qint64 m_gridConsumption = 0;
+    qint64 m_batteryEnergy = 0;
+    qint64 m_batteryCapacity = 0;
+};
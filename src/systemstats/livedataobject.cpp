@@ -8,7 +8,10 @@
 #include <algorithm>
 #include <cmath>
 
-#include <QAlphaCloud/ApiRequest>
+#include <QDateTime>
+
+#include <QAlphaCloud/ChargeConfigInfo>
+#include <QAlphaCloud/DischargeConfigInfo>
 #include <QAlphaCloud/LastPowerData>
 #include <QAlphaCloud/QAlphaCloud>
 #include <QAlphaCloud/StorageSystemsModel>
@@ -17,22 +20,26 @@
 #include <systemstats/SensorProperty.h>
 
 #include "config-alphacloud.h"
+#include "pollscheduler.h"
 
 using namespace QAlphaCloud;
+using namespace std::chrono_literals;
+
+static constexpr std::chrono::milliseconds s_pollInterval = 10s;
 
-LiveDataObject::LiveDataObject(QAlphaCloud::Connector *connector, const QString &serialNumber, KSysGuard::SensorContainer *parent)
+LiveDataObject::LiveDataObject(QAlphaCloud::Connector *connector,
+                               const QString &serialNumber,
+                               PollScheduler *scheduler,
+                               FleetObject *fleet,
+                               KSysGuard::SensorContainer *parent)
     : SensorObject(serialNumber + QLatin1String("_live"), parent)
     , m_liveData(new LastPowerData(connector, serialNumber, this))
+    , m_chargeConfig(new ChargeConfigInfo(connector, serialNumber, this))
+    , m_dischargeConfig(new DischargeConfigInfo(connector, serialNumber, this))
+    , m_scheduler(scheduler)
+    , m_fleet(fleet)
+    , m_serialNumber(serialNumber)
 {
-    m_rateLimitTimer.setInterval(10000);
-    m_rateLimitTimer.setSingleShot(true);
-    connect(&m_rateLimitTimer, &QTimer::timeout, this, [this] {
-        if (m_updatePending) {
-            m_updatePending = false;
-            reload();
-        }
-    });
-
     // Photovoltaic power:
     // const int photovoltaicDesignPower =
     // index.data(static_cast<int>(StorageSystemsModel::Roles::PhotovoltaicPower)).toInt();
@@ -43,7 +50,7 @@ LiveDataObject::LiveDataObject(QAlphaCloud::Connector *connector, const QString
     m_photovoltaicPowerProperty->setVariantType(QVariant::Int);
     m_photovoltaicPowerProperty->setMin(0);
     // m_photovoltaicPowerProperty->setMax(photovoltaicDesignPower * 1000);
-    connect(m_photovoltaicPowerProperty, &KSysGuard::SensorProperty::subscribedChanged, this, &LiveDataObject::update);
+    connect(m_photovoltaicPowerProperty, &KSysGuard::SensorProperty::subscribedChanged, this, &LiveDataObject::schedulePoll);
 
     // Current consumer load:
     m_currentLoadProperty = new KSysGuard::SensorProperty(QStringLiteral("currentLoad"), tr("Current Load"), 0, this);
@@ -53,7 +60,7 @@ LiveDataObject::LiveDataObject(QAlphaCloud::Connector *connector, const QString
     m_currentLoadProperty->setVariantType(QVariant::Int);
     // TODO inverter power or something
     // m_currentLoadProperty->setMax(photovoltaicDesignPower * 1000);
-    connect(m_currentLoadProperty, &KSysGuard::SensorProperty::subscribedChanged, this, &LiveDataObject::update);
+    connect(m_currentLoadProperty, &KSysGuard::SensorProperty::subscribedChanged, this, &LiveDataObject::schedulePoll);
 
     // Power being fed to the grid:
     m_gridFeedProperty = new KSysGuard::SensorProperty(QStringLiteral("gridFeed"),
@@ -67,7 +74,7 @@ LiveDataObject::LiveDataObject(QAlphaCloud::Connector *connector, const QString
     m_gridFeedProperty->setMin(0);
     // TODO inverter power or something
     // m_gridFeedProperty->setMax(photovoltaicDesignPower * 1000);
-    connect(m_gridFeedProperty, &KSysGuard::SensorProperty::subscribedChanged, this, &LiveDataObject::update);
+    connect(m_gridFeedProperty, &KSysGuard::SensorProperty::subscribedChanged, this, &LiveDataObject::schedulePoll);
 
     // Poewr being consumed from the grid:
     m_gridConsumptionProperty = new KSysGuard::SensorProperty(QStringLiteral("gridConsumption"), tr("Grid Consumption"), 0, this);
@@ -78,7 +85,7 @@ LiveDataObject::LiveDataObject(QAlphaCloud::Connector *connector, const QString
     m_gridConsumptionProperty->setMin(0);
     // TODO inverter power or something
     // m_gridConsumptionProperty->setMax(photovoltaicDesignPower * 1000);
-    connect(m_gridConsumptionProperty, &KSysGuard::SensorProperty::subscribedChanged, this, &LiveDataObject::update);
+    connect(m_gridConsumptionProperty, &KSysGuard::SensorProperty::subscribedChanged, this, &LiveDataObject::schedulePoll);
 
     // Battery state of charge percent:
     m_batterySocProperty = new KSysGuard::SensorProperty(QStringLiteral("batterySoc"), tr("State of Charge"), 0, this);
@@ -88,7 +95,7 @@ LiveDataObject::LiveDataObject(QAlphaCloud::Connector *connector, const QString
     m_batterySocProperty->setVariantType(QVariant::Double);
     m_batterySocProperty->setMax(100.0);
     m_batterySocProperty->setMin(0.0);
-    connect(m_batterySocProperty, &KSysGuard::SensorProperty::subscribedChanged, this, &LiveDataObject::update);
+    connect(m_batterySocProperty, &KSysGuard::SensorProperty::subscribedChanged, this, &LiveDataObject::schedulePoll);
 
     // Battery state of charge Wh:
     m_batteryEnergyProperty = new KSysGuard::SensorProperty(QStringLiteral("batteryEnergy"), tr("Battery Energy"), 0, this);
@@ -97,7 +104,7 @@ LiveDataObject::LiveDataObject(QAlphaCloud::Connector *connector, const QString
     m_batteryEnergyProperty->setUnit(KSysGuard::Unit::UnitWattHour);
     m_batteryEnergyProperty->setVariantType(QVariant::Int);
     // TODO max to battery Usable Capacity
-    connect(m_batteryEnergyProperty, &KSysGuard::SensorProperty::subscribedChanged, this, &LiveDataObject::update);
+    connect(m_batteryEnergyProperty, &KSysGuard::SensorProperty::subscribedChanged, this, &LiveDataObject::schedulePoll);
 
     // Battery charging rate:
     m_batteryChargeProperty = new KSysGuard::SensorProperty(QStringLiteral("batteryCharge"), tr("Battery Charge"), 0, this);
@@ -107,7 +114,7 @@ LiveDataObject::LiveDataObject(QAlphaCloud::Connector *connector, const QString
     m_batteryChargeProperty->setVariantType(QVariant::Int);
     // TODO inverter power or something
     // m_batteryChargeProperty->setMax(photovoltaicDesignPower * 1000);
-    connect(m_batteryChargeProperty, &KSysGuard::SensorProperty::subscribedChanged, this, &LiveDataObject::update);
+    connect(m_batteryChargeProperty, &KSysGuard::SensorProperty::subscribedChanged, this, &LiveDataObject::schedulePoll);
 
     // Battery discharging rate:
     m_batteryDischargeProperty = new KSysGuard::SensorProperty(QStringLiteral("batteryDischarge"), tr("Battery Discharge"), 0, this);
@@ -117,13 +124,53 @@ LiveDataObject::LiveDataObject(QAlphaCloud::Connector *connector, const QString
     m_batteryDischargeProperty->setVariantType(QVariant::Int);
     // TODO inverter power or something
     // m_batteryDischargeProperty->setMax(photovoltaicDesignPower * 1000);
-    connect(m_batteryDischargeProperty, &KSysGuard::SensorProperty::subscribedChanged, this, &LiveDataObject::update);
+    connect(m_batteryDischargeProperty, &KSysGuard::SensorProperty::subscribedChanged, this, &LiveDataObject::schedulePoll);
 
     m_batteryTimeProperty = new KSysGuard::SensorProperty(QStringLiteral("batteryTime"), tr("Remaining Time"), 0, this);
     m_batteryTimeProperty->setShortName(tr("Remaining"));
     m_batteryTimeProperty->setUnit(KSysGuard::Unit::UnitTime);
     m_batteryTimeProperty->setVariantType(QVariant::Int);
-    connect(m_batteryTimeProperty, &KSysGuard::SensorProperty::subscribedChanged, this, &LiveDataObject::update);
+    connect(m_batteryTimeProperty, &KSysGuard::SensorProperty::subscribedChanged, this, &LiveDataObject::schedulePoll);
+
+    // Averages and energy computed locally from the live data samples:
+    addAverageProperty(QStringLiteral("photovoltaicPowerAverage5"),
+                       tr("Photovoltaic Power (5 Minute Average)"),
+                       tr("Photovoltaic 5m"),
+                       SampleHistory::Window::FiveMinutes,
+                       SampleHistory::Channel::Photovoltaic);
+    addAverageProperty(QStringLiteral("photovoltaicPowerAverage15"),
+                       tr("Photovoltaic Power (15 Minute Average)"),
+                       tr("Photovoltaic 15m"),
+                       SampleHistory::Window::FifteenMinutes,
+                       SampleHistory::Channel::Photovoltaic);
+    addAverageProperty(QStringLiteral("photovoltaicPowerAverage60"),
+                       tr("Photovoltaic Power (60 Minute Average)"),
+                       tr("Photovoltaic 60m"),
+                       SampleHistory::Window::SixtyMinutes,
+                       SampleHistory::Channel::Photovoltaic);
+    addAverageProperty(QStringLiteral("currentLoadAverage5"),
+                       tr("Load (5 Minute Average)"),
+                       tr("Load 5m"),
+                       SampleHistory::Window::FiveMinutes,
+                       SampleHistory::Channel::Load);
+    addAverageProperty(QStringLiteral("currentLoadAverage15"),
+                       tr("Load (15 Minute Average)"),
+                       tr("Load 15m"),
+                       SampleHistory::Window::FifteenMinutes,
+                       SampleHistory::Channel::Load);
+    addAverageProperty(QStringLiteral("currentLoadAverage60"),
+                       tr("Load (60 Minute Average)"),
+                       tr("Load 60m"),
+                       SampleHistory::Window::SixtyMinutes,
+                       SampleHistory::Channel::Load);
+
+    addEnergyProperty(QStringLiteral("photovoltaicEnergySampled"), tr("Sampled Photovoltaic Energy"), tr("Photovoltaic"), SampleHistory::Channel::Photovoltaic);
+    addEnergyProperty(QStringLiteral("currentLoadEnergySampled"), tr("Sampled Load Energy"), tr("Load"), SampleHistory::Channel::Load);
+    addEnergyProperty(QStringLiteral("gridFeedEnergySampled"), tr("Sampled Grid Feed Energy"), tr("Feed"), SampleHistory::Channel::GridFeed);
+    addEnergyProperty(QStringLiteral("gridConsumptionEnergySampled"),
+                      tr("Sampled Grid Consumption Energy"),
+                      tr("Consumption"),
+                      SampleHistory::Channel::GridConsumption);
 
 #if PRESENTATION_BUILD
     //: Sensor object name with live data
@@ -133,53 +180,56 @@ LiveDataObject::LiveDataObject(QAlphaCloud::Connector *connector, const QString
     setName(tr("%1 (Live)").arg(serialNumber));
 #endif
 
-    // Update once initially but make sure the subscriptions have been processed.
-    // TODO check if this actually works.
-    QMetaObject::invokeMethod(this, &LiveDataObject::update, Qt::QueuedConnection);
+    // The combined sensors need the data of every system, even if none of its own sensors are subscribed.
+    const auto fleetSensors = m_fleet->sensors();
+    for (auto *fleetSensor : fleetSensors) {
+        connect(fleetSensor, &KSysGuard::SensorProperty::subscribedChanged, this, &LiveDataObject::schedulePoll);
+    }
+
+    connect(m_liveData, &LastPowerData::statusChanged, this, [this](RequestStatus status) {
+        if (status == RequestStatus::Finished) {
+            // Don't record the same outdated values over and over.
+            if (m_liveData->valid() && !m_liveData->stale()) {
+                m_history.addSample(QDateTime::currentMSecsSinceEpoch(), currentValues());
+            }
+            // Only adjusts the totals by what changed.
+            m_fleet->setContribution(m_serialNumber, contribution());
+            m_scheduler->reportSuccess(this);
+        } else if (status == RequestStatus::Error) {
+            m_scheduler->reportError(this, m_liveData->error());
+        }
+    });
+
+    m_scheduler->addClient(this, s_pollInterval, [this] {
+        return poll();
+    });
+
+    // Poll once initially but make sure the subscriptions have been processed.
+    QMetaObject::invokeMethod(this, &LiveDataObject::schedulePoll, Qt::QueuedConnection);
 }
 
 // Update all values in lock-step when ksystemstats asks us to rather than updating them
 // when the relevant property change is emitted.
 void LiveDataObject::update()
 {
-    reload();
-
     if (!m_liveData->valid()) {
         return;
     }
 
-    m_photovoltaicPowerProperty->setValue(m_liveData->photovoltaicPower());
-    // NOTE: This sometimes gets negative.
-    m_currentLoadProperty->setValue(std::max(0, m_liveData->currentLoad()));
+    const SampleHistory::Values values = currentValues();
 
-    // gridPower is negative when feeding power, positive when consuming power.
-    // This is a convenience sensor only showing when power is fed into the grid.
-    const int gridPower = m_liveData->gridPower();
-    int gridFeed = 0;
-    int gridConsumption = 0;
+    m_photovoltaicPowerProperty->setValue(values[static_cast<int>(SampleHistory::Channel::Photovoltaic)]);
+    m_currentLoadProperty->setValue(values[static_cast<int>(SampleHistory::Channel::Load)]);
 
-    if (gridPower < 0) {
-        gridFeed = -gridPower;
-    } else if (gridPower > 0) {
-        gridConsumption = gridPower;
-    }
-
-    m_gridFeedProperty->setValue(gridFeed);
-    m_gridConsumptionProperty->setValue(gridConsumption);
+    m_gridFeedProperty->setValue(values[static_cast<int>(SampleHistory::Channel::GridFeed)]);
+    m_gridConsumptionProperty->setValue(values[static_cast<int>(SampleHistory::Channel::GridConsumption)]);
 
     m_batterySocProperty->setValue(m_liveData->batterySoc());
     const int batteryEnergy = std::round(m_batteryRemainingCapacityWh * m_liveData->batterySoc() / 100.0);
     m_batteryEnergyProperty->setValue(batteryEnergy);
 
-    const int batteryPower = m_liveData->batteryPower();
-    int batteryCharge = 0;
-    int batteryDischarge = 0;
-
-    if (batteryPower < 0) {
-        batteryCharge = -batteryPower;
-    } else if (batteryPower > 0) {
-        batteryDischarge = batteryPower;
-    }
+    const int batteryCharge = values[static_cast<int>(SampleHistory::Channel::BatteryCharge)];
+    const int batteryDischarge = values[static_cast<int>(SampleHistory::Channel::BatteryDischarge)];
 
     m_batteryChargeProperty->setValue(batteryCharge);
     m_batteryDischargeProperty->setValue(batteryDischarge);
@@ -188,54 +238,137 @@ void LiveDataObject::update()
         m_batteryTimeProperty->setName(tr("Time until full"));
 
         if (m_batteryRemainingCapacityWh > 0) {
-            const int neededCapacity = std::max(0, m_batteryRemainingCapacityWh - batteryEnergy);
+            // Charging usually stops before reaching a hundred percent.
+            const qreal chargeLimit = m_chargeConfig->valid() && m_chargeConfig->chargeLimit() > 0 ? m_chargeConfig->chargeLimit() : 100.0;
+            const int chargeCapEnergy = m_batteryRemainingCapacityWh * chargeLimit / 100.0;
+            const int neededCapacity = std::max(0, chargeCapEnergy - batteryEnergy);
             m_batteryTimeProperty->setValue(neededCapacity / qreal(batteryCharge) * 60 * 60);
         }
-        // TODO consider batHighCap.
     } else if (batteryDischarge > 0) {
         m_batteryTimeProperty->setName(tr("Time until empty"));
-        const int dischargeCapEnergy = m_batteryRemainingCapacityWh * m_batteryDischargeSoc / 100.0;
+        // Discharging usually stops before reaching zero percent.
+        const qreal dischargeLimit = m_dischargeConfig->valid() ? m_dischargeConfig->dischargeLimit() : 0.0;
+        const int dischargeCapEnergy = m_batteryRemainingCapacityWh * dischargeLimit / 100.0;
         const int remainingEnergy = std::max(0, batteryEnergy - dischargeCapEnergy);
         m_batteryTimeProperty->setValue(remainingEnergy / qreal(batteryDischarge) * 60 * 60);
     }
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    for (const AverageProperty &average : std::as_const(m_averageProperties)) {
+        average.property->setValue(static_cast<int>(std::round(m_history.average(average.window, average.channel, now))));
+    }
+
+    for (const EnergyProperty &energy : std::as_const(m_energyProperties)) {
+        energy.property->setValue(static_cast<int>(std::round(m_history.energyToday(energy.channel, now))));
+    }
 }
 
-void LiveDataObject::updateSystem(const QModelIndex &index)
+SampleHistory::Values LiveDataObject::currentValues() const
 {
-    m_batteryRemainingCapacityWh = index.data(static_cast<int>(StorageSystemsModel::Roles::BatteryRemainingCapacity)).toInt();
-
-    m_batteryEnergyProperty->setMax(m_batteryRemainingCapacityWh);
-
-    // Query discharge cap so remaining time calculation is more accurate since
-    // it will usually not go all the way to zero percent.
-    auto *dischargeRequest = new ApiRequest(m_liveData->connector(), QLatin1String("getDisChargeConfigInfo"));
-    dischargeRequest->setSysSn(m_liveData->serialNumber());
-    connect(dischargeRequest, &ApiRequest::finished, this, [this, dischargeRequest] {
-        if (dischargeRequest->error() != QAlphaCloud::ErrorCode::NoError) {
-            qWarning() << "Failed to read discharge info config" << dischargeRequest->error() << dischargeRequest->errorString();
-            // TODO try again at some point.
-        } else {
-            m_batteryDischargeSoc = dischargeRequest->data().toObject().value(QLatin1String("batUseCap")).toDouble();
-        }
-    });
-    dischargeRequest->send();
+    SampleHistory::Values values{};
+
+    values[static_cast<int>(SampleHistory::Channel::Photovoltaic)] = m_liveData->photovoltaicPower();
+    // NOTE: This sometimes gets negative.
+    values[static_cast<int>(SampleHistory::Channel::Load)] = std::max(0, m_liveData->currentLoad());
 
-    // TODO also check getChargeConfigInfo for batHighCap.
+    // gridPower is negative when feeding power, positive when consuming power.
+    // These are convenience sensors only showing either direction.
+    const int gridPower = m_liveData->gridPower();
+    values[static_cast<int>(SampleHistory::Channel::GridFeed)] = std::max(0, -gridPower);
+    values[static_cast<int>(SampleHistory::Channel::GridConsumption)] = std::max(0, gridPower);
+
+    const int batteryPower = m_liveData->batteryPower();
+    values[static_cast<int>(SampleHistory::Channel::BatteryCharge)] = std::max(0, -batteryPower);
+    values[static_cast<int>(SampleHistory::Channel::BatteryDischarge)] = std::max(0, batteryPower);
+
+    return values;
 }
 
-void LiveDataObject::reload()
+FleetObject::Contribution LiveDataObject::contribution() const
 {
-    if (!m_photovoltaicPowerProperty->isSubscribed() && !m_currentLoadProperty->isSubscribed() && !m_gridFeedProperty->isSubscribed()
-        && !m_gridConsumptionProperty->isSubscribed() && !m_batterySocProperty->isSubscribed() && !m_batteryEnergyProperty->isSubscribed()
-        && !m_batteryChargeProperty->isSubscribed() && !m_batteryDischargeProperty->isSubscribed()) {
-        return;
+    FleetObject::Contribution contribution;
+    if (!m_liveData->valid()) {
+        return contribution;
     }
 
-    if (m_rateLimitTimer.isActive()) {
-        m_updatePending = true;
-        return;
+    const SampleHistory::Values values = currentValues();
+    contribution.photovoltaicPower = values[static_cast<int>(SampleHistory::Channel::Photovoltaic)];
+    contribution.currentLoad = values[static_cast<int>(SampleHistory::Channel::Load)];
+    contribution.gridFeed = values[static_cast<int>(SampleHistory::Channel::GridFeed)];
+    contribution.gridConsumption = values[static_cast<int>(SampleHistory::Channel::GridConsumption)];
+    contribution.batteryEnergy = static_cast<int>(std::round(m_batteryRemainingCapacityWh * m_liveData->batterySoc() / 100.0));
+    contribution.batteryCapacity = m_batteryRemainingCapacityWh;
+    return contribution;
+}
+
+void LiveDataObject::addAverageProperty(const QString &id,
+                                        const QString &name,
+                                        const QString &shortName,
+                                        SampleHistory::Window window,
+                                        SampleHistory::Channel channel)
+{
+    auto *property = new KSysGuard::SensorProperty(id, name, 0, this);
+    property->setShortName(shortName);
+    property->setUnit(KSysGuard::Unit::UnitWatt);
+    property->setVariantType(QVariant::Int);
+    property->setMin(0);
+    connect(property, &KSysGuard::SensorProperty::subscribedChanged, this, &LiveDataObject::schedulePoll);
+
+    m_averageProperties.append(AverageProperty{property, window, channel});
+}
+
+void LiveDataObject::addEnergyProperty(const QString &id, const QString &name, const QString &shortName, SampleHistory::Channel channel)
+{
+    auto *property = new KSysGuard::SensorProperty(id, name, 0, this);
+    property->setShortName(shortName);
+    property->setDescription(tr("Amount of energy since midnight, as sampled from live data"));
+    property->setUnit(KSysGuard::Unit::UnitWattHour);
+    property->setVariantType(QVariant::Int);
+    property->setMin(0);
+    connect(property, &KSysGuard::SensorProperty::subscribedChanged, this, &LiveDataObject::schedulePoll);
+
+    m_energyProperties.append(EnergyProperty{property, channel});
+}
+
+void LiveDataObject::updateSystem(const QModelIndex &index)
+{
+    const int batteryRemainingCapacityWh = index.data(static_cast<int>(StorageSystemsModel::Roles::BatteryRemainingCapacity)).toInt();
+    if (m_batteryRemainingCapacityWh != batteryRemainingCapacityWh) {
+        m_batteryRemainingCapacityWh = batteryRemainingCapacityWh;
+        m_batteryEnergyProperty->setMax(m_batteryRemainingCapacityWh);
+        m_fleet->setContribution(m_serialNumber, contribution());
+    }
+
+    // These are served from cache unless it expired, and failed requests are retried by the library.
+    if (m_chargeConfig->status() != RequestStatus::Loading) {
+        m_chargeConfig->reload();
+    }
+    if (m_dischargeConfig->status() != RequestStatus::Loading) {
+        m_dischargeConfig->reload();
+    }
+}
+
+void LiveDataObject::schedulePoll()
+{
+    m_scheduler->schedule(this);
+}
+
+bool LiveDataObject::poll()
+{
+    if (!m_fleet->isSubscribed() && !m_photovoltaicPowerProperty->isSubscribed() && !m_currentLoadProperty->isSubscribed() && !m_gridFeedProperty->isSubscribed()
+        && !m_gridConsumptionProperty->isSubscribed() && !m_batterySocProperty->isSubscribed() && !m_batteryEnergyProperty->isSubscribed()
+        && !m_batteryChargeProperty->isSubscribed() && !m_batteryDischargeProperty->isSubscribed()
+        && std::none_of(m_averageProperties.cbegin(),
+                        m_averageProperties.cend(),
+                        [](const AverageProperty &average) {
+                            return average.property->isSubscribed();
+                        })
+        && std::none_of(m_energyProperties.cbegin(), m_energyProperties.cend(), [](const EnergyProperty &energy) {
+               return energy.property->isSubscribed();
+           })) {
+        return false;
     }
 
-    m_liveData->reload();
-    m_rateLimitTimer.start();
+    return m_liveData->reload();
 }
@@ -7,9 +7,12 @@
 
 #include <systemstats/SensorObject.h>
 
+#include <QVector>
+
 #include <QAlphaCloud/QAlphaCloud>
 
-#include <QTimer>
+#include "fleetobject.h"
+#include "samplehistory.h"
 
 namespace KSysGuard
 {
@@ -19,24 +22,56 @@ class SensorProperty;
 
 namespace QAlphaCloud
 {
+class ChargeConfigInfo;
 class Connector;
+class DischargeConfigInfo;
 class LastPowerData;
 } // namespace QAlphaCloud
 
 class QModelIndex;
 
+class PollScheduler;
+
 class LiveDataObject : public KSysGuard::SensorObject
 {
 public:
-    LiveDataObject(QAlphaCloud::Connector *connector, const QString &serialNumber, KSysGuard::SensorContainer *parent);
+    LiveDataObject(QAlphaCloud::Connector *connector,
+                   const QString &serialNumber,
+                   PollScheduler *scheduler,
+                   FleetObject *fleet,
+                   KSysGuard::SensorContainer *parent);
 
     void update();
     void updateSystem(const QModelIndex &index);
 
 private:
-    void reload();
+    struct AverageProperty {
+        KSysGuard::SensorProperty *property;
+        SampleHistory::Window window;
+        SampleHistory::Channel channel;
+    };
+    struct EnergyProperty {
+        KSysGuard::SensorProperty *property;
+        SampleHistory::Channel channel;
+    };
+
+    bool poll();
+    void schedulePoll();
+
+    // This system's share of the combined fleet sensors.
+    FleetObject::Contribution contribution() const;
+
+    SampleHistory::Values currentValues() const;
+    void addAverageProperty(const QString &id, const QString &name, const QString &shortName, SampleHistory::Window window, SampleHistory::Channel channel);
+    void addEnergyProperty(const QString &id, const QString &name, const QString &shortName, SampleHistory::Channel channel);
 
     QAlphaCloud::LastPowerData *m_liveData = nullptr;
+    // For when charging and discharging the battery stops (so remaining time is more accurate).
+    QAlphaCloud::ChargeConfigInfo *m_chargeConfig = nullptr;
+    QAlphaCloud::DischargeConfigInfo *m_dischargeConfig = nullptr;
+    PollScheduler *m_scheduler = nullptr;
+    FleetObject *m_fleet = nullptr;
+    QString m_serialNumber;
 
     // Live data:
     KSysGuard::SensorProperty *m_photovoltaicPowerProperty = nullptr;
@@ -54,11 +89,12 @@ private:
     KSysGuard::SensorProperty *m_batteryTimeProperty = nullptr;
     // TODO battery status property
 
+    // Derived from the sample history:
+    QVector<AverageProperty> m_averageProperties;
+    QVector<EnergyProperty> m_energyProperties;
+
+    SampleHistory m_history;
+
     // Mirrored from StorageSystemsModel
     int m_batteryRemainingCapacityWh = 0;
-    // When discharging the battery stops (so remaining time is more accurate).
-    qreal m_batteryDischargeSoc = 0.0;
-
-    QTimer m_rateLimitTimer;
-    bool m_updatePending = false;
 };
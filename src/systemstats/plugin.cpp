@@ -5,14 +5,17 @@
 
 #include "plugin.h"
 #include "dailydataobject.h"
+#include "fleetobject.h"
 #include "livedataobject.h"
+#include "pollscheduler.h"
 #include "systemobject.h"
 
 #include <QNetworkAccessManager>
+#include <QRandomGenerator>
+#include <QSet>
 
 #include <KPluginFactory>
 
-#include <systemstats/AggregateSensor.h>
 #include <systemstats/SensorContainer.h>
 #include <systemstats/SensorObject.h>
 #include <systemstats/SensorProperty.h>
@@ -23,6 +26,10 @@
 K_PLUGIN_CLASS_WITH_JSON(SystemStatsPlugin, "metadata.json")
 
 using namespace QAlphaCloud;
+using namespace std::chrono_literals;
+
+static constexpr std::chrono::milliseconds s_storageSystemsReloadInterval = 1h;
+static constexpr std::chrono::milliseconds s_storageSystemsReloadJitter = 10min;
 
 static QString serialNumberFromIndex(const QModelIndex &index)
 {
@@ -34,6 +41,8 @@ SystemStatsPlugin::SystemStatsPlugin(QObject *parent, const QVariantList &args)
     , m_container(new KSysGuard::SensorContainer("qalphacloud", tr("Alpha Cloud"), this))
     , m_networkAccessManager(new QNetworkAccessManager(this))
     , m_connector(new QAlphaCloud::Connector(QAlphaCloud::Configuration::defaultConfiguration(), this))
+    , m_pollScheduler(new PollScheduler(this))
+    , m_fleet(new FleetObject(m_container))
 {
     m_networkAccessManager->setRedirectPolicy(QNetworkRequest::NoLessSafeRedirectPolicy);
 
@@ -41,23 +50,31 @@ SystemStatsPlugin::SystemStatsPlugin(QObject *parent, const QVariantList &args)
 
     auto *storageSystems = new StorageSystemsModel(m_connector, this);
 
-    connect(storageSystems, &StorageSystemsModel::modelAboutToBeReset, this, [this] {
-        qDeleteAll(m_systems);
-        m_systems.clear();
-        qDeleteAll(m_liveData);
-        m_liveData.clear();
-        qDeleteAll(m_dailyData);
-        m_dailyData.clear();
-    });
-
+    // Keep the sensor objects of systems that are still there so their sensors don't disappear.
     connect(storageSystems, &StorageSystemsModel::modelReset, this, [this, storageSystems] {
+        QSet<QString> serialNumbers;
+        for (int i = 0; i < storageSystems->rowCount(); ++i) {
+            serialNumbers.insert(serialNumberFromIndex(storageSystems->index(i, 0)));
+        }
+
+        const QStringList knownSerialNumbers = m_systems.keys();
+        for (const QString &serialNumber : knownSerialNumbers) {
+            if (!serialNumbers.contains(serialNumber)) {
+                removeStorageSystem(serialNumber);
+            }
+        }
+
         for (int i = 0; i < storageSystems->rowCount(); ++i) {
             const QModelIndex index = storageSystems->index(i, 0);
             if (!index.isValid()) { // shouldn't happen.
                 continue;
             }
 
-            addStorageSystem(index);
+            if (m_systems.contains(serialNumberFromIndex(index))) {
+                updateStorageSystem(index, {});
+            } else {
+                addStorageSystem(index);
+            }
         }
     });
 
@@ -78,29 +95,28 @@ SystemStatsPlugin::SystemStatsPlugin(QObject *parent, const QVariantList &args)
                 continue;
             }
 
-            removeStorageSystem(index);
+            removeStorageSystem(serialNumberFromIndex(index));
         }
     });
     connect(storageSystems,
             &StorageSystemsModel::dataChanged,
             this,
             [this, storageSystems](const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles) {
-                Q_UNUSED(roles);
-
                 for (int i = topLeft.row(); i <= bottomRight.row(); ++i) {
-                    const QModelIndex index = storageSystems->index(i, 0);
-                    const QString serialNumber = serialNumberFromIndex(index);
-
-                    if (auto *storageSystem = m_systems.value(serialNumber)) {
-                        storageSystem->update(index);
-                    }
-                    if (auto *liveData = m_liveData.value(serialNumber)) {
-                        liveData->updateSystem(index);
-                    }
+                    updateStorageSystem(storageSystems->index(i, 0), roles);
                 }
             });
 
+    // Systems rarely change but pick up e.g. capacity changes or newly bound systems eventually.
+    m_storageSystemsReloadTimer.setSingleShot(true);
+    m_storageSystemsReloadTimer.setTimerType(Qt::VeryCoarseTimer);
+    connect(&m_storageSystemsReloadTimer, &QTimer::timeout, this, [this, storageSystems] {
+        storageSystems->reload();
+        scheduleStorageSystemsReload();
+    });
+
     storageSystems->reload();
+    scheduleStorageSystemsReload();
 }
 
 SystemStatsPlugin::~SystemStatsPlugin() = default;
@@ -116,30 +132,55 @@ void SystemStatsPlugin::addStorageSystem(const QModelIndex &index)
     storageSystem->update(index);
     m_systems.insert(serialNumber, storageSystem);
 
-    auto *liveData = new LiveDataObject(m_connector, serialNumber, m_container);
+    auto *liveData = new LiveDataObject(m_connector, serialNumber, m_pollScheduler, m_fleet, m_container);
     liveData->updateSystem(index);
     m_liveData.insert(serialNumber, liveData);
 
-    auto *dailyData = new DailyDataObject(m_connector, serialNumber, m_container);
+    auto *dailyData = new DailyDataObject(m_connector, serialNumber, m_pollScheduler, m_container);
     m_dailyData.insert(serialNumber, dailyData);
 }
 
-void SystemStatsPlugin::removeStorageSystem(const QModelIndex &index)
+void SystemStatsPlugin::updateStorageSystem(const QModelIndex &index, const QVector<int> &roles)
 {
     const QString serialNumber = serialNumberFromIndex(index);
+
+    if (auto *storageSystem = m_systems.value(serialNumber)) {
+        storageSystem->update(index);
+    }
+
+    // This triggers a request, avoid it unless the battery actually changed.
+    if (roles.isEmpty() || roles.contains(static_cast<int>(StorageSystemsModel::Roles::BatteryRemainingCapacity))) {
+        if (auto *liveData = m_liveData.value(serialNumber)) {
+            liveData->updateSystem(index);
+        }
+    }
+}
+
+void SystemStatsPlugin::removeStorageSystem(const QString &serialNumber)
+{
     // deleteLater?
     delete m_systems.take(serialNumber);
     delete m_liveData.take(serialNumber);
     delete m_dailyData.take(serialNumber);
+    m_fleet->removeContribution(serialNumber);
 }
 
-void SystemStatsPlugin::update()
+void SystemStatsPlugin::scheduleStorageSystemsReload()
 {
-    // TODO reload storage systems model occasionally
+    // Spread out requests of many instances rather than having them all hit the server at the same time.
+    const auto jitter = std::chrono::milliseconds(QRandomGenerator::global()->bounded(static_cast<int>(2 * s_storageSystemsReloadJitter.count())))
+        - s_storageSystemsReloadJitter;
+    m_storageSystemsReloadTimer.start(s_storageSystemsReloadInterval + jitter);
+}
 
+void SystemStatsPlugin::update()
+{
+    // Requests are sent by the PollScheduler, this only publishes the latest values.
     for (auto *liveData : std::as_const(m_liveData)) {
         liveData->update();
     }
+    // The systems keep the totals up to date themselves as their data changes.
+    m_fleet->update();
     for (auto *dailyData : std::as_const(m_dailyData)) {
         dailyData->update();
     }
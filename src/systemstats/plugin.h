@@ -7,6 +7,8 @@
 
 #include <systemstats/SensorPlugin.h>
 
+#include <QTimer>
+
 namespace KSysGuard
 {
 class SensorContainer;
@@ -21,7 +23,9 @@ class QNetworkAccessManager;
 class QModelIndex;
 
 class DailyDataObject;
+class FleetObject;
 class LiveDataObject;
+class PollScheduler;
 class SystemObject;
 
 class SystemStatsPlugin : public KSysGuard::SensorPlugin
@@ -41,7 +45,9 @@ public:
 
 private:
     void addStorageSystem(const QModelIndex &index);
-    void removeStorageSystem(const QModelIndex &index);
+    void updateStorageSystem(const QModelIndex &index, const QVector<int> &roles);
+    void removeStorageSystem(const QString &serialNumber);
+    void scheduleStorageSystemsReload();
 
     KSysGuard::SensorContainer *m_container;
 
@@ -49,6 +55,12 @@ private:
 
     QAlphaCloud::Connector *m_connector;
 
+    PollScheduler *m_pollScheduler;
+
+    FleetObject *m_fleet;
+
+    QTimer m_storageSystemsReloadTimer;
+
     QHash<QString, SystemObject *> m_systems;
     QHash<QString, LiveDataObject *> m_liveData;
     QHash<QString, DailyDataObject *> m_dailyData;
@@ -0,0 +1,226 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "pollscheduler.h"
+
+#include "qalphacloud_systemstats_log.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Clients due within the same slot are polled in one go.
+static constexpr qint64 s_slotDuration = 1000; // ms
+// Don't send more than this many requests in a single slot, defer the rest.
+static constexpr int s_maximumPollsPerSlot = 4;
+// Intervals are doubled for every consecutive error, up to 2^5 = 32 times.
+static constexpr int s_maximumBackoffLevel = 5;
+
+PollScheduler::PollScheduler(QObject *parent)
+    : QObject(parent)
+{
+    m_clock.start();
+
+    m_timer.setSingleShot(true);
+    m_timer.setTimerType(Qt::VeryCoarseTimer);
+    connect(&m_timer, &QTimer::timeout, this, &PollScheduler::poll);
+}
+
+PollScheduler::~PollScheduler() = default;
+
+void PollScheduler::addClient(QObject *client, std::chrono::milliseconds interval, const PollFunction &poll)
+{
+    Q_ASSERT(client);
+    Q_ASSERT(interval.count() > 0);
+
+    Client entry;
+    entry.object = client;
+    entry.interval = interval.count();
+    entry.poll = poll;
+
+    // Spread clients of the same interval using the golden ratio, which keeps them
+    // evenly distributed no matter how many there will eventually be.
+    int &phaseCounter = m_phaseCounters[entry.interval];
+    const qreal phase = std::fmod(phaseCounter * 0.618033988749895, 1.0);
+    ++phaseCounter;
+
+    // The first poll happens as soon as someone subscribes, see schedule().
+    entry.nextPoll = m_clock.elapsed() + static_cast<qint64>(phase * entry.interval);
+
+    m_clients.append(entry);
+
+    connect(client, &QObject::destroyed, this, [this](QObject *object) {
+        removeClient(object);
+    });
+
+    scheduleTimer();
+}
+
+void PollScheduler::removeClient(QObject *client)
+{
+    m_clients.erase(std::remove_if(m_clients.begin(),
+                                   m_clients.end(),
+                                   [client](const Client &entry) {
+                                       return entry.object == client;
+                                   }),
+                    m_clients.end());
+    disconnect(client, nullptr, this, nullptr);
+}
+
+PollScheduler::Client *PollScheduler::findClient(QObject *client)
+{
+    auto it = std::find_if(m_clients.begin(), m_clients.end(), [client](const Client &entry) {
+        return entry.object == client;
+    });
+    if (it == m_clients.end()) {
+        return nullptr;
+    }
+    return &*it;
+}
+
+void PollScheduler::schedule(QObject *client)
+{
+    Client *it = findClient(client);
+    if (!it) {
+        return;
+    }
+
+    const qint64 now = m_clock.elapsed();
+    qint64 nextPoll = now;
+    if (it->lastPoll > -1) {
+        nextPoll = std::max(now, it->lastPoll + effectiveInterval(*it));
+    }
+
+    if (nextPoll < it->nextPoll) {
+        it->nextPoll = nextPoll;
+        scheduleTimer();
+    }
+}
+
+bool PollScheduler::isGlobalError(QAlphaCloud::ErrorCode error)
+{
+    switch (error) {
+    // The rate limit applies to the account as a whole.
+    case QAlphaCloud::ErrorCode::TooManyRequests:
+    // Every request is signed the same way, so if one is rejected, all of them are.
+    case QAlphaCloud::ErrorCode::TimestampError:
+    case QAlphaCloud::ErrorCode::TimestampEmpty:
+    case QAlphaCloud::ErrorCode::SignVerificationError:
+    case QAlphaCloud::ErrorCode::SignEmpty:
+    case QAlphaCloud::ErrorCode::AppIdEmpty:
+    case QAlphaCloud::ErrorCode::WhitelistVerificationFailed:
+        return true;
+    default:
+        return false;
+    }
+}
+
+void PollScheduler::reportSuccess(QObject *client)
+{
+    Client *entry = findClient(client);
+    if (entry && entry->backoffLevel > 0) {
+        qCDebug(QALPHACLOUD_SYSTEMSTATS_LOG) << "Request of" << client << "succeeded, resuming regular polling";
+        entry->backoffLevel = 0;
+    }
+
+    // Ease off gradually, so as not to run into the rate limit again right away.
+    if (m_globalBackoffLevel > 0) {
+        --m_globalBackoffLevel;
+        qCDebug(QALPHACLOUD_SYSTEMSTATS_LOG) << "Request of" << client << "succeeded, polling all clients" << (1 << m_globalBackoffLevel) << "times less often";
+    }
+}
+
+void PollScheduler::reportError(QObject *client, QAlphaCloud::ErrorCode error)
+{
+    if (isGlobalError(error)) {
+        if (m_globalBackoffLevel >= s_maximumBackoffLevel) {
+            return;
+        }
+
+        ++m_globalBackoffLevel;
+        qCDebug(QALPHACLOUD_SYSTEMSTATS_LOG) << "Request of" << client << "failed with" << error << "polling all clients" << (1 << m_globalBackoffLevel)
+                                             << "times less often";
+
+        // Also postpone polls that were already scheduled with the shorter interval.
+        for (Client &entry : m_clients) {
+            if (entry.lastPoll > -1) {
+                entry.nextPoll = std::max(entry.nextPoll, entry.lastPoll + effectiveInterval(entry));
+            }
+        }
+        return;
+    }
+
+    Client *entry = findClient(client);
+    if (entry && entry->backoffLevel < s_maximumBackoffLevel) {
+        ++entry->backoffLevel;
+        qCDebug(QALPHACLOUD_SYSTEMSTATS_LOG) << "Request of" << client << "failed with" << error << "polling it" << (1 << entry->backoffLevel)
+                                             << "times less often";
+    }
+}
+
+qint64 PollScheduler::effectiveInterval(const Client &client) const
+{
+    return client.interval << std::max(client.backoffLevel, m_globalBackoffLevel);
+}
+
+void PollScheduler::poll()
+{
+    // Anything due in this slot gets handled now rather than waking up again shortly.
+    const qint64 now = m_clock.elapsed();
+    const qint64 slotEnd = now + s_slotDuration / 2;
+
+    QVector<Client *> due;
+    for (Client &client : m_clients) {
+        if (client.nextPoll <= slotEnd) {
+            due.append(&client);
+        }
+    }
+
+    // Most overdue first so deferred clients don't starve.
+    std::sort(due.begin(), due.end(), [](const Client *a, const Client *b) {
+        return a->nextPoll < b->nextPoll;
+    });
+
+    int sent = 0;
+    for (Client *client : std::as_const(due)) {
+        if (sent >= s_maximumPollsPerSlot) {
+            break;
+        }
+
+        const qint64 interval = effectiveInterval(*client);
+
+        if (client->poll()) {
+            client->lastPoll = now;
+            ++sent;
+        }
+
+        client->nextPoll += interval;
+        // Don't try to catch up on polls we missed, e.g. after suspend.
+        if (client->nextPoll <= now) {
+            client->nextPoll = now + interval;
+        }
+    }
+
+    scheduleTimer();
+}
+
+void PollScheduler::scheduleTimer()
+{
+    if (m_clients.isEmpty()) {
+        m_timer.stop();
+        return;
+    }
+
+    const auto it = std::min_element(m_clients.cbegin(), m_clients.cend(), [](const Client &a, const Client &b) {
+        return a.nextPoll < b.nextPoll;
+    });
+
+    const qint64 delay = std::max(qint64(0), it->nextPoll - m_clock.elapsed());
+    // Round up to the slot duration so nearby clients share a wakeup.
+    const qint64 slotDelay = std::max(s_slotDuration, ((delay + s_slotDuration - 1) / s_slotDuration) * s_slotDuration);
+
+    if (!m_timer.isActive() || m_timer.remainingTime() > slotDelay) {
+        m_timer.start(static_cast<int>(slotDelay));
+    }
+}
@@ -0,0 +1,78 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+
+#include <chrono>
+#include <functional>
+
+#include <QAlphaCloud/QAlphaCloud>
+
+/**
+ * Schedules polling of all storage systems from a single coarse timer.
+ *
+ * Clients with the same interval are spread evenly across it, so many systems
+ * don't all fire their requests at once. Clients that are due within the same
+ * slot are handled in one wakeup, and at most a few requests are sent per slot.
+ */
+class PollScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * Called when a client is due, returns whether a request was actually sent,
+     * which it shouldn't if nobody is subscribed to its sensors.
+     */
+    using PollFunction = std::function<bool()>;
+
+    explicit PollScheduler(QObject *parent = nullptr);
+    ~PollScheduler() override;
+
+    void addClient(QObject *client, std::chrono::milliseconds interval, const PollFunction &poll);
+    void removeClient(QObject *client);
+
+    // Poll as soon as the client's rate limit permits, e.g. when a sensor got subscribed.
+    void schedule(QObject *client);
+
+    // Failed requests slow down polling of that client until one of its requests succeeds again.
+    // Errors that affect every storage system, e.g. the rate limit being hit or an invalid
+    // signature, slow down all clients instead, until requests succeed again.
+    void reportSuccess(QObject *client);
+    void reportError(QObject *client, QAlphaCloud::ErrorCode error);
+
+private:
+    struct Client {
+        QObject *object = nullptr;
+        qint64 interval = 0;
+        qint64 nextPoll = 0;
+        qint64 lastPoll = -1;
+        int backoffLevel = 0;
+        PollFunction poll;
+    };
+
+    static bool isGlobalError(QAlphaCloud::ErrorCode error);
+
+    Client *findClient(QObject *client);
+
+    qint64 effectiveInterval(const Client &client) const;
+    void poll();
+    void scheduleTimer();
+
+    QVector<Client> m_clients;
+    // How many clients have been added per interval, for spreading them out.
+    QHash<qint64, int> m_phaseCounters;
+    // Applies to all clients, on top of their own backoff.
+    int m_globalBackoffLevel = 0;
+
+    QElapsedTimer m_clock;
+    QTimer m_timer;
+};
@@ -0,0 +1,126 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "samplehistory.h"
+
+#include <QDateTime>
+
+#include <algorithm>
+
+using namespace std::chrono_literals;
+
+// Don't integrate across gaps longer than this, e.g. when nobody was subscribed
+// and thus no data was polled, as we don't know what happened in the meantime.
+static constexpr qint64 s_maximumGap = std::chrono::milliseconds(5min).count();
+
+SampleHistory::SampleHistory(int capacity)
+{
+    Q_ASSERT(capacity > 0);
+    m_samples.resize(capacity);
+
+    m_windows[static_cast<int>(Window::FiveMinutes)].duration = std::chrono::milliseconds(5min).count();
+    m_windows[static_cast<int>(Window::FifteenMinutes)].duration = std::chrono::milliseconds(15min).count();
+    m_windows[static_cast<int>(Window::SixtyMinutes)].duration = std::chrono::milliseconds(60min).count();
+}
+
+const SampleHistory::Sample &SampleHistory::sampleAt(qint64 sequence) const
+{
+    return m_samples.at(static_cast<int>(sequence % m_samples.count()));
+}
+
+void SampleHistory::expire(WindowState &window, qint64 now, qint64 oldest)
+{
+    // Each sample leaves a window only once, so this is O(1) amortized.
+    while (window.first < m_sequence && (window.first < oldest || sampleAt(window.first).time <= now - window.duration)) {
+        const Sample &expired = sampleAt(window.first);
+        for (int i = 0; i < s_channelCount; ++i) {
+            window.sums[i] -= expired.values[i];
+        }
+        ++window.first;
+    }
+}
+
+void SampleHistory::addSample(qint64 time, const Values &values)
+{
+    const bool hasPrevious = m_sequence > 0;
+    const Sample previous = hasPrevious ? sampleAt(m_sequence - 1) : Sample();
+
+    if (hasPrevious && time <= previous.time) {
+        return;
+    }
+
+    // Energy since midnight, using the trapezoidal rule.
+    const QDate date = QDateTime::fromMSecsSinceEpoch(time).date();
+    if (m_energyDate != date) {
+        m_energyDate = date;
+        m_energy.fill(0);
+    } else if (hasPrevious && time - previous.time <= s_maximumGap) {
+        const qreal hours = (time - previous.time) / qreal(std::chrono::milliseconds(1h).count());
+        for (int i = 0; i < s_channelCount; ++i) {
+            m_energy[i] += (previous.values[i] + values[i]) / 2.0 * hours;
+        }
+    }
+
+    const qint64 sequence = m_sequence;
+    // Oldest sample that will still be in the buffer once this one has been added.
+    const qint64 oldest = std::max(qint64(0), sequence + 1 - m_samples.count());
+
+    for (WindowState &window : m_windows) {
+        // Samples about to be overwritten are expired before their values are gone.
+        expire(window, time, oldest);
+
+        for (int i = 0; i < s_channelCount; ++i) {
+            window.sums[i] += values[i];
+        }
+    }
+
+    // Overwrites the oldest sample once full.
+    Sample &sample = m_samples[static_cast<int>(sequence % m_samples.count())];
+    sample.time = time;
+    sample.values = values;
+    ++m_sequence;
+}
+
+void SampleHistory::clear()
+{
+    m_sequence = 0;
+    for (WindowState &window : m_windows) {
+        window.first = 0;
+        window.sums.fill(0);
+    }
+    m_energyDate = QDate();
+    m_energy.fill(0);
+}
+
+int SampleHistory::count() const
+{
+    return static_cast<int>(std::min(m_sequence, qint64(m_samples.count())));
+}
+
+int SampleHistory::capacity() const
+{
+    return m_samples.count();
+}
+
+qreal SampleHistory::average(Window window, Channel channel, qint64 now)
+{
+    WindowState &state = m_windows[static_cast<int>(window)];
+    // Without new samples, e.g. when polling stopped, old ones would linger forever otherwise.
+    expire(state, now, 0);
+
+    const qint64 count = m_sequence - state.first;
+    if (count <= 0) {
+        return 0.0;
+    }
+    return state.sums[static_cast<int>(channel)] / qreal(count);
+}
+
+qreal SampleHistory::energyToday(Channel channel, qint64 now) const
+{
+    if (m_energyDate != QDateTime::fromMSecsSinceEpoch(now).date()) {
+        return 0.0;
+    }
+    return m_energy[static_cast<int>(channel)];
+}
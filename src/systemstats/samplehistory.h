@@ -0,0 +1,85 @@
+/*
+ * SPDX-FileCopyrightText: 2023 Kai Uwe Broulik <ghqalpha@broulik.de>
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include <QDate>
+#include <QVector>
+
+#include <array>
+#include <chrono>
+
+/**
+ * Keeps a fixed number of timestamped live data samples.
+ *
+ * All storage is allocated upfront, adding a sample never allocates.
+ *
+ * Rolling averages and the energy since midnight are updated incrementally
+ * as samples are added rather than being recomputed from the buffer.
+ */
+class SampleHistory
+{
+public:
+    enum class Channel {
+        Photovoltaic = 0,
+        Load,
+        GridFeed,
+        GridConsumption,
+        BatteryCharge,
+        BatteryDischarge,
+    };
+    static constexpr int s_channelCount = 6;
+
+    enum class Window {
+        FiveMinutes = 0,
+        FifteenMinutes,
+        SixtyMinutes,
+    };
+    static constexpr int s_windowCount = 3;
+
+    using Values = std::array<int, s_channelCount>;
+
+    // 60 minutes at the fastest poll interval of 10 seconds, with some room to spare.
+    explicit SampleHistory(int capacity = 512);
+
+    void addSample(qint64 time, const Values &values);
+    void clear();
+
+    int count() const;
+    int capacity() const;
+
+    // Average power in W of all samples within the window ending at now, 0 if there are none.
+    // Samples that left the window since the last one was added are expired first.
+    qreal average(Window window, Channel channel, qint64 now);
+    // Energy in Wh since the local midnight before now, integrated from the samples.
+    qreal energyToday(Channel channel, qint64 now) const;
+
+private:
+    struct Sample {
+        qint64 time = 0; // ms since epoch
+        Values values{};
+    };
+
+    struct WindowState {
+        qint64 duration = 0; // ms
+        // Sequence number of the oldest sample within the window.
+        qint64 first = 0;
+        std::array<qint64, s_channelCount> sums{};
+    };
+
+    const Sample &sampleAt(qint64 sequence) const;
+    // Removes samples older than the window's duration before now, as well as those
+    // older than the oldest sequence number, which are about to be overwritten.
+    void expire(WindowState &window, qint64 now, qint64 oldest);
+
+    QVector<Sample> m_samples;
+    // Total number of samples ever added, the newest one being m_sequence - 1.
+    qint64 m_sequence = 0;
+
+    std::array<WindowState, s_windowCount> m_windows;
+
+    QDate m_energyDate;
+    std::array<qreal, s_channelCount> m_energy{}; // Wh
+};
@@ -8,7 +8,6 @@
 #include <QAlphaCloud/QAlphaCloud>
 #include <QAlphaCloud/StorageSystemsModel>
 
-#include <systemstats/AggregateSensor.h>
 #include <systemstats/SensorContainer.h>
 #include <systemstats/SensorProperty.h>
 
@@ -16,6 +15,14 @@
 
 using namespace QAlphaCloud;
 
+// Storage systems are reloaded periodically, don't notify about values that didn't change.
+static void setValueIfChanged(KSysGuard::SensorProperty *property, const QVariant &value)
+{
+    if (property->value() != value) {
+        property->setValue(value);
+    }
+}
+
 SystemObject::SystemObject(const QString &serialNumber,
                            // DO NOT store this QModelIndex. It is only for
                            // initial popuplation of the container.
@@ -72,32 +79,32 @@ SystemObject::SystemObject(const QString &serialNumber,
 void SystemObject::update(const QModelIndex &index)
 {
 #if PRESENTATION_BUILD
-    m_serialNumberProperty->setValue(tr("<Serial Number>"));
+    setValueIfChanged(m_serialNumberProperty, tr("<Serial Number>"));
 #else
     const QString serialNumber = index.data(static_cast<int>(StorageSystemsModel::Roles::SerialNumber)).toString();
-    m_serialNumberProperty->setValue(serialNumber);
+    setValueIfChanged(m_serialNumberProperty, serialNumber);
 #endif
 
 #if PRESENTATION_BUILD
-    m_inverterModelProperty->setValue(tr("<Inverter Model>"));
+    setValueIfChanged(m_inverterModelProperty, tr("<Inverter Model>"));
 #else
     const QString inverterModel = index.data(static_cast<int>(StorageSystemsModel::Roles::InverterModel)).toString();
-    m_inverterModelProperty->setValue(inverterModel);
+    setValueIfChanged(m_inverterModelProperty, inverterModel);
 #endif
 
 #if PRESENTATION_BUILD
-    m_batteryModelProperty->setValue(tr("<Battery Model>"));
+    setValueIfChanged(m_batteryModelProperty, tr("<Battery Model>"));
 #else
     const QString batteryModel = index.data(static_cast<int>(StorageSystemsModel::Roles::BatteryModel)).toString();
-    m_batteryModelProperty->setValue(batteryModel);
+    setValueIfChanged(m_batteryModelProperty, batteryModel);
 #endif
 
     const auto batteryGrossCapacity = index.data(static_cast<int>(StorageSystemsModel::Roles::BatteryGrossCapacity)).value<int>();
-    m_batteryGrossCapacityProperty->setValue(batteryGrossCapacity);
+    setValueIfChanged(m_batteryGrossCapacityProperty, batteryGrossCapacity);
 
     const auto batteryRemainingCapacity = index.data(static_cast<int>(StorageSystemsModel::Roles::BatteryRemainingCapacity)).value<int>();
-    m_batteryRemainingCapacityProperty->setValue(batteryRemainingCapacity);
+    setValueIfChanged(m_batteryRemainingCapacityProperty, batteryRemainingCapacity);
 
     const auto batteryUsableCapacity = index.data(static_cast<int>(StorageSystemsModel::Roles::BatteryUsableCapacity)).value<qreal>();
-    m_batteryUsableCapacityProperty->setValue(batteryUsableCapacity);
+    setValueIfChanged(m_batteryUsableCapacityProperty, batteryUsableCapacity);
 }